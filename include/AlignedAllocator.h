@@ -0,0 +1,55 @@
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Standard allocator returning storage aligned to a fixed boundary
+ *
+ * Used for the structure-of-arrays state vectors so SIMD kernels always
+ * start on a cache-line (64-byte) boundary.
+ */
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() noexcept {}
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+/// Cache-line aligned vector for SoA storage of any scalar type
+template <typename T>
+using AlignedArray = std::vector<T, AlignedAllocator<T, 64>>;
+
+/// Cache-line aligned vector of doubles for SoA state storage
+typedef AlignedArray<double> AlignedVector;
+
+#endif // ALIGNEDALLOCATOR_H
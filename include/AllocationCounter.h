@@ -0,0 +1,40 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+/**
+ * @brief Test hook counting heap allocations per thread and across the step threads
+ *
+ * When the build defines SIMTOOL_COUNT_ALLOCATIONS (CMake option of the
+ * same name), AllocationCounter.cpp replaces the global operator new and
+ * every allocation increments a counter of the calling thread. Threads
+ * that take part in time steps (the stepping thread and the
+ * WorkStealingPool workers) are tracked as well: their allocations also
+ * go to one process-wide counter, which the simulation engine and the
+ * step_allocations test sample around each step, so allocations inside
+ * parallel loops are seen too. Without the option the counters always
+ * read zero and cost nothing.
+ */
+namespace AllocationCounter
+{
+    /**
+     * @brief Check whether allocation counting is compiled in
+     */
+    bool isEnabled();
+
+    /**
+     * @brief Number of allocations made by the calling thread so far
+     */
+    unsigned long long threadAllocations();
+
+    /**
+     * @brief Count the calling thread's allocations in trackedAllocations() from now on
+     */
+    void trackThread();
+
+    /**
+     * @brief Number of allocations made by all tracked threads so far
+     */
+    unsigned long long trackedAllocations();
+}
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,123 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <QFile>
+#include <QString>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "SimulationTypes.h"
+
+/**
+ * @brief Binary checkpoint of a run: parameters, state and solver counters
+ *
+ * A checkpoint file holds a header and two slots, each large enough for
+ * the whole state. Writes alternate between the slots and every slot
+ * carries a sequence number and a checksum, so a write interrupted by a
+ * crash leaves the previous checkpoint intact. read() returns the newest
+ * slot whose checksum matches.
+ */
+struct Checkpoint
+{
+    SimulationParameters parameters;
+    SimulationState state;
+    double initialEnergy;       // Steady-state reference E0
+    int quietSteps;             // Steady-state window progress
+
+    Checkpoint()
+        : initialEnergy(0.0)
+        , quietSteps(0)
+    {}
+
+    /**
+     * @brief Load the newest valid checkpoint of a file
+     * @param path Checkpoint file written by CheckpointWriter
+     * @param checkpoint Filled on success
+     * @param error Reason on failure
+     * @return true if a valid checkpoint was found
+     */
+    static bool read(const QString& path, Checkpoint& checkpoint, QString& error);
+};
+
+/**
+ * @brief Writes checkpoints to a memory-mapped file on a background thread
+ *
+ * submit() copies the state into a staging buffer and returns; the writer
+ * thread copies it into the mapped file and computes the checksum. If the
+ * previous checkpoint is still being written, submit() skips the new one
+ * instead of waiting, so checkpointing never stalls the step loop. The
+ * staging buffer is reused, so steady-state submissions do not allocate.
+ *
+ * The mapping is shared, so a checkpoint survives a crash or kill of the
+ * process once written; surviving a power loss depends on the OS flushing
+ * the page cache.
+ */
+class CheckpointWriter
+{
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * @brief Create or reuse a checkpoint file for a model size and map it
+     *
+     * An existing file for the same DOF count keeps its checkpoints and the
+     * sequence continues, so a resumed run may checkpoint into the file it
+     * was resumed from.
+     *
+     * @return false (with lastError()) if the file cannot be sized or mapped
+     */
+    bool open(const QString& path, int numDOF);
+
+    /**
+     * @brief Queue a checkpoint unless one is still being written
+     * @return true if queued, false if skipped (busy or not open)
+     */
+    bool submit(const SimulationParameters& parameters, const SimulationState& state,
+                double initialEnergy, int quietSteps);
+
+    /**
+     * @brief Wait until the queued checkpoint (if any) is in the file
+     */
+    void flush();
+
+    /**
+     * @brief Flush, stop the writer thread and unmap the file
+     */
+    void close();
+
+    bool isOpen() const { return m_mapped != nullptr; }
+    QString path() const { return m_file.fileName(); }
+    QString lastError() const { return m_lastError; }
+
+    // Statistics since open()
+    int writtenCount() const { return m_written; }
+    int skippedCount() const { return m_skipped; }
+
+private:
+    void writerLoop();
+    void writeSlot();
+
+    QFile m_file;
+    uchar* m_mapped;
+    int m_numDOF;
+    unsigned long long m_sequence;
+    QString m_lastError;
+
+    // Staging copy handed to the writer thread
+    Checkpoint m_staging;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_pending;             // Staging holds a checkpoint not yet written
+    bool m_shutdown;
+
+    int m_written;
+    int m_skipped;
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,145 @@
+#ifndef CONTACTDETECTOR_H
+#define CONTACTDETECTOR_H
+
+#include "StructuralModel.h"
+#include "WorkStealingPool.h"
+#include <vector>
+
+/**
+ * @brief Penalty contact between the bodies of a discretized model
+ *
+ * Node-to-surface contact: a node closer than the contact thickness to a
+ * surface triangle of another body is pushed out along the separation
+ * direction with a penalty force k (thickness - distance), and the
+ * reaction is spread over the triangle's nodes by barycentric weights.
+ * Both bodies of a pair take part as nodes and as surfaces. Contact
+ * within one body is ignored.
+ *
+ * Broad phase: one bounding volume hierarchy per body over its surface
+ * triangles, built once in setup() from the reference geometry and refit
+ * bottom-up to the deformed positions on every evaluation. A node only
+ * descends into the trees of other bodies whose root box it lies in, so
+ * an evaluation costs O(nodes log triangles) instead of the quadratic
+ * pair test. Node queries run on the thread pool; the forces are
+ * scattered afterwards in node order, so the result does not depend on
+ * the thread count.
+ *
+ * All buffers are allocated in setup(); computeForces() does not allocate.
+ */
+class ContactDetector
+{
+public:
+    /**
+     * @brief Totals of the last evaluation
+     */
+    struct Statistics
+    {
+        int contacts;               // Nodes in contact
+        double maxPenetration;      // Largest thickness - distance
+        long long evaluations;      // computeForces() calls since setup()
+        int peakContacts;           // Largest contact count since setup()
+
+        Statistics()
+            : contacts(0)
+            , maxPenetration(0.0)
+            , evaluations(0)
+            , peakContacts(0)
+        {}
+    };
+
+    ContactDetector();
+
+    /**
+     * @brief Build the hierarchies for a model
+     *
+     * Contact needs 3-DOF nodes and at least two bodies with triangles;
+     * otherwise the detector stays disabled. The model must stay alive and
+     * unchanged until the next setup().
+     *
+     * @param model Discretized model (reference node coordinates, triangles, bodies)
+     * @param stiffness Penalty stiffness per unit penetration (> 0)
+     * @param thickness Contact distance (0 = a quarter of the mean edge length)
+     * @param pool Thread pool for the node queries (null = calling thread only)
+     * @param grain Nodes per parallel chunk
+     * @return true if contact is active for this model
+     */
+    bool setup(const StructuralModel& model, double stiffness, double thickness,
+               WorkStealingPool* pool, int grain);
+
+    /**
+     * @brief Release every buffer and disable contact
+     */
+    void clear();
+
+    bool isEnabled() const { return !m_roots.empty(); }
+
+    /**
+     * @brief Contact forces at the given nodal displacements
+     *
+     * Writes the penalty forces of the nodes in contact into forces (one
+     * entry per DOF) and zeroes the entries written by the previous call;
+     * all other entries are left untouched, so a zeroed array stays zero
+     * away from the contact zone.
+     *
+     * @param displacements Displacement per DOF (3 per node)
+     * @param forces Contact force per DOF
+     */
+    template <typename Accum, typename Real>
+    void computeForces(const Accum* displacements, Real* forces);
+
+    /**
+     * @brief Nodes that received a contact force in the last evaluation
+     */
+    const std::vector<int>& activeNodes() const { return m_activeNodes; }
+
+    double stiffness() const { return m_stiffness; }
+    double thickness() const { return m_thickness; }
+    int bodyCount() const { return static_cast<int>(m_roots.size()); }
+    int treeNodeCount() const { return static_cast<int>(m_tree.size()); }
+    const Statistics& statistics() const { return m_statistics; }
+
+private:
+    /**
+     * @brief Hierarchy node; children of an inner node follow it (left at +1)
+     */
+    struct TreeNode
+    {
+        double lower[3];
+        double upper[3];
+        int first;                  // Leaf: first entry in m_order
+        int count;                  // Leaf: triangle count; 0 for inner nodes
+        int right;                  // Inner: index of the right child
+    };
+
+    int build(int begin, int end, const std::vector<double>& centroids);
+    void refit();
+    void queryNode(int node);
+
+    template <typename Body>
+    void forEachChunk(int count, const Body& body);
+
+    const StructuralModel* m_model;
+    WorkStealingPool* m_pool;
+    int m_grain;
+    double m_stiffness;
+    double m_thickness;
+
+    // Broad phase
+    std::vector<TreeNode> m_tree;
+    std::vector<int> m_order;               // Triangle indices, grouped by leaf
+    std::vector<int> m_roots;               // Root node per body with triangles
+    std::vector<int> m_rootBodies;          // Body index of each root
+    std::vector<int> m_triangleBodies;      // Body index per triangle
+
+    // Per evaluation
+    std::vector<double> m_positions;        // Deformed node coordinates
+    std::vector<int> m_hitTriangles;        // Closest triangle of another body per node (-1 = none)
+    std::vector<double> m_hitWeights;       // Barycentric weights of the closest point
+    std::vector<double> m_hitForces;        // Penalty force on the node
+    std::vector<int> m_activeNodes;
+    std::vector<char> m_isActive;
+
+    Statistics m_statistics;
+};
+
+#endif // CONTACTDETECTOR_H
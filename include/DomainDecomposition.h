@@ -0,0 +1,104 @@
+#ifndef DOMAINDECOMPOSITION_H
+#define DOMAINDECOMPOSITION_H
+
+#include "SimulationTypes.h"
+#include "StructuralModel.h"
+#include <vector>
+
+/**
+ * @brief Subdomains of a partitioned model, with halo layers and exchange lists
+ *
+ * Each part owns its nodes and keeps copies of the nodes within haloDepth
+ * edges of them (its halo). A subdomain model holds the owned and halo
+ * nodes and every edge between them, so the rows of the owned DOFs are
+ * exactly the rows of the full operator. One force evaluation spoils the
+ * outermost valid halo ring, so with a halo as deep as the force
+ * evaluations of a step and the halo state refreshed after every step,
+ * the owned DOFs advance as in an undivided run, up to the rounding of
+ * summing each row in the local node order.
+ *
+ * Exchange lists pair up across parts: the nodes part p sends to part q
+ * and the nodes q receives from p are the same global nodes in the same
+ * order (ascending global index), so a message is a plain array. Nothing
+ * here depends on how messages travel (see DomainExchange).
+ */
+class DomainDecomposition
+{
+public:
+    /**
+     * @brief Exchange with one neighbouring part (local node indices)
+     */
+    struct Link
+    {
+        int part;
+        std::vector<int> sendNodes;         // Owned nodes in the other part's halo
+        std::vector<int> receiveNodes;      // Halo nodes owned by the other part
+    };
+
+    /**
+     * @brief Local model of one part
+     */
+    struct Subdomain
+    {
+        int part;
+        int ownedNodes;                     // Local nodes below this are owned, the rest are halo
+        std::vector<int> globalNodes;       // Global node of each local node
+        StructuralModel model;              // Unassembled; same stiffness rows for owned DOFs
+        std::vector<Link> links;            // By ascending part
+    };
+
+    /**
+     * @param model Full model (unassembled is enough); must outlive this object
+     * @param nodeParts Part of each node (see GraphPartitioner)
+     * @param parts Number of parts
+     * @param haloDepth Halo rings around each part
+     */
+    DomainDecomposition(const StructuralModel& model, const std::vector<int>& nodeParts, int parts, int haloDepth);
+
+    int parts() const { return m_parts; }
+    int haloDepth() const { return m_haloDepth; }
+    const std::vector<int>& nodeParts() const { return m_nodeParts; }
+
+    /**
+     * @brief Global halo nodes of a part, ascending
+     */
+    const std::vector<int>& halo(int part) const { return m_halos[part]; }
+
+    /**
+     * @brief Nodes sent from one part to another after every step
+     */
+    int exchangeCount(int from, int to) const { return m_exchangeCounts[from * m_parts + to]; }
+
+    /**
+     * @brief Build the local model and exchange lists of one part
+     * @param part Part index
+     * @param ordering Order of the owned nodes (halo nodes follow in global order)
+     */
+    Subdomain subdomain(int part, DofOrdering ordering) const;
+
+    /**
+     * @brief Halo rings a step of the integrator needs (its force evaluations)
+     */
+    static int haloDepth(IntegratorType type);
+
+    /**
+     * @brief Throw std::runtime_error unless the parameters can run decomposed
+     *
+     * Decomposed runs need an explicit fixed-step integrator in double
+     * precision without contact: adaptive and implicit schemes couple all
+     * DOFs in every step.
+     */
+    static void checkSupported(const SimulationParameters& params);
+
+private:
+    const StructuralModel& m_model;
+    std::vector<int> m_nodeParts;
+    int m_parts;
+    int m_haloDepth;
+    std::vector<int> m_pointers;            // Node adjacency (CSR)
+    std::vector<int> m_neighbours;
+    std::vector<std::vector<int>> m_halos;
+    std::vector<int> m_exchangeCounts;      // parts x parts, row = sender
+};
+
+#endif // DOMAINDECOMPOSITION_H
@@ -0,0 +1,119 @@
+#ifndef DOMAINEXCHANGE_H
+#define DOMAINEXCHANGE_H
+
+#include <QProcess>
+#include <QSharedMemory>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "GraphPartitioner.h"
+#include "SimulationTypes.h"
+#include "StructuralModel.h"
+
+/**
+ * @brief Runs a model as subdomains in worker processes on this host
+ *
+ * The coordinator partitions the model (GraphPartitioner), writes model,
+ * partition, parameters and state into one QSharedMemory segment and
+ * starts one worker process per part. Each worker builds its own
+ * subdomain (DomainDecomposition) and steps it with a SimulationSolver.
+ * After every step the workers exchange their halo values through
+ * per-link message buffers in the segment and meet at a barrier; there
+ * is no other synchronization inside a batch. Message buffers alternate
+ * between even and odd steps, so a fast worker never overwrites values a
+ * neighbour has not read yet.
+ *
+ * The coordinator drives the workers in batches (runBatch()). At the end
+ * of a batch every worker writes its owned state and energy into the
+ * segment, where readState() finds the whole state in the original DOF
+ * numbering.
+ *
+ * Workers are separate processes: a crash ends only that worker, and the
+ * coordinator reports it as an error of the run instead of going down
+ * with it. On Linux each worker pins itself to its own block of the
+ * allowed CPUs before allocating anything, so its memory is placed on the
+ * NUMA node it runs on (first touch). Workers end themselves when the
+ * coordinator process goes away.
+ *
+ * Messages are plain arrays in the order of the exchange lists, so the
+ * transport could be swapped for a network one without changing the
+ * subdomain code.
+ */
+class DomainCoordinator
+{
+public:
+    DomainCoordinator();
+    ~DomainCoordinator();
+
+    DomainCoordinator(const DomainCoordinator&) = delete;
+    DomainCoordinator& operator=(const DomainCoordinator&) = delete;
+
+    /**
+     * @brief Partition the model and start the workers
+     * @param params Run parameters; params.subdomains gives the part count
+     * @param model Unassembled model in its original numbering
+     * @param state Initial state in the original numbering
+     * @param program Worker executable (SimulationToolCli)
+     * @throws std::runtime_error if the parameters cannot run decomposed or a worker fails to start
+     */
+    void start(const SimulationParameters& params, const StructuralModel& model, const SimulationState& state,
+               const QString& program);
+
+    /**
+     * @brief Advance every subdomain by some steps and wait for all of them
+     * @throws std::runtime_error if a worker fails or exits
+     */
+    void runBatch(int steps);
+
+    /**
+     * @brief Positions, velocities, accelerations and energy after the last batch
+     *
+     * Vectors are assigned element-wise; step counters are left alone.
+     * The energy is that of the state at the end of the batch (undivided
+     * runs of some schemes report it at the start of their last step).
+     */
+    void readState(SimulationState& state) const;
+
+    /**
+     * @brief Stop and reap the workers and release the segment
+     */
+    void stop();
+
+    bool isRunning() const { return !m_processes.empty(); }
+    int parts() const { return m_parts; }
+    const GraphPartitioner::Statistics& partitionStatistics() const { return m_statistics; }
+
+    /**
+     * @brief Halo values (doubles) sent between all parts after every step
+     */
+    long long haloValuesPerStep() const { return m_haloValues; }
+
+private:
+    void waitForWorkers(int batch);
+    QString workerError(int rank) const;
+
+    QSharedMemory m_memory;
+    std::vector<std::unique_ptr<QProcess>> m_processes;
+    int m_parts;
+    int m_numDOF;
+    int m_batch;
+    long long m_haloValues;
+    GraphPartitioner::Statistics m_statistics;
+};
+
+/**
+ * @brief Entry point of a worker process (SimulationToolCli --domain-worker)
+ */
+namespace DomainWorker
+{
+    /**
+     * @brief Attach to the coordinator's segment and run one subdomain until stopped
+     * @param key Shared memory key given by the coordinator
+     * @param rank Part index of this worker
+     * @return Process exit code (0 after a regular stop)
+     */
+    int run(const QString& key, int rank);
+}
+
+#endif // DOMAINEXCHANGE_H
@@ -0,0 +1,47 @@
+#ifndef GRAPHPARTITIONER_H
+#define GRAPHPARTITIONER_H
+
+#include "StructuralModel.h"
+#include <vector>
+
+/**
+ * @brief Splits the node graph of a model into balanced, compact parts
+ *
+ * Recursive level-structure bisection: each region is ordered by a
+ * breadth-first search from a pseudo-peripheral node and cut where the
+ * node count reaches its share, so every cut runs along a BFS level
+ * front and crosses few edges. Part counts need not be powers of two;
+ * every split divides the nodes in proportion to the parts on each side.
+ * Disconnected regions are ordered one component after the other.
+ *
+ * The result depends only on the model and the part count.
+ */
+namespace GraphPartitioner
+{
+    /**
+     * @brief Quality of a partition
+     */
+    struct Statistics
+    {
+        int parts;
+        int cutEdges;               // Edges between nodes of different parts
+        int smallestPart;           // Nodes
+        int largestPart;
+        double imbalance;           // Largest part / average part
+    };
+
+    /**
+     * @brief Part of each node
+     * @param model Model with edges (assembled or not)
+     * @param parts Number of parts, at most numNodes()
+     * @return Part index (0 .. parts - 1) per node
+     */
+    std::vector<int> partition(const StructuralModel& model, int parts);
+
+    /**
+     * @brief Cut and balance of a partition
+     */
+    Statistics evaluate(const StructuralModel& model, const std::vector<int>& nodeParts, int parts);
+}
+
+#endif // GRAPHPARTITIONER_H
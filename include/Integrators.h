@@ -0,0 +1,893 @@
+#ifndef INTEGRATORS_H
+#define INTEGRATORS_H
+
+#include "AlignedAllocator.h"
+#include "ConjugateGradient.h"
+#include "ContactDetector.h"
+#include "NewtonSolver.h"
+#include "ScalarPrecision.h"
+#include "Profiler.h"
+#include "SolverKernels.h"
+#include "SolverWorkspace.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Operands shared by all integrator policies for one step
+ *
+ * The engine fills this once per step; policies read the CSR operator,
+ * damping and time step from the kernel arguments and run their row loops
+ * through forEachChunk(), which splits them across the thread pool.
+ *
+ * Every policy also reduces the total energy 0.5 (v^T M v + x^T K x) of
+ * the state at the start or the end of the step in one of its passes,
+ * one partial per chunk in workspace->energyPartials (see totalEnergy()).
+ *
+ * With contact, policies call updateContact() at every new set of
+ * positions before evaluating forces there; computeForces() then adds the
+ * penalty forces to the elastic and damping ones.
+ *
+ * PrecisionPolicy (see ScalarPrecision.h) sets the scalar types of the operator
+ * and force-side vectors (Real) and of positions and velocities (Accum).
+ */
+template <typename PrecisionPolicy>
+struct BasicIntegratorContext
+{
+    typedef typename PrecisionPolicy::Real Real;
+    typedef typename PrecisionPolicy::Accum Accum;
+    typedef SolverKernels::BasicStepArgs<Real, Accum> KernelArgs;
+
+    KernelArgs kernelArgs;                      // CSR, damping, dt, inverse masses
+    const SolverKernels::KernelTable* kernels;
+    WorkStealingPool* pool;                     // null = single-threaded
+    int grain;                                  // Rows per parallel chunk
+
+    AlignedArray<Accum>* positions;
+    AlignedArray<Accum>* velocities;
+    AlignedArray<Real>* accelerations;
+    BasicSolverWorkspace<PrecisionPolicy>* workspace;
+    ContactDetector* contact;                   // null = no contact
+
+    // Implicit schemes: solver set up with the system matrix, and its limits
+    ConjugateGradient* linearSolver;
+    int maxIterations;
+    double tolerance;
+    NewtonSolver* newton;                       // Nonlinear springs (null = linear)
+
+    BasicIntegratorContext()
+        : kernels(nullptr)
+        , pool(nullptr)
+        , grain(1)
+        , positions(nullptr)
+        , velocities(nullptr)
+        , accelerations(nullptr)
+        , workspace(nullptr)
+        , contact(nullptr)
+        , linearSolver(nullptr)
+        , maxIterations(0)
+        , tolerance(0.0)
+        , newton(nullptr)
+    {}
+
+    int size() const { return static_cast<int>(positions->size()); }
+    int chunkCount() const { return WorkStealingPool::chunkCount(0, size(), grain); }
+
+    /**
+     * @brief Run body(chunk, begin, end) over all rows
+     *
+     * Without a pool the chunks run in order on the calling thread, so
+     * per-chunk reductions round the same for any thread count.
+     */
+    template <typename Body>
+    void forEachChunk(const Body& body) const
+    {
+        if (pool) {
+            pool->parallelFor(0, size(), grain, body);
+            return;
+        }
+        const int n = size();
+        const int chunks = chunkCount();
+        for (int c = 0; c < chunks; ++c) {
+            body(c, c * grain, std::min((c + 1) * grain, n));
+        }
+    }
+
+    /**
+     * @brief Sum per-chunk partial results in chunk order
+     */
+    double sumChunks(const AlignedVector& partials) const
+    {
+        const int chunks = chunkCount();
+        double sum = 0.0;
+        for (int c = 0; c < chunks; ++c) {
+            sum += partials[c];
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Total energy reduced by the last step
+     */
+    double totalEnergy() const { return sumChunks(workspace->energyPartials); }
+
+    /**
+     * @brief Contact forces at positions x into workspace->contactForces (no-op without contact)
+     */
+    void updateContact(const Accum* x) const
+    {
+        if (contact) {
+            contact->computeForces(x, workspace->contactForces.data());
+        }
+    }
+
+    /**
+     * @brief f = -K x - c v (+ contact) for rows [begin, end) at an arbitrary (x, v)
+     *
+     * The contact forces are the ones of the last updateContact().
+     */
+    void computeForces(int begin, int end, const Accum* x, Accum* v, Real* f) const
+    {
+        SIMTOOL_PROFILE_SCOPE(Forces);
+        KernelArgs args = kernelArgs;
+        args.begin = begin;
+        args.end = end;
+        args.positions = x;
+        args.velocities = v;
+        args.forces = f;
+        SolverKernels::computeForces(*kernels, args);
+        if (contact) {
+            const Real* fc = workspace->contactForces.data();
+            for (int i = begin; i < end; ++i) {
+                f[i] += fc[i];
+            }
+        }
+    }
+};
+
+typedef BasicIntegratorContext<ScalarPrecisions::Double> IntegratorContext;
+
+/**
+ * @brief Time integration schemes as compile-time policies
+ *
+ * Each fixed-step policy provides a static step() that advances the state
+ * by one time step and the number of workspace stage buffers it needs.
+ * Adaptive policies (Adaptive == true) instead provide attempt(), which
+ * computes a candidate step and its error estimate, and accept(), which
+ * commits it. The engine instantiates its step loop once per policy, so
+ * the per-DOF loops are specialized and inlined with no virtual dispatch.
+ *
+ * Implicit policies (Implicit == true) solve one SPD system per step,
+ * (M + dampingScale c + stiffnessScale K) y = b, with the context's
+ * linear solver; the engine builds that matrix once per run from
+ * systemScales(). With a Newton solver in the context they solve the
+ * nonlinear step equation with it instead (same scales, tangent stiffness
+ * in place of K) and reduce the energy at the end of the step.
+ *
+ * All schemes assume lumped (diagonal) mass and damping; accelerations
+ * must hold M^-1 f(x, v) at the start of the first step.
+ *
+ * The explicit fixed-step schemes (ReducedPrecision == true) take any
+ * BasicIntegratorContext and run in single or mixed precision as well;
+ * the others only run on the double context.
+ */
+namespace Integrators
+{
+    /**
+     * @brief Semi-implicit (symplectic) Euler: v += a dt, x += v dt
+     *
+     * Single fused pass over the operator; first order, cheapest per step.
+     */
+    struct SymplecticEuler
+    {
+        static const int StageBuffers = 0;
+        static const bool Adaptive = false;
+        static const bool Implicit = false;
+        static const bool ReducedPrecision = true;
+        static const char* name() { return "Symplectic Euler"; }
+
+        template <typename Context>
+        static void step(Context& ctx)
+        {
+            typename Context::KernelArgs args = ctx.kernelArgs;
+            args.positions = ctx.positions->data();
+            args.nextPositions = ctx.workspace->nextPositions.data();
+            args.velocities = ctx.velocities->data();
+            args.accelerations = ctx.accelerations->data();
+
+            double* energy = ctx.workspace->energyPartials.data();
+            ctx.updateContact(args.positions);
+
+            // Energy at the start of the step comes out of the fused kernel
+            ctx.forEachChunk([&ctx, &args, energy](int chunk, int begin, int end) {
+                typename Context::KernelArgs chunkArgs = args;
+                chunkArgs.begin = begin;
+                chunkArgs.end = end;
+                chunkArgs.energy = energy + chunk;
+                SolverKernels::symplecticEulerStep(*ctx.kernels, chunkArgs);
+            });
+
+            // The fused kernel sees -K x - c v only; the few DOFs in contact get
+            // the rest of the update as if f had included the contact force
+            if (ctx.contact) {
+                typedef typename Context::Real Real;
+                typedef typename Context::Accum Accum;
+                const Accum dt = static_cast<Accum>(args.timeStep);
+                const Real* fc = ctx.workspace->contactForces.data();
+                for (int node : ctx.contact->activeNodes()) {
+                    for (int i = 3 * node; i < 3 * node + 3; ++i) {
+                        const Real da = fc[i] * args.inverseMasses[i];
+                        args.accelerations[i] += da;
+                        args.velocities[i] += dt * da;
+                        args.nextPositions[i] += dt * dt * da;
+                    }
+                }
+            }
+
+            ctx.positions->swap(ctx.workspace->nextPositions);
+        }
+    };
+
+    /**
+     * @brief Velocity Verlet, second order
+     *
+     * The damping force at the new position uses the predicted velocity
+     * v + a dt.
+     */
+    struct VelocityVerlet
+    {
+        static const int StageBuffers = 1;
+        static const bool Adaptive = false;
+        static const bool Implicit = false;
+        static const bool ReducedPrecision = true;
+        static const char* name() { return "Velocity Verlet"; }
+
+        template <typename Context>
+        static void step(Context& ctx)
+        {
+            typedef typename Context::Real Real;
+            typedef typename Context::Accum Accum;
+
+            const Accum dt = static_cast<Accum>(ctx.kernelArgs.timeStep);
+            const Real* im = ctx.kernelArgs.inverseMasses;
+            Accum* x = ctx.positions->data();
+            Accum* v = ctx.velocities->data();
+            Real* a = ctx.accelerations->data();
+            Accum* xNext = ctx.workspace->nextPositions.data();
+            Accum* vPredicted = ctx.workspace->stages[0].data();
+            Real* f = ctx.workspace->forces.data();
+            double* energy = ctx.workspace->energyPartials.data();
+            const double c = ctx.kernelArgs.damping;
+
+            ctx.forEachChunk([=](int, int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    xNext[i] = x[i] + dt * v[i] + Accum(0.5) * dt * dt * a[i];
+                    vPredicted[i] = v[i] + dt * a[i];
+                }
+            });
+
+            // Energy at the end of the step: K x_next = -(f + c v_predicted)
+            ctx.updateContact(xNext);
+            ctx.forEachChunk([=, &ctx](int chunk, int begin, int end) {
+                ctx.computeForces(begin, end, xNext, vPredicted, f);
+                double e = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    const Real aNext = f[i] * im[i];
+                    v[i] += Accum(0.5) * dt * (a[i] + aNext);
+                    a[i] = aNext;
+                    e += static_cast<double>(v[i]) * v[i] / im[i] - static_cast<double>(xNext[i]) * (f[i] + c * vPredicted[i]);
+                }
+                energy[chunk] = 0.5 * e;
+            });
+
+            ctx.positions->swap(ctx.workspace->nextPositions);
+        }
+    };
+
+    /**
+     * @brief Classical fourth-order Runge-Kutta on (x, v)
+     */
+    struct RungeKutta4
+    {
+        static const int StageBuffers = 5;
+        static const bool Adaptive = false;
+        static const bool Implicit = false;
+        static const bool ReducedPrecision = true;
+        static const char* name() { return "RK4"; }
+
+        template <typename Context>
+        static void step(Context& ctx)
+        {
+            typedef typename Context::Real Real;
+            typedef typename Context::Accum Accum;
+
+            const Accum h = static_cast<Accum>(ctx.kernelArgs.timeStep);
+            const Real* im = ctx.kernelArgs.inverseMasses;
+            Accum* x = ctx.positions->data();
+            Accum* v = ctx.velocities->data();
+            Real* a = ctx.accelerations->data();
+            Real* f = ctx.workspace->forces.data();
+
+            // Stage points alternate between two position buffers because the
+            // operator reads neighbouring rows; velocities only feed their own row
+            Accum* stageX[2] = { ctx.workspace->stages[0].data(), ctx.workspace->stages[1].data() };
+            Accum* stageV = ctx.workspace->stages[2].data();
+            Accum* sumX = ctx.workspace->stages[3].data();
+            Accum* sumV = ctx.workspace->stages[4].data();
+            double* energy = ctx.workspace->energyPartials.data();
+            const double c = ctx.kernelArgs.damping;
+
+            // k1 at (x, v), with the energy at the start of the step
+            ctx.updateContact(x);
+            ctx.forEachChunk([=, &ctx](int chunk, int begin, int end) {
+                ctx.computeForces(begin, end, x, v, f);
+                double e = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    e += static_cast<double>(v[i]) * v[i] / im[i] - static_cast<double>(x[i]) * (f[i] + c * v[i]);
+                    const Accum kv = f[i] * im[i];
+                    sumX[i] = v[i];
+                    sumV[i] = kv;
+                    stageX[0][i] = x[i] + Accum(0.5) * h * v[i];
+                    stageV[i] = v[i] + Accum(0.5) * h * kv;
+                }
+                energy[chunk] = 0.5 * e;
+            });
+
+            // k2 and k3 at the midpoints
+            const Accum nextFactor[2] = { Accum(0.5) * h, h };
+            for (int s = 0; s < 2; ++s) {
+                const Accum* xs = stageX[s];
+                Accum* xNext = stageX[1 - s];
+                const Accum factor = nextFactor[s];
+                ctx.updateContact(xs);
+                ctx.forEachChunk([=, &ctx](int, int begin, int end) {
+                    ctx.computeForces(begin, end, xs, stageV, f);
+                    for (int i = begin; i < end; ++i) {
+                        const Accum kx = stageV[i];
+                        const Accum kv = f[i] * im[i];
+                        sumX[i] += Accum(2) * kx;
+                        sumV[i] += Accum(2) * kv;
+                        xNext[i] = x[i] + factor * kx;
+                        stageV[i] = v[i] + factor * kv;
+                    }
+                });
+            }
+
+            // k4 at the end point, then combine
+            const Accum* xs = stageX[0];
+            ctx.updateContact(xs);
+            ctx.forEachChunk([=, &ctx](int, int begin, int end) {
+                ctx.computeForces(begin, end, xs, stageV, f);
+                for (int i = begin; i < end; ++i) {
+                    const Accum dx = sumX[i] + stageV[i];
+                    const Accum dv = sumV[i] + f[i] * im[i];
+                    x[i] += h / Accum(6) * dx;
+                    v[i] += h / Accum(6) * dv;
+                    a[i] = static_cast<Real>(dv / Accum(6));
+                }
+            });
+        }
+    };
+
+    /**
+     * @brief Explicit Newmark-beta (beta = 0, gamma = 1/2)
+     *
+     * Central-difference member of the Newmark family. With lumped mass
+     * and diagonal damping the acceleration update stays explicit while
+     * the damping term is treated at the new time level.
+     */
+    struct Newmark
+    {
+        static const int StageBuffers = 1;
+        static const bool Adaptive = false;
+        static const bool Implicit = false;
+        static const bool ReducedPrecision = true;
+        static const char* name() { return "Newmark-beta"; }
+
+        template <typename Context>
+        static void step(Context& ctx)
+        {
+            typedef typename Context::Real Real;
+            typedef typename Context::Accum Accum;
+
+            const Accum gamma = 0.5;
+            const Accum dt = static_cast<Accum>(ctx.kernelArgs.timeStep);
+            const double c = ctx.kernelArgs.damping;
+            const Real* im = ctx.kernelArgs.inverseMasses;
+            Accum* x = ctx.positions->data();
+            Accum* v = ctx.velocities->data();
+            Real* a = ctx.accelerations->data();
+            Accum* xNext = ctx.workspace->nextPositions.data();
+            Accum* vPredicted = ctx.workspace->stages[0].data();
+            Real* f = ctx.workspace->forces.data();
+            double* energy = ctx.workspace->energyPartials.data();
+
+            ctx.forEachChunk([=](int, int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    xNext[i] = x[i] + dt * v[i] + Accum(0.5) * dt * dt * a[i];
+                    vPredicted[i] = v[i] + (Accum(1) - gamma) * dt * a[i];
+                }
+            });
+
+            // (m + gamma dt c) a_next = -K x_next - c v_predicted; energy at the end of the step
+            const Accum dampingFactor = gamma * dt * static_cast<Accum>(c);
+            ctx.updateContact(xNext);
+            ctx.forEachChunk([=, &ctx](int chunk, int begin, int end) {
+                ctx.computeForces(begin, end, xNext, vPredicted, f);
+                double e = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    const Real aNext = static_cast<Real>(f[i] * im[i] / (Accum(1) + dampingFactor * im[i]));
+                    v[i] = vPredicted[i] + gamma * dt * aNext;
+                    a[i] = aNext;
+                    e += static_cast<double>(v[i]) * v[i] / im[i] - static_cast<double>(xNext[i]) * (f[i] + c * vPredicted[i]);
+                }
+                energy[chunk] = 0.5 * e;
+            });
+
+            ctx.positions->swap(ctx.workspace->nextPositions);
+        }
+    };
+
+    /**
+     * @brief Dormand-Prince 5(4) embedded Runge-Kutta pair
+     *
+     * Advances with the fifth-order solution and estimates the local error
+     * from the embedded fourth-order one. The last stage is evaluated at
+     * the new state (first same as last), so an accepted step leaves
+     * a = M^-1 f(x, v) for the next one and costs six force evaluations.
+     *
+     * Since x' = v, the position slopes of each stage are the stage
+     * velocities; only stage velocities and accelerations are stored.
+     */
+    struct DormandPrince54
+    {
+        // Stage velocities 2..7, stage accelerations 2..7, two stage positions
+        static const int StageBuffers = 14;
+        static const bool Adaptive = true;
+        static const bool Implicit = false;
+        static const bool ReducedPrecision = false;
+        static const int ErrorOrder = 4;
+        static const char* name() { return "Dormand-Prince 5(4)"; }
+
+        /**
+         * @brief Compute a candidate step of size ctx.kernelArgs.timeStep
+         *
+         * The state is left untouched; the candidate stays in the stage
+         * buffers until accept().
+         *
+         * @param tolerance Absolute and relative error tolerance
+         * @return Error norm scaled by the tolerance (<= 1 means acceptable)
+         */
+        static double attempt(IntegratorContext& ctx, double tolerance)
+        {
+            static const double a[7][6] = {
+                { 0.0 },
+                { 1.0 / 5.0 },
+                { 3.0 / 40.0, 9.0 / 40.0 },
+                { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0 },
+                { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0 },
+                { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0 },
+                { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 }
+            };
+            // Fifth-order minus embedded fourth-order weights
+            static const double e[7] = {
+                71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0,
+                -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0
+            };
+
+            const double h = ctx.kernelArgs.timeStep;
+            const double* im = ctx.kernelArgs.inverseMasses;
+            const double* x = ctx.positions->data();
+            SolverWorkspace& ws = *ctx.workspace;
+
+            // Stage 1 is the current state (x' = v, v' = a)
+            const double* V[7];
+            const double* A[7];
+            double* stageV[7];
+            double* stageA[7];
+            V[0] = ctx.velocities->data();
+            A[0] = ctx.accelerations->data();
+            for (int s = 1; s < 7; ++s) {
+                stageV[s] = ws.stages[s - 1].data();
+                stageA[s] = ws.stages[s + 5].data();
+                V[s] = stageV[s];
+                A[s] = stageA[s];
+            }
+            // Stage positions alternate buffers: the operator reads neighbouring rows
+            double* stageX[2] = { ws.stages[12].data(), ws.stages[13].data() };
+            double* partials = ws.chunkPartials.data();
+            double* energy = ws.energyPartials.data();
+            const double c = ctx.kernelArgs.damping;
+
+            // Stages 2..7: forces at stage s (except the first), then the next stage point
+            for (int s = 0; s < 7; ++s) {
+                const double* xs = stageX[(s + 1) % 2];
+                double* xNext = stageX[s % 2];
+                if (s > 0) {
+                    ctx.updateContact(xs);
+                }
+                ctx.forEachChunk([=, &ctx, &V, &A](int chunk, int begin, int end) {
+                    if (s > 0) {
+                        ctx.computeForces(begin, end, xs, stageV[s], stageA[s]);
+                        for (int i = begin; i < end; ++i) {
+                            stageA[s][i] *= im[i];
+                        }
+                    }
+
+                    if (s < 6) {
+                        const double* as = a[s + 1];
+                        for (int i = begin; i < end; ++i) {
+                            double dx = 0.0;
+                            double dv = 0.0;
+                            for (int j = 0; j <= s; ++j) {
+                                dx += as[j] * V[j][i];
+                                dv += as[j] * A[j][i];
+                            }
+                            xNext[i] = x[i] + h * dx;
+                            stageV[s + 1][i] = V[0][i] + h * dv;
+                        }
+                        return;
+                    }
+
+                    // Last stage: scaled max-norm of the error estimate and the
+                    // energy of the candidate (K x_7 = -(M a_7 + c v_7))
+                    double error = 0.0;
+                    double candidateEnergy = 0.0;
+                    for (int i = begin; i < end; ++i) {
+                        candidateEnergy += V[6][i] * V[6][i] / im[i] - xs[i] * (A[6][i] / im[i] + c * V[6][i]);
+                        double ex = 0.0;
+                        double ev = 0.0;
+                        for (int j = 0; j < 7; ++j) {
+                            ex += e[j] * V[j][i];
+                            ev += e[j] * A[j][i];
+                        }
+                        const double scaleX = tolerance * (1.0 + std::max(std::fabs(x[i]), std::fabs(xs[i])));
+                        const double scaleV = tolerance * (1.0 + std::max(std::fabs(V[0][i]), std::fabs(V[6][i])));
+                        error = std::max(error, std::max(std::fabs(h * ex) / scaleX, std::fabs(h * ev) / scaleV));
+                    }
+                    partials[chunk] = error;
+                    energy[chunk] = 0.5 * candidateEnergy;
+                });
+            }
+
+            // Max is order-independent, so the result does not depend on the thread count
+            const int chunks = ctx.chunkCount();
+            double error = 0.0;
+            for (int c = 0; c < chunks; ++c) {
+                error = std::max(error, partials[c]);
+            }
+            return error;
+        }
+
+        /**
+         * @brief Commit the candidate of the last attempt() (allocation-free swaps)
+         */
+        static void accept(IntegratorContext& ctx)
+        {
+            SolverWorkspace& ws = *ctx.workspace;
+            ctx.positions->swap(ws.stages[13]);
+            ctx.velocities->swap(ws.stages[5]);
+            ctx.accelerations->swap(ws.stages[11]);
+        }
+    };
+
+    /**
+     * @brief Backward (implicit) Euler, first order, unconditionally stable
+     *
+     * Solves (M + h c + h^2 K) v_next = M v - h K x, then x += h v_next.
+     * Strongly damps high frequencies, which is usually what stiff models
+     * with large steps want.
+     */
+    struct BackwardEuler
+    {
+        static const int StageBuffers = 2;
+        static const bool Adaptive = false;
+        static const bool Implicit = true;
+        static const bool ReducedPrecision = false;
+        static const char* name() { return "Backward Euler"; }
+
+        static void systemScales(double h, double& dampingScale, double& stiffnessScale)
+        {
+            dampingScale = h;
+            stiffnessScale = h * h;
+        }
+
+        static void step(IntegratorContext& ctx)
+        {
+            if (ctx.newton) {
+                stepNonlinear(ctx);
+                return;
+            }
+
+            const double h = ctx.kernelArgs.timeStep;
+            const double c = ctx.kernelArgs.damping;
+            const double* im = ctx.kernelArgs.inverseMasses;
+            double* x = ctx.positions->data();
+            double* v = ctx.velocities->data();
+            double* a = ctx.accelerations->data();
+            double* rhs = ctx.workspace->stages[0].data();
+            double* previousV = ctx.workspace->stages[1].data();
+            double* f = ctx.workspace->forces.data();
+            double* energy = ctx.workspace->energyPartials.data();
+
+            // b = M v + h (-K x), using -K x = f + c v; energy at the start of the step
+            ctx.updateContact(x);
+            ctx.forEachChunk([=, &ctx](int chunk, int begin, int end) {
+                ctx.computeForces(begin, end, x, v, f);
+                double e = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    previousV[i] = v[i];
+                    rhs[i] = v[i] / im[i] + h * (f[i] + c * v[i]);
+                    e += v[i] * v[i] / im[i] - x[i] * (f[i] + c * v[i]);
+                }
+                energy[chunk] = 0.5 * e;
+            });
+
+            // Warm start from the current velocity; the caller checks linearSolver->lastResult()
+            ctx.linearSolver->solve(rhs, v, ctx.maxIterations, ctx.tolerance);
+
+            ctx.forEachChunk([=](int, int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    a[i] = (v[i] - previousV[i]) / h;
+                    x[i] += h * v[i];
+                }
+            });
+        }
+
+        /**
+         * @brief M v_next - M v - h f(x + h v_next, v_next) = 0, then x += h v_next
+         */
+        static void stepNonlinear(IntegratorContext& ctx)
+        {
+            const double h = ctx.kernelArgs.timeStep;
+            const double* im = ctx.kernelArgs.inverseMasses;
+            double* x = ctx.positions->data();
+            double* v = ctx.velocities->data();
+            double* a = ctx.accelerations->data();
+            double* rhs = ctx.workspace->stages[0].data();
+            double* previousV = ctx.workspace->stages[1].data();
+            double* energy = ctx.workspace->energyPartials.data();
+
+            ctx.forEachChunk([=](int, int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    previousV[i] = v[i];
+                    rhs[i] = v[i] / im[i];
+                }
+            });
+
+            // Warm start from the current velocity
+            NewtonSolver::StepEquation equation = {rhs, x, nullptr, h, h, 1.0};
+            ctx.newton->solve(equation, v);
+
+            // The last iterate is the new state, so its potential energy is the one at the end of the step
+            const double* potential = ctx.newton->potentialEnergies();
+            ctx.forEachChunk([=](int chunk, int begin, int end) {
+                double e = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    a[i] = (v[i] - previousV[i]) / h;
+                    x[i] += h * v[i];
+                    e += v[i] * v[i] / im[i] + 2.0 * potential[i];
+                }
+                energy[chunk] = 0.5 * e;
+            });
+        }
+    };
+
+    /**
+     * @brief Implicit Newmark-beta, average acceleration (beta = 1/4, gamma = 1/2)
+     *
+     * Second order, unconditionally stable and free of numerical damping.
+     * Solves (M + gamma h c + beta h^2 K) a_next = f(x_pred, v_pred).
+     */
+    struct ImplicitNewmark
+    {
+        static const int StageBuffers = 2;
+        static const bool Adaptive = false;
+        static const bool Implicit = true;
+        static const bool ReducedPrecision = false;
+        static const char* name() { return "Implicit Newmark-beta"; }
+
+        static constexpr double Beta = 0.25;
+        static constexpr double Gamma = 0.5;
+
+        static void systemScales(double h, double& dampingScale, double& stiffnessScale)
+        {
+            dampingScale = Gamma * h;
+            stiffnessScale = Beta * h * h;
+        }
+
+        static void step(IntegratorContext& ctx)
+        {
+            const double h = ctx.kernelArgs.timeStep;
+            double* x = ctx.positions->data();
+            double* v = ctx.velocities->data();
+            double* a = ctx.accelerations->data();
+            double* xPredicted = ctx.workspace->nextPositions.data();
+            double* vPredicted = ctx.workspace->stages[0].data();
+            double* rhs = ctx.workspace->stages[1].data();
+            double* energy = ctx.workspace->energyPartials.data();
+            const double c = ctx.kernelArgs.damping;
+            const double* im = ctx.kernelArgs.inverseMasses;
+
+            ctx.forEachChunk([=](int, int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    xPredicted[i] = x[i] + h * v[i] + (0.5 - Beta) * h * h * a[i];
+                    vPredicted[i] = v[i] + (1.0 - Gamma) * h * a[i];
+                }
+            });
+
+            if (ctx.newton) {
+                // M a_next - f(x_pred + beta h^2 a_next, v_pred + gamma h a_next) = 0
+                NewtonSolver::StepEquation equation = {nullptr, xPredicted, vPredicted, 1.0, Beta * h * h, Gamma * h};
+                ctx.newton->solve(equation, a);
+
+                const double* potential = ctx.newton->potentialEnergies();
+                ctx.forEachChunk([=](int chunk, int begin, int end) {
+                    double e = 0.0;
+                    for (int i = begin; i < end; ++i) {
+                        x[i] = xPredicted[i] + Beta * h * h * a[i];
+                        v[i] = vPredicted[i] + Gamma * h * a[i];
+                        e += v[i] * v[i] / im[i] + 2.0 * potential[i];
+                    }
+                    energy[chunk] = 0.5 * e;
+                });
+                return;
+            }
+
+            ctx.updateContact(xPredicted);
+            ctx.forEachChunk([=, &ctx](int, int begin, int end) {
+                ctx.computeForces(begin, end, xPredicted, vPredicted, rhs);
+            });
+
+            // Warm start from the current acceleration; the caller checks linearSolver->lastResult()
+            ctx.linearSolver->solve(rhs, a, ctx.maxIterations, ctx.tolerance);
+
+            // Energy at the end of the step from equilibrium: K x = -(M a + c v)
+            ctx.forEachChunk([=](int chunk, int begin, int end) {
+                double e = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    x[i] = xPredicted[i] + Beta * h * h * a[i];
+                    v[i] = vPredicted[i] + Gamma * h * a[i];
+                    e += v[i] * v[i] / im[i] - x[i] * (a[i] / im[i] + c * v[i]);
+                }
+                energy[chunk] = 0.5 * e;
+            });
+        }
+    };
+
+    /**
+     * @brief Modal superposition: exact steps of the retained modal coordinates
+     *
+     * Each retained mode q_k of the undamped problem obeys
+     * q'' + 2 alpha_k q' + omega_k^2 q = 0 (alpha_k from the modal damping),
+     * so a step is one constant 2x2 transition matrix per mode: exact for
+     * any step size and O(modes) per step. The solver keeps the physical
+     * state out of date until it is read (see ModalAnalysis::expand()).
+     * Linear models only (no contact).
+     */
+    struct ModalSuperposition
+    {
+        static const int StageBuffers = 0;
+        static const bool Adaptive = false;
+        static const bool Implicit = false;
+        static const bool ReducedPrecision = false;
+        static const char* name() { return "Modal superposition"; }
+
+        /**
+         * @brief Transition matrix p (row-major 2x2) over h of one damped mode
+         */
+        static void propagator(double omega2, double alpha, double h, double* p)
+        {
+            // exp(A h) = e^(-alpha h) (C I + S (A + alpha I)) with A = [0 1; -omega^2 -2 alpha]
+            const double d = omega2 - alpha * alpha;
+            double c;
+            double s;
+            if (d > 0.0) {
+                const double wd = std::sqrt(d);
+                const double decay = std::exp(-alpha * h);
+                c = decay * std::cos(wd * h);
+                s = decay * std::sin(wd * h) / wd;
+            } else if (d < 0.0) {
+                // Overdamped: cosh and sinh folded into the decay, so nothing overflows
+                const double r = std::sqrt(-d);
+                const double slow = std::exp(-(alpha - r) * h);
+                const double fast = std::exp(-(alpha + r) * h);
+                c = 0.5 * (slow + fast);
+                s = 0.5 * (slow - fast) / r;
+            } else {
+                const double decay = std::exp(-alpha * h);
+                c = decay;
+                s = decay * h;
+            }
+            p[0] = c + alpha * s;
+            p[1] = s;
+            p[2] = -omega2 * s;
+            p[3] = c - alpha * s;
+        }
+
+        /**
+         * @brief Advance q and q' by one step, update q''
+         * @return Energy 0.5 (q'^T q' + q^T Omega^2 q) at the end of the step
+         */
+        static double step(int modes, const double* eigenvalues, const double* alphas, const double* propagators,
+                           double* q, double* qd, double* qdd)
+        {
+            double energy = 0.0;
+            for (int k = 0; k < modes; ++k) {
+                const double* p = propagators + 4 * k;
+                const double x = q[k];
+                const double v = qd[k];
+                q[k] = p[0] * x + p[1] * v;
+                qd[k] = p[2] * x + p[3] * v;
+                qdd[k] = -eigenvalues[k] * q[k] - 2.0 * alphas[k] * qd[k];
+                energy += qd[k] * qd[k] + eigenvalues[k] * q[k] * q[k];
+            }
+            return 0.5 * energy;
+        }
+    };
+
+    /**
+     * @brief Step size control for adaptive policies
+     *
+     * h_new = h * safety * error^(-1 / (order + 1)), limited to
+     * [minFactor, maxFactor] and never growing right after a rejection.
+     */
+    struct StepSizeController
+    {
+        double safety;
+        double minFactor;
+        double maxFactor;
+
+        StepSizeController()
+            : safety(0.9)
+            , minFactor(0.2)
+            , maxFactor(5.0)
+        {}
+
+        double nextStep(double h, double error, int errorOrder, bool afterReject) const
+        {
+            double factor;
+            if (std::isnan(error)) {
+                factor = minFactor;
+            } else if (error <= 0.0) {
+                factor = maxFactor;
+            } else {
+                factor = safety * std::pow(error, -1.0 / (errorOrder + 1));
+                factor = std::min(maxFactor, std::max(minFactor, factor));
+            }
+            if (afterReject) {
+                factor = std::min(factor, 1.0);
+            }
+            return h * factor;
+        }
+    };
+
+    /**
+     * @brief An explicit fixed-step policy run in single or mixed precision
+     *
+     * Same traits and step() as Integrator; the solver reads the precision
+     * with PrecisionOf and steps its reduced-precision state with it.
+     */
+    template <typename Integrator, typename PrecisionPolicy>
+    struct WithPrecision : Integrator
+    {
+        static_assert(Integrator::ReducedPrecision, "Only explicit fixed-step schemes run in reduced precision");
+    };
+
+    /**
+     * @brief Precision policy of an integrator policy (double unless wrapped)
+     */
+    template <typename Integrator>
+    struct PrecisionOf
+    {
+        typedef ScalarPrecisions::Double Type;
+    };
+
+    template <typename Integrator, typename PrecisionPolicy>
+    struct PrecisionOf<WithPrecision<Integrator, PrecisionPolicy> >
+    {
+        typedef PrecisionPolicy Type;
+    };
+}
+
+#endif // INTEGRATORS_H
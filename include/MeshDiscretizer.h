@@ -0,0 +1,70 @@
+#ifndef MESHDISCRETIZER_H
+#define MESHDISCRETIZER_H
+
+#include <QString>
+#include <vector>
+
+// OpenCASCADE includes
+#include <TopoDS_Shape.hxx>
+
+#include "StructuralModel.h"
+
+/**
+ * @brief Surface mesh discretizer for loaded STEP geometry
+ *
+ * Turns a TopoDS_Shape into the nodes, triangles and edges of a
+ * StructuralModel. It supports:
+ * - Triangulation of every face with BRepMesh
+ * - Per-body merging of coincident face nodes (shells/solids stay separate)
+ * - Local midpoint refinement of the edges longer than a target element size,
+ *   within a node budget
+ */
+class MeshDiscretizer
+{
+public:
+    /**
+     * @brief Discretization options
+     */
+    struct Options
+    {
+        double elementSize;         // Target maximum edge length (0 = automatic)
+        double angularDeflection;   // BRepMesh angular deflection (radians)
+        int maxRefinementLevels;    // Upper bound on edge-splitting rounds
+        int maxNodes;               // Node budget of the refined model (discretize() fails above it)
+
+        Options()
+            : elementSize(0.0)
+            , angularDeflection(0.5)
+            , maxRefinementLevels(10)
+            , maxNodes(1000000)
+        {}
+    };
+
+    MeshDiscretizer();
+
+    /**
+     * @brief Discretize a shape into a structural model
+     * @param shape The shape to mesh (typically STEPReader::getShape())
+     * @param options Discretization options
+     * @param model Output model (nodes, triangles, edges; not yet assembled)
+     * @return true if at least one triangle was produced within the node budget
+     */
+    bool discretize(const TopoDS_Shape& shape, const Options& options, StructuralModel& model);
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    QString getLastError() const { return m_lastError; }
+
+private:
+    // Helper methods
+    void addBody(const TopoDS_Shape& body, double mergeTolerance, StructuralModel& model);
+    bool refine(const Options& options, StructuralModel& model);
+    void buildEdges(StructuralModel& model);
+
+    // Data members
+    QString m_lastError;
+};
+
+#endif // MESHDISCRETIZER_H
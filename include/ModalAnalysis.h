@@ -0,0 +1,181 @@
+#ifndef MODALANALYSIS_H
+#define MODALANALYSIS_H
+
+#include "AlignedAllocator.h"
+#include "ConjugateGradient.h"
+#include "SimulationTypes.h"
+#include "SparseMatrix.h"
+#include "StructuralModel.h"
+#include "WorkStealingPool.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Natural frequencies and mode shapes of an assembled model
+ *
+ * Solves K phi = lambda M phi (lumped M) for the lowest eigenvalues with
+ * shift-invert Lanczos on the symmetric form A = M^-1/2 K M^-1/2: every
+ * Lanczos step is one preconditioned CG solve with A - sigma I, and the
+ * basis is fully reorthogonalized, so memory grows with the basis size
+ * times the DOF count. Converged modes are locked and the run restarts
+ * until all requested modes are found. The automatic shift starts at the
+ * Gershgorin lower bound of the spectrum, which keeps A - sigma I
+ * positive definite, and moves up to just below the lowest eigenvalue
+ * once that is known; this spreads out the lowest eigenvalues, which the
+ * grounding springs otherwise pack close together. Mode shapes are
+ * mass-normalized (phi^T M phi = 1).
+ *
+ * A Krylov space holds only one direction of a repeated eigenvalue, so
+ * restarted Lanczos can lock higher modes before every copy of a lower
+ * one. An inertia check (the negative pivots of an LDL^T factorization of
+ * A - mu I count the eigenvalues below mu) confirms that no eigenvalue
+ * below the returned ones is missing, and more Lanczos rounds add the
+ * missing copies until it passes.
+ *
+ * It supports:
+ * - The lowest N modes (compute()), used by modal superposition runs
+ * - A cheap estimate of the highest eigenvalue (no solves), and from it
+ *   the stable time step of each explicit integrator
+ * - Projection of physical states onto the modes and expansion back
+ */
+class ModalAnalysis
+{
+public:
+    /**
+     * @brief Extraction settings
+     */
+    struct Options
+    {
+        int modeCount;              // Lowest modes to extract
+        double shift;               // sigma, below the lowest eigenvalue (negative = automatic)
+        double tolerance;           // Relative residual of a converged Ritz pair
+        int basisSize;              // Lanczos steps per run (0 = 2 * modeCount + 40)
+        ConjugateGradient::Preconditioner preconditioner;
+        double solverTolerance;     // CG residual of each shift-invert solve
+        int solverIterations;       // CG iteration limit (0 = number of DOFs)
+        const int* randomOrder;     // Original DOF per DOF of a renumbered model (null = none)
+
+        Options()
+            : modeCount(50)
+            , shift(-1.0)
+            , tolerance(1e-8)
+            , basisSize(0)
+            , preconditioner(ConjugateGradient::Preconditioner::IncompleteCholesky)
+            , solverTolerance(1e-12)
+            , solverIterations(0)
+            , randomOrder(nullptr)
+        {}
+    };
+
+    ModalAnalysis();
+
+    /**
+     * @brief Extract the lowest modes of an assembled model
+     *
+     * The model must stay alive and unchanged while the modes are used.
+     * When the restarts run out before every requested mode has converged,
+     * the converged lowest ones are kept. Fails rather than return a basis
+     * that the inertia check shows to skip lower modes; the check is only
+     * skipped (isVerified() false) when its factorization would not fit in
+     * memory.
+     *
+     * @param model Assembled model (stiffness and lumped masses)
+     * @param options Mode count and accuracy
+     * @param pool Thread pool for the CG solves and basis updates (null = calling thread only)
+     * @param grain Rows per parallel chunk
+     * @return false (see lastError()) if no mode converged, a solve failed or lower modes stay missing
+     */
+    bool compute(const StructuralModel& model, const Options& options,
+                 WorkStealingPool* pool, int grain);
+
+    /**
+     * @brief Release the modes
+     */
+    void clear();
+
+    int modeCount() const { return static_cast<int>(m_eigenvalues.size()); }
+    int size() const { return m_size; }
+
+    /**
+     * @brief Eigenvalues omega^2 in ascending order
+     */
+    const std::vector<double>& eigenvalues() const { return m_eigenvalues; }
+
+    double angularFrequency(int mode) const;
+    double frequency(int mode) const;         // Hz
+
+    /**
+     * @brief Mass-normalized shape of a mode, one entry per DOF
+     */
+    const double* modeShape(int mode) const { return m_shapes.data() + static_cast<size_t>(mode) * m_size; }
+
+    // Statistics of the last compute()
+    int lanczosSteps() const { return m_lanczosSteps; }
+    double shift() const { return m_shift; }                    // Final shift
+    long long solverIterations() const { return m_solverIterations; }
+    bool isVerified() const { return m_verified; }              // Inertia check passed
+    const std::string& lastError() const { return m_lastError; }
+
+    /**
+     * @brief Modal coordinates of a physical vector: q = Phi^T M u
+     */
+    void project(const double* u, double* q) const;
+
+    /**
+     * @brief Physical vector of modal coordinates: u = Phi q
+     */
+    void expand(const double* q, double* u) const;
+
+    /**
+     * @brief Upper estimate of the highest eigenvalue of K phi = lambda M phi
+     *
+     * A short Lanczos run without solves; the largest Ritz value plus its
+     * residual, capped by the Gershgorin bound.
+     *
+     * @param model Assembled model
+     * @param steps Lanczos steps
+     */
+    static double estimateHighestEigenvalue(const StructuralModel& model, int steps = 40);
+
+    /**
+     * @brief Largest stable step of an integrator for a highest eigenvalue
+     *
+     * Uses the stability limit of the scheme on the undamped oscillator
+     * (2 / omega for symplectic Euler, Verlet and explicit Newmark,
+     * 2 sqrt(2) / omega for the Runge-Kutta schemes), reduced for the
+     * damping ratio of the highest mode.
+     *
+     * @param type Integrator
+     * @param highestEigenvalue omega_max^2
+     * @param dampingRatio Damping ratio of the highest mode
+     * @return Critical step, or 0 if the scheme is unconditionally stable
+     */
+    static double criticalTimeStep(IntegratorType type, double highestEigenvalue, double dampingRatio);
+
+    /**
+     * @brief Suggested time step for running params on an assembled model
+     * @param safety Fraction of the critical step
+     * @return safety times the critical step, or 0 if any step is stable
+     */
+    static double suggestTimeStep(const StructuralModel& model, const SimulationParameters& params,
+                                  double safety = 0.9);
+
+private:
+    template <typename Body>
+    void forEachChunk(int count, const Body& body) const;
+
+    const StructuralModel* m_model;
+    WorkStealingPool* m_pool;
+    int m_grain;
+    int m_size;
+
+    std::vector<double> m_eigenvalues;
+    AlignedVector m_shapes;                 // Mode after mode, m_size entries each
+    double m_shift;
+    int m_lanczosSteps;
+    long long m_solverIterations;
+    bool m_verified;
+    std::string m_lastError;
+};
+
+#endif // MODALANALYSIS_H
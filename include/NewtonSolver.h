@@ -0,0 +1,235 @@
+#ifndef NEWTONSOLVER_H
+#define NEWTONSOLVER_H
+
+#include "AlignedAllocator.h"
+#include "ConjugateGradient.h"
+#include "ContactDetector.h"
+#include "SimulationTypes.h"
+#include "SparseMatrix.h"
+#include "StructuralModel.h"
+#include "WorkStealingPool.h"
+#include <vector>
+
+/**
+ * @brief Newton-Raphson solver for the step equations of geometrically nonlinear models
+ *
+ * Treats the springs of StructuralModel::assemble() as geometrically
+ * exact: an edge spring acts along the current edge direction with force
+ * k (l - L) for current length l and rest length L, so large rotations of
+ * the mesh produce no spurious forces. Grounding springs and damping stay
+ * linear, contact forces enter the residual but not the tangent, and the
+ * 1-DOF chain is linear. For small displacements the model reduces to the
+ * assembled K.
+ *
+ * Implicit schemes write their step as R(y) = M y - b - w f(x0 + a y, v0 + d y) = 0
+ * for one unknown vector y (see StepEquation), whose Jacobian
+ * M + w d c + w a K_T(x) is the implicit system matrix with the tangent
+ * stiffness K_T in place of K. Each iteration solves J dy = -R with the
+ * preconditioned CG solver, followed by a backtracking line search on |R|.
+ * The tangent is exact. Strongly compressed springs have negative
+ * geometric stiffness and can make J indefinite; when CG fails, the rest
+ * of the step re-forms J without it, which keeps J positive definite at
+ * the price of slower convergence.
+ *
+ * Modified Newton keeps J and its preconditioner across iterations and
+ * steps, and re-forms them only when the residual stops contracting by the
+ * slowdown factor, the line search has to cut the step or CG fails; full
+ * Newton re-forms them every iteration. Re-forming updates J in place on
+ * a pattern fixed in setup(), so no iteration allocates.
+ */
+class NewtonSolver
+{
+public:
+    /**
+     * @brief Iteration settings
+     */
+    struct Options
+    {
+        NonlinearMethod method;
+        int maxIterations;          // Newton corrections per step
+        double tolerance;           // |R| relative to the largest term of the step equation
+        ConjugateGradient::Preconditioner preconditioner;
+        int solverIterations;       // CG iteration limit per correction
+        double solverTolerance;     // CG residual per correction
+        double slowdown;            // Modified Newton: re-form once |R_new| > slowdown |R|
+        int maxLineSearchCuts;      // Halvings of a correction before it is taken anyway
+
+        Options()
+            : method(NonlinearMethod::Newton)
+            , maxIterations(20)
+            , tolerance(1e-8)
+            , preconditioner(ConjugateGradient::Preconditioner::Jacobi)
+            , solverIterations(100)
+            , solverTolerance(1e-8)
+            , slowdown(0.1)
+            , maxLineSearchCuts(4)
+        {}
+    };
+
+    /**
+     * @brief One step equation R(y) = M y - b - w f(x0 + a y, v0 + d y)
+     *
+     * Null b and v0 stand for zero.
+     */
+    struct StepEquation
+    {
+        const double* b;
+        const double* x0;
+        const double* v0;
+        double w;
+        double a;
+        double d;
+    };
+
+    /**
+     * @brief Outcome of one step
+     */
+    struct Result
+    {
+        int iterations;             // Corrections (linear solves)
+        double residual;            // |R| / reference at exit
+        bool converged;
+        int tangentUpdates;         // Jacobians formed in this step
+        int lineSearchCuts;
+
+        Result()
+            : iterations(0)
+            , residual(0.0)
+            , converged(true)
+            , tangentUpdates(0)
+            , lineSearchCuts(0)
+        {}
+    };
+
+    /**
+     * @brief Totals since setup()
+     */
+    struct Statistics
+    {
+        int steps;
+        long long iterations;
+        int maxStepIterations;
+        long long tangentUpdates;
+        long long lineSearchCuts;
+        int failedSteps;
+
+        Statistics()
+            : steps(0)
+            , iterations(0)
+            , maxStepIterations(0)
+            , tangentUpdates(0)
+            , lineSearchCuts(0)
+            , failedSteps(0)
+        {}
+    };
+
+    NewtonSolver();
+
+    /**
+     * @brief Size every buffer and form the first Jacobian at the given displacements
+     *
+     * The model (assembled) and the contact detector must stay alive and
+     * unchanged until the next setup().
+     *
+     * @param model Assembled model; reference coordinates give the rest lengths
+     * @param stiffnessCoefficient Stiffness coefficient the model was assembled with
+     * @param damping Damping coefficient c
+     * @param dampingScale w d of the step equations
+     * @param stiffnessScale w a of the step equations
+     * @param options Method and limits
+     * @param displacements Displacements the first Jacobian is formed at
+     * @param contact Contact detector (null = no contact)
+     * @param contactForces Buffer of the contact forces (one entry per DOF; null without contact)
+     * @param pool Thread pool (null = calling thread only)
+     * @param grain Rows per parallel chunk
+     */
+    void setup(const StructuralModel& model, double stiffnessCoefficient, double damping,
+               double dampingScale, double stiffnessScale, const Options& options,
+               const double* displacements, ContactDetector* contact, double* contactForces,
+               WorkStealingPool* pool, int grain);
+
+    /**
+     * @brief Release every buffer
+     */
+    void clear();
+
+    bool isEnabled() const { return m_model != nullptr; }
+
+    /**
+     * @brief Solve one step equation
+     * @param equation Step equation; its w a and w d must be the scales given to setup()
+     * @param y Initial guess on entry, last iterate on exit
+     */
+    Result solve(const StepEquation& equation, double* y);
+
+    /**
+     * @brief f = f_int(x) - c v (+ contact) and the potential energy at x
+     * @param v Velocities (null = zero)
+     */
+    void computeForces(const double* x, const double* v, double* f);
+
+    /**
+     * @brief Elastic energy per DOF at the last evaluated iterate (sums to the total)
+     */
+    const double* potentialEnergies() const { return m_potential.data(); }
+
+    const Result& lastResult() const { return m_lastResult; }
+    const Statistics& statistics() const { return m_statistics; }
+    const ConjugateGradient& linearSolver() const { return m_linearSolver; }
+    NonlinearMethod method() const { return m_options.method; }
+
+private:
+    template <typename Body>
+    void forEachChunk(int count, int grain, const Body& body);
+
+    void evaluate(const double* x, const double* v, double* f, bool formTangent);
+    double residual(const StepEquation& equation, const double* y, double& reference, bool formTangent);
+
+    const StructuralModel* m_model;
+    ContactDetector* m_contact;
+    double* m_contactForces;
+    WorkStealingPool* m_pool;
+    int m_grain;                            // Edges per chunk
+    int m_nodeGrain;                        // Nodes per chunk
+    int m_dofsPerNode;
+    Options m_options;
+    double m_grounding;
+    double m_coupling;
+    double m_damping;
+    double m_dampingScale;
+    double m_stiffnessScale;
+
+    // Springs
+    std::vector<double> m_restLengths;      // Per edge (0 = ignored)
+    std::vector<double> m_restDirections;   // Unit reference direction per edge (3-DOF)
+    std::vector<int> m_nodeEdgePointers;    // Incident edges per node (CSR)
+    std::vector<int> m_nodeEdges;
+
+    // Jacobian on a fixed pattern of full node blocks
+    SparseMatrix m_jacobian;
+    std::vector<int> m_diagonalOffsets;     // Per DOF row: entry of the node's own block
+    std::vector<int> m_edgeOffsets;         // Per edge and row of a, then of b: entry of the other node's block
+    ConjugateGradient m_linearSolver;
+    bool m_tangentCurrent;                  // Modified Newton: J and its preconditioner may be reused
+    bool m_definiteTangent;                 // Drop negative geometric stiffness for the rest of the step
+
+    // Per evaluation
+    AlignedVector m_edgeForces;             // Axial force vector per edge (on node a)
+    AlignedVector m_edgeTangents;           // 3x3 (or 1x1) tangent block per edge
+    AlignedVector m_edgeEnergies;
+    AlignedVector m_potential;
+
+    // Iteration vectors
+    AlignedVector m_positions;
+    AlignedVector m_velocities;
+    AlignedVector m_forces;
+    AlignedVector m_residual;
+    AlignedVector m_correction;
+    AlignedVector m_trial;
+    AlignedVector m_partials;
+
+    Result m_lastResult;
+    Statistics m_statistics;
+};
+
+#endif // NEWTONSOLVER_H
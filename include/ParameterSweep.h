@@ -0,0 +1,159 @@
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "SimulationTypes.h"
+#include "StructuralModel.h"
+
+/**
+ * @brief Runs many independent simulations over a grid of parameters
+ *
+ * Each case gets its own SimulationSolver (state, workspace, system
+ * matrix), and the cases are spread over a work-stealing pool, one case
+ * per task. Every case steps single-threaded, so N cores run N cases at
+ * once instead of splitting each small model N ways.
+ *
+ * Per-case metrics are accumulated while stepping, without storing the
+ * trajectory:
+ * - Peak displacement: largest |x_i| seen at the end of any step
+ * - Settling time: last time max|x_i| was above settlingBand * peak
+ * - Final energy, step count, steady-state early stop
+ *
+ * A sweep can be cancelled from any thread; cases that did not finish are
+ * marked Cancelled and run() picks them up again on the next call. With
+ * saveResults()/loadResults() a sweep also resumes across processes.
+ */
+class ParameterSweep
+{
+public:
+    /**
+     * @brief Outcome of one case
+     */
+    enum class CaseStatus
+    {
+        Pending,
+        Completed,
+        Cancelled,
+        Failed
+    };
+
+    /**
+     * @brief Sweep options
+     */
+    struct Options
+    {
+        int maxConcurrent;      // Cases run at once (0 = all cores)
+        double settlingBand;    // Settled once max|x| stays below this fraction of the peak
+
+        Options()
+            : maxConcurrent(0)
+            , settlingBand(0.02)
+        {}
+    };
+
+    /**
+     * @brief Parameters and metrics of one case
+     */
+    struct CaseResult
+    {
+        SimulationParameters parameters;
+        CaseStatus status;
+        std::string error;          // Failed: exception message
+        int steps;                  // Accepted steps
+        double finalTime;
+        double peakDisplacement;
+        double settlingTime;
+        double finalEnergy;
+        bool steady;                // Stopped early at steady state
+        double wallSeconds;
+
+        CaseResult()
+            : status(CaseStatus::Pending)
+            , steps(0)
+            , finalTime(0.0)
+            , peakDisplacement(0.0)
+            , settlingTime(0.0)
+            , finalEnergy(0.0)
+            , steady(false)
+            , wallSeconds(0.0)
+        {}
+    };
+
+    /**
+     * @brief Called from a worker thread after each case finishes (or fails)
+     */
+    typedef std::function<void(int index, const CaseResult& result)> CaseCallback;
+
+    explicit ParameterSweep(const Options& options = Options());
+
+    /**
+     * @brief Cartesian product of damping, stiffness and time step values
+     *
+     * An empty list keeps the value of base. Stiffness varies fastest.
+     */
+    static std::vector<SimulationParameters> grid(const SimulationParameters& base,
+                                                  const std::vector<double>& dampings,
+                                                  const std::vector<double>& stiffnesses,
+                                                  const std::vector<double>& timeSteps);
+
+    /**
+     * @brief Replace the case list; all results are reset to Pending
+     */
+    void setCases(const std::vector<SimulationParameters>& cases);
+
+    /**
+     * @brief Run every case that is not Completed yet
+     *
+     * Blocks until all of them finished or the sweep was cancelled. The
+     * model is shared read-only; each case assembles its own copy with its
+     * stiffness.
+     *
+     * @param model Discretized model (see SimulationSolver::buildModel())
+     * @param callback Optional per-case notification
+     * @return Number of cases completed by this call
+     */
+    int run(const StructuralModel& model, const CaseCallback& callback = CaseCallback());
+
+    /**
+     * @brief Stop the running sweep after the current step of every case
+     *
+     * Thread-safe. A cancel() before run() stops that run before any
+     * step; run() clears the flag when it returns.
+     */
+    void cancel() { m_cancelled = true; }
+    bool isCancelled() const { return m_cancelled; }      // Requested and not yet taken by run()
+
+    const std::vector<CaseResult>& results() const { return m_results; }
+    int completedCount() const;
+
+    /**
+     * @brief Write the result table as CSV (one row per case)
+     */
+    bool saveResults(const std::string& path) const;
+
+    /**
+     * @brief Restore completed cases from a table written by saveResults()
+     *
+     * Rows are matched by index and only taken over when their parameters
+     * equal the current case list, so a changed grid is simply re-run.
+     * Rows that do not parse are skipped (re-run) as well.
+     *
+     * @return Number of completed cases restored
+     */
+    int loadResults(const std::string& path);
+
+    static const char* statusName(CaseStatus status);
+
+private:
+    void runCase(const StructuralModel& model, CaseResult& result);
+
+    Options m_options;
+    std::vector<CaseResult> m_results;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // PARAMETERSWEEP_H
@@ -0,0 +1,126 @@
+#ifndef PARAREAL_H
+#define PARAREAL_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "SimulationSolver.h"
+#include "SimulationTypes.h"
+#include "StructuralModel.h"
+
+/**
+ * @brief Parareal parallel-in-time integration of one run
+ *
+ * The remaining time window is cut into params.timeSlices slices. A cheap
+ * coarse propagator G (implicit Newmark at coarseStepRatio fine steps per
+ * step, stable at any step size) sweeps the window sequentially; the fine
+ * propagator F (the run's own integrator and time step) advances every
+ * slice from its start state, all slices at once on a work-stealing pool.
+ * Each iteration corrects the slice boundaries sequentially,
+ *
+ *   U[n+1] = G(U_new[n]) + F(U_old[n]) - G(U_old[n]),
+ *
+ * until no boundary moves by more than params.pararealTolerance relative to the
+ * largest boundary state (positions and velocities). After k iterations
+ * the first k slices are exact, so the fixed point is the sequential fine
+ * solution whatever the coarse error, and the iteration count is capped
+ * at the slice count. With k iterations the fine work on the critical
+ * path is about k slices instead of all of them.
+ *
+ * Each slice has its own SimulationSolver stepping on one thread, so this
+ * pays off for small models with long time windows, where splitting the
+ * DOFs over threads has too little work per step. Only boundary states
+ * are kept, never whole trajectories.
+ */
+class Parareal
+{
+public:
+    /**
+     * @brief Progress of one iteration
+     */
+    struct Iteration
+    {
+        int iteration;          // 0 = the initial coarse sweep
+        double change;          // Largest boundary move relative to the largest boundary
+        int exactSlices;        // Leading slices that equal the fine solution
+        double wallSeconds;     // Of this iteration
+    };
+
+    /**
+     * @brief Called on the calling thread after each iteration
+     */
+    typedef std::function<void(const Iteration& iteration)> IterationCallback;
+
+    Parareal();
+    ~Parareal();
+
+    Parareal(const Parareal&) = delete;
+    Parareal& operator=(const Parareal&) = delete;
+
+    /**
+     * @brief Initialize the coarse and the per-slice fine solvers
+     * @param params Run parameters (timeSlices, coarseStepRatio, pararealTolerance, pararealMaxIterations)
+     * @param model Discretized model
+     * @param initial State to start from (its currentStep may be past 0 after a restart)
+     * @throws std::runtime_error if the parameters cannot run in Parareal
+     */
+    void setup(const SimulationParameters& params, const StructuralModel& model, const SimulationState& initial);
+
+    /**
+     * @brief Iterate until the slice boundaries converge or the iteration cap is reached
+     * @return False if cancelled (the first iterations() slices are exact then)
+     * @throws std::runtime_error if a slice fails (e.g. Newton does not converge)
+     */
+    bool run(const IterationCallback& callback = IterationCallback());
+
+    /**
+     * @brief Stop after the current step of every slice; thread-safe
+     */
+    void cancel() { m_cancelled = true; }
+
+    int sliceCount() const { return static_cast<int>(m_fine.size()); }
+    int iterations() const { return m_iterations; }
+    bool isConverged() const { return m_converged; }
+
+    /**
+     * @brief States at the slice boundaries, initial state first (sliceCount() + 1)
+     */
+    const std::vector<SimulationState>& boundaries() const { return m_boundaries; }
+
+    /**
+     * @brief Throw std::runtime_error unless the parameters can run in Parareal
+     *
+     * Needs a fixed-step integrator (not Dormand-Prince or modal
+     * superposition), no contact and no domain decomposition.
+     */
+    static void checkSupported(const SimulationParameters& params);
+
+private:
+    void propagate(SimulationSolver& solver, const SimulationState& start, int slice, int steps,
+                   SimulationState& end);
+    void coarse(int slice, const SimulationState& start, SimulationState& end);
+    static void combine(const SimulationState& coarseNew, const SimulationState& fine,
+                        const SimulationState& coarseOld, SimulationState& result);
+    static double distance(const SimulationState& a, const SimulationState& b);     // |x, v| of a - b
+    static double magnitude(const SimulationState& state);
+
+    SimulationSolver m_coarse;
+    std::vector<std::unique_ptr<SimulationSolver>> m_fine;
+    std::vector<int> m_sliceSteps;          // First fine step of each slice, then the end step
+    std::vector<double> m_sliceTimes;       // Time at each slice boundary
+    std::vector<int> m_coarseSteps;         // Coarse steps per slice
+    int m_numThreads;
+    double m_tolerance;
+    int m_maxIterations;
+
+    std::vector<SimulationState> m_boundaries;      // U at the slice boundaries
+    std::vector<SimulationState> m_fineEnds;        // F(U[n]) of the last fine sweep
+    std::vector<SimulationState> m_coarseEnds;      // G(U[n]) of the last correction
+    int m_iterations;
+    bool m_converged;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // PARAREAL_H
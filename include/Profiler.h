@@ -0,0 +1,155 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Per-phase timers for the simulation hot path
+ *
+ * When the build defines SIMTOOL_PROFILING (CMake option of the same
+ * name), SIMTOOL_PROFILE_SCOPE(Forces) and the like time the enclosing
+ * scope and add the duration to the histogram of that Phase. Histograms are process-wide
+ * and updated with relaxed atomics, so worker threads of the solver pool
+ * record into them as well. Without the option the macro expands to
+ * nothing, isEnabled() is false and the statistics stay empty.
+ *
+ * Optionally every timed scope is also kept as a trace event (see
+ * startTrace()) and written as Chrome trace-event JSON, which
+ * chrome://tracing and Perfetto display as a per-thread timeline.
+ */
+namespace Profiler
+{
+    /**
+     * @brief Timed phases of the step loop
+     */
+    enum Phase
+    {
+        Step,           // One solver step (force evaluation, update, linear solve), wall time
+        Forces,         // Force evaluation of one chunk of rows, on the thread computing it
+        LinearSolve,    // CG solve of an implicit step
+        PauseWait,      // Pause check: engine mutex and wait while paused
+        Publish,        // Copying the state into a snapshot and publishing it
+        Emit,           // Emitting progress and state signals
+        Record,         // Queueing the state for the time history writer
+        Checkpoint,     // Handing the state to the checkpoint writer
+        Contact,        // Contact detection and penalty forces of one evaluation
+        PhaseCount
+    };
+
+    /**
+     * @brief Aggregated durations of one phase (nanoseconds)
+     *
+     * Percentiles come from a histogram with four buckets per power of
+     * two, so they are exact to within 25%.
+     */
+    struct PhaseStats
+    {
+        Phase phase;
+        const char* name;
+        unsigned long long count;
+        unsigned long long totalNs;
+        unsigned long long minNs;
+        unsigned long long maxNs;
+        unsigned long long p50Ns;
+        unsigned long long p90Ns;
+        unsigned long long p99Ns;
+
+        double meanNs() const { return count ? static_cast<double>(totalNs) / count : 0.0; }
+    };
+
+    /**
+     * @brief Check whether the timers are compiled in
+     */
+    bool isEnabled();
+
+    /**
+     * @brief Short name of a phase, also used for trace events
+     */
+    const char* phaseName(Phase phase);
+
+    /**
+     * @brief Clear every histogram and the trace (call while nothing is timed)
+     */
+    void reset();
+
+    PhaseStats stats(Phase phase);
+
+    /**
+     * @brief Statistics of every phase that recorded at least once
+     */
+    std::vector<PhaseStats> allStats();
+
+    /**
+     * @brief Write one line per recorded phase: count, total, mean, p50/p99, max
+     */
+    void printSummary(std::ostream& out);
+
+    /**
+     * @brief Keep trace events from now on, up to maxEvents (then drop and count)
+     *
+     * The event buffer is allocated here, so tracing adds no allocations
+     * to the step loop. Call while nothing is timed.
+     */
+    void startTrace(std::size_t maxEvents = 1 << 20);
+
+    /**
+     * @brief Stop keeping trace events (the recorded ones are kept)
+     */
+    void stopTrace();
+
+    unsigned long long traceEventCount();
+    unsigned long long droppedTraceEvents();
+
+    /**
+     * @brief Write the recorded events as Chrome trace-event JSON
+     * @return false (with error) if the file cannot be written
+     */
+    bool writeChromeTrace(const std::string& path, std::string& error);
+
+    /**
+     * @brief Monotonic clock in nanoseconds
+     */
+    inline unsigned long long now()
+    {
+        return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Add one duration to a phase (and to the trace while tracing)
+     */
+    void record(Phase phase, unsigned long long startNs, unsigned long long durationNs);
+
+    /**
+     * @brief Records the lifetime of the scope it is declared in
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Phase phase) : m_phase(phase), m_start(now()) {}
+        ~ScopedTimer() { record(m_phase, m_start, now() - m_start); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Phase m_phase;
+        unsigned long long m_start;
+    };
+}
+
+#define SIMTOOL_PROFILE_CONCAT_(a, b) a##b
+#define SIMTOOL_PROFILE_CONCAT(a, b) SIMTOOL_PROFILE_CONCAT_(a, b)
+
+#ifdef SIMTOOL_PROFILING
+#define SIMTOOL_PROFILE_SCOPE(phase) \
+    ::Profiler::ScopedTimer SIMTOOL_PROFILE_CONCAT(simtoolProfileScope, __LINE__)(::Profiler::phase)
+#else
+#define SIMTOOL_PROFILE_SCOPE(phase)
+#endif
+
+#endif // PROFILER_H
@@ -8,8 +8,10 @@
 // OpenCASCADE includes
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Compound.hxx>
+#ifndef SIMTOOL_NO_DISPLAY
 #include <AIS_InteractiveContext.hxx>
 #include <AIS_Shape.hxx>
+#endif
 
 /**
  * @brief STEP file reader and geometry handler
@@ -20,6 +22,9 @@
  * - Extract geometry information
  * - Display shapes in AIS context
  * - Query geometric properties
+ *
+ * Built with SIMTOOL_NO_DISPLAY (headless tools), the AIS display part is
+ * left out so the reader does not pull in the visualization toolkits.
  */
 class STEPReader : public QObject
 {
@@ -68,12 +73,14 @@ public:
      */
     TopoDS_Shape getShape() const { return m_shape; }
 
+#ifndef SIMTOOL_NO_DISPLAY
     /**
      * @brief Display the shape in the given AIS context
      * @param context The AIS interactive context
      * @param fitAll Whether to fit all objects in view
      */
     void displayShape(const Handle(AIS_InteractiveContext)& context, bool fitAll = true);
+#endif
 
     /**
      * @brief Get geometry information
@@ -81,6 +88,14 @@ public:
      */
     GeometryInfo getGeometryInfo() const;
 
+    /**
+     * @brief Recount the solids, shells, faces, edges and vertices of the loaded shape
+     *
+     * Called by loadSTEPFile(); public so the benchmark suite can time the
+     * topology pass on its own.
+     */
+    void analyzeShape();
+
     /**
      * @brief Check if a shape is loaded
      * @return true if a shape is loaded
@@ -106,13 +121,14 @@ signals:
 
 private:
     // Helper methods
-    void analyzeShape();
     void computeProperties();
     void setError(const QString& error);
 
     // Data members
     TopoDS_Shape m_shape;
+#ifndef SIMTOOL_NO_DISPLAY
     Handle(AIS_Shape) m_aisShape;
+#endif
     GeometryInfo m_geometryInfo;
     QString m_lastError;
     QString m_currentFilePath;
@@ -0,0 +1,69 @@
+#ifndef SCALARPRECISION_H
+#define SCALARPRECISION_H
+
+/**
+ * @brief Scalar types the solver stores and computes its state in
+ *
+ * Double keeps everything in double. Single stores the stiffness values,
+ * masses, state and scratch vectors in float, which halves the memory
+ * traffic of the step loop and doubles the SIMD width. Mixed stores the
+ * stiffness values, inverse masses, forces and accelerations in float but
+ * keeps and accumulates positions and velocities in double, so rounding
+ * errors of the force evaluation do not build up in the trajectory.
+ *
+ * Energies and other reductions are summed in double in every mode.
+ */
+enum class ScalarPrecision
+{
+    Double,
+    Single,
+    Mixed
+};
+
+/**
+ * @brief Compile-time scalar policies, one per ScalarPrecision
+ *
+ * Real is the type of the force-side data (stiffness values, inverse
+ * masses, forces, accelerations), Accum the type positions and velocities
+ * are stored and integrated in.
+ */
+namespace ScalarPrecisions
+{
+    struct Double
+    {
+        typedef double Real;
+        typedef double Accum;
+        static const ScalarPrecision Mode = ScalarPrecision::Double;
+        static const char* name() { return "double"; }
+    };
+
+    struct Single
+    {
+        typedef float Real;
+        typedef float Accum;
+        static const ScalarPrecision Mode = ScalarPrecision::Single;
+        static const char* name() { return "single"; }
+    };
+
+    struct Mixed
+    {
+        typedef float Real;
+        typedef double Accum;
+        static const ScalarPrecision Mode = ScalarPrecision::Mixed;
+        static const char* name() { return "mixed"; }
+    };
+}
+
+/**
+ * @brief Human-readable name of a precision mode
+ */
+inline const char* precisionName(ScalarPrecision precision)
+{
+    switch (precision) {
+        case ScalarPrecision::Single: return ScalarPrecisions::Single::name();
+        case ScalarPrecision::Mixed:  return ScalarPrecisions::Mixed::name();
+        default:                return ScalarPrecisions::Double::name();
+    }
+}
+
+#endif // SCALARPRECISION_H
@@ -0,0 +1,72 @@
+#ifndef SETTLINGTRACKER_H
+#define SETTLINGTRACKER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Online peak and settling time of a displacement history
+ *
+ * The settling time is the last time the amplitude was above a band
+ * (fraction) of its overall peak, computed while stepping without storing
+ * the history. The threshold only rises with the peak, so a sample at or
+ * below the current threshold can never be the answer and is dropped. The
+ * kept samples are the suffix maxima above the threshold (amplitudes
+ * strictly decreasing in time); the answer is the latest one above the
+ * final threshold.
+ */
+class SettlingTracker
+{
+public:
+    explicit SettlingTracker(double band = 0.02)
+        : m_band(band)
+        , m_peak(0.0)
+    {}
+
+    /**
+     * @brief Largest |value| of count values spaced stride apart
+     */
+    static double maxAbs(const double* values, std::size_t count, std::size_t stride = 1)
+    {
+        double result = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            result = std::max(result, std::abs(values[i * stride]));
+        }
+        return result;
+    }
+
+    void add(double time, double amplitude)
+    {
+        m_peak = std::max(m_peak, amplitude);
+        if (amplitude <= m_band * m_peak) {
+            return;
+        }
+        while (!m_samples.empty() && m_samples.back().second <= amplitude) {
+            m_samples.pop_back();
+        }
+        m_samples.push_back(std::make_pair(time, amplitude));
+    }
+
+    double peak() const { return m_peak; }
+
+    double settlingTime() const
+    {
+        const double threshold = m_band * m_peak;
+        for (auto it = m_samples.rbegin(); it != m_samples.rend(); ++it) {
+            if (it->second > threshold) {
+                return it->first;
+            }
+        }
+        return 0.0;
+    }
+
+private:
+    double m_band;
+    double m_peak;
+    std::vector<std::pair<double, double>> m_samples;   // (time, amplitude)
+};
+
+#endif // SETTLINGTRACKER_H
@@ -5,8 +5,22 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <atomic>
+#include <memory>
 #include <vector>
 
+// OpenCASCADE includes
+#include <TopoDS_Shape.hxx>
+
+#include "Checkpoint.h"
+#include "DomainExchange.h"
+#include "Parareal.h"
+#include "Profiler.h"
+#include "SimulationSolver.h"
+#include "SimulationTypes.h"
+#include "TimeHistoryRecorder.h"
+#include "TripleBuffer.h"
+#include "SnapshotPool.h"
+
 /**
  * @brief Simulation computation engine running in a separate thread
  * 
@@ -16,52 +30,43 @@
  * - Progress reporting
  * - Time-stepping simulation
  * - Thread-safe parameter updates
+ * - DOFs and sparse stiffness built from the loaded geometry
+ * - Unthrottled headless mode with decimated state publication
+ * - Lock-free state snapshots for readers and pooled pushed updates
+ * - SIMD kernels (AVX2/AVX-512/scalar, chosen at runtime) on aligned SoA state
+ * - Allocation-free steady-state stepping on a preallocated workspace
+ * - Multi-core stepping on a work-stealing pool, deterministic for any thread count
+ * - Selectable time integrator (see Integrators.h), one specialized step loop each
+ * - Adaptive stepping with embedded error control (Dormand-Prince 5(4))
+ * - Implicit schemes for stiff models, solved with preconditioned CG
+ * - Early stop at steady state, from an energy reduction fused into the step
+ * - Asynchronous checkpoints to a memory-mapped file, and restart from them
+ * - Per-step time history streamed to a columnar file by a background writer
+ * - Per-phase timers and trace events when built with SIMTOOL_PROFILING
+ * - Steps run in batches; pause/stop are polled lock-free between batches
+ * - Domain decomposition over worker processes with shared-memory halo exchange
+ * - Parareal parallel-in-time integration of long runs on small models
  */
 class SimulationEngine : public QThread
 {
     Q_OBJECT
 
 public:
-    /**
-     * @brief Simulation parameters structure
-     */
-    struct SimulationParameters
-    {
-        double timeStep;        // Time step size (seconds)
-        double totalTime;       // Total simulation time (seconds)
-        double damping;         // Damping coefficient
-        double stiffness;       // Stiffness coefficient
-        int maxIterations;      // Maximum iterations per step
-        double tolerance;       // Convergence tolerance
-
-        SimulationParameters()
-            : timeStep(0.01)
-            , totalTime(10.0)
-            , damping(0.1)
-            , stiffness(1000.0)
-            , maxIterations(100)
-            , tolerance(1e-6)
-        {}
-    };
+    // Shared with SimulationSolver and the batch tools (see SimulationTypes.h)
+    typedef ::RunMode RunMode;
+    typedef ::IntegratorType IntegratorType;
+    typedef ::NonlinearMethod NonlinearMethod;
+    typedef ::DofOrdering DofOrdering;
+    typedef ::SimulationParameters SimulationParameters;
+    typedef ::SimulationState SimulationState;
 
     /**
-     * @brief Simulation state structure
+     * @brief Immutable, ref-counted view of a published state
+     *
+     * Snapshots come from a pool and are recycled once every holder has
+     * released them; never cast away the const.
      */
-    struct SimulationState
-    {
-        double currentTime;
-        int currentStep;
-        int totalSteps;
-        std::vector<double> positions;
-        std::vector<double> velocities;
-        std::vector<double> accelerations;
-
-        SimulationState()
-            : currentTime(0.0)
-            , currentStep(0)
-            , totalSteps(0)
-        {}
-    };
+    typedef std::shared_ptr<const SimulationState> StateSnapshot;
 
     explicit SimulationEngine(QObject *parent = nullptr);
     ~SimulationEngine();
@@ -76,16 +81,105 @@ public:
     void setParameters(const SimulationParameters& params);
     SimulationParameters getParameters() const;
 
+    /**
+     * @brief Set the geometry to discretize at the next start
+     * @param shape Shape to mesh (typically STEPReader::getShape());
+     *              a null shape falls back to a 10-DOF chain
+     */
+    void setGeometry(const TopoDS_Shape& shape);
+
+    /**
+     * @brief Set the file that periodic checkpoints are written to
+     *
+     * Checkpoints are taken every checkpointInterval steps (see
+     * SimulationParameters) and once more when the run ends or is stopped.
+     * An empty path disables them.
+     */
+    void setCheckpointFile(const QString& path);
+
+    /**
+     * @brief Continue the next run from the newest checkpoint of a file
+     *
+     * The physics parameters of the checkpoint replace the current ones;
+     * run mode, publication, thread count and checkpoint interval are kept.
+     * Applies to the next start only.
+     */
+    void setResumeCheckpoint(const QString& path);
+
+    /**
+     * @brief Record the time history of the following runs
+     *
+     * Each run calls recorder->start() with the model size, queues the
+     * initial state and every accepted step (thinned by the recorder's
+     * interval), and finishes the file when it ends or is stopped. The
+     * recorder is not owned; pass nullptr to stop recording. Set it while
+     * no run is active.
+     */
+    void setRecorder(TimeHistoryRecorder* recorder);
+
+    /**
+     * @brief Executable started for the workers of decomposed runs
+     *
+     * Runs with subdomains > 1 start it once per part (see
+     * DomainCoordinator). Defaults to SimulationToolCli next to the
+     * application.
+     */
+    void setWorkerProgram(const QString& path);
+
+    /**
+     * @brief Keep a trace event for every timed phase of the following runs
+     *
+     * Each run clears the profiler; with tracing on it also starts a new
+     * trace, which Profiler::writeChromeTrace() exports after the run.
+     * Has no effect unless built with SIMTOOL_PROFILING.
+     */
+    void setTracing(bool enabled);
+
+    /**
+     * @brief Timings of the current (or last) run, per phase of the step loop
+     *
+     * Safe to call from any thread while the run is going. Empty unless
+     * built with SIMTOOL_PROFILING (see Profiler.h).
+     */
+    std::vector<Profiler::PhaseStats> profileStats() const { return Profiler::allStats(); }
+
     // State queries
     bool isRunning() const { return m_isRunning; }
     bool isPaused() const { return m_isPaused; }
     SimulationState getCurrentState() const;
 
+    /**
+     * @brief Get the latest published state without copying it
+     *
+     * Never blocks the solver thread. Readers serialize only among
+     * themselves. In headless mode the snapshot is as recent as the last
+     * decimated publication.
+     *
+     * @return Latest snapshot (null before the first run)
+     */
+    StateSnapshot getLatestSnapshot() const;
+
+    /**
+     * @brief Heap allocations made inside time steps during the last run
+     *
+     * Includes the pool workers of multi-threaded runs. Only counted when
+     * built with SIMTOOL_COUNT_ALLOCATIONS (see AllocationCounter.h);
+     * expected to stay at zero.
+     */
+    unsigned long long stepAllocations() const { return m_stepAllocations; }
+
 signals:
     void progressUpdated(int progress);
     void simulationFinished();
     void simulationError(const QString& error);
-    void stateUpdated(const SimulationState& state);
+    void stateUpdated(const SimulationEngine::StateSnapshot& snapshot);
+
+    /**
+     * @brief The run stopped early because the system came to rest
+     * @param time Simulated time at which the steady state was confirmed
+     * @param energy Total energy at that time
+     */
+    void steadyStateReached(double time, double energy);
 
 protected:
     void run() override;
@@ -93,21 +187,54 @@ protected:
 private:
     // Simulation computation methods
     void initializeSimulation();
-    void performTimeStep();
-    void computeForces(std::vector<double>& forces);
-    void integrateMotion(const std::vector<double>& forces);
-    void checkConvergence();
+    template <typename Integrator> void runLoop();
+    void runDecomposedLoop();
+    void runPararealLoop();
+    template <typename Integrator> void performTimeStep();
     void finalizeSimulation();
-
-    // Thread synchronization
+    void waitWhilePaused();
+    bool isPublishDue(qint64 elapsedMs, int stepsSincePublish) const;
+    void publishState();
+    StateSnapshot publishSnapshot();
+    void submitCheckpoint();
+
+    // Thread synchronization: m_mutex guards parameters and run setup;
+    // m_pauseMutex is only taken to pause, resume or stop
     mutable QMutex m_mutex;
+    QMutex m_pauseMutex;
     QWaitCondition m_pauseCondition;
 
-    // Simulation parameters and state
+    // Simulation parameters (the solver copies them at each start)
     SimulationParameters m_parameters;
-    SimulationState m_state;
+
+    // Published snapshots (solver writes, readers pick up the latest)
+    mutable TripleBuffer<StateSnapshot> m_snapshots;
+    mutable QMutex m_readerMutex;
+    SnapshotPool<SimulationState> m_snapshotPool;
+
+    // Geometry, and the model, state and buffers of the current run
+    TopoDS_Shape m_shape;
+    SimulationSolver m_solver;
+    std::atomic<unsigned long long> m_stepAllocations;
+
+    // Checkpointing (written on its own thread) and pending restart
+    CheckpointWriter m_checkpointWriter;
+    QString m_checkpointPath;
+    QString m_resumePath;
+
+    // Time history output (not owned)
+    TimeHistoryRecorder* m_recorder;
+
+    // Worker processes of a decomposed run, and the state gathered from them
+    std::unique_ptr<DomainCoordinator> m_domains;
+    QString m_workerProgram;
+    SimulationState m_domainState;
+
+    // Parareal iteration of the current run (created and reset under m_pauseMutex)
+    std::unique_ptr<Parareal> m_parareal;
 
     // Control flags
+    std::atomic<bool> m_tracing;
     std::atomic<bool> m_isRunning;
     std::atomic<bool> m_isPaused;
     std::atomic<bool> m_shouldStop;
@@ -116,4 +243,6 @@ private:
     int m_progressPercent;
 };
 
+Q_DECLARE_METATYPE(SimulationEngine::StateSnapshot)
+
 #endif // SIMULATIONENGINE_H
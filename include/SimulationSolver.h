@@ -0,0 +1,337 @@
+#ifndef SIMULATIONSOLVER_H
+#define SIMULATIONSOLVER_H
+
+#include <memory>
+#include <ostream>
+
+// OpenCASCADE includes
+#include <TopoDS_Shape.hxx>
+
+#include "ConjugateGradient.h"
+#include "ContactDetector.h"
+#include "Integrators.h"
+#include "ModalAnalysis.h"
+#include "NewtonSolver.h"
+#include "SimulationTypes.h"
+#include "SolverKernels.h"
+#include "SolverWorkspace.h"
+#include "StructuralModel.h"
+#include "WorkStealingPool.h"
+
+/**
+ * @brief Time-stepping core of one simulation run, without threads or signals
+ *
+ * Owns the assembled model, the state and every solver buffer of a run.
+ * SimulationEngine drives one instance from its QThread; batch tools
+ * (parameter sweeps, command line runs) drive as many as they need, one
+ * per concurrent case. Instances share nothing, so different instances
+ * may step concurrently on different threads.
+ *
+ * The step loop is compiled once per integrator: dispatch() calls a
+ * generic callable with the policy type selected by the parameters, and
+ * the caller runs its loop with step<Integrator>() inside.
+ *
+ * In single and mixed precision (SimulationParameters::precision) the
+ * solver steps a float (or float/double) copy of the operator and state
+ * and brings the double SimulationState up to date only when state() is
+ * read, so loops that read it rarely keep the reduced memory traffic.
+ * Modal superposition runs do the same with their modal coordinates.
+ *
+ * With a node ordering other than Natural (SimulationParameters::dofOrdering)
+ * the model is renumbered before assembly. The solver then works in its own
+ * numbering throughout (model(), modes()), while state() and restore() use
+ * the original DOF numbering of the discretized model.
+ */
+class SimulationSolver
+{
+public:
+    SimulationSolver();
+
+    SimulationSolver(const SimulationSolver&) = delete;
+    SimulationSolver& operator=(const SimulationSolver&) = delete;
+
+    /**
+     * @brief Discretize a shape into an unassembled model
+     * @param shape Shape to mesh; a null shape gives a 10-DOF chain
+     * @param meshSize Target element size (0 = automatic)
+     * @throws std::runtime_error if meshing fails
+     */
+    static StructuralModel buildModel(const TopoDS_Shape& shape, double meshSize);
+
+    /**
+     * @brief Prepare a run: assemble the model and size every buffer
+     *
+     * The model is copied, so one discretized model can seed many runs
+     * with different stiffness values.
+     *
+     * @param params Run parameters (copied)
+     * @param model Discretized model (assembled here with params.stiffness)
+     * @throws std::runtime_error if the parameters combine unsupported options
+     */
+    void initialize(const SimulationParameters& params, const StructuralModel& model);
+
+    /**
+     * @brief Continue a run from a saved state instead of the initial conditions
+     *
+     * Call after initialize() with the parameters the state was computed
+     * with. Positions, velocities and accelerations (the FSAL stage of the
+     * adaptive scheme) are taken over, together with the time, step
+     * counters, step size and steady-state window.
+     *
+     * @throws std::runtime_error if the DOF count does not match the model
+     */
+    void restore(const SimulationState& state, double initialEnergy, int quietSteps);
+
+    /**
+     * @brief Call function(Policy()) with the integrator policy of the parameters
+     *
+     * In single and mixed precision the policy is an
+     * Integrators::WithPrecision, so the loop is compiled per precision too.
+     */
+    template <typename Function>
+    void dispatch(Function&& function) const;
+
+    /**
+     * @brief Advance by one (accepted) step; allocation-free
+     * @throws std::runtime_error if an adaptive step cannot be accepted
+     *         or the Newton iterations of a nonlinear step or the linear
+     *         solve of an implicit step do not converge
+     */
+    template <typename Integrator>
+    void step();
+
+    /**
+     * @brief Whether the run has reached totalTime (or totalSteps)
+     */
+    template <typename Integrator>
+    bool isEndReached() const;
+
+    /**
+     * @brief Update the steady-state window with the energy of the last step
+     * @return True once the energy stayed under the threshold for the whole window
+     */
+    bool checkSteadyState();
+
+    /**
+     * @brief Whether the last checkSteadyState() confirmed a steady state
+     */
+    bool isSteady() const;
+
+    /**
+     * @brief Write run statistics (adaptive steps, Newton and CG iterations, steady state)
+     */
+    void printSummary(std::ostream& out) const;
+
+    /**
+     * @brief Result of comparing a reduced-precision run with a double one
+     */
+    struct PrecisionReport
+    {
+        ScalarPrecision precision;
+        int steps;                  // Steps compared
+        double positionError;       // |x - x_ref| / |x_ref| after the last step
+        double energyError;         // |E - E_ref| / |E0|, largest over all steps
+        bool passed;                // Both errors within params.precisionTolerance
+    };
+
+    /**
+     * @brief Run params (in its precision) and the same run in double side by side
+     *
+     * Intended as a check before a long single or mixed precision run:
+     * both runs start from the same model and initial state and advance
+     * min(steps, planned steps) steps.
+     *
+     * @throws std::runtime_error if params cannot run in its precision
+     */
+    static PrecisionReport validatePrecision(const SimulationParameters& params,
+                                             const StructuralModel& model, int steps);
+
+    const SimulationParameters& parameters() const { return m_parameters; }
+
+    /**
+     * @brief Current state in double and in the original DOF numbering
+     *
+     * Converted here in single and mixed precision, and permuted here once
+     * per step when the model was renumbered.
+     */
+    const SimulationState& state() const;
+
+    /**
+     * @brief The solver's own double state in its numbering, for editing between steps
+     *
+     * Lets domain-decomposition workers overwrite their halo values after
+     * each step (see DomainWorker). Vectors must keep their sizes.
+     *
+     * @throws std::runtime_error in reduced precision, modal runs or renumbered models
+     */
+    SimulationState& writableState();
+
+    int currentStep() const { return m_state.currentStep; }
+    double currentTime() const { return m_state.currentTime; }
+
+    /**
+     * @brief Energy reported by the last step
+     *
+     * The fused explicit kernels and linear backward Euler reduce it at
+     * the start of the step; see stateEnergy() for the state after it.
+     */
+    double energy() const { return m_state.energy; }
+
+    /**
+     * @brief Total energy of the current state (kinetic plus spring potential)
+     *
+     * Evaluates the forces once, so call it between steps, not per step.
+     */
+    double stateEnergy();
+    const StructuralModel& model() const { return m_model; }
+
+    /**
+     * @brief Original DOF of each solver DOF (empty = natural numbering)
+     */
+    const std::vector<int>& dofOrder() const { return m_dofOrder; }
+    double initialEnergy() const { return m_initialEnergy; }
+    int quietSteps() const { return m_quietSteps; }
+
+    /**
+     * @brief Modes of a modal superposition run (empty otherwise)
+     */
+    const ModalAnalysis& modes() const { return m_modes; }
+
+    /**
+     * @brief Newton solver of a nonlinear implicit run (disabled otherwise)
+     */
+    const NewtonSolver& newton() const { return m_newton; }
+
+private:
+    /**
+     * @brief Operator values, state and workspace of a single or mixed precision run
+     *
+     * The CSR index arrays are shared with the double operator.
+     */
+    template <typename PrecisionPolicy>
+    struct ReducedStorage
+    {
+        typedef typename PrecisionPolicy::Real Real;
+        typedef typename PrecisionPolicy::Accum Accum;
+
+        AlignedArray<Real> stiffnessValues;
+        AlignedArray<Accum> positions;
+        AlignedArray<Accum> velocities;
+        AlignedArray<Real> accelerations;
+        BasicSolverWorkspace<PrecisionPolicy> workspace;
+    };
+
+    /**
+     * @brief Modal coordinates of a modal superposition run (see Integrators::ModalSuperposition)
+     */
+    struct ModalStorage
+    {
+        AlignedVector displacements;        // q
+        AlignedVector velocities;           // q'
+        AlignedVector accelerations;        // q''
+        AlignedVector dampings;             // alpha per mode
+        AlignedVector propagators;          // 2x2 transition matrix per mode
+    };
+
+    template <typename Integrator, typename Function>
+    void dispatchPrecision(Function& function) const;
+
+    void computeForces(AlignedVector& forces);
+    double evaluateState(bool updateAccelerations);
+    SolverKernels::StepArgs makeStepArgs();
+    IntegratorContext makeIntegratorContext();
+    template <typename PrecisionPolicy>
+    BasicIntegratorContext<PrecisionPolicy> makeIntegratorContext(ReducedStorage<PrecisionPolicy>& storage);
+    void runKernel(void (*kernel)(const SolverKernels::StepArgs&),
+                   const SolverKernels::StepArgs& args);
+    void runSteps(int count);
+
+    // Reduced-precision copies (see state())
+    template <typename PrecisionPolicy>
+    void storeReduced(ReducedStorage<PrecisionPolicy>& storage, int stageCount, int chunkCount);
+    template <typename PrecisionPolicy>
+    void storeReducedState(ReducedStorage<PrecisionPolicy>& storage);
+    template <typename PrecisionPolicy>
+    void loadReducedState(const ReducedStorage<PrecisionPolicy>& storage) const;
+    ReducedStorage<ScalarPrecisions::Single>& reducedStorage(ScalarPrecisions::Single) { return m_single; }
+    ReducedStorage<ScalarPrecisions::Mixed>& reducedStorage(ScalarPrecisions::Mixed) { return m_mixed; }
+
+    // Modal coordinates (see state())
+    void setupModal();
+    void storeModalState();
+    void loadModalState() const;
+
+    SimulationParameters m_parameters;
+    mutable SimulationState m_state;        // Vectors lag behind while m_stateStale
+    mutable bool m_stateStale;
+    StructuralModel m_model;                // In solver numbering
+    std::vector<int> m_dofOrder;            // Original DOF per solver DOF (params.dofOrdering)
+    mutable SimulationState m_originalState;    // state() in the original numbering
+    mutable int m_originalStep;             // Step m_originalState was permuted at (-1 = none)
+
+    // Solver buffers and kernels
+    SolverWorkspace m_workspace;
+    ReducedStorage<ScalarPrecisions::Single> m_single;
+    ReducedStorage<ScalarPrecisions::Mixed> m_mixed;
+    const SolverKernels::KernelTable* m_kernels;
+    std::unique_ptr<WorkStealingPool> m_pool;
+    SparseMatrix m_systemMatrix;            // Implicit schemes: M + a c + b K
+    ConjugateGradient m_linearSolver;
+    NewtonSolver m_newton;                  // Nonlinear implicit runs (params.nonlinearMethod)
+    ContactDetector m_contact;              // Penalty contact between bodies (params.contactStiffness)
+    ModalAnalysis m_modes;                  // Modal superposition: retained modes
+    ModalStorage m_modal;
+
+    // Steady-state detection
+    double m_initialEnergy;
+    int m_quietSteps;                       // Consecutive steps below the threshold
+};
+
+template <typename Function>
+void SimulationSolver::dispatch(Function&& function) const
+{
+    switch (m_parameters.integrator) {
+        case IntegratorType::VelocityVerlet:
+            dispatchPrecision<Integrators::VelocityVerlet>(function);
+            break;
+        case IntegratorType::RungeKutta4:
+            dispatchPrecision<Integrators::RungeKutta4>(function);
+            break;
+        case IntegratorType::Newmark:
+            dispatchPrecision<Integrators::Newmark>(function);
+            break;
+        case IntegratorType::DormandPrince54:
+            function(Integrators::DormandPrince54());
+            break;
+        case IntegratorType::BackwardEuler:
+            function(Integrators::BackwardEuler());
+            break;
+        case IntegratorType::ImplicitNewmark:
+            function(Integrators::ImplicitNewmark());
+            break;
+        case IntegratorType::ModalSuperposition:
+            function(Integrators::ModalSuperposition());
+            break;
+        default:
+            dispatchPrecision<Integrators::SymplecticEuler>(function);
+            break;
+    }
+}
+
+template <typename Integrator, typename Function>
+void SimulationSolver::dispatchPrecision(Function& function) const
+{
+    switch (m_parameters.precision) {
+        case ScalarPrecision::Single:
+            function(Integrators::WithPrecision<Integrator, ScalarPrecisions::Single>());
+            break;
+        case ScalarPrecision::Mixed:
+            function(Integrators::WithPrecision<Integrator, ScalarPrecisions::Mixed>());
+            break;
+        default:
+            function(Integrator());
+            break;
+    }
+}
+
+#endif // SIMULATIONSOLVER_H
@@ -0,0 +1,169 @@
+#ifndef SIMULATIONTYPES_H
+#define SIMULATIONTYPES_H
+
+#include "AlignedAllocator.h"
+#include "ConjugateGradient.h"
+#include "ScalarPrecision.h"
+
+// Parameter and state types shared by SimulationEngine, SimulationSolver
+// and the batch tools built on the solver. SimulationEngine re-exports them
+// under its own scope (SimulationEngine::SimulationParameters, ...).
+
+/**
+ * @brief Run loop mode
+ *
+ * Interactive sleeps 1 ms and publishes after every step so the UI can
+ * follow the motion. Headless never sleeps and publishes state and
+ * progress only at the configured rate.
+ */
+enum class RunMode
+{
+    Interactive,
+    Headless
+};
+
+/**
+ * @brief Time integration scheme
+ *
+ * Higher-order schemes cost more force evaluations per step but stay
+ * accurate at much larger time steps than symplectic Euler.
+ */
+enum class IntegratorType
+{
+    SymplecticEuler,    // 1 force evaluation per step, first order
+    VelocityVerlet,     // 1 force evaluation per step, second order
+    RungeKutta4,        // 4 force evaluations per step, fourth order
+    Newmark,            // Explicit Newmark-beta (beta = 0, gamma = 1/2)
+    DormandPrince54,    // Adaptive step size, error kept below tolerance
+    BackwardEuler,      // Implicit, first order, damps high frequencies
+    ImplicitNewmark,    // Implicit Newmark-beta (beta = 1/4, gamma = 1/2)
+    ModalSuperposition  // Lowest modes only, each stepped exactly (linear, see ModalAnalysis)
+};
+
+/**
+ * @brief Treatment of the springs by the implicit integrators
+ *
+ * The nonlinear methods treat the springs as geometrically exact and
+ * solve every step with Newton-Raphson iterations (see NewtonSolver).
+ */
+enum class NonlinearMethod
+{
+    Linear,             // Constant system matrix, one linear solve per step
+    Newton,             // Tangent re-formed every iteration
+    ModifiedNewton      // Tangent kept across iterations and steps until convergence slows down
+};
+
+/**
+ * @brief Node numbering of the assembled model (see NodeOrdering)
+ *
+ * Renumbering only changes the memory layout of the operator and state;
+ * SimulationSolver::state() always reports the original numbering.
+ */
+enum class DofOrdering
+{
+    Natural,                // As produced by the mesh discretizer
+    ReverseCuthillMcKee,    // Bandwidth reduction over the mesh edges
+    Morton,                 // Z-order curve through the node coordinates
+    Hilbert                 // Hilbert curve through the node coordinates
+};
+
+/**
+ * @brief Simulation parameters structure
+ */
+struct SimulationParameters
+{
+    double timeStep;        // Time step size (seconds)
+    double totalTime;       // Total simulation time (seconds)
+    double damping;         // Damping coefficient
+    double stiffness;       // Stiffness coefficient
+    int maxIterations;      // Maximum iterations per step (adaptive: attempts; implicit: CG iterations; nonlinear: also Newton iterations)
+    double tolerance;       // Convergence tolerance (adaptive: local error; implicit: CG residual; nonlinear: also Newton residual)
+    double meshSize;        // Target element size for discretization (0 = automatic)
+    RunMode runMode;        // Interactive (throttled) or headless (unthrottled)
+    double publishRate;     // Headless: state publications per second of wall-clock time
+    int publishInterval;    // Headless: publish every N steps instead (0 = use publishRate)
+    int numThreads;         // Threads used for stepping (0 = all cores)
+    int stepBatchSize;      // Steps run between checks of the pause/stop requests
+    IntegratorType integrator;  // Time integration scheme
+    ConjugateGradient::Preconditioner preconditioner;  // Implicit schemes: CG preconditioner
+    double steadyStateThreshold;    // Stop once energy / initial energy stays below this (0 = off)
+    int steadyStateWindow;          // Consecutive steps the energy must stay below the threshold
+    int checkpointInterval;         // Steps between checkpoints (0 = off; see CheckpointWriter)
+    ScalarPrecision precision;            // Scalar type of the state (single/mixed: explicit fixed-step schemes only)
+    int precisionCheckSteps;        // Single/mixed: steps compared against a double run first (0 = off)
+    double precisionTolerance;      // Allowed relative position and energy deviation of that check
+    double contactStiffness;        // Penalty stiffness between bodies (0 = no contact; see ContactDetector)
+    double contactThickness;        // Contact distance (0 = a quarter of the mean edge length)
+    int modeCount;                  // Modal superposition: lowest modes retained
+    NonlinearMethod nonlinearMethod;    // Implicit schemes: linear springs or Newton iterations
+    DofOrdering dofOrdering;        // Node renumbering before assembly, for cache locality
+    int subdomains;                 // Worker processes of a domain decomposed run (1 = this process)
+    int timeSlices;                 // Parareal: time slices integrated in parallel (1 = sequential run)
+    int coarseStepRatio;            // Parareal: fine steps per step of the coarse sweep
+    double pararealTolerance;       // Parareal: largest boundary change, relative to the largest boundary
+    int pararealMaxIterations;      // Parareal: iteration cap (0 = slice count, which always ends exact)
+
+    SimulationParameters()
+        : timeStep(0.01)
+        , totalTime(10.0)
+        , damping(0.1)
+        , stiffness(1000.0)
+        , maxIterations(100)
+        , tolerance(1e-6)
+        , meshSize(0.0)
+        , runMode(RunMode::Interactive)
+        , publishRate(30.0)
+        , publishInterval(0)
+        , numThreads(0)
+        , stepBatchSize(64)
+        , integrator(IntegratorType::SymplecticEuler)
+        , preconditioner(ConjugateGradient::Preconditioner::Jacobi)
+        , steadyStateThreshold(0.0)
+        , steadyStateWindow(100)
+        , checkpointInterval(0)
+        , precision(ScalarPrecision::Double)
+        , precisionCheckSteps(200)
+        , precisionTolerance(1e-3)
+        , contactStiffness(0.0)
+        , contactThickness(0.0)
+        , modeCount(50)
+        , nonlinearMethod(NonlinearMethod::Linear)
+        , dofOrdering(DofOrdering::Natural)
+        , subdomains(1)
+        , timeSlices(1)
+        , coarseStepRatio(4)
+        , pararealTolerance(1e-6)
+        , pararealMaxIterations(0)
+    {}
+};
+
+/**
+ * @brief Simulation state structure
+ */
+struct SimulationState
+{
+    double currentTime;
+    int currentStep;                // Accepted steps so far
+    int totalSteps;                 // Planned steps (0 when adaptive)
+    double timeStep;                // Current step size
+    int rejectedSteps;              // Adaptive: steps repeated with a smaller size
+    double energy;                  // Kinetic + potential energy (reduced during the step)
+    int iterations;                 // Nonlinear: Newton iterations of the last step
+    long long totalIterations;      // Nonlinear: Newton iterations of all steps
+    AlignedVector positions;        // 64-byte aligned SoA storage
+    AlignedVector velocities;
+    AlignedVector accelerations;
+
+    SimulationState()
+        : currentTime(0.0)
+        , currentStep(0)
+        , totalSteps(0)
+        , timeStep(0.0)
+        , rejectedSteps(0)
+        , energy(0.0)
+        , iterations(0)
+        , totalIterations(0)
+    {}
+};
+
+#endif // SIMULATIONTYPES_H
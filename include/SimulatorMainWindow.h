@@ -11,6 +11,9 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QDoubleSpinBox>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QComboBox>
 #include <QProgressBar>
 #include <QPushButton>
 #include <QAction>
@@ -33,6 +36,8 @@
 class SimulationEngine;
 class STEPReader;
 class SharedMemorySender;
+class TimeHistoryRecorder;
+struct StructuralModel;
 
 /**
  * @brief Main window class for the simulation tool
@@ -59,17 +64,24 @@ private slots:
     // Menu actions
     void onOpenSTEP();
     void onSaveResults();
+    void onResumeFromCheckpoint();
+    void onExportTrace();
     void onExit();
+    void onModalAnalysis();
 
     // Toolbar actions
     void onStartSimulation();
     void onPauseSimulation();
     void onStopSimulation();
 
+    // Parameter panel actions
+    void onSuggestTimeStep();
+
     // Simulation engine callbacks
     void onSimulationProgress(int progress);
     void onSimulationFinished();
     void onSimulationError(const QString& error);
+    void onSteadyStateReached(double time, double energy);
 
     // GeomProcessor IPC
     void onSendToGeomProcessor();
@@ -87,11 +99,17 @@ private:
     // OpenCASCADE initialization
     void initializeOCC();
 
+    // Meshes and assembles the loaded shape with the panel's mesh size and stiffness
+    bool assembleModel(StructuralModel& model);
+
     // Menu bar
     QMenu* m_fileMenu;
     QAction* m_openSTEPAction;
     QAction* m_saveResultsAction;
+    QAction* m_resumeCheckpointAction;
+    QAction* m_exportTraceAction;
     QAction* m_exitAction;
+    QAction* m_modalAnalysisAction;
 
     // Toolbar
     QToolBar* m_toolBar;
@@ -113,13 +131,35 @@ private:
     QDockWidget* m_parameterDock;
     QWidget* m_parameterWidget;
     QDoubleSpinBox* m_timeStepSpinBox;
+    QPushButton* m_suggestTimeStepButton;
     QDoubleSpinBox* m_totalTimeSpinBox;
     QDoubleSpinBox* m_dampingSpinBox;
     QDoubleSpinBox* m_stiffnessSpinBox;
+    QDoubleSpinBox* m_meshSizeSpinBox;
+    QDoubleSpinBox* m_contactStiffnessSpinBox;
+    QDoubleSpinBox* m_contactThicknessSpinBox;
+    QCheckBox* m_unthrottledCheckBox;
+    QSpinBox* m_threadCountSpinBox;
+    QSpinBox* m_subdomainsSpinBox;
+    QSpinBox* m_timeSlicesSpinBox;
+    QComboBox* m_integratorComboBox;
+    QSpinBox* m_modeCountSpinBox;
+    QComboBox* m_nonlinearComboBox;
+    QComboBox* m_orderingComboBox;
+    QComboBox* m_precisionComboBox;
+    QDoubleSpinBox* m_toleranceSpinBox;
+    QSpinBox* m_maxIterationsSpinBox;
+    QComboBox* m_preconditionerComboBox;
+    QDoubleSpinBox* m_steadyStateThresholdSpinBox;
+    QSpinBox* m_steadyStateWindowSpinBox;
+    QSpinBox* m_checkpointIntervalSpinBox;
+    QSpinBox* m_recordIntervalSpinBox;
 
     // Status bar
     QProgressBar* m_progressBar;
     QLabel* m_statusLabel;
+    QLabel* m_profileLabel;         // Mean time per step-loop phase (SIMTOOL_PROFILING builds)
+    void    updateProfileLabel();
 
     // 3D 视图左下角几何信息悬浮标签
     QLabel* m_geomInfoLabel = nullptr;
@@ -129,10 +169,12 @@ private:
     SimulationEngine* m_simulationEngine;
     STEPReader* m_stepReader;
     SharedMemorySender* m_sharedMemorySender;
+    TimeHistoryRecorder* m_historyRecorder;     // Time history of the last run (owned)
 
     // State
     QString m_currentFilePath;
     bool m_isSimulationRunning;
+    double m_steadyStateTime;       // Time of the early stop of the last run (< 0 = none)
 
     // GeomProcessor IPC
     QSharedMemory* m_geomIpcShm       = nullptr;
@@ -0,0 +1,60 @@
+#ifndef SNAPSHOTPOOL_H
+#define SNAPSHOTPOOL_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Pool of ref-counted snapshot buffers
+ *
+ * Hands out shared_ptr buffers and recycles a buffer as soon as every
+ * consumer has dropped its reference (the pool holds the last one). Buffers
+ * keep their capacity, so once the pool has warmed up publishing a
+ * snapshot copies data but does not allocate.
+ *
+ * acquire() must only be called from the producer thread; consumers may
+ * hold and release snapshots from any thread.
+ */
+template <typename T>
+class SnapshotPool
+{
+public:
+    explicit SnapshotPool(size_t maxPooled = 16)
+        : m_maxPooled(maxPooled)
+    {}
+
+    /**
+     * @brief Get a buffer no consumer is referencing
+     * @return A recycled buffer, or a new one if all pooled buffers are in use
+     */
+    std::shared_ptr<T> acquire()
+    {
+        for (size_t i = 0; i < m_buffers.size(); ++i) {
+            if (m_buffers[i].use_count() == 1) {
+                // Pair with the consumer's release of its last reference
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return m_buffers[i];
+            }
+        }
+
+        std::shared_ptr<T> buffer = std::make_shared<T>();
+        if (m_buffers.size() < m_maxPooled) {
+            m_buffers.push_back(buffer);
+        }
+        return buffer;
+    }
+
+    /**
+     * @brief Drop all pooled buffers (outstanding references stay valid)
+     */
+    void clear() { m_buffers.clear(); }
+
+    size_t pooledCount() const { return m_buffers.size(); }
+
+private:
+    size_t m_maxPooled;
+    std::vector<std::shared_ptr<T>> m_buffers;
+};
+
+#endif // SNAPSHOTPOOL_H
@@ -0,0 +1,225 @@
+#ifndef SOLVERKERNELS_H
+#define SOLVERKERNELS_H
+
+/**
+ * @brief Vectorized inner loops of the time-stepping solver
+ *
+ * Every kernel works on a CSR stiffness operator and structure-of-arrays
+ * state vectors. Scalar, AVX2 and AVX-512 implementations are compiled
+ * into the binary and the widest one the CPU supports is picked at
+ * runtime. The environment variable SIMTOOL_SIMD (scalar, avx2, avx512)
+ * can force a narrower path, e.g. to compare results; forceIsa() does the
+ * same from code.
+ *
+ * computeForces and symplecticEulerStep also come in single and mixed
+ * precision (see ScalarPrecision.h); call them through the overloads at the end
+ * of this header to pick the variant from the argument type.
+ */
+namespace SolverKernels
+{
+    /**
+     * @brief Instruction set of a kernel implementation
+     */
+    enum class Isa
+    {
+        Scalar,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * @brief Operands of one kernel call over the row range [begin, end)
+     *
+     * Real is the type of the force-side data, Accum that of positions and
+     * velocities (see ScalarPrecision.h).
+     */
+    template <typename Real, typename Accum>
+    struct BasicStepArgs
+    {
+        typedef Real RealType;
+        typedef Accum AccumType;
+
+        int begin;
+        int end;
+
+        // CSR stiffness operator
+        const int* rowPointers;
+        const int* columnIndices;
+        const Real* values;
+
+        // SoA state
+        const Accum* positions;         // x at the start of the step (read-only)
+        Accum* nextPositions;           // x at the end of the step
+        Accum* velocities;              // v, updated in place
+        Real* accelerations;            // a, written
+        Real* forces;                   // f, written by computeForces only
+        const Real* inverseMasses;      // 1 / m per DOF
+        double* energy;                 // Optional: sum of 0.5 (m v^2 + x K x) over the range
+
+        double damping;
+        double timeStep;
+
+        BasicStepArgs()
+            : begin(0), end(0)
+            , rowPointers(nullptr), columnIndices(nullptr), values(nullptr)
+            , positions(nullptr), nextPositions(nullptr), velocities(nullptr)
+            , accelerations(nullptr), forces(nullptr), inverseMasses(nullptr), energy(nullptr)
+            , damping(0.0), timeStep(0.0)
+        {}
+    };
+
+    typedef BasicStepArgs<double, double> StepArgs;
+    typedef BasicStepArgs<float, float> SingleStepArgs;
+    typedef BasicStepArgs<float, double> MixedStepArgs;
+
+    /// Ensemble members advanced together by one ensemble kernel pass
+    const int EnsembleLanes = 8;
+
+    /**
+     * @brief Operands of one ensemble kernel call over the row range [begin, end)
+     *
+     * EnsembleLanes perturbed copies of one model are stepped in lockstep.
+     * State vectors interleave the members per DOF: member m of DOF i is
+     * element i * EnsembleLanes + m, so each CSR entry multiplies one
+     * contiguous vector of members and no gathers are needed. The members
+     * share the stiffness pattern (assembled with a coefficient of 1) and
+     * the masses; stiffness and damping are scaled per member.
+     */
+    struct EnsembleArgs
+    {
+        int begin;
+        int end;
+
+        // CSR stiffness operator for a stiffness coefficient of 1
+        const int* rowPointers;
+        const int* columnIndices;
+        const double* values;
+
+        // Interleaved SoA state (numDOF * EnsembleLanes each)
+        const double* positions;
+        double* nextPositions;
+        double* velocities;
+        double* accelerations;
+        const double* inverseMasses;    // 1 / m per DOF, shared by all members
+
+        // Per member (EnsembleLanes each)
+        const double* stiffnesses;
+        const double* dampings;
+        double* energies;               // Optional: 0.5 (m v^2 + x K x) over the range
+
+        double timeStep;
+
+        EnsembleArgs()
+            : begin(0), end(0)
+            , rowPointers(nullptr), columnIndices(nullptr), values(nullptr)
+            , positions(nullptr), nextPositions(nullptr), velocities(nullptr)
+            , accelerations(nullptr), inverseMasses(nullptr)
+            , stiffnesses(nullptr), dampings(nullptr), energies(nullptr)
+            , timeStep(0.0)
+        {}
+    };
+
+    /**
+     * @brief Kernel entry points of one instruction set
+     */
+    struct KernelTable
+    {
+        Isa isa;
+
+        /// f = -K x - c v
+        void (*computeForces)(const StepArgs& args);
+
+        /// One fused pass: f = -K x - c v, a = f / m, v += a dt, x_next = x + v dt.
+        /// Also reduces the energy of the state at the start of the step into *energy.
+        void (*symplecticEulerStep)(const StepArgs& args);
+
+        /// symplecticEulerStep for EnsembleLanes members at once, with the
+        /// energy of each member at the start of the step in energies[m].
+        void (*ensembleSymplecticEulerStep)(const EnsembleArgs& args);
+
+        // Reduced precision variants of computeForces and symplecticEulerStep
+        void (*computeForcesSingle)(const SingleStepArgs& args);
+        void (*symplecticEulerStepSingle)(const SingleStepArgs& args);
+        void (*computeForcesMixed)(const MixedStepArgs& args);
+        void (*symplecticEulerStepMixed)(const MixedStepArgs& args);
+    };
+
+    /**
+     * @brief Kernels for the best instruction set supported at runtime
+     */
+    const KernelTable& kernels();
+
+    /**
+     * @brief Kernels for a specific instruction set
+     * @return The requested table, or the best supported one if unavailable
+     */
+    const KernelTable& kernels(Isa isa);
+
+    /**
+     * @brief Make kernels() return the table of an instruction set from now on
+     *
+     * Lets tests and benchmarks compare the implementations in one process
+     * (SIMTOOL_SIMD only applies at the first call). Solvers pick up the
+     * table in initialize(), so switch between runs, not during one.
+     *
+     * @return The table now in use (the best supported one if isa is unavailable)
+     */
+    const KernelTable& forceIsa(Isa isa);
+
+    /**
+     * @brief Check whether the CPU and the build support an instruction set
+     */
+    bool isSupported(Isa isa);
+
+    /**
+     * @brief Human-readable instruction set name
+     */
+    const char* isaName(Isa isa);
+
+    // Per-ISA implementations (defined in SolverKernels*.cpp)
+    void computeForcesScalar(const StepArgs& args);
+    void symplecticEulerStepScalar(const StepArgs& args);
+    void ensembleSymplecticEulerStepScalar(const EnsembleArgs& args);
+    void computeForcesScalar(const SingleStepArgs& args);
+    void symplecticEulerStepScalar(const SingleStepArgs& args);
+    void computeForcesScalar(const MixedStepArgs& args);
+    void symplecticEulerStepScalar(const MixedStepArgs& args);
+#ifdef SIMTOOL_X86_KERNELS
+    void computeForcesAVX2(const StepArgs& args);
+    void symplecticEulerStepAVX2(const StepArgs& args);
+    void ensembleSymplecticEulerStepAVX2(const EnsembleArgs& args);
+    void computeForcesAVX2(const SingleStepArgs& args);
+    void symplecticEulerStepAVX2(const SingleStepArgs& args);
+    void computeForcesAVX2(const MixedStepArgs& args);
+    void symplecticEulerStepAVX2(const MixedStepArgs& args);
+    void computeForcesAVX512(const StepArgs& args);
+    void symplecticEulerStepAVX512(const StepArgs& args);
+    void ensembleSymplecticEulerStepAVX512(const EnsembleArgs& args);
+    void computeForcesAVX512(const SingleStepArgs& args);
+    void symplecticEulerStepAVX512(const SingleStepArgs& args);
+    void computeForcesAVX512(const MixedStepArgs& args);
+    void symplecticEulerStepAVX512(const MixedStepArgs& args);
+#endif
+
+    /**
+     * @brief Call the table's kernel for the precision of the arguments
+     */
+    inline void computeForces(const KernelTable& table, const StepArgs& args) { table.computeForces(args); }
+    inline void computeForces(const KernelTable& table, const SingleStepArgs& args) { table.computeForcesSingle(args); }
+    inline void computeForces(const KernelTable& table, const MixedStepArgs& args) { table.computeForcesMixed(args); }
+
+    inline void symplecticEulerStep(const KernelTable& table, const StepArgs& args)
+    {
+        table.symplecticEulerStep(args);
+    }
+    inline void symplecticEulerStep(const KernelTable& table, const SingleStepArgs& args)
+    {
+        table.symplecticEulerStepSingle(args);
+    }
+    inline void symplecticEulerStep(const KernelTable& table, const MixedStepArgs& args)
+    {
+        table.symplecticEulerStepMixed(args);
+    }
+}
+
+#endif // SOLVERKERNELS_H
@@ -0,0 +1,54 @@
+#ifndef SOLVERWORKSPACE_H
+#define SOLVERWORKSPACE_H
+
+#include "AlignedAllocator.h"
+#include "ScalarPrecision.h"
+#include <vector>
+
+/**
+ * @brief Scratch buffers of the time-stepping solver
+ *
+ * Sized once in SimulationSolver::initialize() so the steady-state
+ * step loop never touches the heap. Every new kernel that
+ * needs temporary storage gets a buffer here instead of a local vector.
+ *
+ * Force-side buffers use the Real type of the precision policy, position
+ * and velocity stages its Accum type (see ScalarPrecision.h); reductions are
+ * always double.
+ */
+template <typename PrecisionPolicy>
+struct BasicSolverWorkspace
+{
+    typedef typename PrecisionPolicy::Real Real;
+    typedef typename PrecisionPolicy::Accum Accum;
+
+    AlignedArray<Real> inverseMasses;       // 1 / m per DOF
+    AlignedArray<Accum> nextPositions;      // x at the end of the step (swapped with the state)
+    AlignedArray<Real> forces;              // f = -K x - c v when needed separately
+    AlignedArray<Real> contactForces;       // Penalty contact forces (sized only with contact)
+    std::vector<AlignedArray<Accum>> stages;    // Intermediate stage vectors of the integrator
+    AlignedVector chunkPartials;            // One partial result per parallel chunk (reductions)
+    AlignedVector energyPartials;           // Per-chunk energy reduced inside the step
+
+    /**
+     * @brief Size every buffer for a model
+     * @param numDOF Number of degrees of freedom
+     * @param stageCount Number of stage vectors the integrator needs
+     * @param chunkCount Number of parallel chunks the rows are split into
+     */
+    void resize(int numDOF, int stageCount = 0, int chunkCount = 1);
+
+    /**
+     * @brief Release every buffer
+     */
+    void clear();
+
+    /**
+     * @brief Total bytes held by the workspace
+     */
+    size_t memoryUsage() const;
+};
+
+typedef BasicSolverWorkspace<ScalarPrecisions::Double> SolverWorkspace;
+
+#endif // SOLVERWORKSPACE_H
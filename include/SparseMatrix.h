@@ -0,0 +1,100 @@
+#ifndef SPARSEMATRIX_H
+#define SPARSEMATRIX_H
+
+#include <vector>
+
+/**
+ * @brief Square sparse matrix in compressed sparse row (CSR) format
+ *
+ * Used for the assembled stiffness operator of the simulation model.
+ * It supports:
+ * - Assembly from (row, col, value) triplets with duplicate summation
+ * - Sparse matrix-vector products
+ * - Diagonal extraction
+ * - Scaling and diagonal shifts (system matrices of implicit schemes)
+ */
+class SparseMatrix
+{
+public:
+    /**
+     * @brief Single assembly contribution
+     */
+    struct Triplet
+    {
+        int row;
+        int col;
+        double value;
+
+        Triplet()
+            : row(0)
+            , col(0)
+            , value(0.0)
+        {}
+
+        Triplet(int r, int c, double v)
+            : row(r)
+            , col(c)
+            , value(v)
+        {}
+    };
+
+    SparseMatrix();
+
+    /**
+     * @brief Build a matrix from assembly triplets
+     * @param size Number of rows (and columns)
+     * @param triplets Contributions; entries with equal (row, col) are summed.
+     *                 The vector is sorted in place.
+     * @return The assembled CSR matrix with sorted column indices per row
+     */
+    static SparseMatrix fromTriplets(int size, std::vector<Triplet>& triplets);
+
+    /**
+     * @brief Compute y = A * x
+     * @param x Input vector of length size()
+     * @param y Output vector of length size()
+     */
+    void multiply(const double* x, double* y) const;
+
+    /**
+     * @brief Compute rows [begin, end) of y = A * x
+     */
+    void multiplyRows(int begin, int end, const double* x, double* y) const;
+
+    /**
+     * @brief Extract the main diagonal
+     * @param diagonal Output vector, resized to size()
+     */
+    void diagonal(std::vector<double>& diagonal) const;
+
+    /**
+     * @brief Build scale * A + diag(shift)
+     * @param scale Factor applied to every entry
+     * @param shift Values added to the main diagonal (length size());
+     *              missing diagonal entries are created
+     * @return The new matrix, same ordering guarantees as fromTriplets()
+     */
+    SparseMatrix scaledPlusDiagonal(double scale, const double* shift) const;
+
+    int size() const { return m_size; }
+    int nonZeros() const { return static_cast<int>(m_values.size()); }
+    bool isEmpty() const { return m_size == 0; }
+
+    // Raw CSR arrays (row pointers have size() + 1 entries)
+    const std::vector<int>& rowPointers() const { return m_rowPointers; }
+    const std::vector<int>& columnIndices() const { return m_columnIndices; }
+    const std::vector<double>& values() const { return m_values; }
+
+    /**
+     * @brief Entry values for in-place updates; the pattern stays fixed
+     */
+    std::vector<double>& mutableValues() { return m_values; }
+
+private:
+    int m_size;
+    std::vector<int> m_rowPointers;
+    std::vector<int> m_columnIndices;
+    std::vector<double> m_values;
+};
+
+#endif // SPARSEMATRIX_H
@@ -0,0 +1,94 @@
+#ifndef STRUCTURALMODEL_H
+#define STRUCTURALMODEL_H
+
+#include "SparseMatrix.h"
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Discretized structural model driven by the simulation engine
+ *
+ * Holds the nodes, surface triangles and edges produced by the mesh
+ * discretizer together with the assembled operators. It supports:
+ * - Spring-network stiffness assembly into CSR form
+ * - Lumped nodal masses
+ * - A 1-D chain fallback when no geometry is loaded
+ */
+struct StructuralModel
+{
+    int dofsPerNode;                        // 3 for meshed geometry, 1 for the chain
+    int numBodies;                          // Number of separate bodies (shells/solids)
+    std::vector<double> nodeCoordinates;    // x, y, z per node
+    std::vector<int> nodeBodies;            // Owning body index per node
+    std::vector<int> triangles;             // Three node indices per surface triangle
+    std::vector<int> edges;                 // Two node indices per unique mesh edge
+
+    SparseMatrix stiffness;                 // Assembled stiffness operator K
+    std::vector<double> masses;             // Lumped mass per DOF
+
+    StructuralModel()
+        : dofsPerNode(3)
+        , numBodies(0)
+    {}
+
+    int numNodes() const { return static_cast<int>(nodeCoordinates.size() / 3); }
+    int numDOF() const { return numNodes() * dofsPerNode; }
+    int numTriangles() const { return static_cast<int>(triangles.size() / 3); }
+    int numEdges() const { return static_cast<int>(edges.size() / 2); }
+    bool isEmpty() const { return nodeCoordinates.empty(); }
+
+    /**
+     * @brief Assemble the stiffness operator and lumped masses
+     *
+     * Every DOF is tied to ground by a spring of the given stiffness and
+     * every mesh edge adds an axial coupling spring of 0.1 * stiffness.
+     * For 3-DOF nodes the coupling acts along the edge direction; for
+     * scalar DOFs it reduces to the nearest-neighbour chain.
+     *
+     * @param stiffnessCoefficient Stiffness coefficient from the simulation parameters
+     */
+    void assemble(double stiffnessCoefficient);
+
+    /**
+     * @brief Spring constants of assemble() for a stiffness coefficient
+     */
+    static double groundingStiffness(double stiffnessCoefficient) { return stiffnessCoefficient; }
+    static double couplingStiffness(double stiffnessCoefficient) { return 0.1 * stiffnessCoefficient; }
+
+    /**
+     * @brief Nominal initial displacement of a DOF (original numbering) every run starts from
+     */
+    static double initialDisplacement(int dof) { return 0.01 * std::sin(dof * 0.5); }
+
+    /**
+     * @brief Renumber the nodes; the assembled operators are cleared
+     *
+     * Coordinates, owning bodies, triangles and edges follow their nodes,
+     * so the model describes the same structure afterwards. Call
+     * assemble() again to rebuild the operators in the new numbering.
+     *
+     * @param order Old index of each new node (a permutation of all nodes)
+     */
+    void renumberNodes(const std::vector<int>& order);
+
+    /**
+     * @brief Largest index difference between the two nodes of an edge
+     */
+    int bandwidth() const;
+
+    /**
+     * @brief Neighbour nodes of every node along the edges (CSR, sorted per node)
+     * @param pointers Filled with numNodes() + 1 offsets into neighbours
+     * @param neighbours Filled with the neighbours of each node
+     */
+    void nodeAdjacency(std::vector<int>& pointers, std::vector<int>& neighbours) const;
+
+    /**
+     * @brief Build a 1-D chain of scalar DOFs along the x axis
+     * @param numNodes Number of nodes in the chain
+     * @return Model with edges between consecutive nodes (not yet assembled)
+     */
+    static StructuralModel makeChain(int numNodes);
+};
+
+#endif // STRUCTURALMODEL_H
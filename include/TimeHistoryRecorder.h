@@ -0,0 +1,242 @@
+#ifndef TIMEHISTORYRECORDER_H
+#define TIMEHISTORYRECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SimulationTypes.h"
+
+/**
+ * @brief Streams the per-step state of a run to a chunked columnar file
+ *
+ * The engine hands states to record() from its step loop. record() only
+ * copies the selected fields into a slot of a bounded single-producer
+ * queue and returns; a background thread transposes the queued frames
+ * into chunks and writes them. When the queue is full the frame is
+ * dropped and counted, so the solver never waits for the disk.
+ *
+ * File layout (all little-endian, native layout):
+ * - File header: magic "SIMHIST1", DOF count, fields, value size, block size
+ * - Chunks of up to chunkFrames frames, each self-describing:
+ *   chunk header (frames, first/last time, first step), the time index
+ *   columns (time, step, timeStep, energy), then one column block per
+ *   field and DOF block, holding the block's values frame after frame
+ *
+ * Appending a frame is a copy per block, reading a range of DOFs over time
+ * touches one contiguous run per chunk and block, and a file cut short by
+ * a crash stays readable up to its last whole chunk.
+ *
+ * Field values are stored as float unless doublePrecision is set, which
+ * with decimation (recordInterval) keeps million-step files compact.
+ */
+class TimeHistoryRecorder
+{
+public:
+    /**
+     * @brief Per-DOF fields that can be recorded (bit mask)
+     */
+    enum Field
+    {
+        Positions = 1,
+        Velocities = 2,
+        Accelerations = 4
+    };
+
+    /**
+     * @brief Recorder options
+     */
+    struct Options
+    {
+        int fields;             // Field bit mask
+        int recordInterval;     // Record every N accepted steps
+        int chunkFrames;        // Frames per chunk
+        int blockSize;          // DOFs per column block
+        int queueFrames;        // Frames buffered between solver and writer
+        bool doublePrecision;   // Store field values as double instead of float
+
+        Options()
+            : fields(Positions | Velocities)
+            , recordInterval(1)
+            , chunkFrames(256)
+            , blockSize(1024)
+            , queueFrames(64)
+            , doublePrecision(false)
+        {}
+    };
+
+    explicit TimeHistoryRecorder(const Options& options = Options());
+    ~TimeHistoryRecorder();
+
+    TimeHistoryRecorder(const TimeHistoryRecorder&) = delete;
+    TimeHistoryRecorder& operator=(const TimeHistoryRecorder&) = delete;
+
+    /**
+     * @brief Replace the options for the next start() (ignored while recording)
+     */
+    void setOptions(const Options& options);
+    const Options& options() const { return m_options; }
+
+    /**
+     * @brief Set the file the next start() writes to (truncated)
+     */
+    void setOutputFile(const std::string& path);
+    const std::string& outputFile() const { return m_path; }
+
+    /**
+     * @brief Open the output file, write the header and start the writer thread
+     * @return false (with lastError()) if the file cannot be written
+     */
+    bool start(int numDOF);
+
+    /**
+     * @brief Whether record() would take the state of this step
+     *
+     * Check it before building the state: state() of reduced-precision,
+     * modal and renumbered runs converts every DOF on each call.
+     */
+    bool isDue(int step) const { return isRecording() && step % m_options.recordInterval == 0; }
+
+    /**
+     * @brief Queue a state if it falls on the record interval
+     *
+     * Never blocks on the writer. Call from a single thread.
+     *
+     * @return false if the frame was dropped (queue full) or not recording
+     */
+    bool record(const SimulationState& state);
+
+    /**
+     * @brief Write the remaining frames, stop the writer thread and close the file
+     */
+    void finish();
+
+    bool isRecording() const { return m_thread.joinable(); }
+    std::string lastError() const;
+
+    // Statistics since start()
+    long long recordedCount() const { return m_recorded; }
+    long long droppedCount() const { return m_dropped; }
+    long long writtenCount() const { return m_written; }
+
+private:
+    struct Frame
+    {
+        double time;
+        int step;
+        double timeStep;
+        double energy;
+        std::vector<double> values;     // Field after field, numDOF each
+    };
+
+    void writerLoop();
+    void appendFrame(const Frame& frame);
+    void writeChunk();
+    void fail(const std::string& error);
+
+    Options m_options;
+    std::string m_path;
+    int m_numDOF;
+    int m_fieldCount;
+    std::ofstream m_file;
+
+    // Bounded queue: the solver advances m_head, the writer m_tail
+    std::vector<Frame> m_queue;
+    std::atomic<long long> m_head;
+    std::atomic<long long> m_tail;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_finishing;
+    std::string m_lastError;
+
+    // Chunk being assembled by the writer (columns strided by chunkFrames)
+    std::vector<double> m_times;
+    std::vector<int> m_steps;
+    std::vector<double> m_timeSteps;
+    std::vector<double> m_energies;
+    std::vector<double> m_columns;
+    std::vector<float> m_floatColumns;
+    int m_chunkFill;
+
+    std::atomic<long long> m_recorded;
+    std::atomic<long long> m_dropped;
+    std::atomic<long long> m_written;
+};
+
+/**
+ * @brief Reads files written by TimeHistoryRecorder, one chunk at a time
+ */
+class TimeHistoryReader
+{
+public:
+    /**
+     * @brief Location and time range of one chunk
+     */
+    struct ChunkInfo
+    {
+        long long offset;
+        int frames;
+        double firstTime;
+        double lastTime;
+        int firstStep;
+    };
+
+    /**
+     * @brief Contents of one chunk; columns hold value(field, frame, dof)
+     *        at (field * frames + frame) * numDOF + dof
+     */
+    struct Chunk
+    {
+        int frames;
+        std::vector<double> times;
+        std::vector<int> steps;
+        std::vector<double> timeSteps;
+        std::vector<double> energies;
+        std::vector<double> columns;
+
+        Chunk() : frames(0) {}
+    };
+
+    TimeHistoryReader();
+
+    /**
+     * @brief Open a file and index its chunks (a truncated last chunk is ignored)
+     */
+    bool open(const std::string& path);
+
+    int numDOF() const { return m_numDOF; }
+    int fields() const { return m_fields; }
+    int fieldCount() const { return m_fieldCount; }
+    long long frameCount() const { return m_frameCount; }
+    const std::vector<ChunkInfo>& chunks() const { return m_chunks; }
+    const std::string& lastError() const { return m_lastError; }
+
+    bool readChunk(int index, Chunk& chunk);
+
+    /**
+     * @brief Write the whole history as CSV, one row per frame
+     *
+     * Columns: time, step, timeStep, energy, then x0..xn-1, v0..vn-1 and
+     * a0..an-1 for the recorded fields. Streams chunk by chunk.
+     */
+    bool exportCsv(const std::string& csvPath);
+
+private:
+    std::ifstream m_file;
+    int m_numDOF;
+    int m_fields;
+    int m_fieldCount;
+    int m_valueSize;
+    int m_blockSize;
+    long long m_frameCount;
+    std::vector<ChunkInfo> m_chunks;
+    std::vector<char> m_buffer;
+    std::string m_lastError;
+};
+
+#endif // TIMEHISTORYRECORDER_H
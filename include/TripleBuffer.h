@@ -0,0 +1,75 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * @brief Lock-free single-producer / single-consumer triple buffer
+ *
+ * The producer fills the back slot and publishes it; the consumer picks up
+ * the most recently published slot. Neither side ever blocks or waits for
+ * the other, and intermediate publications the consumer did not see are
+ * simply overwritten.
+ *
+ * Only one thread may write and only one thread may read at a time.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : m_back(0)
+        , m_middle(1)
+        , m_front(2)
+    {}
+
+    /**
+     * @brief Slot owned by the producer until the next publish()
+     */
+    T& writeBuffer() { return m_slots[m_back].value; }
+
+    /**
+     * @brief Hand the back slot to the consumer and take over the spare one
+     */
+    void publish()
+    {
+        const int previous = m_middle.exchange(m_back | DirtyBit, std::memory_order_acq_rel);
+        m_back = previous & IndexMask;
+    }
+
+    /**
+     * @brief Pick up the latest published slot, if any
+     * @return true if the read slot changed
+     */
+    bool update()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & DirtyBit)) {
+            return false;
+        }
+        const int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & IndexMask;
+        return true;
+    }
+
+    /**
+     * @brief Slot owned by the consumer until the next update()
+     */
+    const T& readBuffer() const { return m_slots[m_front].value; }
+
+private:
+    static const int IndexMask = 0x3;
+    static const int DirtyBit = 0x4;
+
+    // Each slot on its own cache line so producer and consumer never share one
+    struct alignas(64) Slot
+    {
+        T value;
+    };
+
+    Slot m_slots[3];
+    alignas(64) int m_back;                 // Producer side only
+    alignas(64) std::atomic<int> m_middle;  // Shared: spare slot index + dirty flag
+    alignas(64) int m_front;                // Consumer side only
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,118 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool for data-parallel solver loops
+ *
+ * A parallelFor() splits an index range into fixed-size chunks and deals
+ * contiguous runs of chunks to the participants (the calling thread plus
+ * the pool workers). Each participant drains its own run front to back and
+ * then steals chunks from the back of the others' runs.
+ *
+ * The chunk layout depends only on the range and the grain size, never on
+ * the thread count, so callers that write per-chunk partial results and
+ * combine them in chunk order get bit-identical output for any number of
+ * threads. Dispatching a job does not allocate.
+ *
+ * One job runs at a time; parallelFor() must not be called concurrently
+ * or from inside a body.
+ */
+class WorkStealingPool
+{
+public:
+    /**
+     * @brief Create the pool
+     * @param numThreads Total participants including the caller (0 = all cores)
+     */
+    explicit WorkStealingPool(int numThreads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Number of participants including the calling thread
+     */
+    int threadCount() const { return static_cast<int>(m_slots.size()); }
+
+    /**
+     * @brief Number of chunks a range is split into
+     */
+    static int chunkCount(int begin, int end, int grain)
+    {
+        return end > begin ? (end - begin + grain - 1) / grain : 0;
+    }
+
+    /**
+     * @brief Run body(chunkIndex, chunkBegin, chunkEnd) over [begin, end)
+     *
+     * Blocks until every chunk has completed.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Chunk size (the last chunk may be shorter)
+     * @param body Callable invoked once per chunk
+     */
+    template <typename Body>
+    void parallelFor(int begin, int end, int grain, const Body& body)
+    {
+        struct Thunk
+        {
+            static void invoke(const void* context, int chunk, int chunkBegin, int chunkEnd)
+            {
+                (*static_cast<const Body*>(context))(chunk, chunkBegin, chunkEnd);
+            }
+        };
+        run(begin, end, grain, &Thunk::invoke, &body);
+    }
+
+    /**
+     * @brief Resolve a requested thread count (0 = all cores)
+     */
+    static int resolveThreadCount(int requested);
+
+private:
+    typedef void (*Invoker)(const void* context, int chunk, int chunkBegin, int chunkEnd);
+
+    // Run of chunk indices owned by one participant
+    struct alignas(64) Slot
+    {
+        std::mutex mutex;
+        int next;
+        int end;
+
+        Slot() : next(0), end(0) {}
+    };
+
+    void run(int begin, int end, int grain, Invoker invoker, const void* context);
+    void workerLoop(int index);
+    void drain(int self);
+    bool takeChunk(int self, int& chunk);
+
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::vector<std::thread> m_threads;
+
+    // Current job
+    Invoker m_invoker;
+    const void* m_context;
+    int m_begin;
+    int m_end;
+    int m_grain;
+
+    // Job hand-off
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobCondition;
+    std::condition_variable m_doneCondition;
+    std::atomic<unsigned long long> m_generation;
+    std::atomic<int> m_workersDone;
+    bool m_shutdown;
+};
+
+#endif // WORKSTEALINGPOOL_H
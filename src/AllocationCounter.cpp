@@ -0,0 +1,147 @@
+#include "AllocationCounter.h"
+
+#ifdef SIMTOOL_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace {
+
+thread_local unsigned long long t_allocations = 0;
+thread_local bool t_tracked = false;
+std::atomic<unsigned long long> s_trackedAllocations(0);
+
+void count()
+{
+    ++t_allocations;
+    if (t_tracked) {
+        s_trackedAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* countedAlloc(std::size_t size)
+{
+    count();
+    return std::malloc(size ? size : 1);
+}
+
+void* countedAlignedAlloc(std::size_t size, std::size_t alignment)
+{
+    count();
+#ifdef _MSC_VER
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment < sizeof(void*) ? sizeof(void*) : alignment, size ? size : 1) != 0) {
+        return nullptr;
+    }
+    return p;
+#endif
+}
+
+void alignedFree(void* p)
+{
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    void* p = countedAlloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    void* p = countedAlignedAlloc(size, static_cast<std::size_t>(alignment));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+
+bool AllocationCounter::isEnabled()
+{
+    return true;
+}
+
+unsigned long long AllocationCounter::threadAllocations()
+{
+    return t_allocations;
+}
+
+void AllocationCounter::trackThread()
+{
+    t_tracked = true;
+}
+
+unsigned long long AllocationCounter::trackedAllocations()
+{
+    return s_trackedAllocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::isEnabled()
+{
+    return false;
+}
+
+unsigned long long AllocationCounter::threadAllocations()
+{
+    return 0;
+}
+
+void AllocationCounter::trackThread()
+{
+}
+
+unsigned long long AllocationCounter::trackedAllocations()
+{
+    return 0;
+}
+
+#endif // SIMTOOL_COUNT_ALLOCATIONS
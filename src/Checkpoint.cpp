@@ -0,0 +1,329 @@
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+const char FileMagic[8] = { 'S', 'I', 'M', 'C', 'K', 'P', 'T', '1' };
+const std::uint32_t FileVersion = 1;
+
+static_assert(std::is_trivially_copyable<SimulationParameters>::value,
+              "SimulationParameters is stored in checkpoints byte for byte");
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t parametersSize;   // Guards against layout changes of SimulationParameters
+    std::int32_t numDOF;
+    std::int32_t reserved;
+    std::uint64_t slotSize;
+};
+
+// Slot layout: SlotHeader, then positions, velocities, accelerations
+struct SlotHeader
+{
+    std::uint64_t sequence;         // 0 = empty
+    std::uint64_t checksum;         // Over everything after this field
+    double currentTime;
+    double timeStep;
+    double energy;
+    double initialEnergy;
+    std::int32_t currentStep;
+    std::int32_t totalSteps;
+    std::int32_t rejectedSteps;
+    std::int32_t quietSteps;
+    SimulationParameters parameters;
+};
+
+std::uint64_t slotSize(int numDOF)
+{
+    const std::uint64_t size = sizeof(SlotHeader) + 3ull * numDOF * sizeof(double);
+    return (size + 63) & ~std::uint64_t(63);
+}
+
+std::uint64_t fileSize(int numDOF)
+{
+    return sizeof(FileHeader) + 2 * slotSize(numDOF);
+}
+
+// FNV-1a over the slot after the checksum field
+std::uint64_t slotChecksum(const uchar* slot, int numDOF)
+{
+    const uchar* begin = slot + offsetof(SlotHeader, currentTime);
+    const uchar* end = slot + sizeof(SlotHeader) + 3ull * numDOF * sizeof(double);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const uchar* p = begin; p != end; ++p) {
+        hash = (hash ^ *p) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool validHeader(const FileHeader& header)
+{
+    return std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) == 0
+        && header.version == FileVersion
+        && header.parametersSize == sizeof(SimulationParameters)
+        && header.numDOF >= 0
+        && header.slotSize == slotSize(header.numDOF);
+}
+
+} // namespace
+
+bool Checkpoint::read(const QString& path, Checkpoint& checkpoint, QString& error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot open checkpoint %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    FileHeader header;
+    if (file.size() < static_cast<qint64>(sizeof(header))
+        || file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+        || !validHeader(header)
+        || file.size() < static_cast<qint64>(fileSize(header.numDOF))) {
+        error = QString("%1 is not a checkpoint of this version").arg(path);
+        return false;
+    }
+
+    uchar* mapped = file.map(0, fileSize(header.numDOF));
+    if (!mapped) {
+        error = QString("Cannot map checkpoint %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    // Newest slot with a matching checksum
+    const uchar* best = nullptr;
+    std::uint64_t bestSequence = 0;
+    for (int s = 0; s < 2; ++s) {
+        const uchar* slot = mapped + sizeof(FileHeader) + s * header.slotSize;
+        SlotHeader slotHeader;
+        std::memcpy(&slotHeader, slot, sizeof(slotHeader));
+        if (slotHeader.sequence > bestSequence && slotHeader.checksum == slotChecksum(slot, header.numDOF)) {
+            best = slot;
+            bestSequence = slotHeader.sequence;
+        }
+    }
+    if (!best) {
+        file.unmap(mapped);
+        error = QString("%1 holds no complete checkpoint").arg(path);
+        return false;
+    }
+
+    SlotHeader slotHeader;
+    std::memcpy(&slotHeader, best, sizeof(slotHeader));
+    checkpoint.parameters = slotHeader.parameters;
+    checkpoint.initialEnergy = slotHeader.initialEnergy;
+    checkpoint.quietSteps = slotHeader.quietSteps;
+
+    SimulationState& state = checkpoint.state;
+    state.currentTime = slotHeader.currentTime;
+    state.currentStep = slotHeader.currentStep;
+    state.totalSteps = slotHeader.totalSteps;
+    state.timeStep = slotHeader.timeStep;
+    state.rejectedSteps = slotHeader.rejectedSteps;
+    state.energy = slotHeader.energy;
+
+    const double* data = reinterpret_cast<const double*>(best + sizeof(SlotHeader));
+    const int n = header.numDOF;
+    state.positions.assign(data, data + n);
+    state.velocities.assign(data + n, data + 2 * n);
+    state.accelerations.assign(data + 2 * n, data + 3 * n);
+
+    file.unmap(mapped);
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter()
+    : m_mapped(nullptr)
+    , m_numDOF(0)
+    , m_sequence(0)
+    , m_pending(false)
+    , m_shutdown(false)
+    , m_written(0)
+    , m_skipped(0)
+{
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    close();
+}
+
+bool CheckpointWriter::open(const QString& path, int numDOF)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        m_lastError = QString("Cannot open checkpoint %1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+
+    // Keep the checkpoints of a file made for the same model size
+    FileHeader header;
+    const bool reuse = m_file.size() >= static_cast<qint64>(fileSize(numDOF))
+                    && m_file.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)
+                    && validHeader(header) && header.numDOF == numDOF;
+
+    if (!m_file.resize(fileSize(numDOF))) {
+        m_lastError = QString("Cannot size checkpoint %1: %2").arg(path, m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    m_mapped = m_file.map(0, fileSize(numDOF));
+    if (!m_mapped) {
+        m_lastError = QString("Cannot map checkpoint %1: %2").arg(path, m_file.errorString());
+        m_file.close();
+        return false;
+    }
+
+    m_numDOF = numDOF;
+    m_sequence = 0;
+    if (reuse) {
+        for (int s = 0; s < 2; ++s) {
+            SlotHeader slotHeader;
+            std::memcpy(&slotHeader, m_mapped + sizeof(FileHeader) + s * header.slotSize, sizeof(slotHeader));
+            m_sequence = std::max<unsigned long long>(m_sequence, slotHeader.sequence);
+        }
+    } else {
+        std::memset(m_mapped, 0, fileSize(numDOF));
+        std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+        header.version = FileVersion;
+        header.parametersSize = sizeof(SimulationParameters);
+        header.numDOF = numDOF;
+        header.reserved = 0;
+        header.slotSize = slotSize(numDOF);
+        std::memcpy(m_mapped, &header, sizeof(header));
+    }
+
+    // Size the staging buffers once; submissions only copy into them
+    m_staging.state.positions.assign(numDOF, 0.0);
+    m_staging.state.velocities.assign(numDOF, 0.0);
+    m_staging.state.accelerations.assign(numDOF, 0.0);
+
+    m_pending = false;
+    m_shutdown = false;
+    m_written = 0;
+    m_skipped = 0;
+    m_thread = std::thread(&CheckpointWriter::writerLoop, this);
+    return true;
+}
+
+bool CheckpointWriter::submit(const SimulationParameters& parameters, const SimulationState& state,
+                              double initialEnergy, int quietSteps)
+{
+    if (!m_mapped || static_cast<int>(state.positions.size()) != m_numDOF) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending) {
+            m_skipped++;
+            return false;
+        }
+
+        // The writer only reads the staging copy while m_pending is set
+        m_staging.parameters = parameters;
+        m_staging.initialEnergy = initialEnergy;
+        m_staging.quietSteps = quietSteps;
+        SimulationState& staged = m_staging.state;
+        staged.currentTime = state.currentTime;
+        staged.currentStep = state.currentStep;
+        staged.totalSteps = state.totalSteps;
+        staged.timeStep = state.timeStep;
+        staged.rejectedSteps = state.rejectedSteps;
+        staged.energy = state.energy;
+        std::copy(state.positions.begin(), state.positions.end(), staged.positions.begin());
+        std::copy(state.velocities.begin(), state.velocities.end(), staged.velocities.begin());
+        std::copy(state.accelerations.begin(), state.accelerations.end(), staged.accelerations.begin());
+        m_pending = true;
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+void CheckpointWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return !m_pending; });
+}
+
+void CheckpointWriter::close()
+{
+    if (m_thread.joinable()) {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shutdown = true;
+        }
+        m_condition.notify_all();
+        m_thread.join();
+    }
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+void CheckpointWriter::writerLoop()
+{
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_pending || m_shutdown; });
+            if (!m_pending) {
+                return;
+            }
+        }
+
+        writeSlot();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending = false;
+            m_written++;
+        }
+        m_condition.notify_all();
+    }
+}
+
+void CheckpointWriter::writeSlot()
+{
+    // Alternate slots, so the previous checkpoint stays valid while this one is written
+    const unsigned long long sequence = m_sequence + 1;
+    uchar* slot = m_mapped + sizeof(FileHeader) + (sequence % 2) * slotSize(m_numDOF);
+
+    const SimulationState& state = m_staging.state;
+    SlotHeader header;
+    header.sequence = 0;    // Invalid until the checksum is in place
+    header.checksum = 0;
+    header.currentTime = state.currentTime;
+    header.timeStep = state.timeStep;
+    header.energy = state.energy;
+    header.initialEnergy = m_staging.initialEnergy;
+    header.currentStep = state.currentStep;
+    header.totalSteps = state.totalSteps;
+    header.rejectedSteps = state.rejectedSteps;
+    header.quietSteps = m_staging.quietSteps;
+    header.parameters = m_staging.parameters;
+    std::memcpy(slot, &header, sizeof(header));
+
+    double* data = reinterpret_cast<double*>(slot + sizeof(SlotHeader));
+    std::copy(state.positions.begin(), state.positions.end(), data);
+    std::copy(state.velocities.begin(), state.velocities.end(), data + m_numDOF);
+    std::copy(state.accelerations.begin(), state.accelerations.end(), data + 2 * m_numDOF);
+
+    header.checksum = slotChecksum(slot, m_numDOF);
+    std::memcpy(slot + offsetof(SlotHeader, checksum), &header.checksum, sizeof(header.checksum));
+    std::memcpy(slot + offsetof(SlotHeader, sequence), &sequence, sizeof(sequence));
+    m_sequence = sequence;
+}
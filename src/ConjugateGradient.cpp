@@ -0,0 +1,330 @@
+#include "ConjugateGradient.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+ConjugateGradient::ConjugateGradient()
+    : m_matrix(nullptr)
+    , m_preconditioner(Preconditioner::Jacobi)
+    , m_pool(nullptr)
+    , m_grain(1)
+    , m_totalIterations(0)
+    , m_solveCount(0)
+    , m_failedSolves(0)
+{
+}
+
+void ConjugateGradient::setup(const SparseMatrix& matrix, Preconditioner preconditioner,
+                              WorkStealingPool* pool, int grain)
+{
+    m_matrix = &matrix;
+    m_preconditioner = preconditioner;
+    m_pool = pool;
+    m_grain = std::max(grain, 1);
+
+    const int n = matrix.size();
+    m_residual.assign(n, 0.0);
+    m_preconditioned.assign(n, 0.0);
+    m_direction.assign(n, 0.0);
+    m_product.assign(n, 0.0);
+    m_partials.assign(std::max(WorkStealingPool::chunkCount(0, n, m_grain), 1), 0.0);
+
+    m_inverseDiagonal.assign(n, 1.0);
+    updateInverseDiagonal();
+
+    m_factor = SparseMatrix();
+    m_factorSources.clear();
+    if (m_preconditioner == Preconditioner::IncompleteCholesky
+        && !(buildIncompleteCholesky() && factorIncompleteCholesky())) {
+        std::cout << "[ConjugateGradient] IC(0) breakdown, falling back to Jacobi" << std::endl;
+        m_factor = SparseMatrix();
+        m_factorSources.clear();
+        m_preconditioner = Preconditioner::Jacobi;
+    }
+
+    m_lastResult = Result();
+    m_totalIterations = 0;
+    m_solveCount = 0;
+    m_failedSolves = 0;
+}
+
+void ConjugateGradient::refactor()
+{
+    updateInverseDiagonal();
+    if (m_preconditioner == Preconditioner::IncompleteCholesky && !factorIncompleteCholesky()) {
+        std::cout << "[ConjugateGradient] IC(0) breakdown, falling back to Jacobi" << std::endl;
+        m_factor = SparseMatrix();
+        m_factorSources.clear();
+        m_preconditioner = Preconditioner::Jacobi;
+    }
+}
+
+void ConjugateGradient::updateInverseDiagonal()
+{
+    const SparseMatrix& a = *m_matrix;
+    const std::vector<int>& rowPtr = a.rowPointers();
+    const std::vector<int>& cols = a.columnIndices();
+    const std::vector<double>& vals = a.values();
+    for (int i = 0; i < a.size(); ++i) {
+        m_inverseDiagonal[i] = 1.0;
+        for (int k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+            if (cols[k] == i && vals[k] != 0.0) {
+                m_inverseDiagonal[i] = 1.0 / vals[k];
+            }
+        }
+    }
+}
+
+template <typename Body>
+void ConjugateGradient::forEachChunk(const Body& body)
+{
+    const int n = m_matrix->size();
+    if (m_pool) {
+        m_pool->parallelFor(0, n, m_grain, body);
+        return;
+    }
+
+    // Same chunk layout on one thread, so reductions round identically
+    const int chunks = WorkStealingPool::chunkCount(0, n, m_grain);
+    for (int c = 0; c < chunks; ++c) {
+        body(c, c * m_grain, std::min((c + 1) * m_grain, n));
+    }
+}
+
+double ConjugateGradient::sumPartials() const
+{
+    const int chunks = WorkStealingPool::chunkCount(0, m_matrix->size(), m_grain);
+    double sum = 0.0;
+    for (int c = 0; c < chunks; ++c) {
+        sum += m_partials[c];
+    }
+    return sum;
+}
+
+ConjugateGradient::Result ConjugateGradient::solve(const double* b, double* x,
+                                                   int maxIterations, double tolerance)
+{
+    SIMTOOL_PROFILE_SCOPE(LinearSolve);
+
+    const SparseMatrix& a = *m_matrix;
+    const bool jacobi = (m_preconditioner == Preconditioner::Jacobi);
+    double* r = m_residual.data();
+    double* z = m_preconditioned.data();
+    double* p = m_direction.data();
+    double* q = m_product.data();
+    const double* inverseDiagonal = m_inverseDiagonal.data();
+    double* partials = m_partials.data();
+
+    Result result;
+    m_solveCount++;
+
+    // r = b - A x, ||b||^2
+    forEachChunk([&a, b, x, r, q, partials](int chunk, int begin, int end) {
+        a.multiplyRows(begin, end, x, q);
+        double bb = 0.0;
+        for (int i = begin; i < end; ++i) {
+            r[i] = b[i] - q[i];
+            bb += b[i] * b[i];
+        }
+        partials[chunk] = bb;
+    });
+    const double normB = std::sqrt(sumPartials());
+    if (normB == 0.0) {
+        std::fill(x, x + a.size(), 0.0);
+        m_lastResult = result;
+        return result;
+    }
+    const double target = tolerance * normB;
+
+    // z = M^-1 r, rz = r . z, p = z
+    auto precondition = [&]() {
+        if (jacobi) {
+            forEachChunk([r, z, inverseDiagonal, partials](int chunk, int begin, int end) {
+                double rz = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    z[i] = inverseDiagonal[i] * r[i];
+                    rz += r[i] * z[i];
+                }
+                partials[chunk] = rz;
+            });
+        } else {
+            applyIncompleteCholesky(r, z);
+            forEachChunk([r, z, partials](int chunk, int begin, int end) {
+                double rz = 0.0;
+                for (int i = begin; i < end; ++i) {
+                    rz += r[i] * z[i];
+                }
+                partials[chunk] = rz;
+            });
+        }
+        return sumPartials();
+    };
+
+    double rz = precondition();
+    if (rz == 0.0) {
+        result.residual = 0.0;
+        m_lastResult = result;
+        return result;  // The initial guess already solves the system
+    }
+    std::copy(z, z + a.size(), p);
+
+    result.residual = 1.0;
+    result.converged = false;
+
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        // q = A p, pq = p . q
+        forEachChunk([&a, p, q, partials](int chunk, int begin, int end) {
+            a.multiplyRows(begin, end, p, q);
+            double pq = 0.0;
+            for (int i = begin; i < end; ++i) {
+                pq += p[i] * q[i];
+            }
+            partials[chunk] = pq;
+        });
+        const double pq = sumPartials();
+        if (pq <= 0.0) {
+            break;  // Not positive definite along p (or exact solution reached)
+        }
+        const double alpha = rz / pq;
+
+        // x += alpha p, r -= alpha q, rr = r . r
+        forEachChunk([alpha, x, r, p, q, partials](int chunk, int begin, int end) {
+            double rr = 0.0;
+            for (int i = begin; i < end; ++i) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                rr += r[i] * r[i];
+            }
+            partials[chunk] = rr;
+        });
+        const double normR = std::sqrt(sumPartials());
+        result.iterations = iteration + 1;
+        result.residual = normR / normB;
+        if (normR <= target) {
+            result.converged = true;
+            break;
+        }
+
+        // p = z + beta p
+        const double rzNext = precondition();
+        const double beta = rzNext / rz;
+        rz = rzNext;
+        forEachChunk([beta, z, p](int, int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                p[i] = z[i] + beta * p[i];
+            }
+        });
+    }
+
+    m_totalIterations += result.iterations;
+    if (!result.converged) {
+        m_failedSolves++;
+    }
+    m_lastResult = result;
+    return result;
+}
+
+bool ConjugateGradient::buildIncompleteCholesky()
+{
+    const SparseMatrix& a = *m_matrix;
+    const int n = a.size();
+    const std::vector<int>& rowPtr = a.rowPointers();
+    const std::vector<int>& cols = a.columnIndices();
+
+    // Keep the lower triangle (columns are sorted, so the diagonal ends each row)
+    std::vector<SparseMatrix::Triplet> lower;
+    lower.reserve(a.nonZeros() / 2 + n);
+    m_factorSources.clear();
+    m_factorSources.reserve(a.nonZeros() / 2 + n);
+    for (int i = 0; i < n; ++i) {
+        bool hasDiagonal = false;
+        for (int k = rowPtr[i]; k < rowPtr[i + 1] && cols[k] <= i; ++k) {
+            lower.push_back(SparseMatrix::Triplet(i, cols[k], 0.0));
+            m_factorSources.push_back(k);
+            hasDiagonal = hasDiagonal || cols[k] == i;
+        }
+        if (!hasDiagonal) {
+            return false;
+        }
+    }
+
+    // Rows of A are sorted, so the entries of L keep the order of their sources
+    m_factor = SparseMatrix::fromTriplets(n, lower);
+    return true;
+}
+
+bool ConjugateGradient::factorIncompleteCholesky()
+{
+    const int n = m_factor.size();
+    const std::vector<int>& lPtr = m_factor.rowPointers();
+    const std::vector<int>& lCols = m_factor.columnIndices();
+    std::vector<double>& l = m_factor.mutableValues();
+    const std::vector<double>& vals = m_matrix->values();
+    for (size_t k = 0; k < l.size(); ++k) {
+        l[k] = vals[m_factorSources[k]];
+    }
+
+    // Row-oriented IC(0): L_ij = (A_ij - sum_k L_ik L_jk) / L_jj on the pattern of A
+    for (int i = 0; i < n; ++i) {
+        const int rowBegin = lPtr[i];
+        const int diag = lPtr[i + 1] - 1;
+
+        for (int k = rowBegin; k <= diag; ++k) {
+            const int j = lCols[k];
+
+            // Sparse dot of rows i and j over columns < j (both sorted)
+            double sum = 0.0;
+            int pi = rowBegin;
+            int pj = lPtr[j];
+            const int endJ = lPtr[j + 1] - 1;
+            while (pi < k && pj < endJ) {
+                if (lCols[pi] == lCols[pj]) {
+                    sum += l[pi++] * l[pj++];
+                } else if (lCols[pi] < lCols[pj]) {
+                    ++pi;
+                } else {
+                    ++pj;
+                }
+            }
+
+            if (k < diag) {
+                l[k] = (l[k] - sum) / l[lPtr[j + 1] - 1];
+            } else {
+                const double pivot = l[k] - sum;
+                if (!(pivot > 0.0)) {
+                    return false;
+                }
+                l[k] = std::sqrt(pivot);
+            }
+        }
+    }
+    return true;
+}
+
+void ConjugateGradient::applyIncompleteCholesky(const double* r, double* z) const
+{
+    const int n = m_factor.size();
+    const int* lPtr = m_factor.rowPointers().data();
+    const int* lCols = m_factor.columnIndices().data();
+    const double* l = m_factor.values().data();
+
+    // Forward: L y = r
+    for (int i = 0; i < n; ++i) {
+        double sum = r[i];
+        const int diag = lPtr[i + 1] - 1;
+        for (int k = lPtr[i]; k < diag; ++k) {
+            sum -= l[k] * z[lCols[k]];
+        }
+        z[i] = sum / l[diag];
+    }
+
+    // Backward: L^T z = y, column-oriented over the rows of L
+    for (int i = n - 1; i >= 0; --i) {
+        const int diag = lPtr[i + 1] - 1;
+        z[i] /= l[diag];
+        for (int k = lPtr[i]; k < diag; ++k) {
+            z[lCols[k]] -= l[k] * z[i];
+        }
+    }
+}
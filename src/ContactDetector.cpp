@@ -0,0 +1,426 @@
+#include "ContactDetector.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+const int LeafSize = 4;         // Triangles per leaf
+const int MaxStack = 64;        // Traversal stack; median splits keep the depth near log2(triangles)
+
+inline double dot(const double* a, const double* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Barycentric weights of the point of triangle abc closest to p
+// (region tests of Ericson, Real-Time Collision Detection, 5.1.5)
+void closestPointWeights(const double* p, const double* a, const double* b, const double* c, double* w)
+{
+    double ab[3], ac[3], ap[3], bp[3], cp[3];
+    for (int k = 0; k < 3; ++k) {
+        ab[k] = b[k] - a[k];
+        ac[k] = c[k] - a[k];
+        ap[k] = p[k] - a[k];
+        bp[k] = p[k] - b[k];
+        cp[k] = p[k] - c[k];
+    }
+
+    const double d1 = dot(ab, ap);
+    const double d2 = dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        w[0] = 1.0; w[1] = 0.0; w[2] = 0.0;
+        return;
+    }
+    const double d3 = dot(ab, bp);
+    const double d4 = dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3) {
+        w[0] = 0.0; w[1] = 1.0; w[2] = 0.0;
+        return;
+    }
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        const double t = d1 / (d1 - d3);
+        w[0] = 1.0 - t; w[1] = t; w[2] = 0.0;
+        return;
+    }
+    const double d5 = dot(ab, cp);
+    const double d6 = dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6) {
+        w[0] = 0.0; w[1] = 0.0; w[2] = 1.0;
+        return;
+    }
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        const double t = d2 / (d2 - d6);
+        w[0] = 1.0 - t; w[1] = 0.0; w[2] = t;
+        return;
+    }
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0) {
+        const double t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        w[0] = 0.0; w[1] = 1.0 - t; w[2] = t;
+        return;
+    }
+    const double scale = 1.0 / (va + vb + vc);
+    w[1] = vb * scale;
+    w[2] = vc * scale;
+    w[0] = 1.0 - w[1] - w[2];
+}
+
+} // namespace
+
+ContactDetector::ContactDetector()
+    : m_model(nullptr)
+    , m_pool(nullptr)
+    , m_grain(1)
+    , m_stiffness(0.0)
+    , m_thickness(0.0)
+{
+}
+
+bool ContactDetector::setup(const StructuralModel& model, double stiffness, double thickness,
+                            WorkStealingPool* pool, int grain)
+{
+    clear();
+    if (model.dofsPerNode != 3 || model.numBodies < 2 || stiffness <= 0.0) {
+        return false;
+    }
+
+    m_model = &model;
+    m_pool = pool;
+    m_grain = std::max(grain, 1);
+    m_stiffness = stiffness;
+
+    const int numNodes = model.numNodes();
+    const int numTriangles = model.numTriangles();
+    const double* coordinates = model.nodeCoordinates.data();
+
+    // Automatic thickness: a quarter of the mean edge length
+    if (thickness <= 0.0 && model.numEdges() > 0) {
+        double total = 0.0;
+        for (int e = 0; e < model.numEdges(); ++e) {
+            const double* a = coordinates + 3 * model.edges[2 * e];
+            const double* b = coordinates + 3 * model.edges[2 * e + 1];
+            const double delta[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            total += std::sqrt(dot(delta, delta));
+        }
+        thickness = 0.25 * total / model.numEdges();
+    }
+    m_thickness = thickness;
+    if (m_thickness <= 0.0) {
+        clear();
+        return false;
+    }
+
+    // Triangles grouped by body, one hierarchy per group
+    std::vector<double> centroids(3 * static_cast<size_t>(numTriangles));
+    m_triangleBodies.resize(numTriangles);
+    m_order.resize(numTriangles);
+    for (int t = 0; t < numTriangles; ++t) {
+        m_triangleBodies[t] = model.nodeBodies[model.triangles[3 * t]];
+        m_order[t] = t;
+        for (int k = 0; k < 3; ++k) {
+            double sum = 0.0;
+            for (int v = 0; v < 3; ++v) {
+                sum += coordinates[3 * model.triangles[3 * t + v] + k];
+            }
+            centroids[3 * t + k] = sum / 3.0;
+        }
+    }
+    std::stable_sort(m_order.begin(), m_order.end(), [this](int a, int b) {
+        return m_triangleBodies[a] < m_triangleBodies[b];
+    });
+
+    m_tree.reserve(2 * static_cast<size_t>(numTriangles) / LeafSize + 2 * model.numBodies);
+    int begin = 0;
+    while (begin < numTriangles) {
+        const int body = m_triangleBodies[m_order[begin]];
+        int end = begin;
+        while (end < numTriangles && m_triangleBodies[m_order[end]] == body) {
+            ++end;
+        }
+        m_roots.push_back(build(begin, end, centroids));
+        m_rootBodies.push_back(body);
+        begin = end;
+    }
+
+    if (m_roots.size() < 2) {
+        clear();
+        return false;
+    }
+
+    m_positions.assign(3 * static_cast<size_t>(numNodes), 0.0);
+    m_hitTriangles.assign(numNodes, -1);
+    m_hitWeights.assign(3 * static_cast<size_t>(numNodes), 0.0);
+    m_hitForces.assign(3 * static_cast<size_t>(numNodes), 0.0);
+    m_isActive.assign(numNodes, 0);
+    m_activeNodes.clear();
+    m_activeNodes.reserve(numNodes);
+
+    std::cout << "[ContactDetector] " << m_roots.size() << " bodies, " << numTriangles << " triangles, "
+              << m_tree.size() << " tree nodes, thickness " << m_thickness << std::endl;
+    return true;
+}
+
+void ContactDetector::clear()
+{
+    m_model = nullptr;
+    m_pool = nullptr;
+    m_stiffness = 0.0;
+    m_thickness = 0.0;
+    std::vector<TreeNode>().swap(m_tree);
+    std::vector<int>().swap(m_order);
+    std::vector<int>().swap(m_roots);
+    std::vector<int>().swap(m_rootBodies);
+    std::vector<int>().swap(m_triangleBodies);
+    std::vector<double>().swap(m_positions);
+    std::vector<int>().swap(m_hitTriangles);
+    std::vector<double>().swap(m_hitWeights);
+    std::vector<double>().swap(m_hitForces);
+    std::vector<int>().swap(m_activeNodes);
+    std::vector<char>().swap(m_isActive);
+    m_statistics = Statistics();
+}
+
+int ContactDetector::build(int begin, int end, const std::vector<double>& centroids)
+{
+    const int index = static_cast<int>(m_tree.size());
+    m_tree.push_back(TreeNode());
+    if (end - begin <= LeafSize) {
+        m_tree[index].first = begin;
+        m_tree[index].count = end - begin;
+        m_tree[index].right = -1;
+        return index;
+    }
+
+    // Median split along the longest axis of the centroid bounds
+    double lower[3] = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                        std::numeric_limits<double>::max() };
+    double upper[3] = { -lower[0], -lower[1], -lower[2] };
+    for (int i = begin; i < end; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            lower[k] = std::min(lower[k], centroids[3 * m_order[i] + k]);
+            upper[k] = std::max(upper[k], centroids[3 * m_order[i] + k]);
+        }
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; ++k) {
+        if (upper[k] - lower[k] > upper[axis] - lower[axis]) {
+            axis = k;
+        }
+    }
+
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(m_order.begin() + begin, m_order.begin() + middle, m_order.begin() + end,
+                     [&centroids, axis](int a, int b) { return centroids[3 * a + axis] < centroids[3 * b + axis]; });
+
+    build(begin, middle, centroids);
+    const int right = build(middle, end, centroids);
+    m_tree[index].first = -1;
+    m_tree[index].count = 0;
+    m_tree[index].right = right;
+    return index;
+}
+
+void ContactDetector::refit()
+{
+    // Children come after their parent, so a reverse sweep sees them first
+    const int* triangles = m_model->triangles.data();
+    for (int n = static_cast<int>(m_tree.size()) - 1; n >= 0; --n) {
+        TreeNode& node = m_tree[n];
+        if (node.count > 0) {
+            for (int k = 0; k < 3; ++k) {
+                node.lower[k] = std::numeric_limits<double>::max();
+                node.upper[k] = -std::numeric_limits<double>::max();
+            }
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                for (int v = 0; v < 3; ++v) {
+                    const double* p = &m_positions[3 * triangles[3 * m_order[i] + v]];
+                    for (int k = 0; k < 3; ++k) {
+                        node.lower[k] = std::min(node.lower[k], p[k]);
+                        node.upper[k] = std::max(node.upper[k], p[k]);
+                    }
+                }
+            }
+            // Leaves are grown by the thickness, so a point query finds every triangle in range
+            for (int k = 0; k < 3; ++k) {
+                node.lower[k] -= m_thickness;
+                node.upper[k] += m_thickness;
+            }
+        } else {
+            const TreeNode& left = m_tree[n + 1];
+            const TreeNode& right = m_tree[node.right];
+            for (int k = 0; k < 3; ++k) {
+                node.lower[k] = std::min(left.lower[k], right.lower[k]);
+                node.upper[k] = std::max(left.upper[k], right.upper[k]);
+            }
+        }
+    }
+}
+
+void ContactDetector::queryNode(int node)
+{
+    const double* p = &m_positions[3 * node];
+    const int body = m_model->nodeBodies[node];
+    const int* triangles = m_model->triangles.data();
+
+    double best = m_thickness;
+    int bestTriangle = -1;
+    double bestWeights[3] = { 0.0, 0.0, 0.0 };
+
+    int stack[MaxStack];
+    for (size_t r = 0; r < m_roots.size(); ++r) {
+        if (m_rootBodies[r] == body) {
+            continue;
+        }
+        int top = 0;
+        stack[top++] = m_roots[r];
+        while (top > 0) {
+            const TreeNode& current = m_tree[stack[--top]];
+            if (p[0] < current.lower[0] || p[0] > current.upper[0]
+                || p[1] < current.lower[1] || p[1] > current.upper[1]
+                || p[2] < current.lower[2] || p[2] > current.upper[2]) {
+                continue;
+            }
+            if (current.count == 0) {
+                stack[top++] = current.right;
+                stack[top++] = static_cast<int>(&current - m_tree.data()) + 1;
+                continue;
+            }
+            for (int i = current.first; i < current.first + current.count; ++i) {
+                const int t = m_order[i];
+                const double* a = &m_positions[3 * triangles[3 * t]];
+                const double* b = &m_positions[3 * triangles[3 * t + 1]];
+                const double* c = &m_positions[3 * triangles[3 * t + 2]];
+                double w[3];
+                closestPointWeights(p, a, b, c, w);
+                double distance = 0.0;
+                for (int k = 0; k < 3; ++k) {
+                    const double delta = p[k] - (w[0] * a[k] + w[1] * b[k] + w[2] * c[k]);
+                    distance += delta * delta;
+                }
+                distance = std::sqrt(distance);
+                if (distance < best) {
+                    best = distance;
+                    bestTriangle = t;
+                    bestWeights[0] = w[0];
+                    bestWeights[1] = w[1];
+                    bestWeights[2] = w[2];
+                }
+            }
+        }
+    }
+
+    m_hitTriangles[node] = bestTriangle;
+    if (bestTriangle < 0) {
+        return;
+    }
+
+    // Push the node away from the closest point; on the surface itself use the face normal
+    const double* a = &m_positions[3 * triangles[3 * bestTriangle]];
+    const double* b = &m_positions[3 * triangles[3 * bestTriangle + 1]];
+    const double* c = &m_positions[3 * triangles[3 * bestTriangle + 2]];
+    double direction[3];
+    for (int k = 0; k < 3; ++k) {
+        direction[k] = p[k] - (bestWeights[0] * a[k] + bestWeights[1] * b[k] + bestWeights[2] * c[k]);
+    }
+    double length = std::sqrt(dot(direction, direction));
+    if (length <= 1e-12 * m_thickness) {
+        const double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        const double ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        direction[0] = ab[1] * ac[2] - ab[2] * ac[1];
+        direction[1] = ab[2] * ac[0] - ab[0] * ac[2];
+        direction[2] = ab[0] * ac[1] - ab[1] * ac[0];
+        length = std::sqrt(dot(direction, direction));
+    }
+
+    const double magnitude = (length > 0.0) ? m_stiffness * (m_thickness - best) / length : 0.0;
+    for (int k = 0; k < 3; ++k) {
+        m_hitWeights[3 * node + k] = bestWeights[k];
+        m_hitForces[3 * node + k] = magnitude * direction[k];
+    }
+}
+
+template <typename Body>
+void ContactDetector::forEachChunk(int count, const Body& body)
+{
+    if (m_pool) {
+        m_pool->parallelFor(0, count, m_grain, body);
+        return;
+    }
+    const int chunks = WorkStealingPool::chunkCount(0, count, m_grain);
+    for (int c = 0; c < chunks; ++c) {
+        body(c, c * m_grain, std::min((c + 1) * m_grain, count));
+    }
+}
+
+template <typename Accum, typename Real>
+void ContactDetector::computeForces(const Accum* displacements, Real* forces)
+{
+    SIMTOOL_PROFILE_SCOPE(Contact);
+
+    // Undo the previous evaluation
+    for (int node : m_activeNodes) {
+        forces[3 * node] = Real(0);
+        forces[3 * node + 1] = Real(0);
+        forces[3 * node + 2] = Real(0);
+        m_isActive[node] = 0;
+    }
+    m_activeNodes.clear();
+
+    // Deformed positions, refit, then one closest-triangle query per node
+    const int numNodes = m_model->numNodes();
+    const double* reference = m_model->nodeCoordinates.data();
+    forEachChunk(numNodes, [this, reference, displacements](int, int begin, int end) {
+        for (int i = 3 * begin; i < 3 * end; ++i) {
+            m_positions[i] = reference[i] + displacements[i];
+        }
+    });
+    refit();
+    forEachChunk(numNodes, [this](int, int begin, int end) {
+        for (int node = begin; node < end; ++node) {
+            queryNode(node);
+        }
+    });
+
+    // Node force and its barycentric reaction, in node order
+    const int* triangles = m_model->triangles.data();
+    auto addForce = [this, forces](int node, const double* force, double scale) {
+        if (!m_isActive[node]) {
+            m_isActive[node] = 1;
+            m_activeNodes.push_back(node);
+        }
+        for (int k = 0; k < 3; ++k) {
+            forces[3 * node + k] += static_cast<Real>(scale * force[k]);
+        }
+    };
+
+    int contacts = 0;
+    double maxPenetration = 0.0;
+    for (int node = 0; node < numNodes; ++node) {
+        const int t = m_hitTriangles[node];
+        if (t < 0) {
+            continue;
+        }
+        const double* force = &m_hitForces[3 * node];
+        const double* weights = &m_hitWeights[3 * node];
+        addForce(node, force, 1.0);
+        for (int v = 0; v < 3; ++v) {
+            addForce(triangles[3 * t + v], force, -weights[v]);
+        }
+        ++contacts;
+        maxPenetration = std::max(maxPenetration, std::sqrt(dot(force, force)) / m_stiffness);
+    }
+
+    m_statistics.contacts = contacts;
+    m_statistics.maxPenetration = maxPenetration;
+    m_statistics.evaluations++;
+    m_statistics.peakContacts = std::max(m_statistics.peakContacts, contacts);
+}
+
+template void ContactDetector::computeForces<double, double>(const double*, double*);
+template void ContactDetector::computeForces<float, float>(const float*, float*);
+template void ContactDetector::computeForces<double, float>(const double*, float*);
@@ -0,0 +1,175 @@
+#include "DomainDecomposition.h"
+#include "NodeOrdering.h"
+#include <algorithm>
+#include <stdexcept>
+
+DomainDecomposition::DomainDecomposition(const StructuralModel& model, const std::vector<int>& nodeParts,
+                                         int parts, int haloDepth)
+    : m_model(model)
+    , m_nodeParts(nodeParts)
+    , m_parts(parts)
+    , m_haloDepth(haloDepth)
+    , m_halos(parts)
+    , m_exchangeCounts(static_cast<size_t>(parts) * parts, 0)
+{
+    model.nodeAdjacency(m_pointers, m_neighbours);
+
+    // Rings around each part by breadth-first search from its nodes; the
+    // stamp marks nodes already reached for the current part
+    const int n = model.numNodes();
+    std::vector<int> stamp(n, -1);
+    std::vector<std::vector<int>> owned(parts);
+    for (int node = 0; node < n; ++node) {
+        owned[m_nodeParts[node]].push_back(node);
+    }
+
+    std::vector<int> ring;
+    std::vector<int> next;
+    for (int part = 0; part < parts; ++part) {
+        for (int node : owned[part]) {
+            stamp[node] = part;
+        }
+        std::vector<int>& halo = m_halos[part];
+        ring = owned[part];
+        for (int depth = 0; depth < haloDepth && !ring.empty(); ++depth) {
+            next.clear();
+            for (int node : ring) {
+                for (int k = m_pointers[node]; k < m_pointers[node + 1]; ++k) {
+                    const int neighbour = m_neighbours[k];
+                    if (stamp[neighbour] != part) {
+                        stamp[neighbour] = part;
+                        next.push_back(neighbour);
+                    }
+                }
+            }
+            halo.insert(halo.end(), next.begin(), next.end());
+            ring.swap(next);
+        }
+        std::sort(halo.begin(), halo.end());
+
+        for (int node : halo) {
+            m_exchangeCounts[m_nodeParts[node] * parts + part]++;
+        }
+    }
+}
+
+DomainDecomposition::Subdomain DomainDecomposition::subdomain(int part, DofOrdering ordering) const
+{
+    Subdomain subdomain;
+    subdomain.part = part;
+
+    // Owned nodes in global order, or renumbered among themselves for locality
+    std::vector<int>& nodes = subdomain.globalNodes;
+    for (int node = 0; node < m_model.numNodes(); ++node) {
+        if (m_nodeParts[node] == part) {
+            nodes.push_back(node);
+        }
+    }
+    subdomain.ownedNodes = static_cast<int>(nodes.size());
+
+    std::vector<int> local(m_model.numNodes(), -1);
+    auto numberNodes = [&nodes, &local]() {
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            local[nodes[i]] = static_cast<int>(i);
+        }
+    };
+    numberNodes();
+    if (ordering != DofOrdering::Natural && subdomain.ownedNodes > 1) {
+        StructuralModel owned;
+        owned.nodeCoordinates.reserve(3 * nodes.size());
+        for (int node : nodes) {
+            owned.nodeCoordinates.insert(owned.nodeCoordinates.end(), &m_model.nodeCoordinates[3 * node],
+                                         &m_model.nodeCoordinates[3 * node] + 3);
+            for (int k = m_pointers[node]; k < m_pointers[node + 1]; ++k) {
+                const int neighbour = m_neighbours[k];
+                if (m_nodeParts[neighbour] == part && neighbour > node) {
+                    owned.edges.push_back(local[node]);
+                    owned.edges.push_back(local[neighbour]);
+                }
+            }
+        }
+        const std::vector<int> order = NodeOrdering::compute(owned, ordering);
+        std::vector<int> renumbered(nodes.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            renumbered[i] = nodes[order[i]];
+        }
+        nodes.swap(renumbered);
+        numberNodes();
+    }
+    nodes.insert(nodes.end(), m_halos[part].begin(), m_halos[part].end());
+    numberNodes();
+
+    // Local model: coordinates and bodies of the local nodes, every edge between them
+    StructuralModel& model = subdomain.model;
+    model.dofsPerNode = m_model.dofsPerNode;
+    model.numBodies = m_model.numBodies;
+    model.nodeCoordinates.resize(3 * nodes.size());
+    if (!m_model.nodeBodies.empty()) {
+        model.nodeBodies.resize(nodes.size());
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const int node = nodes[i];
+        for (int c = 0; c < 3; ++c) {
+            model.nodeCoordinates[3 * i + c] = m_model.nodeCoordinates[3 * node + c];
+        }
+        if (!m_model.nodeBodies.empty()) {
+            model.nodeBodies[i] = m_model.nodeBodies[node];
+        }
+    }
+    for (int e = 0; e < m_model.numEdges(); ++e) {
+        const int a = local[m_model.edges[2 * e]];
+        const int b = local[m_model.edges[2 * e + 1]];
+        if (a >= 0 && b >= 0) {
+            model.edges.push_back(a);
+            model.edges.push_back(b);
+        }
+    }
+
+    // Links in ascending part order, lists in ascending global node order
+    for (int other = 0; other < m_parts; ++other) {
+        if (other == part || (exchangeCount(part, other) == 0 && exchangeCount(other, part) == 0)) {
+            continue;
+        }
+        Link link;
+        link.part = other;
+        for (int node : m_halos[other]) {
+            if (m_nodeParts[node] == part) {
+                link.sendNodes.push_back(local[node]);
+            }
+        }
+        for (int node : m_halos[part]) {
+            if (m_nodeParts[node] == other) {
+                link.receiveNodes.push_back(local[node]);
+            }
+        }
+        subdomain.links.push_back(link);
+    }
+    return subdomain;
+}
+
+int DomainDecomposition::haloDepth(IntegratorType type)
+{
+    switch (type) {
+        case IntegratorType::RungeKutta4: return 4;
+        default:                          return 1;
+    }
+}
+
+void DomainDecomposition::checkSupported(const SimulationParameters& params)
+{
+    switch (params.integrator) {
+        case IntegratorType::SymplecticEuler:
+        case IntegratorType::VelocityVerlet:
+        case IntegratorType::RungeKutta4:
+        case IntegratorType::Newmark:
+            break;
+        default:
+            throw std::runtime_error("Domain decomposition needs an explicit fixed-step integrator");
+    }
+    if (params.precision != ScalarPrecision::Double) {
+        throw std::runtime_error("Domain decomposition runs in double precision only");
+    }
+    if (params.contactStiffness > 0.0) {
+        throw std::runtime_error("Domain decomposition does not support contact");
+    }
+}
@@ -0,0 +1,648 @@
+#include "DomainExchange.h"
+#include "DomainDecomposition.h"
+#include "SimulationSolver.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char SegmentMagic[8] = { 'S', 'I', 'M', 'D', 'O', 'M', 'N', '1' };
+const std::uint32_t SegmentVersion = 1;
+
+static_assert(std::atomic<int>::is_always_lock_free,
+              "Control words in shared memory must be lock-free to work across processes");
+static_assert(std::is_trivially_copyable<SimulationParameters>::value,
+              "SimulationParameters is copied into the segment byte for byte");
+
+enum Command { RunCommand = 0, StopCommand = 1 };
+enum WorkerStatus { Starting = 0, Ready = 1, Failed = 2 };
+
+// Control words of the segment (lock-free atomics are address-free, so
+// they synchronize the processes that map the segment)
+struct alignas(64) Control
+{
+    std::atomic<int> command;
+    std::atomic<int> batch;                 // Sequence number of the last batch handed out
+    std::atomic<int> batchSteps;
+    std::atomic<int> abort;                 // Set on any failure; every wait gives up
+    alignas(64) std::atomic<int> arrived;   // Step barrier between the workers
+    std::atomic<int> generation;
+};
+
+struct alignas(64) WorkerSlot
+{
+    std::atomic<int> status;
+    std::atomic<int> finishedBatch;
+    double energy;                          // Of the owned DOFs after the last batch
+    char error[256];
+};
+
+// Offsets of the arrays behind the header
+struct SegmentLayout
+{
+    std::uint64_t coordinates;              // double[3 * numNodes]
+    std::uint64_t bodies;                   // int32[numNodes]
+    std::uint64_t edges;                    // int32[2 * numEdges]
+    std::uint64_t parts;                    // int32[numNodes]
+    std::uint64_t links;                    // uint64[parts * parts]: message buffer pair per sender, receiver
+    std::uint64_t state;                    // double[3 * numDOF]: x, v, a in the original numbering
+    std::uint64_t workers;                  // WorkerSlot[parts]
+    std::uint64_t size;
+};
+
+struct SegmentHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t parametersSize;
+    std::int64_t coordinatorPid;
+    std::int32_t parts;
+    std::int32_t numNodes;
+    std::int32_t numEdges;
+    std::int32_t dofsPerNode;
+    std::int32_t numBodies;
+    std::int32_t haloDepth;
+    std::int32_t workerThreads;
+    std::int32_t startStep;
+    double startTime;
+    double timeStep;
+    SimulationParameters parameters;
+    SegmentLayout layout;
+    Control control;
+};
+
+std::uint64_t align64(std::uint64_t offset)
+{
+    return (offset + 63) & ~std::uint64_t(63);
+}
+
+template <typename T>
+T* at(void* base, std::uint64_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+template <typename T>
+const T* at(const void* base, std::uint64_t offset)
+{
+    return reinterpret_cast<const T*>(static_cast<const char*>(base) + offset);
+}
+
+// Doubles per node in a message: x, v and a of each of its DOFs
+int valuesPerNode(int dofsPerNode)
+{
+    return 3 * dofsPerNode;
+}
+
+bool coordinatorAlive(std::int64_t coordinatorPid)
+{
+#ifdef Q_OS_UNIX
+    return coordinatorPid == 0 || static_cast<std::int64_t>(getppid()) == coordinatorPid;
+#else
+    Q_UNUSED(coordinatorPid);
+    return true;
+#endif
+}
+
+/**
+ * Spin, then yield, then sleep until done() holds. Returns false once the
+ * abort flag is set or the coordinator process has gone away.
+ */
+template <typename Done>
+bool waitUntil(const Control& control, std::int64_t coordinatorPid, Done done)
+{
+    for (unsigned spins = 0; !done(); ++spins) {
+        if (control.abort.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (spins < 4096) {
+            continue;
+        }
+        if (spins < 8192) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        if ((spins & 1023) == 0 && !coordinatorAlive(coordinatorPid)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sense-counting barrier: the last worker to arrive resets the count and
+// starts the next generation; its release publishes every message written
+// before the barrier
+bool stepBarrier(Control& control, int parts, std::int64_t coordinatorPid)
+{
+    const int generation = control.generation.load(std::memory_order_acquire);
+    if (control.arrived.fetch_add(1, std::memory_order_acq_rel) == parts - 1) {
+        control.arrived.store(0, std::memory_order_relaxed);
+        control.generation.fetch_add(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return waitUntil(control, coordinatorPid, [&control, generation]() {
+        return control.generation.load(std::memory_order_acquire) != generation;
+    });
+}
+
+// Pin this process to its share of the allowed CPUs, so first touch puts
+// its memory on the NUMA node it runs on
+void pinToCpus(int rank, int parts)
+{
+#ifdef Q_OS_LINUX
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (static_cast<int>(cpus.size()) < parts) {
+        return;     // More workers than CPUs: leave the placement to the scheduler
+    }
+    const size_t share = cpus.size() / parts;
+    cpu_set_t mine;
+    CPU_ZERO(&mine);
+    for (size_t i = rank * share; i < (rank + 1) * share; ++i) {
+        CPU_SET(cpus[i], &mine);
+    }
+    sched_setaffinity(0, sizeof(mine), &mine);
+#else
+    Q_UNUSED(rank);
+    Q_UNUSED(parts);
+#endif
+}
+
+// Message buffers of one direction of a link, and the local DOFs they carry
+struct Channel
+{
+    std::vector<int> dofs;
+    double* buffers[2];                     // Even and odd steps
+};
+
+std::vector<Channel> openChannels(const DomainDecomposition::Subdomain& subdomain, SegmentHeader* header,
+                                  bool send)
+{
+    const int parts = header->parts;
+    const int d = header->dofsPerNode;
+    const std::uint64_t* links = at<std::uint64_t>(header, header->layout.links);
+
+    std::vector<Channel> channels;
+    for (const DomainDecomposition::Link& link : subdomain.links) {
+        const std::vector<int>& nodes = send ? link.sendNodes : link.receiveNodes;
+        if (nodes.empty()) {
+            continue;
+        }
+        const std::uint64_t offset = send ? links[subdomain.part * parts + link.part]
+                                          : links[link.part * parts + subdomain.part];
+        Channel channel;
+        for (int node : nodes) {
+            for (int c = 0; c < d; ++c) {
+                channel.dofs.push_back(node * d + c);
+            }
+        }
+        channel.buffers[0] = at<double>(header, offset);
+        channel.buffers[1] = channel.buffers[0] + nodes.size() * valuesPerNode(d);
+        channels.push_back(channel);
+    }
+    return channels;
+}
+
+} // namespace
+
+DomainCoordinator::DomainCoordinator()
+    : m_parts(0)
+    , m_numDOF(0)
+    , m_batch(0)
+    , m_haloValues(0)
+{
+    m_statistics = GraphPartitioner::Statistics();
+}
+
+DomainCoordinator::~DomainCoordinator()
+{
+    stop();
+}
+
+void DomainCoordinator::start(const SimulationParameters& params, const StructuralModel& model,
+                              const SimulationState& state, const QString& program)
+{
+    stop();
+    DomainDecomposition::checkSupported(params);
+
+    m_parts = std::max(1, std::min(params.subdomains, model.numNodes()));
+    const std::vector<int> nodeParts = GraphPartitioner::partition(model, m_parts);
+    m_statistics = GraphPartitioner::evaluate(model, nodeParts, m_parts);
+    const int depth = DomainDecomposition::haloDepth(params.integrator);
+    const DomainDecomposition decomposition(model, nodeParts, m_parts, depth);
+    const int n = model.numNodes();
+    const int d = model.dofsPerNode;
+    m_numDOF = model.numDOF();
+    m_batch = 0;
+
+    // Layout: every array starts on its own cache line
+    SegmentLayout layout;
+    std::uint64_t offset = align64(sizeof(SegmentHeader));
+    layout.coordinates = offset;
+    offset = align64(offset + 3ull * n * sizeof(double));
+    layout.bodies = offset;
+    offset = align64(offset + static_cast<std::uint64_t>(n) * sizeof(std::int32_t));
+    layout.edges = offset;
+    offset = align64(offset + 2ull * model.numEdges() * sizeof(std::int32_t));
+    layout.parts = offset;
+    offset = align64(offset + static_cast<std::uint64_t>(n) * sizeof(std::int32_t));
+    layout.links = offset;
+    offset = align64(offset + static_cast<std::uint64_t>(m_parts) * m_parts * sizeof(std::uint64_t));
+    std::vector<std::uint64_t> links(static_cast<size_t>(m_parts) * m_parts, 0);
+    m_haloValues = 0;
+    for (int from = 0; from < m_parts; ++from) {
+        for (int to = 0; to < m_parts; ++to) {
+            const std::uint64_t values = static_cast<std::uint64_t>(decomposition.exchangeCount(from, to))
+                                       * valuesPerNode(d);
+            if (values > 0) {
+                links[from * m_parts + to] = offset;
+                offset = align64(offset + 2 * values * sizeof(double));
+                m_haloValues += values;
+            }
+        }
+    }
+    layout.state = offset;
+    offset = align64(offset + 3ull * m_numDOF * sizeof(double));
+    layout.workers = offset;
+    offset = align64(offset + static_cast<std::uint64_t>(m_parts) * sizeof(WorkerSlot));
+    layout.size = offset;
+    if (layout.size > static_cast<std::uint64_t>(INT_MAX)) {
+        throw std::runtime_error("Model too large for a shared memory segment ("
+                                 + std::to_string(layout.size) + " bytes)");
+    }
+
+    static std::atomic<int> segments(0);
+    const QString key = QString("SimulationTool.domains.%1.%2")
+                        .arg(QCoreApplication::applicationPid()).arg(++segments);
+    m_memory.setKey(key);
+    if (m_memory.attach()) {
+        m_memory.detach();      // Left behind by a crashed run
+    }
+    if (!m_memory.create(static_cast<int>(layout.size))) {
+        throw std::runtime_error("Cannot create shared memory: " + m_memory.errorString().toStdString());
+    }
+
+    void* base = m_memory.data();
+    std::memset(base, 0, layout.size);
+    SegmentHeader* header = new (base) SegmentHeader();
+    header->layout = layout;
+    std::memcpy(header->magic, SegmentMagic, sizeof(SegmentMagic));
+    header->version = SegmentVersion;
+    header->parametersSize = sizeof(SimulationParameters);
+    header->coordinatorPid = QCoreApplication::applicationPid();
+    header->parts = m_parts;
+    header->numNodes = n;
+    header->numEdges = model.numEdges();
+    header->dofsPerNode = d;
+    header->numBodies = model.numBodies;
+    header->haloDepth = depth;
+    header->workerThreads = params.numThreads > 0 ? params.numThreads
+                                                  : std::max(1, QThread::idealThreadCount() / m_parts);
+    header->startStep = state.currentStep;
+    header->startTime = state.currentTime;
+    header->timeStep = state.timeStep;
+    header->parameters = params;
+    header->control.command.store(RunCommand, std::memory_order_relaxed);
+    header->control.batch.store(0, std::memory_order_relaxed);
+    header->control.batchSteps.store(0, std::memory_order_relaxed);
+    header->control.abort.store(0, std::memory_order_relaxed);
+    header->control.arrived.store(0, std::memory_order_relaxed);
+    header->control.generation.store(0, std::memory_order_relaxed);
+
+    std::copy(model.nodeCoordinates.begin(), model.nodeCoordinates.end(),
+              at<double>(base, header->layout.coordinates));
+    if (!model.nodeBodies.empty()) {
+        std::copy(model.nodeBodies.begin(), model.nodeBodies.end(), at<std::int32_t>(base, header->layout.bodies));
+    }
+    std::copy(model.edges.begin(), model.edges.end(), at<std::int32_t>(base, header->layout.edges));
+    std::copy(nodeParts.begin(), nodeParts.end(), at<std::int32_t>(base, header->layout.parts));
+    std::copy(links.begin(), links.end(), at<std::uint64_t>(base, header->layout.links));
+    double* x = at<double>(base, header->layout.state);
+    std::copy(state.positions.begin(), state.positions.end(), x);
+    std::copy(state.velocities.begin(), state.velocities.end(), x + m_numDOF);
+    std::copy(state.accelerations.begin(), state.accelerations.end(), x + 2 * m_numDOF);
+    WorkerSlot* workerSlots = at<WorkerSlot>(base, header->layout.workers);
+    for (int rank = 0; rank < m_parts; ++rank) {
+        new (&workerSlots[rank]) WorkerSlot();
+        workerSlots[rank].status.store(Starting, std::memory_order_relaxed);
+        workerSlots[rank].finishedBatch.store(0, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // One process per part; their output goes straight to ours
+    for (int rank = 0; rank < m_parts; ++rank) {
+        std::unique_ptr<QProcess> process(new QProcess());
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(program, QStringList() << "--domain-worker" << key << "--domain-rank" << QString::number(rank));
+        const bool started = process->waitForStarted(30000);
+        const QString error = process->errorString();
+        m_processes.push_back(std::move(process));
+        if (!started) {
+            stop();
+            throw std::runtime_error("Cannot start worker " + program.toStdString() + ": " + error.toStdString());
+        }
+    }
+    waitForWorkers(0);
+
+    std::cout << "[DomainCoordinator] " << m_parts << " worker processes, " << m_statistics.smallestPart << " - "
+              << m_statistics.largestPart << " nodes each (imbalance " << m_statistics.imbalance << "), "
+              << m_statistics.cutEdges << " cut edges, halo depth " << depth << ", " << m_haloValues
+              << " values exchanged per step" << std::endl;
+}
+
+void DomainCoordinator::runBatch(int steps)
+{
+    Control& control = static_cast<SegmentHeader*>(m_memory.data())->control;
+    control.batchSteps.store(steps, std::memory_order_relaxed);
+    control.batch.store(++m_batch, std::memory_order_release);
+    waitForWorkers(m_batch);
+}
+
+// Batch 0 waits for every worker to be ready. Failures and exits of
+// workers are checked while waiting, so a crashed worker ends the run
+// with an error instead of a hang.
+void DomainCoordinator::waitForWorkers(int batch)
+{
+    SegmentHeader* header = static_cast<SegmentHeader*>(m_memory.data());
+    const WorkerSlot* workerSlots = at<WorkerSlot>(header, header->layout.workers);
+
+    for (unsigned spins = 0; ; ++spins) {
+        bool done = true;
+        int failed = -1;
+        for (int rank = 0; rank < m_parts; ++rank) {
+            const int status = workerSlots[rank].status.load(std::memory_order_acquire);
+            if (status == Failed) {
+                failed = rank;
+                break;
+            }
+            if (batch == 0 ? status != Ready
+                           : workerSlots[rank].finishedBatch.load(std::memory_order_acquire) != batch) {
+                done = false;
+            }
+        }
+        if (failed < 0 && done) {
+            return;
+        }
+
+        if (failed < 0 && spins >= 8192 && (spins & 255) == 0) {
+            for (int rank = 0; rank < m_parts && failed < 0; ++rank) {
+                QProcess* process = m_processes[rank].get();
+                if (process->state() == QProcess::NotRunning || process->waitForFinished(0)) {
+                    failed = rank;
+                }
+            }
+        }
+        if (failed >= 0) {
+            header->control.abort.store(1, std::memory_order_release);
+            const QString error = workerError(failed);
+            stop();
+            throw std::runtime_error(error.toStdString());
+        }
+
+        if (spins < 4096) {
+            continue;
+        }
+        if (spins < 8192) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+QString DomainCoordinator::workerError(int rank) const
+{
+    const SegmentHeader* header = static_cast<const SegmentHeader*>(m_memory.constData());
+    const WorkerSlot& slot = at<WorkerSlot>(header, header->layout.workers)[rank];
+    if (slot.status.load(std::memory_order_acquire) == Failed) {
+        return QString("Domain worker %1 failed: %2").arg(rank).arg(QString::fromUtf8(slot.error));
+    }
+    const QProcess* process = m_processes[rank].get();
+    if (process->exitStatus() == QProcess::CrashExit) {
+        return QString("Domain worker %1 crashed").arg(rank);
+    }
+    return QString("Domain worker %1 exited with code %2").arg(rank).arg(process->exitCode());
+}
+
+void DomainCoordinator::readState(SimulationState& state) const
+{
+    const SegmentHeader* header = static_cast<const SegmentHeader*>(m_memory.constData());
+    const double* x = at<double>(header, header->layout.state);
+    state.positions.assign(x, x + m_numDOF);
+    state.velocities.assign(x + m_numDOF, x + 2 * m_numDOF);
+    state.accelerations.assign(x + 2 * m_numDOF, x + 3 * m_numDOF);
+
+    const WorkerSlot* workerSlots = at<WorkerSlot>(header, header->layout.workers);
+    double energy = 0.0;
+    for (int rank = 0; rank < m_parts; ++rank) {
+        energy += workerSlots[rank].energy;
+    }
+    state.energy = energy;
+}
+
+void DomainCoordinator::stop()
+{
+    if (m_memory.isAttached()) {
+        static_cast<SegmentHeader*>(m_memory.data())->control.command.store(StopCommand, std::memory_order_release);
+    }
+    for (std::unique_ptr<QProcess>& process : m_processes) {
+        if (process->state() != QProcess::NotRunning && !process->waitForFinished(5000)) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+    }
+    m_processes.clear();
+    if (m_memory.isAttached()) {
+        m_memory.detach();
+    }
+}
+
+int DomainWorker::run(const QString& key, int rank)
+{
+    QSharedMemory memory(key);
+    if (!memory.attach()) {
+        std::cerr << "[DomainWorker] Cannot attach to " << key.toStdString() << ": "
+                  << memory.errorString().toStdString() << std::endl;
+        return 1;
+    }
+    SegmentHeader* header = static_cast<SegmentHeader*>(memory.data());
+    if (std::memcmp(header->magic, SegmentMagic, sizeof(SegmentMagic)) != 0 || header->version != SegmentVersion
+        || header->parametersSize != sizeof(SimulationParameters) || rank < 0 || rank >= header->parts) {
+        std::cerr << "[DomainWorker] Segment " << key.toStdString() << " is not for this build or rank" << std::endl;
+        return 1;
+    }
+    Control& control = header->control;
+    WorkerSlot& slot = at<WorkerSlot>(header, header->layout.workers)[rank];
+    const std::int64_t coordinator = header->coordinatorPid;
+    const int parts = header->parts;
+    const int d = header->dofsPerNode;
+
+    try {
+        pinToCpus(rank, parts);
+
+        // The full model is only needed to cut out the subdomain
+        DomainDecomposition::Subdomain subdomain;
+        {
+            StructuralModel model;
+            model.dofsPerNode = d;
+            model.numBodies = header->numBodies;
+            const double* coordinates = at<double>(header, header->layout.coordinates);
+            model.nodeCoordinates.assign(coordinates, coordinates + 3 * static_cast<size_t>(header->numNodes));
+            const std::int32_t* bodies = at<std::int32_t>(header, header->layout.bodies);
+            model.nodeBodies.assign(bodies, bodies + header->numNodes);
+            const std::int32_t* edges = at<std::int32_t>(header, header->layout.edges);
+            model.edges.assign(edges, edges + 2 * static_cast<size_t>(header->numEdges));
+            const std::int32_t* nodeParts = at<std::int32_t>(header, header->layout.parts);
+            const DomainDecomposition decomposition(model, std::vector<int>(nodeParts, nodeParts + header->numNodes),
+                                                    parts, header->haloDepth);
+            subdomain = decomposition.subdomain(rank, header->parameters.dofOrdering);
+        }
+
+        // Stepping, steady state and output stay with the coordinator
+        SimulationParameters params = header->parameters;
+        params.numThreads = header->workerThreads;
+        params.dofOrdering = DofOrdering::Natural;     // The subdomain is already in its order
+        params.subdomains = 1;
+        params.runMode = RunMode::Headless;
+        params.steadyStateThreshold = 0.0;
+        params.checkpointInterval = 0;
+        SimulationSolver solver;
+        solver.initialize(params, subdomain.model);
+
+        // Start from the coordinator's state, halo included
+        const int numDOF = subdomain.model.numDOF();
+        const int ownedDOF = subdomain.ownedNodes * d;
+        const int globalDOF = header->numNodes * d;
+        double* x = at<double>(header, header->layout.state);
+        double* v = x + globalDOF;
+        double* a = v + globalDOF;
+        SimulationState start;
+        start.positions.resize(numDOF);
+        start.velocities.resize(numDOF);
+        start.accelerations.resize(numDOF);
+        for (int node = 0; node < static_cast<int>(subdomain.globalNodes.size()); ++node) {
+            for (int c = 0; c < d; ++c) {
+                const int global = subdomain.globalNodes[node] * d + c;
+                start.positions[node * d + c] = x[global];
+                start.velocities[node * d + c] = v[global];
+                start.accelerations[node * d + c] = a[global];
+            }
+        }
+        start.currentStep = header->startStep;
+        start.currentTime = header->startTime;
+        start.timeStep = header->timeStep;
+        solver.restore(start, 0.0, 0);     // Steady state is the coordinator's business
+
+        const std::vector<Channel> sends = openChannels(subdomain, header, true);
+        const std::vector<Channel> receives = openChannels(subdomain, header, false);
+        std::vector<double> stiffnessForces(ownedDOF);
+
+        slot.status.store(Ready, std::memory_order_release);
+        std::cout << "[DomainWorker] Part " << rank << ": " << subdomain.ownedNodes << " nodes, "
+                  << subdomain.globalNodes.size() - subdomain.ownedNodes << " halo nodes, "
+                  << subdomain.links.size() << " neighbours, " << params.numThreads << " threads" << std::endl;
+
+        bool aborted = false;
+        solver.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            SimulationState& local = solver.writableState();
+            int batch = 0;
+            for (;;) {
+                if (!waitUntil(control, coordinator, [&control, batch]() {
+                        return control.batch.load(std::memory_order_acquire) != batch
+                            || control.command.load(std::memory_order_acquire) == StopCommand;
+                    })) {
+                    aborted = true;
+                    return;
+                }
+                if (control.command.load(std::memory_order_acquire) == StopCommand) {
+                    return;
+                }
+                batch = control.batch.load(std::memory_order_acquire);
+                const int steps = control.batchSteps.load(std::memory_order_relaxed);
+
+                for (int s = 0; s < steps; ++s) {
+                    solver.step<Integrator>();
+
+                    // Halo exchange: send, meet, receive
+                    const int parity = solver.currentStep() & 1;
+                    for (const Channel& channel : sends) {
+                        double* out = channel.buffers[parity];
+                        for (int dof : channel.dofs) {
+                            *out++ = local.positions[dof];
+                            *out++ = local.velocities[dof];
+                            *out++ = local.accelerations[dof];
+                        }
+                    }
+                    if (!stepBarrier(control, parts, coordinator)) {
+                        aborted = true;
+                        return;
+                    }
+                    for (const Channel& channel : receives) {
+                        const double* in = channel.buffers[parity];
+                        for (int dof : channel.dofs) {
+                            local.positions[dof] = *in++;
+                            local.velocities[dof] = *in++;
+                            local.accelerations[dof] = *in++;
+                        }
+                    }
+                }
+
+                // Owned state and energy for the coordinator: E = 1/2 (v^T M v + x^T K x)
+                const StructuralModel& model = solver.model();
+                model.stiffness.multiplyRows(0, ownedDOF, local.positions.data(), stiffnessForces.data());
+                double energy = 0.0;
+                for (int node = 0; node < subdomain.ownedNodes; ++node) {
+                    for (int c = 0; c < d; ++c) {
+                        const int i = node * d + c;
+                        const int global = subdomain.globalNodes[node] * d + c;
+                        x[global] = local.positions[i];
+                        v[global] = local.velocities[i];
+                        a[global] = local.accelerations[i];
+                        energy += model.masses[i] * local.velocities[i] * local.velocities[i]
+                                + local.positions[i] * stiffnessForces[i];
+                    }
+                }
+                slot.energy = 0.5 * energy;
+                slot.finishedBatch.store(batch, std::memory_order_release);
+            }
+        });
+        return aborted ? 1 : 0;
+    }
+    catch (const std::exception& e) {
+        std::strncpy(slot.error, e.what(), sizeof(slot.error) - 1);
+        slot.status.store(Failed, std::memory_order_release);
+        control.abort.store(1, std::memory_order_release);
+        std::cerr << "[DomainWorker] Part " << rank << ": " << e.what() << std::endl;
+        return 1;
+    }
+}
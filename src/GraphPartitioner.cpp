@@ -0,0 +1,146 @@
+#include "GraphPartitioner.h"
+#include <algorithm>
+
+namespace {
+
+struct Graph
+{
+    std::vector<int> pointers;
+    std::vector<int> neighbours;
+};
+
+/**
+ * Breadth-first order of the nodes of one region reachable from root.
+ * Levels of visited nodes are written to levels and must be reset to -1
+ * by the caller.
+ */
+void breadthFirst(const Graph& graph, int root, const std::vector<int>& region, int label,
+                  std::vector<int>& levels, std::vector<int>& queue)
+{
+    queue.clear();
+    queue.push_back(root);
+    levels[root] = 0;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const int node = queue[head];
+        for (int k = graph.pointers[node]; k < graph.pointers[node + 1]; ++k) {
+            const int neighbour = graph.neighbours[k];
+            if (region[neighbour] == label && levels[neighbour] < 0) {
+                levels[neighbour] = levels[node] + 1;
+                queue.push_back(neighbour);
+            }
+        }
+    }
+}
+
+// Level-structure order of a region: component by component, each from a
+// pseudo-peripheral node found by repeated BFS (George and Liu)
+void levelOrder(const Graph& graph, const std::vector<int>& nodes, const std::vector<int>& region, int label,
+                std::vector<int>& levels, std::vector<int>& order)
+{
+    order.clear();
+    std::vector<int> queue;
+    for (int seed : nodes) {
+        if (levels[seed] >= 0) {
+            continue;
+        }
+
+        int root = seed;
+        int eccentricity = -1;
+        for (;;) {
+            breadthFirst(graph, root, region, label, levels, queue);
+            const int depth = levels[queue.back()];
+            const int candidate = queue.back();
+            for (int node : queue) {
+                levels[node] = -1;
+            }
+            if (depth <= eccentricity) {
+                break;
+            }
+            eccentricity = depth;
+            root = candidate;
+        }
+
+        // Final search from the root; levels stay set and mark the component as done
+        breadthFirst(graph, root, region, label, levels, queue);
+        order.insert(order.end(), queue.begin(), queue.end());
+    }
+    for (int node : order) {
+        levels[node] = -1;
+    }
+}
+
+void bisect(const Graph& graph, std::vector<int>& nodes, int firstPart, int parts,
+            std::vector<int>& region, std::vector<int>& levels)
+{
+    if (parts == 1) {
+        for (int node : nodes) {
+            region[node] = firstPart;
+        }
+        return;
+    }
+
+    // Region labels are the first part of the region; both halves get theirs here
+    std::vector<int> order;
+    levelOrder(graph, nodes, region, region[nodes.front()], levels, order);
+
+    const int lowerParts = parts / 2;
+    const size_t lowerCount = nodes.size() * static_cast<size_t>(lowerParts) / static_cast<size_t>(parts);
+    std::vector<int> lower(order.begin(), order.begin() + lowerCount);
+    std::vector<int> upper(order.begin() + lowerCount, order.end());
+    for (int node : lower) {
+        region[node] = firstPart;
+    }
+    for (int node : upper) {
+        region[node] = firstPart + lowerParts;
+    }
+    nodes.clear();
+    nodes.shrink_to_fit();
+
+    bisect(graph, lower, firstPart, lowerParts, region, levels);
+    bisect(graph, upper, firstPart + lowerParts, parts - lowerParts, region, levels);
+}
+
+} // namespace
+
+std::vector<int> GraphPartitioner::partition(const StructuralModel& model, int parts)
+{
+    const int n = model.numNodes();
+    std::vector<int> region(n, 0);
+    parts = std::max(1, std::min(parts, n));
+    if (parts <= 1) {
+        return region;
+    }
+
+    Graph graph;
+    model.nodeAdjacency(graph.pointers, graph.neighbours);
+    std::vector<int> levels(n, -1);
+    std::vector<int> nodes(n);
+    for (int i = 0; i < n; ++i) {
+        nodes[i] = i;
+    }
+    bisect(graph, nodes, 0, parts, region, levels);
+    return region;
+}
+
+GraphPartitioner::Statistics GraphPartitioner::evaluate(const StructuralModel& model,
+                                                        const std::vector<int>& nodeParts, int parts)
+{
+    Statistics statistics;
+    statistics.parts = parts;
+    statistics.cutEdges = 0;
+    for (int e = 0; e < model.numEdges(); ++e) {
+        if (nodeParts[model.edges[2 * e]] != nodeParts[model.edges[2 * e + 1]]) {
+            statistics.cutEdges++;
+        }
+    }
+
+    std::vector<int> sizes(parts, 0);
+    for (int part : nodeParts) {
+        sizes[part]++;
+    }
+    statistics.smallestPart = sizes.empty() ? 0 : *std::min_element(sizes.begin(), sizes.end());
+    statistics.largestPart = sizes.empty() ? 0 : *std::max_element(sizes.begin(), sizes.end());
+    const double average = parts > 0 ? static_cast<double>(nodeParts.size()) / parts : 0.0;
+    statistics.imbalance = average > 0.0 ? statistics.largestPart / average : 1.0;
+    return statistics;
+}
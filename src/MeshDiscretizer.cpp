@@ -0,0 +1,344 @@
+#include "MeshDiscretizer.h"
+
+// OpenCASCADE includes
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard_Failure.hxx>
+#include <Standard_Version.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <gp_Pnt.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+// Key for an undirected edge between two node indices
+inline uint64_t edgeKey(int a, int b)
+{
+    if (a > b) {
+        std::swap(a, b);
+    }
+    return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+}
+
+// Key for a cell of the node-merging grid
+inline uint64_t cellKey(int64_t ix, int64_t iy, int64_t iz)
+{
+    const uint64_t mask = (1ull << 21) - 1;
+    return ((static_cast<uint64_t>(ix) & mask) << 42)
+         | ((static_cast<uint64_t>(iy) & mask) << 21)
+         |  (static_cast<uint64_t>(iz) & mask);
+}
+
+} // namespace
+
+MeshDiscretizer::MeshDiscretizer()
+{
+}
+
+bool MeshDiscretizer::discretize(const TopoDS_Shape& shape, const Options& options, StructuralModel& model)
+{
+    model = StructuralModel();
+    m_lastError.clear();
+
+    if (shape.IsNull()) {
+        m_lastError = "No shape to discretize";
+        return false;
+    }
+
+    try {
+        Bnd_Box boundingBox;
+        BRepBndLib::Add(shape, boundingBox);
+        if (boundingBox.IsVoid()) {
+            m_lastError = "Shape has an empty bounding box";
+            return false;
+        }
+
+        Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+        boundingBox.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+        const double diagonal = std::sqrt((xMax - xMin) * (xMax - xMin)
+                                        + (yMax - yMin) * (yMax - yMin)
+                                        + (zMax - zMin) * (zMax - zMin));
+
+        // Triangulate all faces; the deflection only controls curvature fidelity,
+        // element size is enforced by the refinement pass below
+        const double linearDeflection = std::max(diagonal * 1e-3, 1e-7);
+        BRepMesh_IncrementalMesh mesher(shape, linearDeflection, Standard_False,
+                                        options.angularDeflection, Standard_True);
+
+        const double mergeTolerance = std::max(diagonal * 1e-7, 1e-9);
+
+        // Bodies: solids, free shells, then free faces
+        TopExp_Explorer solidExp(shape, TopAbs_SOLID);
+        for (; solidExp.More(); solidExp.Next()) {
+            addBody(solidExp.Current(), mergeTolerance, model);
+        }
+        TopExp_Explorer shellExp(shape, TopAbs_SHELL, TopAbs_SOLID);
+        for (; shellExp.More(); shellExp.Next()) {
+            addBody(shellExp.Current(), mergeTolerance, model);
+        }
+        TopExp_Explorer faceExp(shape, TopAbs_FACE, TopAbs_SHELL);
+        for (; faceExp.More(); faceExp.Next()) {
+            addBody(faceExp.Current(), mergeTolerance, model);
+        }
+    }
+    catch (const Standard_Failure& e) {
+        m_lastError = QString("OpenCASCADE meshing error: %1").arg(e.GetMessageString());
+        return false;
+    }
+
+    if (model.numTriangles() == 0) {
+        m_lastError = "Shape produced no triangles (no faces or meshing failed)";
+        return false;
+    }
+
+    // Split the edges that are longer than the requested element size
+    if (options.elementSize > 0.0 && !refine(options, model)) {
+        return false;
+    }
+
+    buildEdges(model);
+
+    std::cout << "[MeshDiscretizer] Bodies=" << model.numBodies
+              << ", Nodes=" << model.numNodes()
+              << ", Triangles=" << model.numTriangles()
+              << ", Edges=" << model.numEdges()
+              << std::endl;
+
+    return true;
+}
+
+void MeshDiscretizer::addBody(const TopoDS_Shape& body, double mergeTolerance, StructuralModel& model)
+{
+    const int bodyIndex = model.numBodies;
+    const int firstTriangle = model.numTriangles();
+
+    // Spatial hash of this body's nodes for merging coincident face nodes
+    std::unordered_multimap<uint64_t, int> grid;
+    const double cellSize = mergeTolerance;
+
+    auto findOrAddNode = [&](const gp_Pnt& p) -> int {
+        const int64_t ix = static_cast<int64_t>(std::floor(p.X() / cellSize));
+        const int64_t iy = static_cast<int64_t>(std::floor(p.Y() / cellSize));
+        const int64_t iz = static_cast<int64_t>(std::floor(p.Z() / cellSize));
+
+        for (int64_t dx = -1; dx <= 1; ++dx) {
+            for (int64_t dy = -1; dy <= 1; ++dy) {
+                for (int64_t dz = -1; dz <= 1; ++dz) {
+                    auto range = grid.equal_range(cellKey(ix + dx, iy + dy, iz + dz));
+                    for (auto it = range.first; it != range.second; ++it) {
+                        const double* q = &model.nodeCoordinates[3 * it->second];
+                        if (std::fabs(q[0] - p.X()) <= mergeTolerance
+                            && std::fabs(q[1] - p.Y()) <= mergeTolerance
+                            && std::fabs(q[2] - p.Z()) <= mergeTolerance) {
+                            return it->second;
+                        }
+                    }
+                }
+            }
+        }
+
+        const int index = model.numNodes();
+        model.nodeCoordinates.push_back(p.X());
+        model.nodeCoordinates.push_back(p.Y());
+        model.nodeCoordinates.push_back(p.Z());
+        model.nodeBodies.push_back(bodyIndex);
+        grid.insert(std::make_pair(cellKey(ix, iy, iz), index));
+        return index;
+    };
+
+    TopExp_Explorer faceExp(body, TopAbs_FACE);
+    for (; faceExp.More(); faceExp.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(faceExp.Current());
+        TopLoc_Location location;
+        Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
+        if (triangulation.IsNull()) {
+            continue;
+        }
+
+        const bool reversed = (face.Orientation() == TopAbs_REVERSED);
+        std::vector<int> localToGlobal(triangulation->NbNodes() + 1, -1);
+
+        for (int i = 1; i <= triangulation->NbNodes(); ++i) {
+#if OCC_VERSION_HEX >= 0x070600
+            gp_Pnt p = triangulation->Node(i);
+#else
+            gp_Pnt p = triangulation->Nodes().Value(i);
+#endif
+            if (!location.IsIdentity()) {
+                p.Transform(location.Transformation());
+            }
+            localToGlobal[i] = findOrAddNode(p);
+        }
+
+        for (int t = 1; t <= triangulation->NbTriangles(); ++t) {
+            Standard_Integer n1, n2, n3;
+#if OCC_VERSION_HEX >= 0x070600
+            triangulation->Triangle(t).Get(n1, n2, n3);
+#else
+            triangulation->Triangles().Value(t).Get(n1, n2, n3);
+#endif
+            if (reversed) {
+                std::swap(n2, n3);
+            }
+            const int a = localToGlobal[n1];
+            const int b = localToGlobal[n2];
+            const int c = localToGlobal[n3];
+            if (a == b || b == c || a == c) {
+                continue;   // Degenerate after merging
+            }
+            model.triangles.push_back(a);
+            model.triangles.push_back(b);
+            model.triangles.push_back(c);
+        }
+    }
+
+    if (model.numTriangles() > firstTriangle) {
+        model.numBodies++;
+    }
+}
+
+// Each round splits every edge longer than the element size at its
+// midpoint. A triangle with three split edges becomes four, one with two
+// becomes three and one with one becomes two, so neighbours stay conforming
+// and only the coarse regions grow. Children keep the parent's orientation
+// and take its place in the triangle list.
+bool MeshDiscretizer::refine(const Options& options, StructuralModel& model)
+{
+    const double limit = options.elementSize * options.elementSize;
+    auto isLong = [&model, limit](int a, int b) {
+        double length = 0.0;
+        for (int c = 0; c < 3; ++c) {
+            const double delta = model.nodeCoordinates[3 * b + c] - model.nodeCoordinates[3 * a + c];
+            length += delta * delta;
+        }
+        return length > limit;
+    };
+
+    std::vector<uint64_t> marked;
+    std::unordered_map<uint64_t, int> midpoints;
+    std::vector<int> refined;
+    for (int round = 0; round < options.maxRefinementLevels; ++round) {
+        marked.clear();
+        for (int t = 0; t < model.numTriangles(); ++t) {
+            for (int k = 0; k < 3; ++k) {
+                const int a = model.triangles[3 * t + k];
+                const int b = model.triangles[3 * t + (k + 1) % 3];
+                if (isLong(a, b)) {
+                    marked.push_back(edgeKey(a, b));
+                }
+            }
+        }
+        std::sort(marked.begin(), marked.end());
+        marked.erase(std::unique(marked.begin(), marked.end()), marked.end());
+        if (marked.empty()) {
+            break;
+        }
+
+        // Every split edge adds one node
+        if (static_cast<long long>(model.numNodes()) + static_cast<long long>(marked.size()) > options.maxNodes) {
+            m_lastError = QString("Element size %1 needs more than %2 nodes; increase the mesh size")
+                              .arg(options.elementSize).arg(options.maxNodes);
+            return false;
+        }
+
+        midpoints.clear();
+        midpoints.reserve(marked.size());
+        for (uint64_t key : marked) {
+            const int a = static_cast<int>(key >> 32);
+            const int b = static_cast<int>(key & 0xffffffffu);
+            midpoints.emplace(key, model.numNodes());
+            for (int c = 0; c < 3; ++c) {
+                model.nodeCoordinates.push_back(
+                    0.5 * (model.nodeCoordinates[3 * a + c] + model.nodeCoordinates[3 * b + c]));
+            }
+            model.nodeBodies.push_back(model.nodeBodies[a]);
+        }
+        auto midpoint = [&midpoints](int a, int b) {
+            auto it = midpoints.find(edgeKey(a, b));
+            return it == midpoints.end() ? -1 : it->second;
+        };
+
+        refined.clear();
+        refined.reserve(model.triangles.size() * 2);
+        for (int t = 0; t < model.numTriangles(); ++t) {
+            const int* v = &model.triangles[3 * t];
+            const int m[3] = { midpoint(v[0], v[1]), midpoint(v[1], v[2]), midpoint(v[2], v[0]) };
+            const int split = (m[0] >= 0) + (m[1] >= 0) + (m[2] >= 0);
+            if (split == 0) {
+                refined.insert(refined.end(), v, v + 3);
+            } else if (split == 3) {
+                const int children[12] = { v[0], m[0], m[2],  m[0], v[1], m[1],  m[2], m[1], v[2],  m[0], m[1], m[2] };
+                refined.insert(refined.end(), children, children + 12);
+            } else if (split == 1) {
+                // Bisect from the vertex opposite the split edge k
+                const int k = m[0] >= 0 ? 0 : (m[1] >= 0 ? 1 : 2);
+                const int a = v[k];
+                const int b = v[(k + 1) % 3];
+                const int c = v[(k + 2) % 3];
+                const int children[6] = { a, m[k], c,  m[k], b, c };
+                refined.insert(refined.end(), children, children + 6);
+            } else {
+                // Edge k = (a, b) is kept: cut off corner c, then split the
+                // quadrilateral a, b, mbc, mca along its shorter diagonal
+                const int k = m[0] < 0 ? 0 : (m[1] < 0 ? 1 : 2);
+                const int a = v[k];
+                const int b = v[(k + 1) % 3];
+                const int c = v[(k + 2) % 3];
+                const int mbc = m[(k + 1) % 3];
+                const int mca = m[(k + 2) % 3];
+                double diagonalA = 0.0;
+                double diagonalB = 0.0;
+                for (int i = 0; i < 3; ++i) {
+                    const double da = model.nodeCoordinates[3 * mbc + i] - model.nodeCoordinates[3 * a + i];
+                    const double db = model.nodeCoordinates[3 * mca + i] - model.nodeCoordinates[3 * b + i];
+                    diagonalA += da * da;
+                    diagonalB += db * db;
+                }
+                const int corner[3] = { mca, mbc, c };
+                refined.insert(refined.end(), corner, corner + 3);
+                if (diagonalA <= diagonalB) {
+                    const int children[6] = { a, b, mbc,  a, mbc, mca };
+                    refined.insert(refined.end(), children, children + 6);
+                } else {
+                    const int children[6] = { a, b, mca,  b, mbc, mca };
+                    refined.insert(refined.end(), children, children + 6);
+                }
+            }
+        }
+        model.triangles.swap(refined);
+    }
+    return true;
+}
+
+void MeshDiscretizer::buildEdges(StructuralModel& model)
+{
+    std::vector<uint64_t> keys;
+    keys.reserve(model.triangles.size());
+
+    for (int t = 0; t < model.numTriangles(); ++t) {
+        for (int k = 0; k < 3; ++k) {
+            keys.push_back(edgeKey(model.triangles[3 * t + k], model.triangles[3 * t + (k + 1) % 3]));
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    model.edges.clear();
+    model.edges.reserve(keys.size() * 2);
+    for (uint64_t key : keys) {
+        model.edges.push_back(static_cast<int>(key >> 32));
+        model.edges.push_back(static_cast<int>(key & 0xffffffffu));
+    }
+}
@@ -0,0 +1,776 @@
+#include "ModalAnalysis.h"
+#include "NodeOrdering.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+const int MaxRestarts = 20;         // Lanczos runs after the first one
+const double RestartNoise = 0.01;   // Random share of a restart vector
+const double MinShiftGap = 1e-6;    // Automatic shift gap below the lowest eigenvalue, relative to the spectrum width
+const int MaxInertiaRounds = 8;     // Lanczos rounds that add modes an inertia check found missing
+const long long MaxEnvelopeEntries = 20000000;  // Envelope of the inertia factorization (160 MB)
+
+// Eigenvalues and eigenvectors of a symmetric tridiagonal matrix by the
+// implicit QL method. d holds the diagonal, e[i] the entry coupling i and
+// i + 1. On return d holds the eigenvalues and column k of the row-major
+// n x n matrix z the eigenvector of d[k].
+bool tridiagonalEigen(int n, std::vector<double>& d, std::vector<double>& e, std::vector<double>& z)
+{
+    const double epsilon = std::numeric_limits<double>::epsilon();
+    z.assign(static_cast<size_t>(n) * n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        z[static_cast<size_t>(i) * n + i] = 1.0;
+    }
+    e.resize(n);
+    e[n - 1] = 0.0;
+
+    for (int l = 0; l < n; ++l) {
+        int iterations = 0;
+        int m;
+        do {
+            for (m = l; m < n - 1; ++m) {
+                const double dd = std::fabs(d[m]) + std::fabs(d[m + 1]);
+                if (std::fabs(e[m]) <= epsilon * dd) {
+                    break;
+                }
+            }
+            if (m == l) {
+                break;
+            }
+            if (++iterations > 60) {
+                return false;
+            }
+
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = std::hypot(g, 1.0);
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            double s = 1.0;
+            double c = 1.0;
+            double p = 0.0;
+            int i = m - 1;
+            for (; i >= l; --i) {
+                double f = s * e[i];
+                const double b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == 0.0) {
+                    d[i + 1] -= p;
+                    e[m] = 0.0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2.0 * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+                for (int k = 0; k < n; ++k) {
+                    double* row = &z[static_cast<size_t>(k) * n];
+                    f = row[i + 1];
+                    row[i + 1] = s * row[i] + c * f;
+                    row[i] = c * row[i] - s * f;
+                }
+            }
+            if (r == 0.0 && i >= l) {
+                continue;
+            }
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0.0;
+        } while (m != l);
+    }
+    return true;
+}
+
+// Gershgorin bounds on the eigenvalues of the symmetric form D A D (D = diag(scales))
+void gershgorinBounds(const SparseMatrix& matrix, const std::vector<double>& scales, double& lower, double& upper)
+{
+    const std::vector<int>& rows = matrix.rowPointers();
+    const std::vector<int>& columns = matrix.columnIndices();
+    const std::vector<double>& values = matrix.values();
+    lower = std::numeric_limits<double>::max();
+    upper = -lower;
+    for (int r = 0; r < matrix.size(); ++r) {
+        double diagonal = 0.0;
+        double radius = 0.0;
+        for (int k = rows[r]; k < rows[r + 1]; ++k) {
+            const double value = values[k] * scales[r] * scales[columns[k]];
+            if (columns[k] == r) {
+                diagonal = value;
+            } else {
+                radius += std::fabs(value);
+            }
+        }
+        lower = std::min(lower, diagonal - radius);
+        upper = std::max(upper, diagonal + radius);
+    }
+}
+
+// Number of eigenvalues of a symmetric matrix below mu, from the signs of
+// the pivots of an LDL^T factorization of matrix - mu I (Sylvester's law of
+// inertia). Rows are factored in the given order and stored as an envelope
+// (each row from its first nonzero column to the diagonal). Returns -1 if
+// the envelope would exceed maxEntries.
+int countEigenvaluesBelow(const SparseMatrix& matrix, const std::vector<int>& order, double mu, long long maxEntries)
+{
+    const std::vector<int>& rows = matrix.rowPointers();
+    const std::vector<int>& columns = matrix.columnIndices();
+    const std::vector<double>& values = matrix.values();
+    const int n = matrix.size();
+    std::vector<int> position(n);
+    for (int i = 0; i < n; ++i) {
+        position[order[i]] = i;
+    }
+
+    std::vector<int> first(n);
+    std::vector<long long> start(n + 1, 0);
+    double scale = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const int r = order[i];
+        first[i] = i;
+        for (int k = rows[r]; k < rows[r + 1]; ++k) {
+            first[i] = std::min(first[i], position[columns[k]]);
+            scale = std::max(scale, std::fabs(values[k]));
+        }
+        start[i + 1] = start[i] + (i - first[i] + 1);
+    }
+    if (start[n] > maxEntries) {
+        return -1;
+    }
+
+    std::vector<double> envelope(static_cast<size_t>(start[n]), 0.0);
+    for (int i = 0; i < n; ++i) {
+        const int r = order[i];
+        double* row = envelope.data() + start[i] - first[i];
+        for (int k = rows[r]; k < rows[r + 1]; ++k) {
+            const int j = position[columns[k]];
+            if (j <= i) {
+                row[j] += values[k];
+            }
+        }
+        row[i] -= mu;
+    }
+
+    // Row by row: g = L D is built in place, then scaled to L
+    std::vector<double> pivots(n);
+    const double tiny = std::numeric_limits<double>::epsilon() * std::max(scale, std::fabs(mu));
+    int negative = 0;
+    for (int i = 0; i < n; ++i) {
+        double* row = envelope.data() + start[i] - first[i];
+        double diagonal = row[i];
+        for (int j = first[i]; j < i; ++j) {
+            const double* other = envelope.data() + start[j] - first[j];
+            double g = row[j];
+            for (int k = std::max(first[i], first[j]); k < j; ++k) {
+                g -= row[k] * other[k];
+            }
+            row[j] = g;
+        }
+        for (int j = first[i]; j < i; ++j) {
+            const double l = row[j] / pivots[j];
+            diagonal -= row[j] * l;
+            row[j] = l;
+        }
+        if (std::fabs(diagonal) < tiny) {
+            diagonal = tiny;    // mu on an eigenvalue: counted as not below it
+        }
+        pivots[i] = diagonal;
+        negative += diagonal < 0.0;
+    }
+    return negative;
+}
+
+// M^-1/2 per DOF
+std::vector<double> massScales(const StructuralModel& model)
+{
+    std::vector<double> scales(model.masses.size());
+    for (size_t i = 0; i < scales.size(); ++i) {
+        scales[i] = 1.0 / std::sqrt(model.masses[i]);
+    }
+    return scales;
+}
+
+} // namespace
+
+ModalAnalysis::ModalAnalysis()
+    : m_model(nullptr)
+    , m_pool(nullptr)
+    , m_grain(1)
+    , m_size(0)
+    , m_shift(0.0)
+    , m_lanczosSteps(0)
+    , m_solverIterations(0)
+    , m_verified(false)
+{
+}
+
+template <typename Body>
+void ModalAnalysis::forEachChunk(int count, const Body& body) const
+{
+    if (m_pool) {
+        m_pool->parallelFor(0, count, m_grain, body);
+        return;
+    }
+    const int chunks = WorkStealingPool::chunkCount(0, count, m_grain);
+    for (int c = 0; c < chunks; ++c) {
+        body(c, c * m_grain, std::min((c + 1) * m_grain, count));
+    }
+}
+
+void ModalAnalysis::clear()
+{
+    m_model = nullptr;
+    m_size = 0;
+    m_eigenvalues.clear();
+    m_shapes = AlignedVector();
+    m_shift = 0.0;
+    m_lanczosSteps = 0;
+    m_verified = false;
+    m_solverIterations = 0;
+}
+
+bool ModalAnalysis::compute(const StructuralModel& model, const Options& options,
+                            WorkStealingPool* pool, int grain)
+{
+    clear();
+    m_lastError.clear();
+    m_pool = pool;
+    m_grain = std::max(grain, 1);
+
+    const int n = model.numDOF();
+    if (n == 0 || model.stiffness.size() != n || static_cast<int>(model.masses.size()) != n) {
+        m_lastError = "Modal analysis needs an assembled model";
+        return false;
+    }
+    const int wanted = std::min(std::max(options.modeCount, 1), n);
+    const int maxSteps = std::min(n, options.basisSize > 0 ? std::max(options.basisSize, wanted)
+                                                            : 2 * wanted + 40);
+
+    // Symmetric form A = M^-1/2 K M^-1/2; its eigenvectors y give phi = M^-1/2 y
+    const std::vector<double> scales = massScales(model);
+    double lower = 0.0;
+    double upper = 0.0;
+    gershgorinBounds(model.stiffness, scales, lower, upper);
+    double shift = options.shift >= 0.0 ? options.shift : 0.999 * std::max(lower, 0.0);
+    const double initialShift = shift;
+    SparseMatrix symmetric;
+    ConjugateGradient solver;
+    auto setupOperator = [&]() {
+        const std::vector<int>& rows = model.stiffness.rowPointers();
+        const std::vector<int>& columns = model.stiffness.columnIndices();
+        const std::vector<double>& values = model.stiffness.values();
+        std::vector<SparseMatrix::Triplet> triplets;
+        triplets.reserve(model.stiffness.nonZeros() + n);
+        for (int r = 0; r < n; ++r) {
+            for (int k = rows[r]; k < rows[r + 1]; ++k) {
+                triplets.push_back(SparseMatrix::Triplet(r, columns[k], values[k] * scales[r] * scales[columns[k]]));
+            }
+            triplets.push_back(SparseMatrix::Triplet(r, r, -shift));
+        }
+        symmetric = SparseMatrix::fromTriplets(n, triplets);
+        solver.setup(symmetric, options.preconditioner, pool, m_grain);
+    };
+    setupOperator();
+    const int solverIterations = options.solverIterations > 0 ? options.solverIterations : std::max(n, 100);
+
+    // Dot products summed per chunk, then in chunk order (same for any thread count)
+    const int chunks = WorkStealingPool::chunkCount(0, n, m_grain);
+    std::vector<double> partials(chunks);
+    auto dot = [&](const double* a, const double* b) {
+        forEachChunk(n, [&partials, a, b](int chunk, int begin, int end) {
+            double sum = 0.0;
+            for (int i = begin; i < end; ++i) {
+                sum += a[i] * b[i];
+            }
+            partials[chunk] = sum;
+        });
+        return std::accumulate(partials.begin(), partials.end(), 0.0);
+    };
+    auto axpy = [&](double alpha, const double* x, double* y) {
+        forEachChunk(n, [alpha, x, y](int, int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                y[i] += alpha * x[i];
+            }
+        });
+    };
+
+    // Converged modes are locked (kept out of later runs by reorthogonalization);
+    // a run that ends before all are found restarts from its unconverged Ritz vectors
+    AlignedVector basis(static_cast<size_t>(maxSteps + 1) * n);
+    AlignedVector locked(static_cast<size_t>(wanted) * n);
+    std::vector<double> lockedValues;
+    AlignedVector w(n);
+    std::vector<double> alphas;
+    std::vector<double> betas;
+    std::vector<double> ritz;
+    std::vector<double> vectors;
+    std::vector<double> offDiagonal;
+    std::vector<int> order;
+
+    auto normalize = [&](double* v) {
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t k = 0; k < lockedValues.size(); ++k) {
+                const double* y = locked.data() + k * n;
+                axpy(-dot(y, v), y, v);
+            }
+        }
+        const double norm = std::sqrt(dot(v, v));
+        if (norm <= 0.0) {
+            return false;
+        }
+        forEachChunk(n, [v, norm](int, int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                v[i] /= norm;
+            }
+        });
+        return true;
+    };
+
+    // Random start vectors from a fixed seed, so runs repeat exactly; drawn
+    // in the original numbering, so a renumbered model finds the same modes
+    std::mt19937 generator(12345);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::vector<double> draws(options.randomOrder ? n : 0);
+    auto randomVector = [&](double* v) {
+        if (options.randomOrder) {
+            for (int i = 0; i < n; ++i) {
+                draws[i] = uniform(generator);
+            }
+            for (int i = 0; i < n; ++i) {
+                v[i] = draws[options.randomOrder[i]];
+            }
+        } else {
+            for (int i = 0; i < n; ++i) {
+                v[i] = uniform(generator);
+            }
+        }
+        return normalize(v);
+    };
+    // Inertia counts (see countEigenvaluesBelow()) factor A in reverse
+    // Cuthill-McKee order, which keeps the envelope small
+    std::vector<int> dofOrder(n);
+    std::iota(dofOrder.begin(), dofOrder.end(), 0);
+    if (model.numDOF() == n && model.numEdges() > 0) {
+        const std::vector<int> nodes = NodeOrdering::compute(model, DofOrdering::ReverseCuthillMcKee);
+        const int d = model.dofsPerNode;
+        for (size_t k = 0; k < nodes.size(); ++k) {
+            for (int c = 0; c < d; ++c) {
+                dofOrder[k * d + c] = nodes[k] * d + c;
+            }
+        }
+    }
+    int totalSteps = 0;
+    double lastResidual = 0.0;          // Of the top Ritz value of the last check
+
+    // Lanczos runs until target modes are locked, each run restarting from the
+    // last one. Repair rounds keep the shift and lock whatever has converged at
+    // each check: a Krylov space holds one direction of a repeated eigenvalue,
+    // so every run adds about one copy. They lock only modes below ceiling,
+    // so the higher ones that converge alongside do not use up the target.
+    auto lanczos = [&](int target, bool repairing, double ceiling) {
+        locked.resize(static_cast<size_t>(target) * n);
+        const int restarts = MaxRestarts + (repairing ? target - static_cast<int>(lockedValues.size()) : 0);
+        for (int run = 0; run <= restarts && static_cast<int>(lockedValues.size()) < target; ++run) {
+            const int needed = target - static_cast<int>(lockedValues.size());
+            const int available = n - static_cast<int>(lockedValues.size());
+            const int runSteps = std::min(maxSteps, available);
+            alphas.clear();
+            betas.clear();
+
+            int steps = 0;
+            int converged = 0;
+            bool exhausted = false;
+            while (steps < runSteps) {
+                const double* q = basis.data() + static_cast<size_t>(steps) * n;
+
+                // w = (A - sigma I)^-1 q
+                std::fill(w.begin(), w.end(), 0.0);
+                const ConjugateGradient::Result result = solver.solve(q, w.data(), solverIterations, options.solverTolerance);
+                m_solverIterations += result.iterations;
+                if (!result.converged) {
+                    m_lastError = "Shift-invert solve did not converge (residual " + std::to_string(result.residual) + ")";
+                    return false;
+                }
+
+                // Full reorthogonalization against the locked modes and the basis, twice (classical Gram-Schmidt)
+                const double alpha = dot(q, w.data());
+                for (int pass = 0; pass < 2; ++pass) {
+                    for (size_t k = 0; k < lockedValues.size(); ++k) {
+                        const double* y = locked.data() + k * n;
+                        axpy(-dot(y, w.data()), y, w.data());
+                    }
+                    for (int j = 0; j <= steps; ++j) {
+                        const double* v = basis.data() + static_cast<size_t>(j) * n;
+                        axpy(-dot(v, w.data()), v, w.data());
+                    }
+                }
+                const double beta = std::sqrt(dot(w.data(), w.data()));
+                alphas.push_back(alpha);
+                betas.push_back(beta);
+                ++steps;
+                ++totalSteps;
+
+                // An invariant subspace (or the whole remaining space) gives exact pairs
+                exhausted = beta <= 1e-12 * std::fabs(alpha) || steps == available;
+                if (!exhausted) {
+                    double* next = basis.data() + static_cast<size_t>(steps) * n;
+                    forEachChunk(n, [&w, next, beta](int, int begin, int end) {
+                        for (int i = begin; i < end; ++i) {
+                            next[i] = w[i] / beta;
+                        }
+                    });
+                }
+
+                // Ritz pairs of T every few steps once enough could have converged
+                const bool last = exhausted || steps == runSteps;
+                if (!last && (steps < (repairing ? 1 : needed) || steps % 10 != 0)) {
+                    continue;
+                }
+                ritz = alphas;
+                offDiagonal.assign(betas.begin(), betas.end() - 1);
+                if (!tridiagonalEigen(steps, ritz, offDiagonal, vectors)) {
+                    m_lastError = "Tridiagonal eigenvalue iteration did not converge";
+                    return false;
+                }
+
+                // Largest Ritz values of (A - sigma I)^-1 are the lowest eigenvalues; count the converged prefix
+                order.resize(steps);
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [&ritz](int a, int b) { return ritz[a] > ritz[b]; });
+                lastResidual = exhausted ? 0.0 : beta * std::fabs(vectors[static_cast<size_t>(steps - 1) * steps + order[0]]);
+                converged = 0;
+                for (int k = 0; k < std::min(needed, steps); ++k) {
+                    const int column = order[k];
+                    const double residual = exhausted ? 0.0
+                        : beta * std::fabs(vectors[static_cast<size_t>(steps - 1) * steps + column]);
+                    if (ritz[column] <= 0.0 || residual > options.tolerance * ritz[column]
+                        || shift + 1.0 / ritz[column] >= ceiling) {
+                        break;
+                    }
+                    ++converged;
+                }
+                if (converged == needed || last || (repairing && converged > 0)) {
+                    break;
+                }
+            }
+
+            // Ritz vectors y = Q s: lock the converged ones, restart from the sum of the next ones
+            auto ritzVector = [&](int column, double* y) {
+                std::fill(y, y + n, 0.0);
+                for (int j = 0; j < steps; ++j) {
+                    axpy(vectors[static_cast<size_t>(j) * steps + column], basis.data() + static_cast<size_t>(j) * n, y);
+                }
+            };
+            for (int k = 0; k < converged; ++k) {
+                ritzVector(order[k], locked.data() + lockedValues.size() * n);
+                lockedValues.push_back(shift + 1.0 / ritz[order[k]]);
+            }
+            if (exhausted || converged == needed) {
+                break;
+            }
+            const int restartEnd = std::min(needed, steps);
+            double* scratch = locked.data() + lockedValues.size() * n;     // Free slot, since converged < needed
+            std::fill(w.begin(), w.end(), 0.0);
+            for (int k = converged; k < restartEnd; ++k) {
+                ritzVector(order[k], scratch);
+                axpy(1.0, scratch, w.data());
+            }
+            // A little random noise reaches the copies of repeated eigenvalues, which
+            // a single Krylov space holds only one direction of
+            if (!normalize(w.data()) || !randomVector(scratch)) {
+                break;
+            }
+            axpy(RestartNoise, scratch, w.data());
+
+            // Move an automatic shift up to just below the lowest eigenvalue: the
+            // Gershgorin bound is loose, and a far shift leaves the clustered lowest
+            // eigenvalues too close together to converge. The lowest locked mode is
+            // exact; otherwise the top Ritz value bounds it from above and its
+            // residual says how far below it may lie.
+            if (options.shift < 0.0 && !repairing) {
+                double lowest = 0.0;
+                double margin = 0.0;
+                if (!lockedValues.empty()) {
+                    lowest = *std::min_element(lockedValues.begin(), lockedValues.end());
+                    margin = 0.1 * (shift + 1.0 / ritz[order[restartEnd - 1]] - lowest);
+                } else {
+                    const double theta = ritz[order[0]];
+                    lowest = shift + 1.0 / theta;
+                    margin = 4.0 * lastResidual / (theta * theta);
+                }
+                // Never closer than MinShiftGap of the spectrum width, which bounds the condition of A - sigma I
+                const double candidate = lowest - std::max(margin, MinShiftGap * (upper - lowest));
+                // Never past an eigenvalue that no run has found yet (unknown if too large to count)
+                if (candidate > shift + 0.5 * (lowest - shift)
+                    && countEigenvaluesBelow(symmetric, dofOrder, candidate - shift, MaxEnvelopeEntries) <= 0) {
+                    shift = candidate;
+                    setupOperator();
+                }
+            }
+            std::copy(w.begin(), w.end(), basis.begin());
+            if (!normalize(basis.data())) {
+                break;
+            }
+        }
+
+        return true;
+    };
+    randomVector(basis.data());
+    if (!lanczos(wanted, false, std::numeric_limits<double>::infinity())) {
+        clear();
+        return false;
+    }
+    if (lockedValues.empty()) {
+        m_lastError = "No mode converged within " + std::to_string(totalSteps) + " Lanczos steps";
+        clear();
+        return false;
+    }
+
+    // Inertia check: the LDL^T pivots of A - mu I count the eigenvalues below
+    // mu, just under the cluster of the highest returned mode. Each one must
+    // have been locked; missing ones (copies of repeated eigenvalues, common
+    // on flat or symmetric models) start another round.
+    std::vector<double> sorted;
+    for (int round = 0; ; ++round) {
+        sorted = lockedValues;
+        std::sort(sorted.begin(), sorted.end());
+        const double top = sorted[std::min(wanted, static_cast<int>(sorted.size())) - 1];
+        const double mu = top - std::max(1e-6 * (top - shift), 1e-9 * upper);
+        const int count = countEigenvaluesBelow(symmetric, dofOrder, mu - shift, MaxEnvelopeEntries);
+        if (count < 0) {
+            std::cout << "[ModalAnalysis] Inertia check skipped (factorization envelope above "
+                      << MaxEnvelopeEntries << " entries); copies of repeated eigenvalues may be missing" << std::endl;
+            break;
+        }
+        const int missing = count - static_cast<int>(std::lower_bound(sorted.begin(), sorted.end(), mu) - sorted.begin());
+        if (missing == 0) {
+            m_verified = true;
+            break;
+        }
+        if (missing < 0 || round == MaxInertiaRounds) {
+            m_lastError = "Inertia check failed: " + std::to_string(count) + " eigenvalues lie below "
+                        + std::to_string(mu) + " but " + std::to_string(count - missing) + " modes were found";
+            clear();
+            return false;
+        }
+        std::cout << "[ModalAnalysis] Inertia check: " << missing << " modes below " << mu
+                  << " not found (repeated eigenvalues), searching again" << std::endl;
+
+        // A moved shift may lie above a missed mode; go back to the safe one
+        if (countEigenvaluesBelow(symmetric, dofOrder, 0.0, MaxEnvelopeEntries) > 0) {
+            if (options.shift >= 0.0) {
+                m_lastError = "Shift " + std::to_string(shift) + " lies above the lowest eigenvalue";
+                clear();
+                return false;
+            }
+            shift = initialShift;
+            setupOperator();
+        }
+        if (!randomVector(basis.data())
+            || !lanczos(static_cast<int>(lockedValues.size()) + std::min(missing, wanted), true, mu)) {
+            if (m_lastError.empty()) {
+                m_lastError = "No start vector outside the locked modes";
+            }
+            clear();
+            return false;
+        }
+    }
+
+    m_lanczosSteps = totalSteps;
+    const int found = std::min(static_cast<int>(lockedValues.size()), wanted);
+    if (found < wanted) {
+        std::cout << "[ModalAnalysis] " << found << " of " << wanted << " modes converged within "
+                  << totalSteps << " Lanczos steps" << std::endl;
+    }
+
+    // Lowest eigenvalues in ascending order, mass-normalized shapes phi = M^-1/2 y
+    order.resize(lockedValues.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&lockedValues](int a, int b) { return lockedValues[a] < lockedValues[b]; });
+    m_size = n;
+    m_model = &model;
+    m_shift = shift;
+    m_eigenvalues.resize(found);
+    m_shapes.assign(static_cast<size_t>(found) * n, 0.0);
+    for (int k = 0; k < found; ++k) {
+        m_eigenvalues[k] = lockedValues[order[k]];
+        const double* y = locked.data() + static_cast<size_t>(order[k]) * n;
+        double* shape = m_shapes.data() + static_cast<size_t>(k) * n;
+
+        // Sign convention: the largest entry is positive
+        int largest = 0;
+        for (int i = 0; i < n; ++i) {
+            if (std::fabs(y[i]) > std::fabs(y[largest])) {
+                largest = i;
+            }
+        }
+        const double sign = y[largest] < 0.0 ? -1.0 : 1.0;
+        for (int i = 0; i < n; ++i) {
+            shape[i] = sign * y[i] * scales[i];
+        }
+    }
+    return true;
+}
+
+double ModalAnalysis::angularFrequency(int mode) const
+{
+    return std::sqrt(std::max(m_eigenvalues[mode], 0.0));
+}
+
+double ModalAnalysis::frequency(int mode) const
+{
+    return angularFrequency(mode) / (2.0 * Pi);
+}
+
+void ModalAnalysis::project(const double* u, double* q) const
+{
+    // One partial per chunk and mode, added in chunk order
+    const int modes = modeCount();
+    const int chunks = WorkStealingPool::chunkCount(0, m_size, m_grain);
+    std::vector<double> partials(static_cast<size_t>(chunks) * modes);
+    const double* masses = m_model->masses.data();
+    forEachChunk(m_size, [this, u, masses, modes, &partials](int chunk, int begin, int end) {
+        for (int k = 0; k < modes; ++k) {
+            const double* shape = modeShape(k);
+            double sum = 0.0;
+            for (int i = begin; i < end; ++i) {
+                sum += shape[i] * masses[i] * u[i];
+            }
+            partials[static_cast<size_t>(chunk) * modes + k] = sum;
+        }
+    });
+    for (int k = 0; k < modes; ++k) {
+        q[k] = 0.0;
+        for (int c = 0; c < chunks; ++c) {
+            q[k] += partials[static_cast<size_t>(c) * modes + k];
+        }
+    }
+}
+
+void ModalAnalysis::expand(const double* q, double* u) const
+{
+    const int modes = modeCount();
+    forEachChunk(m_size, [this, q, u, modes](int, int begin, int end) {
+        std::fill(u + begin, u + end, 0.0);
+        for (int k = 0; k < modes; ++k) {
+            const double* shape = modeShape(k);
+            const double qk = q[k];
+            for (int i = begin; i < end; ++i) {
+                u[i] += qk * shape[i];
+            }
+        }
+    });
+}
+
+double ModalAnalysis::estimateHighestEigenvalue(const StructuralModel& model, int steps)
+{
+    const int n = model.numDOF();
+    if (n == 0 || model.stiffness.size() != n) {
+        return 0.0;
+    }
+    const std::vector<double> scales = massScales(model);
+    double lower = 0.0;
+    double bound = 0.0;
+    gershgorinBounds(model.stiffness, scales, lower, bound);
+    steps = std::min(std::max(steps, 1), n);
+
+    // Plain Lanczos on M^-1/2 K M^-1/2; the largest Ritz value converges first
+    std::vector<double> previous(n, 0.0);
+    std::vector<double> current(n);
+    std::vector<double> scaled(n);
+    std::vector<double> product(n);
+    for (int i = 0; i < n; ++i) {
+        current[i] = 1.0 + 0.5 * std::sin(0.7 * i);
+    }
+    double norm = std::sqrt(std::inner_product(current.begin(), current.end(), current.begin(), 0.0));
+    for (double& value : current) {
+        value /= norm;
+    }
+
+    std::vector<double> alphas;
+    std::vector<double> betas;
+    double beta = 0.0;
+    for (int j = 0; j < steps; ++j) {
+        for (int i = 0; i < n; ++i) {
+            scaled[i] = scales[i] * current[i];
+        }
+        model.stiffness.multiply(scaled.data(), product.data());
+        for (int i = 0; i < n; ++i) {
+            product[i] *= scales[i];
+        }
+        const double alpha = std::inner_product(current.begin(), current.end(), product.begin(), 0.0);
+        for (int i = 0; i < n; ++i) {
+            product[i] -= alpha * current[i] + beta * previous[i];
+        }
+        beta = std::sqrt(std::inner_product(product.begin(), product.end(), product.begin(), 0.0));
+        alphas.push_back(alpha);
+        betas.push_back(beta);
+        if (beta <= 1e-12 * std::fabs(alpha)) {
+            break;
+        }
+        previous.swap(current);
+        for (int i = 0; i < n; ++i) {
+            current[i] = product[i] / beta;
+        }
+    }
+
+    const int m = static_cast<int>(alphas.size());
+    std::vector<double> ritz = alphas;
+    std::vector<double> offDiagonal(betas.begin(), betas.end() - 1);
+    std::vector<double> vectors;
+    if (!tridiagonalEigen(m, ritz, offDiagonal, vectors)) {
+        return bound;
+    }
+    const int largest = static_cast<int>(std::max_element(ritz.begin(), ritz.end()) - ritz.begin());
+    const double residual = betas.back() * std::fabs(vectors[static_cast<size_t>(m - 1) * m + largest]);
+    return std::min(ritz[largest] + residual, bound);
+}
+
+double ModalAnalysis::criticalTimeStep(IntegratorType type, double highestEigenvalue, double dampingRatio)
+{
+    // omega dt limit of the scheme on the undamped oscillator (imaginary axis)
+    double limit;
+    switch (type) {
+        case IntegratorType::SymplecticEuler:
+        case IntegratorType::VelocityVerlet:
+        case IntegratorType::Newmark:
+            limit = 2.0;
+            break;
+        case IntegratorType::RungeKutta4:
+        case IntegratorType::DormandPrince54:       // Conservative for Dormand-Prince
+            limit = 2.0 * std::sqrt(2.0);
+            break;
+        default:
+            return 0.0;                             // Implicit and modal: any step is stable
+    }
+    if (highestEigenvalue <= 0.0) {
+        return 0.0;
+    }
+
+    // Central difference with damping ratio xi: omega dt <= 2 (sqrt(1 + xi^2) - xi)
+    const double xi = std::max(dampingRatio, 0.0);
+    return limit * (std::sqrt(1.0 + xi * xi) - xi) / std::sqrt(highestEigenvalue);
+}
+
+double ModalAnalysis::suggestTimeStep(const StructuralModel& model, const SimulationParameters& params, double safety)
+{
+    const double highest = estimateHighestEigenvalue(model);
+    if (highest <= 0.0) {
+        return 0.0;
+    }
+
+    // Damping force c v per DOF: xi = c / (2 m omega), largest for the lightest DOF
+    double lightest = model.masses.empty() ? 1.0 : model.masses.front();
+    for (double mass : model.masses) {
+        lightest = std::min(lightest, mass);
+    }
+    const double xi = params.damping / (2.0 * lightest * std::sqrt(highest));
+    return safety * criticalTimeStep(params.integrator, highest, xi);
+}
@@ -0,0 +1,247 @@
+#include "MonteCarloEnsemble.h"
+#include "AlignedAllocator.h"
+#include "SettlingTracker.h"
+#include "SolverKernels.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+double MonteCarloEnsemble::Distribution::sample(std::mt19937_64& random) const
+{
+    switch (kind) {
+        case Kind::Uniform:
+            return std::uniform_real_distribution<double>(first, second)(random);
+        case Kind::Normal:
+            return std::normal_distribution<double>(first, second)(random);
+        default:
+            return first;
+    }
+}
+
+namespace {
+
+void checkDistribution(const MonteCarloEnsemble::Distribution& distribution, const char* name)
+{
+    typedef MonteCarloEnsemble::Distribution::Kind Kind;
+    if (distribution.kind == Kind::Normal && !(distribution.second > 0.0)) {
+        throw std::runtime_error(std::string("Ensemble ") + name
+                                 + ": normal distribution needs a positive standard deviation");
+    }
+    if (distribution.kind == Kind::Uniform && !(distribution.first <= distribution.second)) {
+        throw std::runtime_error(std::string("Ensemble ") + name + ": uniform distribution needs low <= high");
+    }
+}
+
+} // namespace
+
+MonteCarloEnsemble::MonteCarloEnsemble(const Options& options)
+    : m_options(options)
+    , m_cancelled(false)
+{
+}
+
+void MonteCarloEnsemble::checkOptions(const Options& options)
+{
+    if (options.base.integrator != IntegratorType::SymplecticEuler) {
+        throw std::runtime_error("Ensemble members are stepped with symplectic Euler; select that integrator");
+    }
+    if (!(options.base.timeStep > 0.0)) {
+        throw std::runtime_error("Ensemble needs a positive time step");
+    }
+    checkDistribution(options.damping, "damping");
+    checkDistribution(options.stiffness, "stiffness");
+    checkDistribution(options.amplitude, "amplitude");
+    if (!(options.positionNoise >= 0.0)) {
+        throw std::runtime_error("Ensemble position noise must not be negative");
+    }
+}
+
+void MonteCarloEnsemble::sampleMembers(int numDOF, std::vector<double>& initialPositions)
+{
+    std::mt19937_64 random(m_options.seed);
+
+    m_members.assign(std::max(m_options.members, 0), Member());
+    initialPositions.assign(m_members.size() * numDOF, 0.0);
+
+    for (size_t m = 0; m < m_members.size(); ++m) {
+        Member& member = m_members[m];
+        member.damping = std::max(m_options.damping.sample(random), 0.0);
+        do {
+            member.stiffness = m_options.stiffness.sample(random);
+        } while (!(member.stiffness > 0.0));
+        member.amplitude = m_options.amplitude.sample(random);
+
+        // Nominal shape of SimulationSolver, scaled and perturbed per member
+        double* x0 = initialPositions.data() + m * numDOF;
+        for (int i = 0; i < numDOF; ++i) {
+            x0[i] = member.amplitude * StructuralModel::initialDisplacement(i);
+        }
+        // A normal distribution needs a positive deviation, so no noise means none is built
+        if (m_options.positionNoise > 0.0) {
+            std::normal_distribution<double> noise(0.0, m_options.positionNoise);
+            for (int i = 0; i < numDOF; ++i) {
+                x0[i] += noise(random);
+            }
+        }
+    }
+}
+
+bool MonteCarloEnsemble::run(const StructuralModel& model)
+{
+    checkOptions(m_options);
+    m_cancelled = false;
+
+    // Unit stiffness: K scales linearly with the coefficient, so members scale it per lane
+    StructuralModel unitModel = model;
+    unitModel.assemble(1.0);
+    const int numDOF = unitModel.numDOF();
+
+    std::vector<double> initialPositions;
+    sampleMembers(numDOF, initialPositions);
+
+    const int lanes = SolverKernels::EnsembleLanes;
+    const int batches = (static_cast<int>(m_members.size()) + lanes - 1) / lanes;
+    if (batches == 0) {
+        return true;
+    }
+
+    const int numThreads = std::min(WorkStealingPool::resolveThreadCount(m_options.maxConcurrent), batches);
+    std::cout << "[MonteCarloEnsemble] " << m_members.size() << " members in " << batches
+              << " batches of " << lanes << " (" << SolverKernels::isaName(SolverKernels::kernels().isa)
+              << ") on " << numThreads << " threads" << std::endl;
+
+    WorkStealingPool pool(numThreads);
+    pool.parallelFor(0, batches, 1, [&](int, int begin, int end) {
+        for (int batch = begin; batch < end; ++batch) {
+            runBatch(unitModel, initialPositions, batch);
+        }
+    });
+
+    return !m_cancelled;
+}
+
+void MonteCarloEnsemble::runBatch(const StructuralModel& model, const std::vector<double>& initialPositions,
+                                  int batch)
+{
+    const int lanes = SolverKernels::EnsembleLanes;
+    const int numDOF = model.numDOF();
+    const int first = batch * lanes;
+    const int active = std::min(lanes, static_cast<int>(m_members.size()) - first);
+
+    // Interleaved state; unused lanes of the last batch stay at rest
+    AlignedVector positions(static_cast<size_t>(numDOF) * lanes, 0.0);
+    AlignedVector nextPositions(positions.size(), 0.0);
+    AlignedVector velocities(positions.size(), 0.0);
+    AlignedVector accelerations(positions.size(), 0.0);
+    AlignedVector inverseMasses(numDOF);
+    AlignedVector stiffnesses(lanes, 1.0);
+    AlignedVector dampings(lanes, 0.0);
+    AlignedVector energies(lanes, 0.0);
+
+    for (int i = 0; i < numDOF; ++i) {
+        inverseMasses[i] = 1.0 / model.masses[i];
+    }
+    for (int m = 0; m < active; ++m) {
+        stiffnesses[m] = m_members[first + m].stiffness;
+        dampings[m] = m_members[first + m].damping;
+        const double* x0 = initialPositions.data() + static_cast<size_t>(first + m) * numDOF;
+        for (int i = 0; i < numDOF; ++i) {
+            positions[i * lanes + m] = x0[i];
+        }
+    }
+
+    const SparseMatrix& k = model.stiffness;
+    SolverKernels::EnsembleArgs args;
+    args.begin = 0;
+    args.end = numDOF;
+    args.rowPointers = k.rowPointers().data();
+    args.columnIndices = k.columnIndices().data();
+    args.values = k.values().data();
+    args.inverseMasses = inverseMasses.data();
+    args.stiffnesses = stiffnesses.data();
+    args.dampings = dampings.data();
+    args.velocities = velocities.data();
+    args.accelerations = accelerations.data();
+    args.timeStep = m_options.base.timeStep;
+    void (*step)(const SolverKernels::EnsembleArgs&) = SolverKernels::kernels().ensembleSymplecticEulerStep;
+
+    std::vector<SettlingTracker> trackers(active, SettlingTracker(m_options.settlingBand));
+    for (int m = 0; m < active; ++m) {
+        trackers[m].add(0.0, SettlingTracker::maxAbs(positions.data() + m, numDOF, lanes));
+    }
+
+    const int totalSteps = static_cast<int>(m_options.base.totalTime / m_options.base.timeStep);
+    for (int n = 1; n <= totalSteps && !m_cancelled; ++n) {
+        args.positions = positions.data();
+        args.nextPositions = nextPositions.data();
+        step(args);
+        positions.swap(nextPositions);
+
+        const double time = n * m_options.base.timeStep;
+        for (int m = 0; m < active; ++m) {
+            trackers[m].add(time, SettlingTracker::maxAbs(positions.data() + m, numDOF, lanes));
+        }
+    }
+
+    // A zero-length step evaluates the energy of the final state without moving it
+    args.positions = positions.data();
+    args.nextPositions = nextPositions.data();
+    args.energies = energies.data();
+    args.timeStep = 0.0;
+    step(args);
+
+    for (int m = 0; m < active; ++m) {
+        Member& member = m_members[first + m];
+        member.peakDisplacement = trackers[m].peak();
+        member.settlingTime = trackers[m].settlingTime();
+        member.finalEnergy = energies[m];
+    }
+}
+
+MonteCarloEnsemble::Statistics MonteCarloEnsemble::statistics(double Member::* metric) const
+{
+    Statistics stats;
+    if (m_members.empty()) {
+        return stats;
+    }
+
+    stats.min = m_members.front().*metric;
+    stats.max = stats.min;
+    double sum = 0.0;
+    for (const Member& member : m_members) {
+        const double value = member.*metric;
+        sum += value;
+        stats.min = std::min(stats.min, value);
+        stats.max = std::max(stats.max, value);
+    }
+    stats.mean = sum / m_members.size();
+
+    double squares = 0.0;
+    for (const Member& member : m_members) {
+        const double deviation = member.*metric - stats.mean;
+        squares += deviation * deviation;
+    }
+    stats.stddev = m_members.size() > 1 ? std::sqrt(squares / (m_members.size() - 1)) : 0.0;
+    return stats;
+}
+
+bool MonteCarloEnsemble::saveResults(const std::string& path) const
+{
+    std::ofstream out(path.c_str());
+    if (!out) {
+        return false;
+    }
+
+    out << std::setprecision(17);
+    out << "member,damping,stiffness,amplitude,peakDisplacement,settlingTime,finalEnergy\n";
+    for (size_t m = 0; m < m_members.size(); ++m) {
+        const Member& r = m_members[m];
+        out << m << ',' << r.damping << ',' << r.stiffness << ',' << r.amplitude << ','
+            << r.peakDisplacement << ',' << r.settlingTime << ',' << r.finalEnergy << '\n';
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,457 @@
+#include "NewtonSolver.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sufficient decrease of |R| a line search step must reach (Armijo constant)
+const double SufficientDecrease = 1e-4;
+
+// Offset of column col in row row of a CSR matrix (the entry must exist)
+int entryOffset(const SparseMatrix& matrix, int row, int col)
+{
+    const std::vector<int>& rowPtr = matrix.rowPointers();
+    const std::vector<int>& cols = matrix.columnIndices();
+    return static_cast<int>(std::lower_bound(cols.begin() + rowPtr[row], cols.begin() + rowPtr[row + 1], col)
+                            - cols.begin());
+}
+
+} // namespace
+
+NewtonSolver::NewtonSolver()
+    : m_model(nullptr)
+    , m_contact(nullptr)
+    , m_contactForces(nullptr)
+    , m_pool(nullptr)
+    , m_grain(1)
+    , m_nodeGrain(1)
+    , m_dofsPerNode(3)
+    , m_grounding(0.0)
+    , m_coupling(0.0)
+    , m_damping(0.0)
+    , m_dampingScale(0.0)
+    , m_stiffnessScale(0.0)
+    , m_tangentCurrent(false)
+    , m_definiteTangent(false)
+{
+}
+
+void NewtonSolver::setup(const StructuralModel& model, double stiffnessCoefficient, double damping,
+                         double dampingScale, double stiffnessScale, const Options& options,
+                         const double* displacements, ContactDetector* contact, double* contactForces,
+                         WorkStealingPool* pool, int grain)
+{
+    clear();
+    m_model = &model;
+    m_contact = (contact && contact->isEnabled()) ? contact : nullptr;
+    m_contactForces = m_contact ? contactForces : nullptr;
+    m_pool = pool;
+    m_grain = std::max(grain, 1);
+    m_dofsPerNode = model.dofsPerNode;
+    m_nodeGrain = std::max(m_grain / m_dofsPerNode, 1);
+    m_options = options;
+    m_grounding = StructuralModel::groundingStiffness(stiffnessCoefficient);
+    m_coupling = StructuralModel::couplingStiffness(stiffnessCoefficient);
+    m_damping = damping;
+    m_dampingScale = dampingScale;
+    m_stiffnessScale = stiffnessScale;
+
+    const int d = m_dofsPerNode;
+    const int nodes = model.numNodes();
+    const int edges = model.numEdges();
+    const int n = model.numDOF();
+
+    // Rest geometry of the springs (zero-length edges carry no spring, as in assemble())
+    m_restLengths.assign(edges, 0.0);
+    m_restDirections.assign(3 * static_cast<size_t>(edges), 0.0);
+    for (int e = 0; e < edges; ++e) {
+        const int a = model.edges[2 * e];
+        const int b = model.edges[2 * e + 1];
+        double length = 0.0;
+        for (int c = 0; c < 3; ++c) {
+            const double delta = model.nodeCoordinates[3 * b + c] - model.nodeCoordinates[3 * a + c];
+            m_restDirections[3 * e + c] = delta;
+            length += delta * delta;
+        }
+        length = std::sqrt(length);
+        if (length > 0.0) {
+            for (int c = 0; c < 3; ++c) {
+                m_restDirections[3 * e + c] /= length;
+            }
+        }
+        // Scalar chains couple neighbours whatever their spacing
+        m_restLengths[e] = (d == 1) ? 1.0 : length;
+    }
+
+    // Incident edges per node
+    m_nodeEdgePointers.assign(static_cast<size_t>(nodes) + 1, 0);
+    for (int e = 0; e < edges; ++e) {
+        m_nodeEdgePointers[model.edges[2 * e] + 1]++;
+        m_nodeEdgePointers[model.edges[2 * e + 1] + 1]++;
+    }
+    for (int p = 0; p < nodes; ++p) {
+        m_nodeEdgePointers[p + 1] += m_nodeEdgePointers[p];
+    }
+    m_nodeEdges.resize(m_nodeEdgePointers[nodes]);
+    std::vector<int> fill(m_nodeEdgePointers.begin(), m_nodeEdgePointers.end() - 1);
+    for (int e = 0; e < edges; ++e) {
+        m_nodeEdges[fill[model.edges[2 * e]]++] = e;
+        m_nodeEdges[fill[model.edges[2 * e + 1]]++] = e;
+    }
+
+    // Jacobian pattern: full node blocks, so rotated springs never need new entries
+    std::vector<SparseMatrix::Triplet> triplets;
+    triplets.reserve((static_cast<size_t>(nodes) + 2 * static_cast<size_t>(edges)) * d * d);
+    for (int p = 0; p < nodes; ++p) {
+        for (int r = 0; r < d; ++r) {
+            for (int c = 0; c < d; ++c) {
+                triplets.push_back(SparseMatrix::Triplet(p * d + r, p * d + c, 0.0));
+            }
+        }
+    }
+    for (int e = 0; e < edges; ++e) {
+        const int a = model.edges[2 * e];
+        const int b = model.edges[2 * e + 1];
+        for (int r = 0; r < d; ++r) {
+            for (int c = 0; c < d; ++c) {
+                triplets.push_back(SparseMatrix::Triplet(a * d + r, b * d + c, 0.0));
+                triplets.push_back(SparseMatrix::Triplet(b * d + r, a * d + c, 0.0));
+            }
+        }
+    }
+    m_jacobian = SparseMatrix::fromTriplets(n, triplets);
+
+    m_diagonalOffsets.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_diagonalOffsets[i] = entryOffset(m_jacobian, i, (i / d) * d);
+    }
+    m_edgeOffsets.resize(2 * static_cast<size_t>(edges) * d);
+    for (int e = 0; e < edges; ++e) {
+        const int a = model.edges[2 * e];
+        const int b = model.edges[2 * e + 1];
+        for (int r = 0; r < d; ++r) {
+            m_edgeOffsets[(2 * e) * d + r] = entryOffset(m_jacobian, a * d + r, b * d);
+            m_edgeOffsets[(2 * e + 1) * d + r] = entryOffset(m_jacobian, b * d + r, a * d);
+        }
+    }
+
+    m_edgeForces.assign(static_cast<size_t>(edges) * d, 0.0);
+    m_edgeTangents.assign(static_cast<size_t>(edges) * d * d, 0.0);
+    m_edgeEnergies.assign(edges, 0.0);
+    m_potential.assign(n, 0.0);
+    m_positions.assign(n, 0.0);
+    m_velocities.assign(n, 0.0);
+    m_forces.assign(n, 0.0);
+    m_residual.assign(n, 0.0);
+    m_correction.assign(n, 0.0);
+    m_trial.assign(n, 0.0);
+    m_partials.assign(4 * static_cast<size_t>(WorkStealingPool::chunkCount(0, n, m_grain)), 0.0);
+
+    // First Jacobian at the given state
+    evaluate(displacements, nullptr, m_forces.data(), true);
+    m_linearSolver.setup(m_jacobian, m_options.preconditioner, m_pool, m_grain);
+    m_tangentCurrent = true;
+}
+
+void NewtonSolver::clear()
+{
+    *this = NewtonSolver();
+}
+
+template <typename Body>
+void NewtonSolver::forEachChunk(int count, int grain, const Body& body)
+{
+    if (m_pool) {
+        m_pool->parallelFor(0, count, grain, body);
+        return;
+    }
+    const int chunks = WorkStealingPool::chunkCount(0, count, grain);
+    for (int c = 0; c < chunks; ++c) {
+        body(c, c * grain, std::min((c + 1) * grain, count));
+    }
+}
+
+void NewtonSolver::computeForces(const double* x, const double* v, double* f)
+{
+    evaluate(x, v, f, false);
+}
+
+void NewtonSolver::evaluate(const double* x, const double* v, double* f, bool formTangent)
+{
+    SIMTOOL_PROFILE_SCOPE(Forces);
+
+    const int d = m_dofsPerNode;
+    const StructuralModel& model = *m_model;
+    const int* edges = model.edges.data();
+    const double* coordinates = model.nodeCoordinates.data();
+
+    // Pass 1, per edge: axial force, energy and tangent block in the current configuration
+    forEachChunk(model.numEdges(), m_grain, [=](int, int begin, int end) {
+        for (int e = begin; e < end; ++e) {
+            double* force = &m_edgeForces[static_cast<size_t>(e) * d];
+            double* tangent = &m_edgeTangents[static_cast<size_t>(e) * d * d];
+            const double restLength = m_restLengths[e];
+            const int a = edges[2 * e];
+            const int b = edges[2 * e + 1];
+
+            if (restLength <= 0.0) {
+                std::fill(force, force + d, 0.0);
+                std::fill(tangent, tangent + d * d, 0.0);
+                m_edgeEnergies[e] = 0.0;
+                continue;
+            }
+
+            if (d == 1) {
+                const double stretch = x[b] - x[a];
+                force[0] = m_coupling * stretch;
+                tangent[0] = m_coupling;
+                m_edgeEnergies[e] = 0.5 * m_coupling * stretch * stretch;
+                continue;
+            }
+
+            double dir[3];
+            double length = 0.0;
+            for (int c = 0; c < 3; ++c) {
+                dir[c] = coordinates[3 * b + c] + x[3 * b + c] - coordinates[3 * a + c] - x[3 * a + c];
+                length += dir[c] * dir[c];
+            }
+            length = std::sqrt(length);
+            // A collapsed edge keeps its reference direction
+            const bool collapsed = length <= 1e-12 * restLength;
+            for (int c = 0; c < 3; ++c) {
+                dir[c] = collapsed ? m_restDirections[3 * e + c] : dir[c] / length;
+            }
+
+            const double stretch = length - restLength;
+            for (int c = 0; c < 3; ++c) {
+                force[c] = m_coupling * stretch * dir[c];
+            }
+            m_edgeEnergies[e] = 0.5 * m_coupling * stretch * stretch;
+
+            if (formTangent) {
+                // k (n n^T + g (I - n n^T)) with the geometric part g = 1 - L / l
+                double g = collapsed ? 0.0 : 1.0 - restLength / length;
+                if (m_definiteTangent) {
+                    g = std::max(g, 0.0);
+                }
+                for (int r = 0; r < 3; ++r) {
+                    for (int c = 0; c < 3; ++c) {
+                        tangent[3 * r + c] = m_coupling * ((1.0 - g) * dir[r] * dir[c] + (r == c ? g : 0.0));
+                    }
+                }
+            }
+        }
+    });
+
+    if (m_contact) {
+        m_contact->computeForces(x, m_contactForces);
+    }
+
+    // Pass 2, per node: gather the forces, energies and Jacobian rows of its DOFs
+    const int* rowPtr = m_jacobian.rowPointers().data();
+    double* jacobian = m_jacobian.mutableValues().data();
+    const double* masses = model.masses.data();
+    forEachChunk(model.numNodes(), m_nodeGrain, [=](int, int begin, int end) {
+        for (int p = begin; p < end; ++p) {
+            double nodeEnergy = 0.0;
+            for (int r = 0; r < d; ++r) {
+                const int i = p * d + r;
+                f[i] = -m_grounding * x[i];
+                if (v) {
+                    f[i] -= m_damping * v[i];
+                }
+                if (m_contactForces) {
+                    f[i] += m_contactForces[i];
+                }
+                nodeEnergy += 0.5 * m_grounding * x[i] * x[i];
+            }
+
+            if (formTangent) {
+                for (int r = 0; r < d; ++r) {
+                    const int i = p * d + r;
+                    std::fill(jacobian + rowPtr[i], jacobian + rowPtr[i + 1], 0.0);
+                    jacobian[m_diagonalOffsets[i] + r] = masses[i] + m_dampingScale * m_damping
+                                                       + m_stiffnessScale * m_grounding;
+                }
+            }
+
+            for (int k = m_nodeEdgePointers[p]; k < m_nodeEdgePointers[p + 1]; ++k) {
+                const int e = m_nodeEdges[k];
+                const bool first = (edges[2 * e] == p);
+                const double sign = first ? 1.0 : -1.0;
+                const double* force = &m_edgeForces[static_cast<size_t>(e) * d];
+                for (int r = 0; r < d; ++r) {
+                    f[p * d + r] += sign * force[r];
+                }
+                nodeEnergy += 0.5 * m_edgeEnergies[e];
+
+                if (formTangent) {
+                    const double* tangent = &m_edgeTangents[static_cast<size_t>(e) * d * d];
+                    const int* offsets = &m_edgeOffsets[(2 * static_cast<size_t>(e) + (first ? 0 : 1)) * d];
+                    for (int r = 0; r < d; ++r) {
+                        const int i = p * d + r;
+                        for (int c = 0; c < d; ++c) {
+                            const double value = m_stiffnessScale * tangent[d * r + c];
+                            jacobian[m_diagonalOffsets[i] + c] += value;
+                            jacobian[offsets[r] + c] -= value;
+                        }
+                    }
+                }
+            }
+
+            // Springs are split evenly between their nodes; the node's share goes to its first DOF
+            m_potential[p * d] = nodeEnergy;
+            for (int r = 1; r < d; ++r) {
+                m_potential[p * d + r] = 0.0;
+            }
+        }
+    });
+}
+
+double NewtonSolver::residual(const StepEquation& equation, const double* y, double& reference,
+                              bool formTangent)
+{
+    const int n = m_model->numDOF();
+    const double* masses = m_model->masses.data();
+    double* x = m_positions.data();
+    double* v = m_velocities.data();
+    double* f = m_forces.data();
+    double* r = m_residual.data();
+    double* partials = m_partials.data();
+
+    forEachChunk(n, m_grain, [=, &equation](int, int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            x[i] = equation.x0[i] + equation.a * y[i];
+            v[i] = (equation.v0 ? equation.v0[i] : 0.0) + equation.d * y[i];
+        }
+    });
+
+    evaluate(x, v, f, formTangent);
+
+    // |R|^2 and the squared norms of the three terms of the step equation
+    forEachChunk(n, m_grain, [=, &equation](int chunk, int begin, int end) {
+        double rr = 0.0;
+        double my = 0.0;
+        double bb = 0.0;
+        double wf = 0.0;
+        for (int i = begin; i < end; ++i) {
+            const double inertia = masses[i] * y[i];
+            const double base = equation.b ? equation.b[i] : 0.0;
+            const double force = equation.w * f[i];
+            r[i] = inertia - base - force;
+            rr += r[i] * r[i];
+            my += inertia * inertia;
+            bb += base * base;
+            wf += force * force;
+        }
+        partials[4 * chunk] = rr;
+        partials[4 * chunk + 1] = my;
+        partials[4 * chunk + 2] = bb;
+        partials[4 * chunk + 3] = wf;
+    });
+
+    const int chunks = WorkStealingPool::chunkCount(0, n, m_grain);
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int c = 0; c < chunks; ++c) {
+        for (int k = 0; k < 4; ++k) {
+            sums[k] += partials[4 * c + k];
+        }
+    }
+    reference = std::sqrt(std::max(sums[1], std::max(sums[2], sums[3])));
+    return std::sqrt(sums[0]);
+}
+
+NewtonSolver::Result NewtonSolver::solve(const StepEquation& equation, double* y)
+{
+    const int n = m_model->numDOF();
+    const bool full = (m_options.method != NonlinearMethod::ModifiedNewton);
+    double* correction = m_correction.data();
+    double* trial = m_trial.data();
+
+    Result result;
+    double reference = 0.0;
+    m_definiteTangent = false;
+    bool formed = full || !m_tangentCurrent;
+    double norm = residual(equation, y, reference, formed);
+
+    for (;;) {
+        result.residual = (reference > 0.0) ? norm / reference : norm;
+        if (norm <= m_options.tolerance * reference) {
+            break;
+        }
+        if (result.iterations >= m_options.maxIterations) {
+            result.converged = false;
+            break;
+        }
+
+        // Modified Newton decided to re-form after the last iterate was evaluated
+        if (!formed && !m_tangentCurrent) {
+            norm = residual(equation, y, reference, true);
+            formed = true;
+        }
+        if (formed) {
+            m_linearSolver.refactor();
+            m_tangentCurrent = true;
+            result.tangentUpdates++;
+        }
+
+        // J dy = R, the correction is -dy
+        std::fill(m_correction.begin(), m_correction.end(), 0.0);
+        ConjugateGradient::Result linear = m_linearSolver.solve(m_residual.data(), correction,
+                                                                m_options.solverIterations,
+                                                                m_options.solverTolerance);
+        if (!linear.converged && !m_definiteTangent) {
+            // Compressed springs may have made J indefinite: retry without their negative geometric stiffness
+            m_definiteTangent = true;
+            norm = residual(equation, y, reference, true);
+            m_linearSolver.refactor();
+            m_tangentCurrent = true;
+            result.tangentUpdates++;
+            std::fill(m_correction.begin(), m_correction.end(), 0.0);
+            linear = m_linearSolver.solve(m_residual.data(), correction,
+                                          m_options.solverIterations, m_options.solverTolerance);
+        }
+        result.iterations++;
+
+        // Backtracking line search on |R|; the last cut is taken even without enough decrease
+        double lambda = 1.0;
+        int cuts = 0;
+        double trialReference = 0.0;
+        double trialNorm = 0.0;
+        for (;;) {
+            forEachChunk(n, m_grain, [=](int, int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    trial[i] = y[i] - lambda * correction[i];
+                }
+            });
+            trialNorm = residual(equation, trial, trialReference, full);
+            if (trialNorm <= (1.0 - SufficientDecrease * lambda) * norm || cuts >= m_options.maxLineSearchCuts) {
+                break;
+            }
+            lambda *= 0.5;
+            cuts++;
+        }
+        std::copy(m_trial.begin(), m_trial.end(), y);
+        formed = full;
+        result.lineSearchCuts += cuts;
+
+        // Modified Newton: slow contraction, a cut step or a failed solve ask for a new tangent
+        if (!full && (cuts > 0 || !linear.converged || trialNorm > m_options.slowdown * norm)) {
+            m_tangentCurrent = false;
+        }
+        norm = trialNorm;
+        reference = trialReference;
+    }
+
+    m_statistics.steps++;
+    m_statistics.iterations += result.iterations;
+    m_statistics.maxStepIterations = std::max(m_statistics.maxStepIterations, result.iterations);
+    m_statistics.tangentUpdates += result.tangentUpdates;
+    m_statistics.lineSearchCuts += result.lineSearchCuts;
+    if (!result.converged) {
+        m_statistics.failedSteps++;
+    }
+    m_lastResult = result;
+    return result;
+}
@@ -0,0 +1,210 @@
+#include "NodeOrdering.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+
+const int CurveBits = 21;       // Bits per axis, so three axes fit a 64-bit key
+
+/**
+ * Breadth-first search over the unnumbered nodes reachable from root.
+ * Writes the visit order to queue (neighbours by increasing degree, as
+ * Cuthill-McKee wants) and the level of each visited node.
+ */
+void breadthFirst(int root, const std::vector<int>& pointers, const std::vector<int>& neighbours,
+                  const std::vector<char>& numbered, std::vector<int>& levels, std::vector<int>& queue)
+{
+    queue.clear();
+    queue.push_back(root);
+    levels[root] = 0;
+    std::vector<int> next;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const int node = queue[head];
+        next.clear();
+        for (int k = pointers[node]; k < pointers[node + 1]; ++k) {
+            const int neighbour = neighbours[k];
+            if (!numbered[neighbour] && levels[neighbour] < 0) {
+                levels[neighbour] = levels[node] + 1;
+                next.push_back(neighbour);
+            }
+        }
+        std::stable_sort(next.begin(), next.end(), [&pointers](int a, int b) {
+            return pointers[a + 1] - pointers[a] < pointers[b + 1] - pointers[b];
+        });
+        queue.insert(queue.end(), next.begin(), next.end());
+    }
+}
+
+std::vector<int> reverseCuthillMcKee(const StructuralModel& model)
+{
+    const int n = model.numNodes();
+    std::vector<int> pointers;
+    std::vector<int> neighbours;
+    model.nodeAdjacency(pointers, neighbours);
+    auto degree = [&pointers](int node) { return pointers[node + 1] - pointers[node]; };
+
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> numbered(n, 0);
+    std::vector<int> levels(n, -1);
+    std::vector<int> queue;
+
+    for (int seed = 0; seed < n; ++seed) {
+        if (numbered[seed]) {
+            continue;
+        }
+
+        // Pseudo-peripheral root (George and Liu): move to a lowest-degree
+        // node of the last level while the eccentricity grows
+        int root = seed;
+        int eccentricity = -1;
+        for (;;) {
+            breadthFirst(root, pointers, neighbours, numbered, levels, queue);
+            const int depth = levels[queue.back()];
+            int candidate = queue.back();
+            for (int node : queue) {
+                if (levels[node] == depth && degree(node) < degree(candidate)) {
+                    candidate = node;
+                }
+            }
+            for (int node : queue) {
+                levels[node] = -1;
+            }
+            if (depth <= eccentricity) {
+                break;
+            }
+            eccentricity = depth;
+            root = candidate;
+        }
+
+        breadthFirst(root, pointers, neighbours, numbered, levels, queue);
+        for (int node : queue) {
+            numbered[node] = 1;
+            levels[node] = -1;
+            order.push_back(node);
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Spread the low 21 bits of v to every third bit
+std::uint64_t spreadBits(std::uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffULL;
+    v = (v | v << 16) & 0x1f0000ff0000ffULL;
+    v = (v | v << 8) & 0x100f00f00f00f00fULL;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+    v = (v | v << 2) & 0x1249249249249249ULL;
+    return v;
+}
+
+std::uint64_t interleave(const std::uint32_t* x)
+{
+    return spreadBits(x[0]) << 2 | spreadBits(x[1]) << 1 | spreadBits(x[2]);
+}
+
+// Hilbert index of a grid point: coordinates to the transposed index
+// (Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004)
+std::uint64_t hilbertKey(std::uint32_t* x)
+{
+    const std::uint32_t top = 1u << (CurveBits - 1);
+    for (std::uint32_t q = top; q > 1; q >>= 1) {
+        const std::uint32_t p = q - 1;
+        for (int i = 0; i < 3; ++i) {
+            if (x[i] & q) {
+                x[0] ^= p;
+            } else {
+                const std::uint32_t t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+        }
+    }
+    x[1] ^= x[0];
+    x[2] ^= x[1];
+    std::uint32_t t = 0;
+    for (std::uint32_t q = top; q > 1; q >>= 1) {
+        if (x[2] & q) {
+            t ^= q - 1;
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        x[i] ^= t;
+    }
+    return interleave(x);
+}
+
+std::vector<int> spaceFillingCurve(const StructuralModel& model, bool hilbert)
+{
+    const int n = model.numNodes();
+    const double* coordinates = model.nodeCoordinates.data();
+
+    // One scale for all axes, so the cells stay cubes
+    double lower[3] = {0.0, 0.0, 0.0};
+    double extent = 0.0;
+    if (n > 0) {
+        double upper[3];
+        for (int c = 0; c < 3; ++c) {
+            lower[c] = upper[c] = coordinates[c];
+        }
+        for (int i = 1; i < n; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                lower[c] = std::min(lower[c], coordinates[3 * i + c]);
+                upper[c] = std::max(upper[c], coordinates[3 * i + c]);
+            }
+        }
+        for (int c = 0; c < 3; ++c) {
+            extent = std::max(extent, upper[c] - lower[c]);
+        }
+    }
+    const double cells = static_cast<double>((1u << CurveBits) - 1);
+    const double scale = extent > 0.0 ? cells / extent : 0.0;
+
+    std::vector<std::uint64_t> keys(n);
+    for (int i = 0; i < n; ++i) {
+        std::uint32_t x[3];
+        for (int c = 0; c < 3; ++c) {
+            const double cell = (coordinates[3 * i + c] - lower[c]) * scale;
+            x[c] = static_cast<std::uint32_t>(std::min(std::max(cell, 0.0), cells));
+        }
+        keys[i] = hilbert ? hilbertKey(x) : interleave(x);
+    }
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a] < keys[b]; });
+    return order;
+}
+
+} // namespace
+
+std::vector<int> NodeOrdering::compute(const StructuralModel& model, DofOrdering method)
+{
+    switch (method) {
+        case DofOrdering::ReverseCuthillMcKee:
+            return reverseCuthillMcKee(model);
+        case DofOrdering::Morton:
+            return spaceFillingCurve(model, false);
+        case DofOrdering::Hilbert:
+            return spaceFillingCurve(model, true);
+        default: {
+            std::vector<int> order(model.numNodes());
+            std::iota(order.begin(), order.end(), 0);
+            return order;
+        }
+    }
+}
+
+const char* NodeOrdering::name(DofOrdering method)
+{
+    switch (method) {
+        case DofOrdering::ReverseCuthillMcKee: return "rcm";
+        case DofOrdering::Morton:              return "morton";
+        case DofOrdering::Hilbert:             return "hilbert";
+        default:                               return "natural";
+    }
+}
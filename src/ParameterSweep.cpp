@@ -0,0 +1,263 @@
+#include "ParameterSweep.h"
+#include "SettlingTracker.h"
+#include "SimulationSolver.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+bool sameCase(const SimulationParameters& a, const SimulationParameters& b)
+{
+    return a.integrator == b.integrator && a.timeStep == b.timeStep && a.totalTime == b.totalTime
+        && a.damping == b.damping && a.stiffness == b.stiffness;
+}
+
+} // namespace
+
+ParameterSweep::ParameterSweep(const Options& options)
+    : m_options(options)
+    , m_cancelled(false)
+{
+}
+
+std::vector<SimulationParameters> ParameterSweep::grid(const SimulationParameters& base,
+                                                       const std::vector<double>& dampings,
+                                                       const std::vector<double>& stiffnesses,
+                                                       const std::vector<double>& timeSteps)
+{
+    const std::vector<double> d = dampings.empty() ? std::vector<double>(1, base.damping) : dampings;
+    const std::vector<double> k = stiffnesses.empty() ? std::vector<double>(1, base.stiffness) : stiffnesses;
+    const std::vector<double> h = timeSteps.empty() ? std::vector<double>(1, base.timeStep) : timeSteps;
+
+    std::vector<SimulationParameters> cases;
+    cases.reserve(d.size() * k.size() * h.size());
+    for (double timeStep : h) {
+        for (double damping : d) {
+            for (double stiffness : k) {
+                SimulationParameters params = base;
+                params.timeStep = timeStep;
+                params.damping = damping;
+                params.stiffness = stiffness;
+                cases.push_back(params);
+            }
+        }
+    }
+    return cases;
+}
+
+void ParameterSweep::setCases(const std::vector<SimulationParameters>& cases)
+{
+    m_results.assign(cases.size(), CaseResult());
+    for (size_t i = 0; i < cases.size(); ++i) {
+        m_results[i].parameters = cases[i];
+    }
+}
+
+int ParameterSweep::completedCount() const
+{
+    return static_cast<int>(std::count_if(m_results.begin(), m_results.end(),
+        [](const CaseResult& result) { return result.status == CaseStatus::Completed; }));
+}
+
+int ParameterSweep::run(const StructuralModel& model, const CaseCallback& callback)
+{
+    // Only unfinished cases are scheduled, which is what makes a sweep resumable
+    std::vector<int> pending;
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        if (m_results[i].status != CaseStatus::Completed) {
+            pending.push_back(static_cast<int>(i));
+        }
+    }
+    if (pending.empty()) {
+        m_cancelled = false;
+        return 0;
+    }
+
+    const int numThreads = std::min(WorkStealingPool::resolveThreadCount(m_options.maxConcurrent),
+                                    static_cast<int>(pending.size()));
+    std::cout << "[ParameterSweep] Running " << pending.size() << " of " << m_results.size()
+              << " cases on " << numThreads << " threads" << std::endl;
+
+    std::atomic<int> completed(0);
+    auto body = [&](int, int begin, int end) {
+        for (int p = begin; p < end; ++p) {
+            const int index = pending[p];
+            CaseResult& result = m_results[index];
+            runCase(model, result);
+            if (result.status == CaseStatus::Completed) {
+                completed++;
+            }
+            if (callback && result.status != CaseStatus::Cancelled) {
+                callback(index, result);
+            }
+        }
+    };
+
+    // One case per chunk; each worker steals whole cases from the others
+    WorkStealingPool pool(numThreads);
+    pool.parallelFor(0, static_cast<int>(pending.size()), 1, body);
+
+    // A cancel() stops this run only, including one that came before it started
+    const bool cancelled = m_cancelled.exchange(false);
+    std::cout << "[ParameterSweep] " << completed << " cases completed"
+              << (cancelled ? " (cancelled)" : "") << std::endl;
+    return completed;
+}
+
+void ParameterSweep::runCase(const StructuralModel& model, CaseResult& result)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Cases run side by side, so each one steps on its calling thread only
+    const SimulationParameters requested = result.parameters;
+    SimulationParameters params = requested;
+    params.numThreads = 1;
+    params.runMode = RunMode::Headless;
+
+    result = CaseResult();
+    result.parameters = requested;
+
+    try {
+        SimulationSolver solver;
+        solver.initialize(params, model);
+
+        SettlingTracker tracker(m_options.settlingBand);
+        const AlignedVector& initial = solver.state().positions;
+        tracker.add(solver.currentTime(), SettlingTracker::maxAbs(initial.data(), initial.size()));
+
+        bool finished = false;
+        solver.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            while (!solver.isEndReached<Integrator>()) {
+                if (m_cancelled) {
+                    return;
+                }
+                solver.step<Integrator>();
+                // state() converts reduced-precision runs back to double
+                const AlignedVector& positions = solver.state().positions;
+                tracker.add(solver.currentTime(), SettlingTracker::maxAbs(positions.data(), positions.size()));
+                if (solver.checkSteadyState()) {
+                    break;
+                }
+            }
+            finished = true;
+        });
+
+        result.status = finished ? CaseStatus::Completed : CaseStatus::Cancelled;
+        result.steps = solver.currentStep();
+        result.finalTime = solver.currentTime();
+        result.peakDisplacement = tracker.peak();
+        result.settlingTime = tracker.settlingTime();
+        result.finalEnergy = solver.stateEnergy();     // energy() may be from the start of the last step
+        result.steady = solver.isSteady();
+    }
+    catch (const std::exception& e) {
+        result.status = CaseStatus::Failed;
+        result.error = e.what();
+    }
+
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+const char* ParameterSweep::statusName(CaseStatus status)
+{
+    switch (status) {
+        case CaseStatus::Completed: return "completed";
+        case CaseStatus::Cancelled: return "cancelled";
+        case CaseStatus::Failed:    return "failed";
+        default:                    return "pending";
+    }
+}
+
+bool ParameterSweep::saveResults(const std::string& path) const
+{
+    std::ofstream out(path.c_str());
+    if (!out) {
+        return false;
+    }
+
+    // Full precision, so reloaded parameters compare equal to the grid
+    out << std::setprecision(17);
+    out << "index,status,integrator,timeStep,totalTime,damping,stiffness,"
+           "steps,finalTime,peakDisplacement,settlingTime,finalEnergy,steady,wallSeconds,error\n";
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const CaseResult& r = m_results[i];
+        std::string error = r.error;
+        std::replace(error.begin(), error.end(), ',', ';');
+        std::replace(error.begin(), error.end(), '\n', ' ');
+
+        out << i << ',' << statusName(r.status) << ','
+            << static_cast<int>(r.parameters.integrator) << ','
+            << r.parameters.timeStep << ',' << r.parameters.totalTime << ','
+            << r.parameters.damping << ',' << r.parameters.stiffness << ','
+            << r.steps << ',' << r.finalTime << ',' << r.peakDisplacement << ','
+            << r.settlingTime << ',' << r.finalEnergy << ',' << (r.steady ? 1 : 0) << ','
+            << r.wallSeconds << ',' << error << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+int ParameterSweep::loadResults(const std::string& path)
+{
+    std::ifstream in(path.c_str());
+    if (!in) {
+        return 0;
+    }
+
+    int restored = 0;
+    std::string line;
+    std::getline(in, line);     // Header
+    while (std::getline(in, line)) {
+        std::istringstream row(line);
+        std::vector<std::string> fields;
+        std::string field;
+        while (std::getline(row, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 14 || fields[1] != statusName(CaseStatus::Completed)) {
+            continue;
+        }
+
+        // Rows that do not parse (truncated or hand-edited tables) are re-run
+        size_t index = 0;
+        CaseResult loaded;
+        try {
+            index = std::stoul(fields[0]);
+            if (index >= m_results.size()) {
+                continue;
+            }
+
+            loaded.parameters = m_results[index].parameters;
+            loaded.parameters.integrator = static_cast<IntegratorType>(std::stoi(fields[2]));
+            loaded.parameters.timeStep = std::stod(fields[3]);
+            loaded.parameters.totalTime = std::stod(fields[4]);
+            loaded.parameters.damping = std::stod(fields[5]);
+            loaded.parameters.stiffness = std::stod(fields[6]);
+            if (!sameCase(loaded.parameters, m_results[index].parameters)) {
+                continue;
+            }
+
+            loaded.status = CaseStatus::Completed;
+            loaded.steps = std::stoi(fields[7]);
+            loaded.finalTime = std::stod(fields[8]);
+            loaded.peakDisplacement = std::stod(fields[9]);
+            loaded.settlingTime = std::stod(fields[10]);
+            loaded.finalEnergy = std::stod(fields[11]);
+            loaded.steady = (fields[12] == "1");
+            loaded.wallSeconds = std::stod(fields[13]);
+        }
+        catch (const std::exception&) {
+            continue;
+        }
+        m_results[index] = loaded;
+        restored++;
+    }
+    return restored;
+}
@@ -0,0 +1,269 @@
+#include "Parareal.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+Parareal::Parareal()
+    : m_numThreads(1)
+    , m_tolerance(0.0)
+    , m_maxIterations(0)
+    , m_iterations(0)
+    , m_converged(false)
+    , m_cancelled(false)
+{
+}
+
+Parareal::~Parareal()
+{
+}
+
+void Parareal::checkSupported(const SimulationParameters& params)
+{
+    switch (params.integrator) {
+        case IntegratorType::DormandPrince54:
+        case IntegratorType::ModalSuperposition:
+            throw std::runtime_error("Parareal needs a fixed-step integrator");
+        default:
+            break;
+    }
+    if (params.contactStiffness > 0.0) {
+        throw std::runtime_error("Parareal does not support contact");
+    }
+    if (params.subdomains > 1) {
+        throw std::runtime_error("Parareal and domain decomposition cannot be combined");
+    }
+}
+
+void Parareal::setup(const SimulationParameters& params, const StructuralModel& model,
+                     const SimulationState& initial)
+{
+    checkSupported(params);
+
+    // Same step count as SimulationSolver::initialize()
+    const int totalSteps = static_cast<int>(params.totalTime / params.timeStep);
+    const int firstStep = std::min(initial.currentStep, totalSteps);
+    const int remaining = totalSteps - firstStep;
+    const int slices = std::max(1, std::min(params.timeSlices, remaining));
+    const int ratio = std::max(1, params.coarseStepRatio);
+
+    // Equal slices of fine steps; boundary times summed like the sequential run
+    m_sliceSteps.resize(slices + 1);
+    for (int n = 0; n <= slices; ++n) {
+        m_sliceSteps[n] = firstStep + static_cast<int>(static_cast<long long>(remaining) * n / slices);
+    }
+    m_sliceTimes.resize(slices + 1);
+    double time = initial.currentTime;
+    for (int n = 0; n < slices; ++n) {
+        m_sliceTimes[n] = time;
+        for (int step = m_sliceSteps[n]; step < m_sliceSteps[n + 1]; ++step) {
+            time += params.timeStep;
+        }
+    }
+    m_sliceTimes[slices] = time;
+    m_coarseSteps.resize(slices);
+    for (int n = 0; n < slices; ++n) {
+        m_coarseSteps[n] = std::max(1, (m_sliceSteps[n + 1] - m_sliceSteps[n] + ratio / 2) / ratio);
+    }
+
+    // Slices run side by side, so each fine solver steps on its calling thread only
+    SimulationParameters fine = params;
+    fine.numThreads = 1;
+    fine.runMode = RunMode::Headless;
+    fine.steadyStateThreshold = 0.0;
+    fine.checkpointInterval = 0;
+    fine.timeSlices = 1;
+    m_fine.clear();
+    for (int n = 0; n < slices; ++n) {
+        m_fine.push_back(std::unique_ptr<SimulationSolver>(new SimulationSolver()));
+        m_fine.back()->initialize(fine, model);
+    }
+
+    // Implicit Newmark is stable and free of numerical damping at any coarse step
+    SimulationParameters coarse = fine;
+    coarse.integrator = IntegratorType::ImplicitNewmark;
+    coarse.precision = ScalarPrecision::Double;
+    coarse.timeStep = params.timeStep * ratio;
+    m_coarse.initialize(coarse, model);
+
+    m_numThreads = std::min(WorkStealingPool::resolveThreadCount(params.numThreads), slices);
+    m_tolerance = params.pararealTolerance;
+    m_maxIterations = params.pararealMaxIterations > 0 ? std::min(params.pararealMaxIterations, slices) : slices;
+    m_boundaries.assign(slices + 1, initial);
+    m_fineEnds.assign(slices, initial);
+    m_coarseEnds.assign(slices, initial);
+    m_iterations = 0;
+    m_converged = false;
+
+    std::cout << "[Parareal] " << slices << " time slices of " << remaining / slices << " steps on "
+              << m_numThreads << " threads; coarse sweep: implicit Newmark at " << ratio
+              << " fine steps per step" << std::endl;
+}
+
+bool Parareal::run(const IterationCallback& callback)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    m_cancelled = false;
+    m_iterations = 0;
+    m_converged = false;
+    const int slices = sliceCount();
+    if (slices == 0) {
+        return true;
+    }
+
+    // Iteration 0: the coarse sweep alone gives the first boundary states
+    Clock::time_point start = Clock::now();
+    for (int n = 0; n < slices && !m_cancelled; ++n) {
+        coarse(n, m_boundaries[n], m_coarseEnds[n]);
+        m_boundaries[n + 1] = m_coarseEnds[n];
+    }
+    if (m_cancelled) {
+        return false;
+    }
+    if (callback) {
+        Iteration iteration = { 0, std::numeric_limits<double>::infinity(), 0,
+                                std::chrono::duration<double>(Clock::now() - start).count() };
+        callback(iteration);
+    }
+
+    WorkStealingPool pool(m_numThreads);
+    std::vector<std::string> errors(slices);
+    SimulationState coarseNew;
+    SimulationState updated;
+
+    for (int k = 1; k <= m_maxIterations; ++k) {
+        start = Clock::now();
+
+        // Fine sweep over the slices that are not exact yet, one slice per chunk
+        const int firstOpen = k - 1;
+        pool.parallelFor(firstOpen, slices, 1, [&](int, int begin, int end) {
+            for (int n = begin; n < end; ++n) {
+                try {
+                    propagate(*m_fine[n], m_boundaries[n], n, m_sliceSteps[n + 1] - m_sliceSteps[n], m_fineEnds[n]);
+                }
+                catch (const std::exception& e) {
+                    errors[n] = e.what();
+                    m_cancelled = true;
+                }
+            }
+        });
+        for (int n = firstOpen; n < slices; ++n) {
+            if (!errors[n].empty()) {
+                throw std::runtime_error("Parareal slice " + std::to_string(n) + ": " + errors[n]);
+            }
+        }
+        if (m_cancelled) {
+            return false;
+        }
+
+        // Sequential correction; the first open slice starts from an exact state
+        double change = 0.0;
+        for (int n = firstOpen; n < slices; ++n) {
+            if (n == firstOpen) {
+                updated = m_fineEnds[n];
+            } else {
+                coarse(n, m_boundaries[n], coarseNew);
+                combine(coarseNew, m_fineEnds[n], m_coarseEnds[n], updated);
+                std::swap(m_coarseEnds[n], coarseNew);
+            }
+            change = std::max(change, distance(m_boundaries[n + 1], updated));
+            std::swap(m_boundaries[n + 1], updated);
+        }
+        double scale = 0.0;
+        for (int n = 1; n <= slices; ++n) {
+            scale = std::max(scale, magnitude(m_boundaries[n]));
+        }
+        change = change > 0.0 ? change / scale : 0.0;
+
+        m_iterations = k;
+        m_converged = change <= m_tolerance || k == slices;
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "[Parareal] Iteration " << k << ": boundary change " << change << ", " << k << "/" << slices
+                  << " slices exact (" << seconds << " s)" << std::endl;
+        if (callback) {
+            Iteration iteration = { k, change, k, seconds };
+            callback(iteration);
+        }
+        if (m_converged) {
+            break;
+        }
+    }
+
+    if (m_converged) {
+        std::cout << "[Parareal] Converged after " << m_iterations << " iterations: fine work on the critical path "
+                  << m_iterations << " of " << slices << " slices" << std::endl;
+    } else {
+        std::cout << "[Parareal] Not converged to " << m_tolerance << " after " << m_iterations
+                  << " iterations" << std::endl;
+    }
+    return !m_cancelled;
+}
+
+void Parareal::propagate(SimulationSolver& solver, const SimulationState& start, int slice, int steps,
+                         SimulationState& end)
+{
+    solver.restore(start, 0.0, 0);
+    solver.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        for (int i = 0; i < steps && !m_cancelled.load(std::memory_order_relaxed); ++i) {
+            solver.step<Integrator>();
+        }
+    });
+
+    // Element-wise, so the end state reuses its buffers
+    const SimulationState& state = solver.state();
+    end.positions.assign(state.positions.begin(), state.positions.end());
+    end.velocities.assign(state.velocities.begin(), state.velocities.end());
+    end.accelerations.assign(state.accelerations.begin(), state.accelerations.end());
+    end.energy = state.energy;
+    end.iterations = state.iterations;
+    end.totalIterations = state.totalIterations;
+    end.rejectedSteps = start.rejectedSteps;
+    end.totalSteps = start.totalSteps;
+    end.timeStep = start.timeStep;
+    end.currentStep = m_sliceSteps[slice + 1];
+    end.currentTime = m_sliceTimes[slice + 1];
+}
+
+void Parareal::coarse(int slice, const SimulationState& start, SimulationState& end)
+{
+    propagate(m_coarse, start, slice, m_coarseSteps[slice], end);
+}
+
+void Parareal::combine(const SimulationState& coarseNew, const SimulationState& fine,
+                       const SimulationState& coarseOld, SimulationState& result)
+{
+    const size_t numDOF = fine.positions.size();
+    result = fine;
+    for (size_t i = 0; i < numDOF; ++i) {
+        result.positions[i] += coarseNew.positions[i] - coarseOld.positions[i];
+        result.velocities[i] += coarseNew.velocities[i] - coarseOld.velocities[i];
+        result.accelerations[i] += coarseNew.accelerations[i] - coarseOld.accelerations[i];
+    }
+    result.energy += coarseNew.energy - coarseOld.energy;
+}
+
+double Parareal::distance(const SimulationState& a, const SimulationState& b)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < a.positions.size(); ++i) {
+        const double dx = a.positions[i] - b.positions[i];
+        const double dv = a.velocities[i] - b.velocities[i];
+        sum += dx * dx + dv * dv;
+    }
+    return std::sqrt(sum);
+}
+
+double Parareal::magnitude(const SimulationState& state)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < state.positions.size(); ++i) {
+        sum += state.positions[i] * state.positions[i] + state.velocities[i] * state.velocities[i];
+    }
+    return std::sqrt(sum);
+}
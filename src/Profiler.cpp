@@ -0,0 +1,313 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+
+const char* const PhaseNames[Profiler::PhaseCount] = {
+    "step", "computeForces", "linearSolve", "pauseWait", "publish", "emit", "record", "checkpoint", "contact"
+};
+
+} // namespace
+
+const char* Profiler::phaseName(Phase phase)
+{
+    return (phase >= 0 && phase < PhaseCount) ? PhaseNames[phase] : "unknown";
+}
+
+#ifdef SIMTOOL_PROFILING
+
+namespace {
+
+// Four buckets per power of two: values below 4 ns get a bucket each, above
+// that the two bits after the leading one select the quarter of the octave
+const int BucketCount = 256;
+
+int bucketOf(unsigned long long ns)
+{
+    if (ns < 4) {
+        return static_cast<int>(ns);
+    }
+    int msb = 63;
+    while (!(ns >> msb)) {
+        --msb;
+    }
+    return (msb - 1) * 4 + static_cast<int>((ns >> (msb - 2)) & 3);
+}
+
+unsigned long long bucketLowerBound(int bucket)
+{
+    if (bucket < 4) {
+        return bucket;
+    }
+    const int msb = bucket / 4 + 1;
+    return static_cast<unsigned long long>(4 + bucket % 4) << (msb - 2);
+}
+
+// Zero-initialized; the minimum is kept as the maximum of ~ns for that reason
+struct Histogram
+{
+    std::atomic<unsigned long long> totalNs;
+    std::atomic<unsigned long long> minComplement;
+    std::atomic<unsigned long long> maxNs;
+    std::atomic<unsigned long long> buckets[BucketCount];
+};
+
+struct TraceEvent
+{
+    unsigned long long startNs;
+    unsigned long long durationNs;
+    unsigned int thread;
+    Profiler::Phase phase;
+};
+
+Histogram g_histograms[Profiler::PhaseCount];
+
+std::vector<TraceEvent> g_trace;
+std::atomic<bool> g_tracing(false);
+std::atomic<unsigned long long> g_traceNext(0);
+std::atomic<unsigned long long> g_traceDropped(0);
+
+// Small, stable thread numbers for the trace
+std::atomic<unsigned int> g_nextThread(1);
+thread_local unsigned int t_thread = 0;
+
+unsigned int threadNumber()
+{
+    if (t_thread == 0) {
+        t_thread = g_nextThread.fetch_add(1, std::memory_order_relaxed);
+    }
+    return t_thread;
+}
+
+void updateMax(std::atomic<unsigned long long>& target, unsigned long long value)
+{
+    unsigned long long current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+unsigned long long percentile(const unsigned long long* buckets, unsigned long long count, double fraction)
+{
+    // Smallest bucket holding the requested rank, reported by its lower bound
+    const unsigned long long rank = std::max(1ull, static_cast<unsigned long long>(fraction * count + 0.5));
+    unsigned long long seen = 0;
+    for (int b = 0; b < BucketCount; ++b) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            return bucketLowerBound(b);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+bool Profiler::isEnabled()
+{
+    return true;
+}
+
+void Profiler::reset()
+{
+    for (Histogram& histogram : g_histograms) {
+        histogram.totalNs.store(0, std::memory_order_relaxed);
+        histogram.minComplement.store(0, std::memory_order_relaxed);
+        histogram.maxNs.store(0, std::memory_order_relaxed);
+        for (std::atomic<unsigned long long>& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+    g_tracing = false;
+    g_trace.clear();
+    g_traceNext = 0;
+    g_traceDropped = 0;
+}
+
+Profiler::PhaseStats Profiler::stats(Phase phase)
+{
+    const Histogram& histogram = g_histograms[phase];
+
+    // The count comes from the same bucket reads as the percentiles, so
+    // concurrent updates cannot push a rank past the last bucket
+    unsigned long long buckets[BucketCount];
+    unsigned long long count = 0;
+    for (int b = 0; b < BucketCount; ++b) {
+        buckets[b] = histogram.buckets[b].load(std::memory_order_relaxed);
+        count += buckets[b];
+    }
+
+    PhaseStats result;
+    result.phase = phase;
+    result.name = phaseName(phase);
+    result.count = count;
+    result.totalNs = histogram.totalNs.load(std::memory_order_relaxed);
+    result.minNs = count ? ~histogram.minComplement.load(std::memory_order_relaxed) : 0;
+    result.maxNs = histogram.maxNs.load(std::memory_order_relaxed);
+    result.p50Ns = percentile(buckets, count, 0.50);
+    result.p90Ns = percentile(buckets, count, 0.90);
+    result.p99Ns = percentile(buckets, count, 0.99);
+    return result;
+}
+
+void Profiler::startTrace(std::size_t maxEvents)
+{
+    g_tracing = false;
+    g_trace.assign(maxEvents, TraceEvent());
+    g_traceNext = 0;
+    g_traceDropped = 0;
+    g_tracing = true;
+}
+
+void Profiler::stopTrace()
+{
+    g_tracing = false;
+}
+
+unsigned long long Profiler::traceEventCount()
+{
+    return std::min<unsigned long long>(g_traceNext.load(), g_trace.size());
+}
+
+unsigned long long Profiler::droppedTraceEvents()
+{
+    return g_traceDropped;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path, std::string& error)
+{
+    std::ofstream out(path.c_str());
+    if (!out) {
+        error = "Cannot write " + path;
+        return false;
+    }
+
+    const unsigned long long count = traceEventCount();
+    unsigned long long origin = ~0ull;
+    for (unsigned long long i = 0; i < count; ++i) {
+        origin = std::min(origin, g_trace[i].startNs);
+    }
+
+    // Complete events ("ph":"X"), timestamps in microseconds from the first event
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    out << std::fixed << std::setprecision(3);
+    for (unsigned long long i = 0; i < count; ++i) {
+        const TraceEvent& event = g_trace[i];
+        out << (i ? ",\n" : "\n")
+            << "{\"name\":\"" << phaseName(event.phase) << "\",\"cat\":\"simulation\",\"ph\":\"X\""
+            << ",\"ts\":" << (event.startNs - origin) / 1000.0
+            << ",\"dur\":" << event.durationNs / 1000.0
+            << ",\"pid\":1,\"tid\":" << event.thread << '}';
+    }
+    out << "\n]}\n";
+
+    out.flush();
+    if (!out) {
+        error = "Error writing " + path;
+        return false;
+    }
+    return true;
+}
+
+void Profiler::record(Phase phase, unsigned long long startNs, unsigned long long durationNs)
+{
+    Histogram& histogram = g_histograms[phase];
+    histogram.totalNs.fetch_add(durationNs, std::memory_order_relaxed);
+    histogram.buckets[bucketOf(durationNs)].fetch_add(1, std::memory_order_relaxed);
+    updateMax(histogram.minComplement, ~durationNs);
+    updateMax(histogram.maxNs, durationNs);
+
+    if (g_tracing.load(std::memory_order_relaxed)) {
+        const unsigned long long index = g_traceNext.fetch_add(1, std::memory_order_relaxed);
+        if (index < g_trace.size()) {
+            TraceEvent& event = g_trace[index];
+            event.startNs = startNs;
+            event.durationNs = durationNs;
+            event.thread = threadNumber();
+            event.phase = phase;
+        } else {
+            g_traceDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+#else
+
+bool Profiler::isEnabled()
+{
+    return false;
+}
+
+void Profiler::reset()
+{
+}
+
+Profiler::PhaseStats Profiler::stats(Phase phase)
+{
+    PhaseStats result = PhaseStats();
+    result.phase = phase;
+    result.name = phaseName(phase);
+    return result;
+}
+
+void Profiler::startTrace(std::size_t)
+{
+}
+
+void Profiler::stopTrace()
+{
+}
+
+unsigned long long Profiler::traceEventCount()
+{
+    return 0;
+}
+
+unsigned long long Profiler::droppedTraceEvents()
+{
+    return 0;
+}
+
+bool Profiler::writeChromeTrace(const std::string&, std::string& error)
+{
+    error = "Profiling is not compiled in (SIMTOOL_PROFILING)";
+    return false;
+}
+
+void Profiler::record(Phase, unsigned long long, unsigned long long)
+{
+}
+
+#endif // SIMTOOL_PROFILING
+
+std::vector<Profiler::PhaseStats> Profiler::allStats()
+{
+    std::vector<PhaseStats> result;
+    for (int p = 0; p < PhaseCount; ++p) {
+        const PhaseStats phaseStats = stats(static_cast<Phase>(p));
+        if (phaseStats.count > 0) {
+            result.push_back(phaseStats);
+        }
+    }
+    return result;
+}
+
+void Profiler::printSummary(std::ostream& out)
+{
+    const std::ios::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    for (const PhaseStats& s : allStats()) {
+        out << "[Profiler] " << std::left << std::setw(14) << s.name << std::right
+            << " n = " << s.count
+            << ", total " << s.totalNs / 1e6 << " ms"
+            << ", mean " << s.meanNs() / 1e3 << " us"
+            << ", p50 " << s.p50Ns / 1e3 << " us"
+            << ", p99 " << s.p99Ns / 1e3 << " us"
+            << ", max " << s.maxNs / 1e3 << " us" << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
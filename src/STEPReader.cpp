@@ -10,10 +10,12 @@
 #include <BRepGProp.hxx>
 #include <Bnd_Box.hxx>
 #include <BRepBndLib.hxx>
+#ifndef SIMTOOL_NO_DISPLAY
 #include <Quantity_Color.hxx>
 #include <AIS_Shape.hxx>
 #include <V3d_Viewer.hxx>
 #include <V3d_View.hxx>
+#endif
 #include <BRep_Builder.hxx>
 #include <fstream>
 #include <iostream>
@@ -25,7 +27,9 @@
 STEPReader::STEPReader(QObject *parent)
     : QObject(parent)
     , m_shape()
+#ifndef SIMTOOL_NO_DISPLAY
     , m_aisShape(nullptr)
+#endif
 {
 }
 
@@ -263,6 +267,7 @@ bool STEPReader::loadSTEPFile(const QString& filePath)
 #endif
 }
 
+#ifndef SIMTOOL_NO_DISPLAY
 void STEPReader::displayShape(const Handle(AIS_InteractiveContext)& context, bool fitAll)
 {
     if (m_shape.IsNull() || context.IsNull()) {
@@ -295,6 +300,7 @@ void STEPReader::displayShape(const Handle(AIS_InteractiveContext)& context, boo
         }
     }
 }
+#endif
 
 STEPReader::GeometryInfo STEPReader::getGeometryInfo() const
 {
@@ -304,9 +310,11 @@ STEPReader::GeometryInfo STEPReader::getGeometryInfo() const
 void STEPReader::clear()
 {
     m_shape.Nullify();
+#ifndef SIMTOOL_NO_DISPLAY
     if (!m_aisShape.IsNull()) {
         m_aisShape.Nullify();
     }
+#endif
     m_geometryInfo = GeometryInfo();
     m_currentFilePath.clear();
     m_lastError.clear();
@@ -1,15 +1,24 @@
 #include "SimulationEngine.h"
+#include "AllocationCounter.h"
+#include <QCoreApplication>
 #include <QThread>
 #include <QMutexLocker>
-#include <cmath>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
 
 SimulationEngine::SimulationEngine(QObject *parent)
     : QThread(parent)
+    , m_stepAllocations(0)
+    , m_recorder(nullptr)
+    , m_tracing(false)
     , m_isRunning(false)
     , m_isPaused(false)
     , m_shouldStop(false)
     , m_progressPercent(0)
 {
+    qRegisterMetaType<SimulationEngine::StateSnapshot>("SimulationEngine::StateSnapshot");
 }
 
 SimulationEngine::~SimulationEngine()
@@ -31,23 +40,31 @@ void SimulationEngine::startSimulation()
     start();
 }
 
+// The step loop only loads the flags between batches; the pause mutex is
+// taken here and by a paused loop, so a wake-up cannot be lost.
 void SimulationEngine::pauseSimulation()
 {
-    QMutexLocker locker(&m_mutex);
-    m_isPaused = true;
+    QMutexLocker locker(&m_pauseMutex);
+    m_isPaused.store(true, std::memory_order_relaxed);
 }
 
 void SimulationEngine::stopSimulation()
 {
-    m_shouldStop = true;
-    m_isPaused = false;
+    QMutexLocker locker(&m_pauseMutex);
+    m_shouldStop.store(true, std::memory_order_relaxed);
+    m_isPaused.store(false, std::memory_order_relaxed);
     m_pauseCondition.wakeAll();
+
+    // A Parareal sweep can be long; its slices stop after their current step
+    if (m_parareal) {
+        m_parareal->cancel();
+    }
 }
 
 void SimulationEngine::resumeSimulation()
 {
-    QMutexLocker locker(&m_mutex);
-    m_isPaused = false;
+    QMutexLocker locker(&m_pauseMutex);
+    m_isPaused.store(false, std::memory_order_relaxed);
     m_pauseCondition.wakeAll();
 }
 
@@ -63,50 +80,71 @@ SimulationEngine::SimulationParameters SimulationEngine::getParameters() const
     return m_parameters;
 }
 
-SimulationEngine::SimulationState SimulationEngine::getCurrentState() const
+void SimulationEngine::setGeometry(const TopoDS_Shape& shape)
 {
     QMutexLocker locker(&m_mutex);
-    return m_state;
+    m_shape = shape;
 }
 
-void SimulationEngine::run()
+void SimulationEngine::setCheckpointFile(const QString& path)
 {
-    m_isRunning = true;
+    QMutexLocker locker(&m_mutex);
+    m_checkpointPath = path;
+}
 
-    try {
-        initializeSimulation();
+void SimulationEngine::setResumeCheckpoint(const QString& path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_resumePath = path;
+}
 
-        while (m_state.currentStep < m_state.totalSteps && !m_shouldStop) {
-            // Check for pause
-            {
-                QMutexLocker locker(&m_mutex);
-                while (m_isPaused && !m_shouldStop) {
-                    m_pauseCondition.wait(&m_mutex);
-                }
-            }
+void SimulationEngine::setRecorder(TimeHistoryRecorder* recorder)
+{
+    QMutexLocker locker(&m_mutex);
+    m_recorder = recorder;
+}
 
-            if (m_shouldStop) {
-                break;
-            }
+void SimulationEngine::setWorkerProgram(const QString& path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_workerProgram = path;
+}
 
-            // Perform simulation step
-            performTimeStep();
+void SimulationEngine::setTracing(bool enabled)
+{
+    m_tracing = enabled;
+}
 
-            // Update progress
-            int progress = static_cast<int>(
-                (static_cast<double>(m_state.currentStep) / m_state.totalSteps) * 100.0
-            );
+SimulationEngine::SimulationState SimulationEngine::getCurrentState() const
+{
+    StateSnapshot snapshot = getLatestSnapshot();
+    return snapshot ? *snapshot : SimulationState();
+}
 
-            if (progress != m_progressPercent) {
-                m_progressPercent = progress;
-                emit progressUpdated(progress);
-            }
+SimulationEngine::StateSnapshot SimulationEngine::getLatestSnapshot() const
+{
+    QMutexLocker locker(&m_readerMutex);
+    m_snapshots.update();
+    return m_snapshots.readBuffer();
+}
 
-            // Emit state update
-            emit stateUpdated(m_state);
+void SimulationEngine::run()
+{
+    m_isRunning = true;
 
-            // Small delay to prevent CPU overload
-            msleep(1);
+    try {
+        initializeSimulation();
+        publishSnapshot();  // Readers see the initial state right away
+
+        // Pick the step loop once; each one is compiled for its integrator
+        if (m_domains) {
+            runDecomposedLoop();
+        } else if (m_parareal) {
+            runPararealLoop();
+        } else {
+            m_solver.dispatch([this](auto policy) {
+                this->runLoop<decltype(policy)>();
+            });
         }
 
         finalizeSimulation();
@@ -122,106 +160,400 @@ void SimulationEngine::run()
         emit simulationError("Unknown simulation error occurred");
     }
 
+    m_domains.reset();
+    {
+        QMutexLocker locker(&m_pauseMutex);
+        m_parareal.reset();
+    }
     m_isRunning = false;
 }
 
-void SimulationEngine::initializeSimulation()
+template <typename Integrator>
+void SimulationEngine::runLoop()
 {
-    QMutexLocker locker(&m_mutex);
+    const bool interactive = (m_parameters.runMode == RunMode::Interactive);
+    QElapsedTimer publishTimer;
+    publishTimer.start();
+    int stepsSincePublish = 0;
+    const int checkpointInterval = m_parameters.checkpointInterval;
+    const int batchSize = std::max(1, m_parameters.stepBatchSize);
+    bool steady = false;
+    AllocationCounter::trackThread();
+
+    while (!steady && !m_solver.isEndReached<Integrator>()) {
+        // Pause and stop are seen between batches: two relaxed loads, no lock
+        if (m_isPaused.load(std::memory_order_relaxed)) {
+            waitWhilePaused();
+        }
+        if (m_shouldStop.load(std::memory_order_relaxed)) {
+            break;
+        }
+
+        for (int i = 0; i < batchSize && !m_solver.isEndReached<Integrator>(); ++i) {
+            // Perform simulation step (allocation-free; counted by the test hook,
+            // on this thread and the pool workers)
+            const unsigned long long allocationsBefore = AllocationCounter::trackedAllocations();
+            performTimeStep<Integrator>();
+            m_stepAllocations += AllocationCounter::trackedAllocations() - allocationsBefore;
+            ++stepsSincePublish;
+
+            // Queue the step for the history writer (dropped, never waited on, if it falls behind);
+            // the state is only built for steps on the record interval
+            if (m_recorder && m_recorder->isDue(m_solver.currentStep())) {
+                SIMTOOL_PROFILE_SCOPE(Record);
+                m_recorder->record(m_solver.state());
+            }
+
+            // Hand a copy to the checkpoint writer (skipped if it is still busy)
+            if (checkpointInterval > 0 && m_solver.currentStep() % checkpointInterval == 0) {
+                submitCheckpoint();
+            }
 
-    // Calculate total steps
-    m_state.totalSteps = static_cast<int>(m_parameters.totalTime / m_parameters.timeStep);
-    m_state.currentStep = 0;
-    m_state.currentTime = 0.0;
+            // Stop early once the system has come to rest
+            if (m_solver.checkSteadyState()) {
+                publishState();
+                stepsSincePublish = 0;
+                emit steadyStateReached(m_solver.currentTime(), m_solver.energy());
+                steady = true;
+                break;
+            }
 
-    // Initialize state vectors (example: 10 degrees of freedom)
-    const int numDOF = 10;
-    m_state.positions.resize(numDOF, 0.0);
-    m_state.velocities.resize(numDOF, 0.0);
-    m_state.accelerations.resize(numDOF, 0.0);
+            // Publish progress and state (every step, or decimated when headless)
+            if (isPublishDue(publishTimer.elapsed(), stepsSincePublish)) {
+                publishState();
+                publishTimer.restart();
+                stepsSincePublish = 0;
+            }
 
-    // Set initial conditions (example: small perturbation)
-    for (int i = 0; i < numDOF; ++i) {
-        m_state.positions[i] = 0.01 * std::sin(i * 0.5);
+            // Small delay to prevent CPU overload (interactive mode only)
+            if (interactive) {
+                msleep(1);
+            }
+        }
     }
 
-    m_progressPercent = 0;
+    // Make sure the last computed step is always published
+    if (stepsSincePublish > 0) {
+        publishState();
+    }
 }
 
-void SimulationEngine::performTimeStep()
+// Decomposed runs: the workers step and the solver here only holds the
+// gathered state, so recording, checkpoints, the steady-state window and
+// publication happen at batch ends.
+void SimulationEngine::runDecomposedLoop()
 {
-    QMutexLocker locker(&m_mutex);
-
-    // Compute forces
-    std::vector<double> forces(m_state.positions.size());
-    computeForces(forces);
+    const bool interactive = (m_parameters.runMode == RunMode::Interactive);
+    QElapsedTimer publishTimer;
+    publishTimer.start();
+    int stepsSincePublish = 0;
+    const int checkpointInterval = m_parameters.checkpointInterval;
+    const int batchSize = std::max(1, m_parameters.stepBatchSize);
+    const double threshold = m_parameters.steadyStateThreshold;
+    SimulationState& state = m_domainState;
+    bool steady = false;
+
+    while (!steady && state.currentStep < state.totalSteps) {
+        if (m_isPaused.load(std::memory_order_relaxed)) {
+            waitWhilePaused();
+        }
+        if (m_shouldStop.load(std::memory_order_relaxed)) {
+            break;
+        }
 
-    // Integrate motion
-    integrateMotion(forces);
+        const int steps = std::min(batchSize, state.totalSteps - state.currentStep);
+        {
+            SIMTOOL_PROFILE_SCOPE(Step);
+            m_domains->runBatch(steps);
+        }
+        m_domains->readState(state);
+        const int previousStep = state.currentStep;
+        for (int i = 0; i < steps; ++i) {
+            state.currentTime += state.timeStep;    // Same sums as the workers
+        }
+        state.currentStep += steps;
+        stepsSincePublish += steps;
 
-    // Update time and step
-    m_state.currentTime += m_parameters.timeStep;
-    m_state.currentStep++;
-}
+        // Whole batches count towards the steady-state window
+        const bool quiet = threshold > 0.0 && state.energy <= threshold * m_solver.initialEnergy();
+        m_solver.restore(state, m_solver.initialEnergy(), quiet ? m_solver.quietSteps() + steps : 0);
 
-void SimulationEngine::computeForces(std::vector<double>& forces)
-{
-    // Simple spring-damper system
-    const size_t n = m_state.positions.size();
+        if (m_recorder && m_recorder->isDue(m_solver.currentStep())) {
+            SIMTOOL_PROFILE_SCOPE(Record);
+            m_recorder->record(m_solver.state());
+        }
+        if (checkpointInterval > 0 && previousStep / checkpointInterval != state.currentStep / checkpointInterval) {
+            submitCheckpoint();
+        }
 
-    for (size_t i = 0; i < n; ++i) {
-        // Spring force: F = -k * x
-        double springForce = -m_parameters.stiffness * m_state.positions[i];
+        if (m_solver.isSteady()) {
+            publishState();
+            stepsSincePublish = 0;
+            emit steadyStateReached(m_solver.currentTime(), m_solver.energy());
+            steady = true;
+        } else if (isPublishDue(publishTimer.elapsed(), stepsSincePublish)) {
+            publishState();
+            publishTimer.restart();
+            stepsSincePublish = 0;
+        }
 
-        // Damping force: F = -c * v
-        double dampingForce = -m_parameters.damping * m_state.velocities[i];
+        if (interactive) {
+            msleep(1);
+        }
+    }
 
-        // Total force
-        forces[i] = springForce + dampingForce;
+    if (stepsSincePublish > 0) {
+        publishState();
+    }
+}
 
-        // Add coupling with neighbors (if applicable)
-        if (i > 0) {
-            forces[i] += 0.1 * m_parameters.stiffness * (m_state.positions[i-1] - m_state.positions[i]);
+// Parareal runs: the slices iterate on their own solvers and the solver
+// here only holds the slice boundaries, so pause and stop take effect
+// between iterations (stop also cancels the slices), and recording and
+// checkpoints happen at slice boundaries once the iteration has ended.
+// There is no early stop at steady state.
+void SimulationEngine::runPararealLoop()
+{
+    const double initialEnergy = m_solver.initialEnergy();
+    const std::vector<SimulationState>& boundaries = m_parareal->boundaries();
+    int published = 0;
+
+    // After each iteration the leading exact slices show the run so far
+    const bool finished = m_parareal->run([&](const Parareal::Iteration& iteration) {
+        if (iteration.exactSlices > published) {
+            published = iteration.exactSlices;
+            m_solver.restore(boundaries[published], initialEnergy, 0);
+            publishState();
+        }
+        if (m_isPaused.load(std::memory_order_relaxed)) {
+            waitWhilePaused();
         }
-        if (i < n - 1) {
-            forces[i] += 0.1 * m_parameters.stiffness * (m_state.positions[i+1] - m_state.positions[i]);
+        if (m_shouldStop.load(std::memory_order_relaxed)) {
+            m_parareal->cancel();
         }
+    });
+
+    // A stopped or unconverged run keeps only the slices that are already exact
+    const bool converged = finished && m_parareal->isConverged();
+    const int last = converged ? m_parareal->sliceCount() : m_parareal->iterations();
+
+    const int checkpointInterval = m_parameters.checkpointInterval;
+    for (int n = 1; n <= last; ++n) {
+        const int previousStep = boundaries[n - 1].currentStep;
+        m_solver.restore(boundaries[n], initialEnergy, 0);
+        if (m_recorder && m_recorder->isDue(m_solver.currentStep())) {
+            SIMTOOL_PROFILE_SCOPE(Record);
+            m_recorder->record(m_solver.state());
+        }
+        if (checkpointInterval > 0
+            && previousStep / checkpointInterval != boundaries[n].currentStep / checkpointInterval) {
+            submitCheckpoint();
+        }
+        if (n > published) {
+            publishState();
+        }
+    }
+
+    if (finished && !converged) {
+        throw std::runtime_error(QString("Parareal did not converge to %1 within %2 iterations; only %3 of %4 "
+                                         "time slices are exact")
+                                     .arg(m_parameters.pararealTolerance).arg(m_parareal->iterations())
+                                     .arg(last).arg(m_parareal->sliceCount()).toStdString());
     }
 }
 
-void SimulationEngine::integrateMotion(const std::vector<double>& forces)
+void SimulationEngine::waitWhilePaused()
 {
-    // Simple Euler integration (can be replaced with more sophisticated methods)
-    const double mass = 1.0; // Unit mass
-    const size_t n = m_state.positions.size();
+    SIMTOOL_PROFILE_SCOPE(PauseWait);
+    QMutexLocker locker(&m_pauseMutex);
+    while (m_isPaused.load(std::memory_order_relaxed) && !m_shouldStop.load(std::memory_order_relaxed)) {
+        m_pauseCondition.wait(&m_pauseMutex);
+    }
+}
 
-    for (size_t i = 0; i < n; ++i) {
-        // a = F / m
-        m_state.accelerations[i] = forces[i] / mass;
+bool SimulationEngine::isPublishDue(qint64 elapsedMs, int stepsSincePublish) const
+{
+    if (m_parameters.runMode == RunMode::Interactive) {
+        return true;
+    }
 
-        // v = v + a * dt
-        m_state.velocities[i] += m_state.accelerations[i] * m_parameters.timeStep;
+    if (m_parameters.publishInterval > 0) {
+        return stepsSincePublish >= m_parameters.publishInterval;
+    }
 
-        // x = x + v * dt
-        m_state.positions[i] += m_state.velocities[i] * m_parameters.timeStep;
+    if (m_parameters.publishRate <= 0.0) {
+        return false;
     }
+    return elapsedMs >= static_cast<qint64>(1000.0 / m_parameters.publishRate);
 }
 
-void SimulationEngine::checkConvergence()
+void SimulationEngine::publishState()
 {
-    // Check if system has converged (optional)
-    double totalEnergy = 0.0;
+    const SimulationState& state = m_solver.state();
 
-    for (size_t i = 0; i < m_state.positions.size(); ++i) {
-        // Kinetic energy: 0.5 * m * v^2
-        totalEnergy += 0.5 * m_state.velocities[i] * m_state.velocities[i];
+    // Update progress (by simulated time, so adaptive runs report it too)
+    int progress = static_cast<int>(
+        std::min(state.currentTime / m_parameters.totalTime, 1.0) * 100.0
+    );
 
-        // Potential energy: 0.5 * k * x^2
-        totalEnergy += 0.5 * m_parameters.stiffness * m_state.positions[i] * m_state.positions[i];
+    if (progress != m_progressPercent) {
+        SIMTOOL_PROFILE_SCOPE(Emit);
+        m_progressPercent = progress;
+        emit progressUpdated(progress);
     }
 
-    // Could check if energy is below threshold for convergence
-    // For now, just continue until time limit
+    // Emit state update (shares the pooled snapshot, no per-receiver copy)
+    const StateSnapshot snapshot = publishSnapshot();
+    SIMTOOL_PROFILE_SCOPE(Emit);
+    emit stateUpdated(snapshot);
+}
+
+SimulationEngine::StateSnapshot SimulationEngine::publishSnapshot()
+{
+    SIMTOOL_PROFILE_SCOPE(Publish);
+    const SimulationState& state = m_solver.state();
+    std::shared_ptr<SimulationState> buffer = m_snapshotPool.acquire();
+
+    // Assign element-wise so recycled buffers reuse their capacity
+    buffer->currentTime = state.currentTime;
+    buffer->currentStep = state.currentStep;
+    buffer->totalSteps = state.totalSteps;
+    buffer->timeStep = state.timeStep;
+    buffer->rejectedSteps = state.rejectedSteps;
+    buffer->energy = state.energy;
+    buffer->iterations = state.iterations;
+    buffer->totalIterations = state.totalIterations;
+    buffer->positions.assign(state.positions.begin(), state.positions.end());
+    buffer->velocities.assign(state.velocities.begin(), state.velocities.end());
+    buffer->accelerations.assign(state.accelerations.begin(), state.accelerations.end());
+
+    StateSnapshot snapshot = buffer;
+    m_snapshots.writeBuffer() = snapshot;
+    m_snapshots.publish();
+    return snapshot;
+}
+
+void SimulationEngine::submitCheckpoint()
+{
+    SIMTOOL_PROFILE_SCOPE(Checkpoint);
+    QMutexLocker locker(&m_mutex);
+    m_checkpointWriter.submit(m_solver.parameters(), m_solver.state(),
+                              m_solver.initialEnergy(), m_solver.quietSteps());
+}
+
+void SimulationEngine::initializeSimulation()
+{
+    QMutexLocker locker(&m_mutex);
+    m_checkpointWriter.close();
+
+    // A restart takes the physics of the checkpoint, but runs and publishes as configured now
+    Checkpoint checkpoint;
+    const bool resume = !m_resumePath.isEmpty();
+    if (resume) {
+        QString error;
+        const QString path = m_resumePath;
+        m_resumePath.clear();
+        if (!Checkpoint::read(path, checkpoint, error)) {
+            throw std::runtime_error(error.toStdString());
+        }
+
+        SimulationParameters params = checkpoint.parameters;
+        params.runMode = m_parameters.runMode;
+        params.publishRate = m_parameters.publishRate;
+        params.publishInterval = m_parameters.publishInterval;
+        params.numThreads = m_parameters.numThreads;
+        params.stepBatchSize = m_parameters.stepBatchSize;
+        params.checkpointInterval = m_parameters.checkpointInterval;
+        params.subdomains = m_parameters.subdomains;
+        params.timeSlices = m_parameters.timeSlices;
+        params.coarseStepRatio = m_parameters.coarseStepRatio;
+        params.pararealTolerance = m_parameters.pararealTolerance;
+        params.pararealMaxIterations = m_parameters.pararealMaxIterations;
+        m_parameters = params;
+    }
+
+    // Discretize the geometry, then assemble and size the solver for it
+    const StructuralModel model = SimulationSolver::buildModel(m_shape, m_parameters.meshSize);
+
+    // Single and mixed precision runs first follow a double run for a few steps
+    if (m_parameters.precision != ScalarPrecision::Double && m_parameters.precisionCheckSteps > 0 && !resume) {
+        const SimulationSolver::PrecisionReport report =
+            SimulationSolver::validatePrecision(m_parameters, model, m_parameters.precisionCheckSteps);
+        std::cout << "[SimulationEngine] " << precisionName(report.precision) << " precision vs double after "
+                  << report.steps << " steps: position error " << report.positionError
+                  << ", energy error " << report.energyError << std::endl;
+        if (!report.passed) {
+            std::cout << "[SimulationEngine] Deviation above " << m_parameters.precisionTolerance
+                      << ", running in double precision" << std::endl;
+            m_parameters.precision = ScalarPrecision::Double;
+        }
+    }
+
+    m_solver.initialize(m_parameters, model);
+    if (resume) {
+        m_solver.restore(checkpoint.state, checkpoint.initialEnergy, checkpoint.quietSteps);
+        std::cout << "[SimulationEngine] Resumed at t = " << checkpoint.state.currentTime
+                  << " (step " << checkpoint.state.currentStep << ")" << std::endl;
+    }
+
+    // Decomposed runs step in worker processes, from the state set up above
+    m_domains.reset();
+    if (m_parameters.subdomains > 1) {
+        QString program = m_workerProgram;
+        if (program.isEmpty()) {
+            program = QCoreApplication::applicationDirPath() + "/SimulationToolCli";
+#ifdef Q_OS_WIN
+            program += ".exe";
+#endif
+        }
+        m_domains.reset(new DomainCoordinator());
+        m_domains->start(m_parameters, model, m_solver.state(), program);
+        m_domainState = m_solver.state();
+    }
+
+    // Parareal runs iterate over time slices from the same state
+    {
+        QMutexLocker pauseLocker(&m_pauseMutex);
+        m_parareal.reset();
+    }
+    if (m_parameters.timeSlices > 1) {
+        std::unique_ptr<Parareal> parareal(new Parareal());
+        parareal->setup(m_parameters, model, m_solver.state());
+        QMutexLocker pauseLocker(&m_pauseMutex);
+        m_parareal = std::move(parareal);
+    }
+
+    if (m_parameters.checkpointInterval > 0 && !m_checkpointPath.isEmpty()
+        && !m_checkpointWriter.open(m_checkpointPath, m_solver.model().numDOF())) {
+        std::cout << "[SimulationEngine] Checkpoints disabled: "
+                  << m_checkpointWriter.lastError().toStdString() << std::endl;
+    }
+
+    if (m_recorder) {
+        if (m_recorder->start(m_solver.model().numDOF())) {
+            m_recorder->record(m_solver.state());
+        } else {
+            std::cout << "[SimulationEngine] Time history disabled: " << m_recorder->lastError() << std::endl;
+        }
+    }
+
+    m_stepAllocations = 0;
+    m_progressPercent = 0;
+
+    // Timings cover this run only
+    Profiler::reset();
+    if (m_tracing) {
+        Profiler::startTrace();
+    }
+}
+
+// The solver is only touched by this thread while a run is going, so the
+// step itself takes no lock.
+template <typename Integrator>
+void SimulationEngine::performTimeStep()
+{
+    SIMTOOL_PROFILE_SCOPE(Step);
+    m_solver.step<Integrator>();
 }
 
 void SimulationEngine::finalizeSimulation()
@@ -229,5 +561,35 @@ void SimulationEngine::finalizeSimulation()
     // Cleanup and final calculations
     QMutexLocker locker(&m_mutex);
 
-    // Could save final state, compute statistics, etc.
+    // Final checkpoint, also after stopSimulation(), so a stopped run can be continued
+    if (m_checkpointWriter.isOpen()) {
+        m_checkpointWriter.flush();
+        m_checkpointWriter.submit(m_solver.parameters(), m_solver.state(),
+                                  m_solver.initialEnergy(), m_solver.quietSteps());
+        m_checkpointWriter.close();
+        std::cout << "[SimulationEngine] Checkpoints written to " << m_checkpointWriter.path().toStdString()
+                  << ": " << m_checkpointWriter.writtenCount() << " (" << m_checkpointWriter.skippedCount()
+                  << " skipped while busy)" << std::endl;
+    }
+
+    if (m_recorder && m_recorder->isRecording()) {
+        m_recorder->finish();
+        std::cout << "[SimulationEngine] Time history written to " << m_recorder->outputFile() << ": "
+                  << m_recorder->writtenCount() << " frames (" << m_recorder->droppedCount()
+                  << " dropped while the writer was behind)" << std::endl;
+    }
+
+    m_solver.printSummary(std::cout);
+    if (Profiler::isEnabled()) {
+        Profiler::stopTrace();
+        Profiler::printSummary(std::cout);
+        if (m_tracing) {
+            std::cout << "[SimulationEngine] Trace events: " << Profiler::traceEventCount() << " ("
+                      << Profiler::droppedTraceEvents() << " dropped, buffer full)" << std::endl;
+        }
+    }
+    if (AllocationCounter::isEnabled()) {
+        std::cout << "[SimulationEngine] Heap allocations inside " << m_solver.currentStep()
+                  << " time steps: " << m_stepAllocations << std::endl;
+    }
 }
@@ -0,0 +1,807 @@
+#include "SimulationSolver.h"
+#include "MeshDiscretizer.h"
+#include "NodeOrdering.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+// Rows per parallel chunk; a multiple of the widest SIMD width. The chunk
+// layout depends only on this value, which keeps results independent of
+// the thread count.
+const int ParallelGrain = 4096;
+
+int stageBuffersFor(IntegratorType type)
+{
+    switch (type) {
+        case IntegratorType::VelocityVerlet: return Integrators::VelocityVerlet::StageBuffers;
+        case IntegratorType::RungeKutta4:    return Integrators::RungeKutta4::StageBuffers;
+        case IntegratorType::Newmark:        return Integrators::Newmark::StageBuffers;
+        case IntegratorType::DormandPrince54: return Integrators::DormandPrince54::StageBuffers;
+        case IntegratorType::BackwardEuler:  return Integrators::BackwardEuler::StageBuffers;
+        case IntegratorType::ImplicitNewmark: return Integrators::ImplicitNewmark::StageBuffers;
+        case IntegratorType::ModalSuperposition: return Integrators::ModalSuperposition::StageBuffers;
+        default:                                               return Integrators::SymplecticEuler::StageBuffers;
+    }
+}
+
+// System matrix scales of the implicit schemes; false for explicit ones
+bool systemScalesFor(IntegratorType type, double h,
+                     double& dampingScale, double& stiffnessScale)
+{
+    switch (type) {
+        case IntegratorType::BackwardEuler:
+            Integrators::BackwardEuler::systemScales(h, dampingScale, stiffnessScale);
+            return true;
+        case IntegratorType::ImplicitNewmark:
+            Integrators::ImplicitNewmark::systemScales(h, dampingScale, stiffnessScale);
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+SimulationSolver::SimulationSolver()
+    : m_stateStale(false)
+    , m_originalStep(-1)
+    , m_kernels(&SolverKernels::kernels())
+    , m_initialEnergy(0.0)
+    , m_quietSteps(0)
+{
+}
+
+StructuralModel SimulationSolver::buildModel(const TopoDS_Shape& shape, double meshSize)
+{
+    // Discretize the geometry into DOFs (fallback: 10-DOF chain)
+    if (shape.IsNull()) {
+        return StructuralModel::makeChain(10);
+    }
+
+    StructuralModel model;
+    MeshDiscretizer discretizer;
+    MeshDiscretizer::Options options;
+    options.elementSize = meshSize;
+    if (!discretizer.discretize(shape, options, model)) {
+        throw std::runtime_error(discretizer.getLastError().toStdString());
+    }
+    return model;
+}
+
+void SimulationSolver::initialize(const SimulationParameters& params, const StructuralModel& model)
+{
+    m_parameters = params;
+
+    // Calculate total steps (adaptive runs start from timeStep and adjust it)
+    const bool adaptive = (m_parameters.integrator == IntegratorType::DormandPrince54);
+    const bool reduced = (m_parameters.precision != ScalarPrecision::Double);
+    const bool modal = (m_parameters.integrator == IntegratorType::ModalSuperposition);
+    double dampingScale = 0.0;
+    double stiffnessScale = 0.0;
+    const bool implicit = systemScalesFor(m_parameters.integrator, m_parameters.timeStep, dampingScale, stiffnessScale);
+    if (reduced && (adaptive || implicit || modal)) {
+        throw std::runtime_error(std::string(precisionName(m_parameters.precision))
+                                 + " precision needs an explicit fixed-step integrator");
+    }
+    if (modal && m_parameters.contactStiffness > 0.0) {
+        throw std::runtime_error("Modal superposition is linear and does not support contact");
+    }
+    const bool nonlinear = (m_parameters.nonlinearMethod != NonlinearMethod::Linear);
+    if (nonlinear && !implicit) {
+        throw std::runtime_error("Nonlinear springs need an implicit integrator");
+    }
+
+    m_state.totalSteps = adaptive ? 0 : static_cast<int>(m_parameters.totalTime / m_parameters.timeStep);
+    m_state.currentStep = 0;
+    m_state.currentTime = 0.0;
+    m_state.timeStep = m_parameters.timeStep;
+    m_state.rejectedSteps = 0;
+    m_state.iterations = 0;
+    m_state.totalIterations = 0;
+    m_stateStale = false;
+
+    // Renumber the nodes for locality before anything is laid out in memory
+    m_model = model;
+    m_dofOrder.clear();
+    m_originalState = SimulationState();
+    m_originalStep = -1;
+    if (m_parameters.dofOrdering != DofOrdering::Natural && m_model.numNodes() > 1) {
+        const std::vector<int> order = NodeOrdering::compute(m_model, m_parameters.dofOrdering);
+        const int bandwidth = m_model.bandwidth();
+        m_model.renumberNodes(order);
+        std::cout << "[SimulationSolver] DOF ordering " << NodeOrdering::name(m_parameters.dofOrdering)
+                  << ": edge bandwidth " << bandwidth << " -> " << m_model.bandwidth() << std::endl;
+
+        const int dofsPerNode = m_model.dofsPerNode;
+        m_dofOrder.resize(static_cast<size_t>(m_model.numNodes()) * dofsPerNode);
+        for (int node = 0; node < m_model.numNodes(); ++node) {
+            for (int c = 0; c < dofsPerNode; ++c) {
+                m_dofOrder[node * dofsPerNode + c] = order[node] * dofsPerNode + c;
+            }
+        }
+    }
+    m_model.assemble(m_parameters.stiffness);
+
+    // Initialize state vectors
+    const int numDOF = m_model.numDOF();
+    m_state.positions.assign(numDOF, 0.0);
+    m_state.velocities.assign(numDOF, 0.0);
+    m_state.accelerations.assign(numDOF, 0.0);
+
+    // Set initial conditions (example: small perturbation, by original DOF)
+    for (int i = 0; i < numDOF; ++i) {
+        const int dof = m_dofOrder.empty() ? i : m_dofOrder[i];
+        m_state.positions[i] = StructuralModel::initialDisplacement(dof);
+    }
+
+    // Every scratch buffer of the step loop is sized here, once (in single
+    // and mixed precision the double workspace only sets up the initial state)
+    const int stageCount = stageBuffersFor(m_parameters.integrator);
+    const int chunkCount = WorkStealingPool::chunkCount(0, numDOF, ParallelGrain);
+    m_workspace.resize(numDOF, reduced ? 0 : stageCount, chunkCount);
+    for (int i = 0; i < numDOF; ++i) {
+        m_workspace.inverseMasses[i] = 1.0 / m_model.masses[i];
+    }
+    m_kernels = &SolverKernels::kernels();
+
+    // Thread pool (only worth it when there are several chunks to share)
+    int numThreads = WorkStealingPool::resolveThreadCount(m_parameters.numThreads);
+    numThreads = std::min(numThreads, WorkStealingPool::chunkCount(0, numDOF, ParallelGrain));
+    if (numThreads <= 1) {
+        m_pool.reset();
+    } else if (!m_pool || m_pool->threadCount() != numThreads) {
+        m_pool.reset(new WorkStealingPool(numThreads));
+    }
+
+    // Contact between bodies; the penalty forces enter every force evaluation
+    m_contact.clear();
+    m_workspace.contactForces = AlignedVector();
+    if (m_parameters.contactStiffness > 0.0) {
+        if (m_contact.setup(m_model, m_parameters.contactStiffness, m_parameters.contactThickness,
+                            m_pool.get(), ParallelGrain)) {
+            m_workspace.contactForces.assign(numDOF, 0.0);
+        } else {
+            std::cout << "[SimulationSolver] Contact needs at least two meshed bodies; disabled" << std::endl;
+        }
+    }
+
+    // Implicit schemes: factor the constant system matrix once per run
+    // (nonlinear ones form their Jacobian from the tangent stiffness instead)
+    m_newton.clear();
+    if (implicit && nonlinear) {
+        NewtonSolver::Options options;
+        options.method = m_parameters.nonlinearMethod;
+        options.maxIterations = m_parameters.maxIterations;
+        options.tolerance = m_parameters.tolerance;
+        options.preconditioner = m_parameters.preconditioner;
+        options.solverIterations = m_parameters.maxIterations;
+        options.solverTolerance = m_parameters.tolerance;
+        m_systemMatrix = SparseMatrix();
+        m_newton.setup(m_model, m_parameters.stiffness, m_parameters.damping, dampingScale, stiffnessScale,
+                       options, m_state.positions.data(), m_contact.isEnabled() ? &m_contact : nullptr,
+                       m_workspace.contactForces.data(), m_pool.get(), ParallelGrain);
+    } else if (implicit) {
+        std::vector<double> shift(numDOF);
+        for (int i = 0; i < numDOF; ++i) {
+            shift[i] = m_model.masses[i] + dampingScale * m_parameters.damping;
+        }
+        m_systemMatrix = m_model.stiffness.scaledPlusDiagonal(stiffnessScale, shift.data());
+        m_linearSolver.setup(m_systemMatrix, m_parameters.preconditioner, m_pool.get(), ParallelGrain);
+    } else {
+        m_systemMatrix = SparseMatrix();
+    }
+
+    // Multi-step schemes start from a = M^-1 f(x0, v0); reference energy E0
+    m_state.energy = evaluateState(true);
+    m_initialEnergy = m_state.energy;
+    m_quietSteps = 0;
+
+    // Modal superposition: extract the modes and restart from the retained part of the state
+    m_modes.clear();
+    m_modal = ModalStorage();
+    if (modal) {
+        setupModal();
+    }
+
+    // Reduced precision: round the operator and the initial state once
+    m_single = ReducedStorage<ScalarPrecisions::Single>();
+    m_mixed = ReducedStorage<ScalarPrecisions::Mixed>();
+    switch (m_parameters.precision) {
+        case ScalarPrecision::Single:
+            storeReduced(m_single, stageCount, chunkCount);
+            break;
+        case ScalarPrecision::Mixed:
+            storeReduced(m_mixed, stageCount, chunkCount);
+            break;
+        default:
+            break;
+    }
+}
+
+void SimulationSolver::restore(const SimulationState& state, double initialEnergy, int quietSteps)
+{
+    const size_t numDOF = static_cast<size_t>(m_model.numDOF());
+    if (state.positions.size() != numDOF || state.velocities.size() != numDOF
+        || state.accelerations.size() != numDOF) {
+        throw std::runtime_error("Saved state has " + std::to_string(state.positions.size())
+                                 + " DOFs, the model has " + std::to_string(numDOF));
+    }
+
+    // Element-wise, so the state keeps the buffers sized in initialize()
+    m_state.currentTime = state.currentTime;
+    m_state.currentStep = state.currentStep;
+    m_state.timeStep = state.timeStep;
+    m_state.rejectedSteps = state.rejectedSteps;
+    m_state.energy = state.energy;
+    m_state.iterations = state.iterations;
+    m_state.totalIterations = state.totalIterations;
+    if (m_dofOrder.empty()) {
+        std::copy(state.positions.begin(), state.positions.end(), m_state.positions.begin());
+        std::copy(state.velocities.begin(), state.velocities.end(), m_state.velocities.begin());
+        std::copy(state.accelerations.begin(), state.accelerations.end(), m_state.accelerations.begin());
+    } else {
+        // Saved states are in the original numbering
+        for (size_t i = 0; i < numDOF; ++i) {
+            const int dof = m_dofOrder[i];
+            m_state.positions[i] = state.positions[dof];
+            m_state.velocities[i] = state.velocities[dof];
+            m_state.accelerations[i] = state.accelerations[dof];
+        }
+    }
+    m_originalStep = -1;
+    m_initialEnergy = initialEnergy;
+    m_quietSteps = quietSteps;
+    m_stateStale = false;
+
+    switch (m_parameters.precision) {
+        case ScalarPrecision::Single:
+            storeReducedState(m_single);
+            break;
+        case ScalarPrecision::Mixed:
+            storeReducedState(m_mixed);
+            break;
+        default:
+            break;
+    }
+    if (m_parameters.integrator == IntegratorType::ModalSuperposition) {
+        storeModalState();
+    }
+}
+
+void SimulationSolver::setupModal()
+{
+    ModalAnalysis::Options options;
+    options.modeCount = m_parameters.modeCount;
+    options.randomOrder = m_dofOrder.empty() ? nullptr : m_dofOrder.data();
+    if (!m_modes.compute(m_model, options, m_pool.get(), ParallelGrain)) {
+        throw std::runtime_error("Modal analysis failed: " + m_modes.lastError());
+    }
+
+    const int modes = m_modes.modeCount();
+    const int numDOF = m_model.numDOF();
+    m_modal.displacements.assign(modes, 0.0);
+    m_modal.velocities.assign(modes, 0.0);
+    m_modal.accelerations.assign(modes, 0.0);
+    m_modal.dampings.assign(modes, 0.0);
+    m_modal.propagators.assign(4 * static_cast<size_t>(modes), 0.0);
+
+    // Modal damping from the diagonal of Phi^T (c I) Phi (exact for uniform masses)
+    for (int k = 0; k < modes; ++k) {
+        const double* shape = m_modes.modeShape(k);
+        double sum = 0.0;
+        for (int i = 0; i < numDOF; ++i) {
+            sum += shape[i] * shape[i];
+        }
+        m_modal.dampings[k] = 0.5 * m_parameters.damping * sum;
+        Integrators::ModalSuperposition::propagator(m_modes.eigenvalues()[k], m_modal.dampings[k],
+                                                    m_parameters.timeStep, &m_modal.propagators[4 * k]);
+    }
+
+    // The run starts from the projection of the initial state; E0 is its energy
+    const double fullEnergy = m_state.energy;
+    storeModalState();
+    loadModalState();
+    double energy = 0.0;
+    for (int k = 0; k < modes; ++k) {
+        const double q = m_modal.displacements[k];
+        const double v = m_modal.velocities[k];
+        energy += v * v + m_modes.eigenvalues()[k] * q * q;
+    }
+    m_state.energy = 0.5 * energy;
+    m_initialEnergy = m_state.energy;
+
+    std::cout << "[SimulationSolver] Modal superposition: " << modes << " modes, " << m_modes.frequency(0)
+              << " - " << m_modes.frequency(modes - 1) << " Hz, "
+              << 100.0 * m_state.energy / std::max(fullEnergy, 1e-300)
+              << "% of the initial energy retained" << std::endl;
+}
+
+void SimulationSolver::storeModalState()
+{
+    m_modes.project(m_state.positions.data(), m_modal.displacements.data());
+    m_modes.project(m_state.velocities.data(), m_modal.velocities.data());
+    for (int k = 0; k < m_modes.modeCount(); ++k) {
+        m_modal.accelerations[k] = -m_modes.eigenvalues()[k] * m_modal.displacements[k]
+                                 - 2.0 * m_modal.dampings[k] * m_modal.velocities[k];
+    }
+}
+
+void SimulationSolver::loadModalState() const
+{
+    m_modes.expand(m_modal.displacements.data(), m_state.positions.data());
+    m_modes.expand(m_modal.velocities.data(), m_state.velocities.data());
+    m_modes.expand(m_modal.accelerations.data(), m_state.accelerations.data());
+}
+
+const SimulationState& SimulationSolver::state() const
+{
+    if (m_stateStale) {
+        if (m_parameters.integrator == IntegratorType::ModalSuperposition) {
+            loadModalState();
+        } else if (m_parameters.precision == ScalarPrecision::Single) {
+            loadReducedState(m_single);
+        } else {
+            loadReducedState(m_mixed);
+        }
+        m_stateStale = false;
+    }
+    if (m_dofOrder.empty()) {
+        return m_state;
+    }
+
+    // Scalars on every call, vectors once per step (every step advances currentStep)
+    m_originalState.currentTime = m_state.currentTime;
+    m_originalState.currentStep = m_state.currentStep;
+    m_originalState.totalSteps = m_state.totalSteps;
+    m_originalState.timeStep = m_state.timeStep;
+    m_originalState.rejectedSteps = m_state.rejectedSteps;
+    m_originalState.energy = m_state.energy;
+    m_originalState.iterations = m_state.iterations;
+    m_originalState.totalIterations = m_state.totalIterations;
+    if (m_originalStep != m_state.currentStep) {
+        const size_t numDOF = m_dofOrder.size();
+        m_originalState.positions.resize(numDOF);
+        m_originalState.velocities.resize(numDOF);
+        m_originalState.accelerations.resize(numDOF);
+        for (size_t i = 0; i < numDOF; ++i) {
+            const int dof = m_dofOrder[i];
+            m_originalState.positions[dof] = m_state.positions[i];
+            m_originalState.velocities[dof] = m_state.velocities[i];
+            m_originalState.accelerations[dof] = m_state.accelerations[i];
+        }
+        m_originalStep = m_state.currentStep;
+    }
+    return m_originalState;
+}
+
+SimulationState& SimulationSolver::writableState()
+{
+    if (m_parameters.precision != ScalarPrecision::Double
+        || m_parameters.integrator == IntegratorType::ModalSuperposition || !m_dofOrder.empty()) {
+        throw std::runtime_error("Only double precision runs in the natural numbering expose their state");
+    }
+    return m_state;
+}
+
+template <typename PrecisionPolicy>
+void SimulationSolver::storeReduced(ReducedStorage<PrecisionPolicy>& storage, int stageCount, int chunkCount)
+{
+    typedef typename PrecisionPolicy::Real Real;
+
+    const std::vector<double>& values = m_model.stiffness.values();
+    storage.stiffnessValues.resize(values.size());
+    std::transform(values.begin(), values.end(), storage.stiffnessValues.begin(),
+                   [](double value) { return static_cast<Real>(value); });
+
+    const int numDOF = m_model.numDOF();
+    storage.workspace.resize(numDOF, stageCount, chunkCount);
+    if (m_contact.isEnabled()) {
+        storage.workspace.contactForces.assign(numDOF, Real(0));
+    }
+    for (int i = 0; i < numDOF; ++i) {
+        storage.workspace.inverseMasses[i] = static_cast<Real>(m_workspace.inverseMasses[i]);
+    }
+
+    storage.positions.resize(numDOF);
+    storage.velocities.resize(numDOF);
+    storage.accelerations.resize(numDOF);
+    storeReducedState(storage);
+}
+
+template <typename PrecisionPolicy>
+void SimulationSolver::storeReducedState(ReducedStorage<PrecisionPolicy>& storage)
+{
+    std::copy(m_state.positions.begin(), m_state.positions.end(), storage.positions.begin());
+    std::copy(m_state.velocities.begin(), m_state.velocities.end(), storage.velocities.begin());
+    std::copy(m_state.accelerations.begin(), m_state.accelerations.end(), storage.accelerations.begin());
+}
+
+template <typename PrecisionPolicy>
+void SimulationSolver::loadReducedState(const ReducedStorage<PrecisionPolicy>& storage) const
+{
+    std::copy(storage.positions.begin(), storage.positions.end(), m_state.positions.begin());
+    std::copy(storage.velocities.begin(), storage.velocities.end(), m_state.velocities.begin());
+    std::copy(storage.accelerations.begin(), storage.accelerations.end(), m_state.accelerations.begin());
+}
+
+template <typename Integrator>
+void SimulationSolver::step()
+{
+    // Advance x, v and a by one step with the selected scheme
+    typedef typename Integrators::PrecisionOf<Integrator>::Type PrecisionPolicy;
+
+    if constexpr (std::is_same<Integrator, Integrators::ModalSuperposition>::value) {
+        // O(modes) per step; the physical state is expanded when state() is read
+        m_state.energy = Integrator::step(m_modes.modeCount(), m_modes.eigenvalues().data(),
+                                          m_modal.dampings.data(), m_modal.propagators.data(),
+                                          m_modal.displacements.data(), m_modal.velocities.data(),
+                                          m_modal.accelerations.data());
+        m_state.currentTime += m_parameters.timeStep;
+        m_state.currentStep++;
+        m_stateStale = true;
+    } else if constexpr (!std::is_same<PrecisionPolicy, ScalarPrecisions::Double>::value) {
+        BasicIntegratorContext<PrecisionPolicy> context = makeIntegratorContext(reducedStorage(PrecisionPolicy()));
+        Integrator::step(context);
+        m_state.energy = context.totalEnergy();
+        m_state.currentTime += m_parameters.timeStep;
+        m_state.currentStep++;
+        m_stateStale = true;
+    } else if constexpr (Integrator::Adaptive) {
+        IntegratorContext context = makeIntegratorContext();
+        const Integrators::StepSizeController controller;
+        const double remaining = m_parameters.totalTime - m_state.currentTime;
+        const double minStep = 1e-12 * m_parameters.totalTime;
+
+        // Retry with smaller steps until the error estimate is within tolerance
+        for (int attempt = 1; ; ++attempt) {
+            const double h = std::min(m_state.timeStep, remaining);
+            context.kernelArgs.timeStep = h;
+            const double error = Integrator::attempt(context, m_parameters.tolerance);
+
+            if (error <= 1.0) {
+                Integrator::accept(context);
+                m_state.energy = context.totalEnergy();
+                m_state.currentTime = (h == remaining) ? m_parameters.totalTime : m_state.currentTime + h;
+                m_state.currentStep++;
+                // Shortening the last step to land on totalTime must not shrink the next one
+                const double next = controller.nextStep(h, error, Integrator::ErrorOrder, attempt > 1);
+                m_state.timeStep = (h < m_state.timeStep) ? std::max(m_state.timeStep, next) : next;
+                return;
+            }
+
+            m_state.rejectedSteps++;
+            m_state.timeStep = controller.nextStep(h, error, Integrator::ErrorOrder, true);
+
+            if (attempt >= m_parameters.maxIterations) {
+                throw std::runtime_error("Adaptive step rejected " + std::to_string(attempt)
+                                         + " times at t = " + std::to_string(m_state.currentTime));
+            }
+            if (m_state.timeStep < minStep) {
+                throw std::runtime_error("Adaptive step size underflow at t = "
+                                         + std::to_string(m_state.currentTime));
+            }
+        }
+    } else {
+        IntegratorContext context = makeIntegratorContext();
+        Integrator::step(context);
+        m_state.energy = context.totalEnergy();
+
+        if (context.newton) {
+            const NewtonSolver::Result& result = m_newton.lastResult();
+            m_state.iterations = result.iterations;
+            m_state.totalIterations += result.iterations;
+            if (!result.converged) {
+                throw std::runtime_error("Newton iterations did not converge within "
+                                         + std::to_string(m_parameters.maxIterations) + " iterations at t = "
+                                         + std::to_string(m_state.currentTime) + " (residual "
+                                         + std::to_string(result.residual) + ")");
+            }
+        } else if (Integrator::Implicit) {
+            const ConjugateGradient::Result& result = m_linearSolver.lastResult();
+            if (!result.converged) {
+                throw std::runtime_error("Linear solver did not converge within "
+                                         + std::to_string(m_parameters.maxIterations) + " iterations at t = "
+                                         + std::to_string(m_state.currentTime) + " (residual "
+                                         + std::to_string(result.residual) + ")");
+            }
+        }
+
+        // Update time and step
+        m_state.currentTime += m_parameters.timeStep;
+        m_state.currentStep++;
+    }
+}
+
+template <typename Integrator>
+bool SimulationSolver::isEndReached() const
+{
+    // Adaptive runs end on simulated time, fixed-step runs on the step count
+    if (Integrator::Adaptive) {
+        return m_state.currentTime >= m_parameters.totalTime;
+    }
+    return m_state.currentStep >= m_state.totalSteps;
+}
+
+SolverKernels::StepArgs SimulationSolver::makeStepArgs()
+{
+    const SparseMatrix& k = m_model.stiffness;
+
+    SolverKernels::StepArgs args;
+    args.begin = 0;
+    args.end = k.size();
+    args.rowPointers = k.rowPointers().data();
+    args.columnIndices = k.columnIndices().data();
+    args.values = k.values().data();
+    args.positions = m_state.positions.data();
+    args.nextPositions = m_workspace.nextPositions.data();
+    args.velocities = m_state.velocities.data();
+    args.accelerations = m_state.accelerations.data();
+    args.inverseMasses = m_workspace.inverseMasses.data();
+    args.damping = m_parameters.damping;
+    args.timeStep = m_parameters.timeStep;
+    return args;
+}
+
+IntegratorContext SimulationSolver::makeIntegratorContext()
+{
+    IntegratorContext context;
+    context.kernelArgs = makeStepArgs();
+    context.kernels = m_kernels;
+    context.pool = m_pool.get();
+    context.grain = ParallelGrain;
+    context.positions = &m_state.positions;
+    context.velocities = &m_state.velocities;
+    context.accelerations = &m_state.accelerations;
+    context.workspace = &m_workspace;
+    context.contact = m_contact.isEnabled() ? &m_contact : nullptr;
+    context.linearSolver = &m_linearSolver;
+    context.maxIterations = m_parameters.maxIterations;
+    context.tolerance = m_parameters.tolerance;
+    context.newton = m_newton.isEnabled() ? &m_newton : nullptr;
+    return context;
+}
+
+template <typename PrecisionPolicy>
+BasicIntegratorContext<PrecisionPolicy> SimulationSolver::makeIntegratorContext(ReducedStorage<PrecisionPolicy>& storage)
+{
+    const SparseMatrix& k = m_model.stiffness;
+
+    BasicIntegratorContext<PrecisionPolicy> context;
+    context.kernelArgs.begin = 0;
+    context.kernelArgs.end = k.size();
+    context.kernelArgs.rowPointers = k.rowPointers().data();
+    context.kernelArgs.columnIndices = k.columnIndices().data();
+    context.kernelArgs.values = storage.stiffnessValues.data();
+    context.kernelArgs.inverseMasses = storage.workspace.inverseMasses.data();
+    context.kernelArgs.damping = m_parameters.damping;
+    context.kernelArgs.timeStep = m_parameters.timeStep;
+    context.kernels = m_kernels;
+    context.pool = m_pool.get();
+    context.grain = ParallelGrain;
+    context.positions = &storage.positions;
+    context.velocities = &storage.velocities;
+    context.accelerations = &storage.accelerations;
+    context.workspace = &storage.workspace;
+    context.contact = m_contact.isEnabled() ? &m_contact : nullptr;
+    return context;
+}
+
+void SimulationSolver::runKernel(void (*kernel)(const SolverKernels::StepArgs&),
+                                 const SolverKernels::StepArgs& args)
+{
+    if (!m_pool) {
+        kernel(args);
+        return;
+    }
+
+    // Rows are independent, so each chunk writes a disjoint slice
+    m_pool->parallelFor(args.begin, args.end, ParallelGrain,
+        [kernel, &args](int, int chunkBegin, int chunkEnd) {
+            SolverKernels::StepArgs chunkArgs = args;
+            chunkArgs.begin = chunkBegin;
+            chunkArgs.end = chunkEnd;
+            kernel(chunkArgs);
+        });
+}
+
+void SimulationSolver::computeForces(AlignedVector& forces)
+{
+    SIMTOOL_PROFILE_SCOPE(Forces);
+
+    // F = -K * x - c * v
+    SolverKernels::StepArgs args = makeStepArgs();
+    args.forces = forces.data();
+    runKernel(m_kernels->computeForces, args);
+}
+
+double SimulationSolver::evaluateState(bool updateAccelerations)
+{
+    const int numDOF = m_model.numDOF();
+    double energy = 0.0;
+    if (m_newton.isEnabled()) {
+        // Nonlinear forces include contact; the potential is the elastic energy of the springs
+        m_newton.computeForces(m_state.positions.data(), m_state.velocities.data(), m_workspace.forces.data());
+        const double* potential = m_newton.potentialEnergies();
+        for (int i = 0; i < numDOF; ++i) {
+            const double v = m_state.velocities[i];
+            if (updateAccelerations) {
+                m_state.accelerations[i] = m_workspace.forces[i] * m_workspace.inverseMasses[i];
+            }
+            energy += m_model.masses[i] * v * v + 2.0 * potential[i];
+        }
+    } else {
+        computeForces(m_workspace.forces);
+        if (m_contact.isEnabled() && updateAccelerations) {
+            m_contact.computeForces(m_state.positions.data(), m_workspace.contactForces.data());
+        }
+        for (int i = 0; i < numDOF; ++i) {
+            const double f = m_workspace.forces[i];
+            const double v = m_state.velocities[i];
+            if (updateAccelerations) {
+                const double contact = m_contact.isEnabled() ? m_workspace.contactForces[i] : 0.0;
+                m_state.accelerations[i] = (f + contact) * m_workspace.inverseMasses[i];
+            }
+            energy += m_model.masses[i] * v * v - m_state.positions[i] * (f + m_parameters.damping * v);
+        }
+    }
+    return 0.5 * energy;
+}
+
+double SimulationSolver::stateEnergy()
+{
+    state();    // Brings reduced-precision and modal runs back to the double state
+    return evaluateState(false);
+}
+
+void SimulationSolver::runSteps(int count)
+{
+    dispatch([this, count](auto policy) {
+        typedef decltype(policy) Integrator;
+        for (int i = 0; i < count && !this->isEndReached<Integrator>(); ++i) {
+            this->step<Integrator>();
+        }
+    });
+}
+
+SimulationSolver::PrecisionReport SimulationSolver::validatePrecision(const SimulationParameters& params,
+                                                                      const StructuralModel& model, int steps)
+{
+    SimulationParameters referenceParams = params;
+    referenceParams.precision = ScalarPrecision::Double;
+
+    SimulationSolver solver;
+    SimulationSolver reference;
+    solver.initialize(params, model);
+    reference.initialize(referenceParams, model);
+
+    PrecisionReport report;
+    report.precision = params.precision;
+    report.steps = 0;
+    report.energyError = 0.0;
+
+    // Energies are reduced inside each step, so they are compared at every step
+    const double energyScale = std::max(std::fabs(reference.initialEnergy()), 1e-300);
+    const int count = std::min(steps, reference.m_state.totalSteps);
+    for (int i = 0; i < count; ++i) {
+        solver.runSteps(1);
+        reference.runSteps(1);
+        report.energyError = std::max(report.energyError,
+                                      std::fabs(solver.energy() - reference.energy()) / energyScale);
+        report.steps++;
+    }
+
+    const SimulationState& x = solver.state();
+    const SimulationState& xRef = reference.state();
+    double difference = 0.0;
+    double norm = 0.0;
+    for (size_t i = 0; i < xRef.positions.size(); ++i) {
+        const double d = x.positions[i] - xRef.positions[i];
+        difference += d * d;
+        norm += xRef.positions[i] * xRef.positions[i];
+    }
+    report.positionError = std::sqrt(difference / std::max(norm, 1e-300));
+    report.passed = report.positionError <= params.precisionTolerance
+                 && report.energyError <= params.precisionTolerance;
+    return report;
+}
+
+bool SimulationSolver::checkSteadyState()
+{
+    // The energy was reduced inside the step; this only compares it
+    if (m_parameters.steadyStateThreshold <= 0.0) {
+        return false;
+    }
+
+    if (m_state.energy <= m_parameters.steadyStateThreshold * m_initialEnergy) {
+        m_quietSteps++;
+    } else {
+        m_quietSteps = 0;
+    }
+    return m_quietSteps >= std::max(m_parameters.steadyStateWindow, 1);
+}
+
+bool SimulationSolver::isSteady() const
+{
+    return m_parameters.steadyStateThreshold > 0.0
+        && m_quietSteps >= std::max(m_parameters.steadyStateWindow, 1);
+}
+
+void SimulationSolver::printSummary(std::ostream& out) const
+{
+    if (isSteady()) {
+        out << "[SimulationSolver] Steady state at t = " << m_state.currentTime
+            << " (energy " << m_state.energy << ", initial " << m_initialEnergy << ")" << std::endl;
+    }
+    if (m_parameters.integrator == IntegratorType::DormandPrince54) {
+        out << "[SimulationSolver] Adaptive steps: " << m_state.currentStep << " accepted, "
+            << m_state.rejectedSteps << " rejected, last step size " << m_state.timeStep << std::endl;
+    }
+    if (m_modes.modeCount() > 0) {
+        out << "[SimulationSolver] Modal superposition: " << m_modes.modeCount() << " modes up to "
+            << m_modes.frequency(m_modes.modeCount() - 1) << " Hz (" << m_modes.lanczosSteps()
+            << " Lanczos steps, " << m_modes.solverIterations() << " CG iterations)" << std::endl;
+    }
+    if (m_contact.isEnabled()) {
+        const ContactDetector::Statistics& contact = m_contact.statistics();
+        out << "[SimulationSolver] Contact: " << m_contact.bodyCount() << " bodies, thickness "
+            << m_contact.thickness() << ", " << contact.contacts << " nodes in contact (peak "
+            << contact.peakContacts << "), max penetration " << contact.maxPenetration << std::endl;
+    }
+    if (m_newton.isEnabled() && m_newton.statistics().steps > 0) {
+        const NewtonSolver::Statistics& newton = m_newton.statistics();
+        const ConjugateGradient& cg = m_newton.linearSolver();
+        out << "[SimulationSolver] "
+            << (m_newton.method() == NonlinearMethod::ModifiedNewton ? "Modified Newton" : "Newton") << ": "
+            << static_cast<double>(newton.iterations) / newton.steps << " iterations per step (max "
+            << newton.maxStepIterations << "), " << newton.tangentUpdates << " tangent updates, "
+            << newton.lineSearchCuts << " line search cuts, "
+            << (cg.solveCount() > 0 ? static_cast<double>(cg.totalIterations()) / cg.solveCount() : 0.0)
+            << " CG iterations per solve" << std::endl;
+    }
+    if (!m_systemMatrix.isEmpty() && m_linearSolver.solveCount() > 0) {
+        out << "[SimulationSolver] CG ("
+            << (m_linearSolver.preconditioner() == ConjugateGradient::Preconditioner::Jacobi ? "Jacobi" : "IC(0)")
+            << "): " << m_linearSolver.solveCount() << " solves, "
+            << static_cast<double>(m_linearSolver.totalIterations()) / m_linearSolver.solveCount()
+            << " iterations per solve, " << m_linearSolver.failedSolves()
+            << " not converged within " << m_parameters.maxIterations << " iterations" << std::endl;
+    }
+}
+
+// One step loop per integrator policy
+#define SIMTOOL_INSTANTIATE_STEP(Policy) \
+    template void SimulationSolver::step<Integrators::Policy>(); \
+    template bool SimulationSolver::isEndReached<Integrators::Policy>() const;
+
+SIMTOOL_INSTANTIATE_STEP(SymplecticEuler)
+SIMTOOL_INSTANTIATE_STEP(VelocityVerlet)
+SIMTOOL_INSTANTIATE_STEP(RungeKutta4)
+SIMTOOL_INSTANTIATE_STEP(Newmark)
+SIMTOOL_INSTANTIATE_STEP(DormandPrince54)
+SIMTOOL_INSTANTIATE_STEP(BackwardEuler)
+SIMTOOL_INSTANTIATE_STEP(ImplicitNewmark)
+SIMTOOL_INSTANTIATE_STEP(ModalSuperposition)
+
+#undef SIMTOOL_INSTANTIATE_STEP
+
+// Explicit fixed-step policies also run in single and mixed precision
+#define SIMTOOL_INSTANTIATE_REDUCED_STEP(Policy, Mode) \
+    template void SimulationSolver::step<Integrators::WithPrecision<Integrators::Policy, ScalarPrecisions::Mode> >(); \
+    template bool SimulationSolver::isEndReached<Integrators::WithPrecision<Integrators::Policy, ScalarPrecisions::Mode> >() const;
+
+SIMTOOL_INSTANTIATE_REDUCED_STEP(SymplecticEuler, Single)
+SIMTOOL_INSTANTIATE_REDUCED_STEP(SymplecticEuler, Mixed)
+SIMTOOL_INSTANTIATE_REDUCED_STEP(VelocityVerlet, Single)
+SIMTOOL_INSTANTIATE_REDUCED_STEP(VelocityVerlet, Mixed)
+SIMTOOL_INSTANTIATE_REDUCED_STEP(RungeKutta4, Single)
+SIMTOOL_INSTANTIATE_REDUCED_STEP(RungeKutta4, Mixed)
+SIMTOOL_INSTANTIATE_REDUCED_STEP(Newmark, Single)
+SIMTOOL_INSTANTIATE_REDUCED_STEP(Newmark, Mixed)
+
+#undef SIMTOOL_INSTANTIATE_REDUCED_STEP
@@ -1,7 +1,11 @@
 ﻿#include "SimulatorMainWindow.h"
 #include "SimulationEngine.h"
+#include "SimulationSolver.h"
+#include "ModalAnalysis.h"
 #include "STEPReader.h"
 #include "SharedMemorySender.h"
+#include "TimeHistoryRecorder.h"
+#include "Profiler.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -14,6 +18,8 @@
 #include <QUuid>
 #include <QProcess>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 // OpenCASCADE includes
@@ -29,7 +35,10 @@ SimulatorMainWindow::SimulatorMainWindow(QWidget *parent)
     , m_fileMenu(nullptr)
     , m_openSTEPAction(nullptr)
     , m_saveResultsAction(nullptr)
+    , m_resumeCheckpointAction(nullptr)
+    , m_exportTraceAction(nullptr)
     , m_exitAction(nullptr)
+    , m_modalAnalysisAction(nullptr)
     , m_toolBar(nullptr)
     , m_startAction(nullptr)
     , m_pauseAction(nullptr)
@@ -39,15 +48,38 @@ SimulatorMainWindow::SimulatorMainWindow(QWidget *parent)
     , m_parameterDock(nullptr)
     , m_parameterWidget(nullptr)
     , m_timeStepSpinBox(nullptr)
+    , m_suggestTimeStepButton(nullptr)
     , m_totalTimeSpinBox(nullptr)
     , m_dampingSpinBox(nullptr)
     , m_stiffnessSpinBox(nullptr)
+    , m_meshSizeSpinBox(nullptr)
+    , m_contactStiffnessSpinBox(nullptr)
+    , m_contactThicknessSpinBox(nullptr)
+    , m_unthrottledCheckBox(nullptr)
+    , m_threadCountSpinBox(nullptr)
+    , m_subdomainsSpinBox(nullptr)
+    , m_timeSlicesSpinBox(nullptr)
+    , m_integratorComboBox(nullptr)
+    , m_modeCountSpinBox(nullptr)
+    , m_nonlinearComboBox(nullptr)
+    , m_orderingComboBox(nullptr)
+    , m_precisionComboBox(nullptr)
+    , m_toleranceSpinBox(nullptr)
+    , m_maxIterationsSpinBox(nullptr)
+    , m_preconditionerComboBox(nullptr)
+    , m_steadyStateThresholdSpinBox(nullptr)
+    , m_steadyStateWindowSpinBox(nullptr)
+    , m_checkpointIntervalSpinBox(nullptr)
+    , m_recordIntervalSpinBox(nullptr)
     , m_progressBar(nullptr)
     , m_statusLabel(nullptr)
+    , m_profileLabel(nullptr)
     , m_simulationEngine(nullptr)
     , m_stepReader(nullptr)
     , m_sharedMemorySender(nullptr)
+    , m_historyRecorder(nullptr)
     , m_isSimulationRunning(false)
+    , m_steadyStateTime(-1.0)
 {
     setupUI();
     initializeOCC();
@@ -56,6 +88,15 @@ SimulatorMainWindow::SimulatorMainWindow(QWidget *parent)
     m_simulationEngine    = new SimulationEngine(this);
     m_stepReader          = new STEPReader(this);
     m_sharedMemorySender  = new SharedMemorySender(this);
+    m_historyRecorder     = new TimeHistoryRecorder();
+
+    // Every run streams its time history to a temporary file; "保存结果" exports it
+    m_historyRecorder->setOutputFile(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+        .filePath(QString("SimulationTool_%1.simh").arg(QCoreApplication::applicationPid())).toStdString());
+    m_simulationEngine->setRecorder(m_historyRecorder);
+
+    // Profiling builds keep a trace of every run for "导出性能跟踪"
+    m_simulationEngine->setTracing(Profiler::isEnabled());
 
     // Connect signals
     connect(m_simulationEngine, &SimulationEngine::progressUpdated,
@@ -64,6 +105,8 @@ SimulatorMainWindow::SimulatorMainWindow(QWidget *parent)
             this, &SimulatorMainWindow::onSimulationFinished);
     connect(m_simulationEngine, &SimulationEngine::simulationError,
             this, &SimulatorMainWindow::onSimulationError);
+    connect(m_simulationEngine, &SimulationEngine::steadyStateReached,
+            this, &SimulatorMainWindow::onSteadyStateReached);
 
     // Initialize shared memory
     m_sharedMemorySender->initialize("SimulationData", 1024 * 1024); // 1 MB
@@ -96,6 +139,7 @@ SimulatorMainWindow::~SimulatorMainWindow()
         m_simulationEngine->stopSimulation();
         m_simulationEngine->wait();
     }
+    delete m_historyRecorder;
 }
 
 void SimulatorMainWindow::resizeEvent(QResizeEvent* event)
@@ -145,6 +189,15 @@ void SimulatorMainWindow::createMenuBar()
     connect(m_saveResultsAction, &QAction::triggered, this, &SimulatorMainWindow::onSaveResults);
     m_fileMenu->addAction(m_saveResultsAction);
 
+    m_resumeCheckpointAction = new QAction(tr("从检查点恢复(&R)..."), this);
+    connect(m_resumeCheckpointAction, &QAction::triggered, this, &SimulatorMainWindow::onResumeFromCheckpoint);
+    m_fileMenu->addAction(m_resumeCheckpointAction);
+
+    m_exportTraceAction = new QAction(tr("导出性能跟踪(&T)..."), this);
+    m_exportTraceAction->setVisible(Profiler::isEnabled());
+    connect(m_exportTraceAction, &QAction::triggered, this, &SimulatorMainWindow::onExportTrace);
+    m_fileMenu->addAction(m_exportTraceAction);
+
     m_fileMenu->addSeparator();
 
     m_exitAction = new QAction(tr("退出(&X)"), this);
@@ -160,6 +213,11 @@ void SimulatorMainWindow::createMenuBar()
     connect(m_sendToGeomAction, &QAction::triggered,
             this, &SimulatorMainWindow::onSendToGeomProcessor);
     geomMenu->addAction(m_sendToGeomAction);
+
+    QMenu* analysisMenu = menuBar()->addMenu(tr("分析(&A)"));
+    m_modalAnalysisAction = new QAction(tr("模态分析(&M)..."), this);
+    connect(m_modalAnalysisAction, &QAction::triggered, this, &SimulatorMainWindow::onModalAnalysis);
+    analysisMenu->addAction(m_modalAnalysisAction);
 }
 
 void SimulatorMainWindow::createToolBar()
@@ -220,7 +278,15 @@ void SimulatorMainWindow::createParameterPanel()
     m_timeStepSpinBox->setValue(0.01);
     m_timeStepSpinBox->setDecimals(4);
     m_timeStepSpinBox->setSuffix(" s");
-    formLayout->addRow(tr("时间步长:"), m_timeStepSpinBox);
+
+    // Stable step of the selected integrator from the highest natural frequency
+    m_suggestTimeStepButton = new QPushButton(tr("建议"));
+    m_suggestTimeStepButton->setToolTip(tr("按最高固有频率计算所选积分方法的稳定时间步长"));
+    connect(m_suggestTimeStepButton, &QPushButton::clicked, this, &SimulatorMainWindow::onSuggestTimeStep);
+    QHBoxLayout* timeStepLayout = new QHBoxLayout();
+    timeStepLayout->addWidget(m_timeStepSpinBox, 1);
+    timeStepLayout->addWidget(m_suggestTimeStepButton);
+    formLayout->addRow(tr("时间步长:"), timeStepLayout);
 
     m_totalTimeSpinBox = new QDoubleSpinBox();
     m_totalTimeSpinBox->setRange(0.1, 1000.0);
@@ -229,6 +295,11 @@ void SimulatorMainWindow::createParameterPanel()
     m_totalTimeSpinBox->setSuffix(" s");
     formLayout->addRow(tr("总时长:"), m_totalTimeSpinBox);
 
+    // 全速运行：不休眠，界面按约 30 Hz 刷新
+    m_unthrottledCheckBox = new QCheckBox(tr("全速运行（降频刷新）"));
+    m_unthrottledCheckBox->setChecked(false);
+    formLayout->addRow(m_unthrottledCheckBox);
+
     mainLayout->addWidget(paramGroup);
 
     // Physics parameters group
@@ -247,7 +318,172 @@ void SimulatorMainWindow::createParameterPanel()
     m_stiffnessSpinBox->setDecimals(1);
     physicsLayout->addRow(tr("刚度系数:"), m_stiffnessSpinBox);
 
+    m_meshSizeSpinBox = new QDoubleSpinBox();
+    m_meshSizeSpinBox->setRange(0.0, 1000.0);
+    m_meshSizeSpinBox->setValue(0.0);
+    m_meshSizeSpinBox->setDecimals(4);
+    m_meshSizeSpinBox->setSpecialValueText(tr("自动"));
+    physicsLayout->addRow(tr("网格尺寸:"), m_meshSizeSpinBox);
+
+    // Penalty contact between the bodies of an assembly
+    m_contactStiffnessSpinBox = new QDoubleSpinBox();
+    m_contactStiffnessSpinBox->setRange(0.0, 1.0e7);
+    m_contactStiffnessSpinBox->setValue(0.0);
+    m_contactStiffnessSpinBox->setDecimals(1);
+    m_contactStiffnessSpinBox->setSpecialValueText(tr("关闭"));
+    physicsLayout->addRow(tr("接触刚度:"), m_contactStiffnessSpinBox);
+
+    m_contactThicknessSpinBox = new QDoubleSpinBox();
+    m_contactThicknessSpinBox->setRange(0.0, 1000.0);
+    m_contactThicknessSpinBox->setValue(0.0);
+    m_contactThicknessSpinBox->setDecimals(4);
+    m_contactThicknessSpinBox->setSpecialValueText(tr("自动"));
+    physicsLayout->addRow(tr("接触厚度:"), m_contactThicknessSpinBox);
+
     mainLayout->addWidget(physicsGroup);
+
+    // Solver parameters group
+    QGroupBox*   solverGroup  = new QGroupBox(tr("求解器"));
+    QFormLayout* solverLayout = new QFormLayout(solverGroup);
+
+    m_threadCountSpinBox = new QSpinBox();
+    m_threadCountSpinBox->setRange(0, 256);
+    m_threadCountSpinBox->setValue(0);
+    m_threadCountSpinBox->setSpecialValueText(tr("自动"));
+    solverLayout->addRow(tr("计算线程数:"), m_threadCountSpinBox);
+
+    // Worker processes of a domain decomposed run (explicit fixed-step, double precision)
+    m_subdomainsSpinBox = new QSpinBox();
+    m_subdomainsSpinBox->setRange(1, 64);
+    m_subdomainsSpinBox->setValue(1);
+    m_subdomainsSpinBox->setSpecialValueText(tr("关闭"));
+    solverLayout->addRow(tr("子域进程数:"), m_subdomainsSpinBox);
+
+    // Parareal time slices (fixed-step integrators, no contact)
+    m_timeSlicesSpinBox = new QSpinBox();
+    m_timeSlicesSpinBox->setRange(1, 256);
+    m_timeSlicesSpinBox->setValue(1);
+    m_timeSlicesSpinBox->setSpecialValueText(tr("关闭"));
+    solverLayout->addRow(tr("并行时间片数:"), m_timeSlicesSpinBox);
+
+    // Node renumbering before assembly; results keep the original numbering
+    m_orderingComboBox = new QComboBox();
+    m_orderingComboBox->addItem(tr("原始顺序"), static_cast<int>(SimulationEngine::DofOrdering::Natural));
+    m_orderingComboBox->addItem(tr("反向Cuthill-McKee (RCM)"),
+        static_cast<int>(SimulationEngine::DofOrdering::ReverseCuthillMcKee));
+    m_orderingComboBox->addItem(tr("Morton曲线"), static_cast<int>(SimulationEngine::DofOrdering::Morton));
+    m_orderingComboBox->addItem(tr("Hilbert曲线"), static_cast<int>(SimulationEngine::DofOrdering::Hilbert));
+    solverLayout->addRow(tr("自由度编号:"), m_orderingComboBox);
+
+    // Item data holds SimulationEngine::IntegratorType
+    m_integratorComboBox = new QComboBox();
+    m_integratorComboBox->addItem(tr("辛欧拉"),
+        static_cast<int>(SimulationEngine::IntegratorType::SymplecticEuler));
+    m_integratorComboBox->addItem(tr("速度Verlet"),
+        static_cast<int>(SimulationEngine::IntegratorType::VelocityVerlet));
+    m_integratorComboBox->addItem(tr("四阶龙格-库塔 (RK4)"),
+        static_cast<int>(SimulationEngine::IntegratorType::RungeKutta4));
+    m_integratorComboBox->addItem(tr("Newmark-β"),
+        static_cast<int>(SimulationEngine::IntegratorType::Newmark));
+    m_integratorComboBox->addItem(tr("Dormand-Prince 5(4)（自适应步长）"),
+        static_cast<int>(SimulationEngine::IntegratorType::DormandPrince54));
+    m_integratorComboBox->addItem(tr("后向欧拉（隐式）"),
+        static_cast<int>(SimulationEngine::IntegratorType::BackwardEuler));
+    m_integratorComboBox->addItem(tr("Newmark-β（隐式）"),
+        static_cast<int>(SimulationEngine::IntegratorType::ImplicitNewmark));
+    m_integratorComboBox->addItem(tr("模态叠加（线性）"),
+        static_cast<int>(SimulationEngine::IntegratorType::ModalSuperposition));
+    solverLayout->addRow(tr("积分方法:"), m_integratorComboBox);
+
+    m_modeCountSpinBox = new QSpinBox();
+    m_modeCountSpinBox->setRange(1, 10000);
+    m_modeCountSpinBox->setValue(50);
+    m_modeCountSpinBox->setEnabled(false);
+    solverLayout->addRow(tr("保留模态数:"), m_modeCountSpinBox);
+
+    // Newton iterations on geometrically exact springs, implicit schemes only
+    m_nonlinearComboBox = new QComboBox();
+    m_nonlinearComboBox->addItem(tr("线性"), static_cast<int>(SimulationEngine::NonlinearMethod::Linear));
+    m_nonlinearComboBox->addItem(tr("牛顿-拉弗森"), static_cast<int>(SimulationEngine::NonlinearMethod::Newton));
+    m_nonlinearComboBox->addItem(tr("修正牛顿（复用切线刚度）"),
+        static_cast<int>(SimulationEngine::NonlinearMethod::ModifiedNewton));
+    m_nonlinearComboBox->setEnabled(false);
+    solverLayout->addRow(tr("非线性求解:"), m_nonlinearComboBox);
+
+    // Single and mixed precision only for the explicit fixed-step schemes
+    m_precisionComboBox = new QComboBox();
+    m_precisionComboBox->addItem(tr("双精度"), static_cast<int>(ScalarPrecision::Double));
+    m_precisionComboBox->addItem(tr("单精度"), static_cast<int>(ScalarPrecision::Single));
+    m_precisionComboBox->addItem(tr("混合精度（单精度力，双精度状态）"), static_cast<int>(ScalarPrecision::Mixed));
+    solverLayout->addRow(tr("计算精度:"), m_precisionComboBox);
+    connect(m_integratorComboBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, [this]() {
+        const SimulationEngine::IntegratorType type =
+            static_cast<SimulationEngine::IntegratorType>(m_integratorComboBox->currentData().toInt());
+        const bool modal = type == SimulationEngine::IntegratorType::ModalSuperposition;
+        const bool implicit = type == SimulationEngine::IntegratorType::BackwardEuler
+                           || type == SimulationEngine::IntegratorType::ImplicitNewmark;
+        const bool explicitFixedStep = type != SimulationEngine::IntegratorType::DormandPrince54
+                                    && !implicit
+                                    && !modal;
+        if (!explicitFixedStep) {
+            m_precisionComboBox->setCurrentIndex(0);
+        }
+        if (!implicit) {
+            m_nonlinearComboBox->setCurrentIndex(0);
+        }
+        m_precisionComboBox->setEnabled(explicitFixedStep);
+        m_modeCountSpinBox->setEnabled(modal);
+        m_nonlinearComboBox->setEnabled(implicit);
+    });
+
+    m_toleranceSpinBox = new QDoubleSpinBox();
+    m_toleranceSpinBox->setDecimals(10);
+    m_toleranceSpinBox->setRange(1e-10, 0.1);
+    m_toleranceSpinBox->setSingleStep(1e-6);
+    m_toleranceSpinBox->setValue(1e-6);
+    solverLayout->addRow(tr("误差容差:"), m_toleranceSpinBox);
+
+    m_maxIterationsSpinBox = new QSpinBox();
+    m_maxIterationsSpinBox->setRange(1, 100000);
+    m_maxIterationsSpinBox->setValue(100);
+    solverLayout->addRow(tr("最大迭代次数:"), m_maxIterationsSpinBox);
+
+    m_preconditionerComboBox = new QComboBox();
+    m_preconditionerComboBox->addItem(tr("Jacobi"),
+        static_cast<int>(ConjugateGradient::Preconditioner::Jacobi));
+    m_preconditionerComboBox->addItem(tr("不完全Cholesky (IC0)"),
+        static_cast<int>(ConjugateGradient::Preconditioner::IncompleteCholesky));
+    solverLayout->addRow(tr("CG预条件:"), m_preconditionerComboBox);
+
+    // Energy ratio E / E0 below which the run counts as settled
+    m_steadyStateThresholdSpinBox = new QDoubleSpinBox();
+    m_steadyStateThresholdSpinBox->setDecimals(8);
+    m_steadyStateThresholdSpinBox->setRange(0.0, 1.0);
+    m_steadyStateThresholdSpinBox->setSingleStep(1e-4);
+    m_steadyStateThresholdSpinBox->setValue(0.0);
+    m_steadyStateThresholdSpinBox->setSpecialValueText(tr("关闭"));
+    solverLayout->addRow(tr("稳态能量比阈值:"), m_steadyStateThresholdSpinBox);
+
+    m_steadyStateWindowSpinBox = new QSpinBox();
+    m_steadyStateWindowSpinBox->setRange(1, 1000000);
+    m_steadyStateWindowSpinBox->setValue(100);
+    solverLayout->addRow(tr("稳态判定步数:"), m_steadyStateWindowSpinBox);
+
+    // Written next to the STEP file as <file>.ckpt
+    m_checkpointIntervalSpinBox = new QSpinBox();
+    m_checkpointIntervalSpinBox->setRange(0, 100000000);
+    m_checkpointIntervalSpinBox->setSingleStep(1000);
+    m_checkpointIntervalSpinBox->setValue(0);
+    m_checkpointIntervalSpinBox->setSpecialValueText(tr("关闭"));
+    solverLayout->addRow(tr("检查点间隔(步):"), m_checkpointIntervalSpinBox);
+
+    m_recordIntervalSpinBox = new QSpinBox();
+    m_recordIntervalSpinBox->setRange(1, 1000000);
+    m_recordIntervalSpinBox->setValue(1);
+    solverLayout->addRow(tr("结果记录间隔(步):"), m_recordIntervalSpinBox);
+
+    mainLayout->addWidget(solverGroup);
     mainLayout->addStretch();
 
     m_parameterDock->setWidget(m_parameterWidget);
@@ -264,6 +500,28 @@ void SimulatorMainWindow::createStatusBar()
 
     statusBar()->addWidget(m_statusLabel, 1);
     statusBar()->addWidget(m_progressBar);
+
+    m_profileLabel = new QLabel();
+    m_profileLabel->setVisible(Profiler::isEnabled());
+    statusBar()->addPermanentWidget(m_profileLabel);
+}
+
+void SimulatorMainWindow::updateProfileLabel()
+{
+    if (!Profiler::isEnabled()) return;
+
+    // Mean per phase in the bar, percentiles in the tooltip
+    QStringList means;
+    QStringList details;
+    for (const Profiler::PhaseStats& s : m_simulationEngine->profileStats()) {
+        means << QString("%1 %2 µs").arg(QString::fromLatin1(s.name)).arg(s.meanNs() / 1e3, 0, 'f', 1);
+        details << tr("%1: %2 次, 平均 %3 µs, p50 %4 µs, p99 %5 µs, 最大 %6 µs")
+                       .arg(QString::fromLatin1(s.name)).arg(s.count)
+                       .arg(s.meanNs() / 1e3, 0, 'f', 2).arg(s.p50Ns / 1e3, 0, 'f', 2)
+                       .arg(s.p99Ns / 1e3, 0, 'f', 2).arg(s.maxNs / 1e3, 0, 'f', 2);
+    }
+    m_profileLabel->setText(means.join(" | "));
+    m_profileLabel->setToolTip(details.join("\n"));
 }
 
 void SimulatorMainWindow::initializeOCC()
@@ -333,18 +591,170 @@ void SimulatorMainWindow::onOpenSTEP()
 
 void SimulatorMainWindow::onSaveResults()
 {
+    if (m_isSimulationRunning || m_simulationEngine->isRunning()) {
+        QMessageBox::warning(this, tr("警告"), tr("请先停止仿真再保存结果"));
+        return;
+    }
+
+    const QString historyPath = QString::fromStdString(m_historyRecorder->outputFile());
+    if (!QFile::exists(historyPath)) {
+        QMessageBox::warning(this, tr("警告"), tr("没有可保存的结果，请先运行仿真"));
+        return;
+    }
+
     QString filePath = QFileDialog::getSaveFileName(this,
-        tr("保存结果"), "", tr("CSV Files (*.csv);;Text Files (*.txt)"));
+        tr("保存结果"), "", tr("CSV Files (*.csv);;Text Files (*.txt);;Time History (*.simh)"));
     if (filePath.isEmpty()) return;
 
+    // The binary history is copied as is; text formats are exported chunk by chunk
+    bool saved = false;
+    QString error;
+    if (filePath.endsWith(".simh", Qt::CaseInsensitive)) {
+        QFile::remove(filePath);
+        saved = QFile::copy(historyPath, filePath);
+    } else {
+        TimeHistoryReader reader;
+        saved = reader.open(historyPath.toStdString()) && reader.exportCsv(filePath.toStdString());
+        error = QString::fromStdString(reader.lastError());
+    }
+
+    if (!saved) {
+        m_statusLabel->setText(tr("结果保存失败"));
+        QMessageBox::warning(this, tr("保存失败"), tr("无法保存结果: %1").arg(error));
+        return;
+    }
     m_statusLabel->setText(tr("结果保存成功"));
 }
 
+void SimulatorMainWindow::onResumeFromCheckpoint()
+{
+    if (m_isSimulationRunning) return;
+    if (!m_stepReader->hasShape()) {
+        QMessageBox::warning(this, tr("警告"), tr("请先加载检查点对应的STEP文件"));
+        return;
+    }
+
+    QString filePath = QFileDialog::getOpenFileName(this,
+        tr("从检查点恢复"), m_currentFilePath + ".ckpt", tr("Checkpoint Files (*.ckpt);;All Files (*)"));
+    if (filePath.isEmpty()) return;
+
+    // The engine takes the physics of the checkpoint; the panel only sets how the run is shown
+    m_simulationEngine->setResumeCheckpoint(filePath);
+    onStartSimulation();
+}
+
+void SimulatorMainWindow::onExportTrace()
+{
+    if (m_simulationEngine->isRunning()) {
+        QMessageBox::warning(this, tr("警告"), tr("请先停止仿真再导出性能跟踪"));
+        return;
+    }
+    if (Profiler::traceEventCount() == 0) {
+        QMessageBox::warning(this, tr("警告"), tr("没有可导出的性能跟踪，请先运行仿真"));
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(this,
+        tr("导出性能跟踪"), "trace.json", tr("Chrome Trace (*.json)"));
+    if (filePath.isEmpty()) return;
+
+    std::string error;
+    if (!Profiler::writeChromeTrace(filePath.toStdString(), error)) {
+        QMessageBox::warning(this, tr("导出失败"), QString::fromStdString(error));
+        return;
+    }
+    m_statusLabel->setText(tr("性能跟踪已导出（可在 chrome://tracing 或 Perfetto 中打开）"));
+}
+
 void SimulatorMainWindow::onExit()
 {
     qApp->quit();
 }
 
+bool SimulatorMainWindow::assembleModel(StructuralModel& model)
+{
+    if (!m_stepReader->hasShape()) {
+        QMessageBox::warning(this, tr("警告"), tr("请先加载STEP文件"));
+        return false;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    try {
+        model = SimulationSolver::buildModel(m_stepReader->getShape(), m_meshSizeSpinBox->value());
+        model.assemble(m_stiffnessSpinBox->value());
+    } catch (const std::exception& e) {
+        QApplication::restoreOverrideCursor();
+        QMessageBox::critical(this, tr("错误"), tr("网格划分失败: %1").arg(QString::fromStdString(e.what())));
+        return false;
+    }
+    QApplication::restoreOverrideCursor();
+    return true;
+}
+
+void SimulatorMainWindow::onSuggestTimeStep()
+{
+    StructuralModel model;
+    if (!assembleModel(model)) return;
+
+    SimulationEngine::SimulationParameters params;
+    params.integrator = static_cast<SimulationEngine::IntegratorType>(m_integratorComboBox->currentData().toInt());
+    params.damping = m_dampingSpinBox->value();
+    const double highest = ModalAnalysis::estimateHighestEigenvalue(model);
+    const double suggested = ModalAnalysis::suggestTimeStep(model, params);
+    const double maxFrequency = std::sqrt(std::max(highest, 0.0)) / (2.0 * 3.14159265358979323846);
+
+    if (suggested <= 0.0) {
+        m_statusLabel->setText(tr("所选积分方法无条件稳定，时间步长只受精度限制（最高固有频率 %1 Hz）")
+            .arg(maxFrequency, 0, 'g', 4));
+        return;
+    }
+    m_timeStepSpinBox->setValue(suggested);
+    if (suggested < m_timeStepSpinBox->minimum()) {
+        m_statusLabel->setText(tr("建议时间步长 %1 s 小于可设置的最小值（最高固有频率 %2 Hz），请减小刚度系数")
+            .arg(suggested, 0, 'g', 4).arg(maxFrequency, 0, 'g', 4));
+    } else {
+        m_statusLabel->setText(tr("建议时间步长: %1 s（稳定极限的 90%，最高固有频率 %2 Hz）")
+            .arg(suggested, 0, 'g', 4).arg(maxFrequency, 0, 'g', 4));
+    }
+}
+
+void SimulatorMainWindow::onModalAnalysis()
+{
+    StructuralModel model;
+    if (!assembleModel(model)) return;
+
+    ModalAnalysis modes;
+    ModalAnalysis::Options options;
+    options.modeCount = m_modeCountSpinBox->value();
+    options.preconditioner = static_cast<ConjugateGradient::Preconditioner>(
+        m_preconditionerComboBox->currentData().toInt());
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool ok = modes.compute(model, options, nullptr, 4096);
+    QApplication::restoreOverrideCursor();
+    if (!ok) {
+        QMessageBox::critical(this, tr("错误"), tr("模态分析失败: %1").arg(QString::fromStdString(modes.lastError())));
+        return;
+    }
+
+    QString table = tr("阶次\t频率 (Hz)\t周期 (s)\n");
+    for (int k = 0; k < modes.modeCount(); ++k) {
+        const double frequency = modes.frequency(k);
+        table += QString("%1\t%2\t%3\n").arg(k + 1).arg(frequency, 0, 'g', 8)
+                     .arg(frequency > 0.0 ? 1.0 / frequency : 0.0, 0, 'g', 8);
+    }
+
+    QMessageBox box(QMessageBox::Information, tr("模态分析"),
+        tr("%1 个自由度，前 %2 阶固有频率 %3 - %4 Hz")
+            .arg(model.numDOF()).arg(modes.modeCount())
+            .arg(modes.frequency(0), 0, 'g', 6).arg(modes.frequency(modes.modeCount() - 1), 0, 'g', 6),
+        QMessageBox::Ok, this);
+    box.setDetailedText(table);
+    box.exec();
+    m_statusLabel->setText(tr("模态分析完成: %1 阶模态（%2 步 Lanczos 迭代%3）")
+        .arg(modes.modeCount()).arg(modes.lanczosSteps())
+        .arg(modes.isVerified() ? tr("，惯性检验通过") : tr("，模型过大未做惯性检验")));
+}
+
 void SimulatorMainWindow::onStartSimulation()
 {
     if (m_isSimulationRunning) return;
@@ -358,8 +768,38 @@ void SimulatorMainWindow::onStartSimulation()
     params.totalTime = m_totalTimeSpinBox->value();
     params.damping   = m_dampingSpinBox->value();
     params.stiffness = m_stiffnessSpinBox->value();
-
+    params.meshSize  = m_meshSizeSpinBox->value();
+    params.contactStiffness = m_contactStiffnessSpinBox->value();
+    params.contactThickness = m_contactThicknessSpinBox->value();
+    params.numThreads = m_threadCountSpinBox->value();
+    params.subdomains = m_subdomainsSpinBox->value();
+    params.timeSlices = m_timeSlicesSpinBox->value();
+    params.dofOrdering = static_cast<SimulationEngine::DofOrdering>(m_orderingComboBox->currentData().toInt());
+    params.integrator = static_cast<SimulationEngine::IntegratorType>(
+        m_integratorComboBox->currentData().toInt());
+    params.precision = static_cast<ScalarPrecision>(m_precisionComboBox->currentData().toInt());
+    params.modeCount = m_modeCountSpinBox->value();
+    params.nonlinearMethod = static_cast<SimulationEngine::NonlinearMethod>(
+        m_nonlinearComboBox->currentData().toInt());
+    params.tolerance  = m_toleranceSpinBox->value();
+    params.maxIterations = m_maxIterationsSpinBox->value();
+    params.preconditioner = static_cast<ConjugateGradient::Preconditioner>(
+        m_preconditionerComboBox->currentData().toInt());
+    params.steadyStateThreshold = m_steadyStateThresholdSpinBox->value();
+    params.steadyStateWindow = m_steadyStateWindowSpinBox->value();
+    params.checkpointInterval = m_checkpointIntervalSpinBox->value();
+    params.runMode   = m_unthrottledCheckBox->isChecked()
+                     ? SimulationEngine::RunMode::Headless
+                     : SimulationEngine::RunMode::Interactive;
+
+    m_steadyStateTime = -1.0;
+    m_simulationEngine->setGeometry(m_stepReader->getShape());
     m_simulationEngine->setParameters(params);
+    m_simulationEngine->setCheckpointFile(m_currentFilePath + ".ckpt");
+
+    TimeHistoryRecorder::Options recordOptions = m_historyRecorder->options();
+    recordOptions.recordInterval = m_recordIntervalSpinBox->value();
+    m_historyRecorder->setOptions(recordOptions);
     m_simulationEngine->startSimulation();
     m_isSimulationRunning = true;
 
@@ -402,6 +842,7 @@ void SimulatorMainWindow::onSimulationProgress(int progress)
 {
     m_progressBar->setValue(progress);
     m_statusLabel->setText(tr("仿真运行中... %1%").arg(progress));
+    updateProfileLabel();
 }
 
 void SimulatorMainWindow::onSimulationFinished()
@@ -413,7 +854,28 @@ void SimulatorMainWindow::onSimulationFinished()
     m_pauseAction->setEnabled(false);
     m_stopAction->setEnabled(false);
     m_progressBar->setValue(100);
-    m_statusLabel->setText(tr("仿真完成"));
+
+    const SimulationEngine::SimulationState state = m_simulationEngine->getCurrentState();
+    QString status = tr("仿真完成");
+    if (m_steadyStateTime >= 0.0) {
+        status = tr("已达到稳态，提前结束（t = %1 s）").arg(m_steadyStateTime);
+    }
+    if (m_simulationEngine->getParameters().integrator == SimulationEngine::IntegratorType::DormandPrince54) {
+        status += tr("（接受 %1 步，拒绝 %2 步）").arg(state.currentStep).arg(state.rejectedSteps);
+    }
+    if (m_simulationEngine->getParameters().nonlinearMethod != SimulationEngine::NonlinearMethod::Linear
+        && state.currentStep > 0) {
+        status += tr("（牛顿迭代 %1 次/步）")
+            .arg(static_cast<double>(state.totalIterations) / state.currentStep, 0, 'g', 3);
+    }
+    m_statusLabel->setText(status);
+    updateProfileLabel();
+}
+
+void SimulatorMainWindow::onSteadyStateReached(double time, double energy)
+{
+    m_steadyStateTime = time;
+    m_statusLabel->setText(tr("已达到稳态（t = %1 s，能量 %2），正在结束...").arg(time).arg(energy));
 }
 
 void SimulatorMainWindow::onSimulationError(const QString& error)
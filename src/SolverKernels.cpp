@@ -0,0 +1,278 @@
+#include "SolverKernels.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(SIMTOOL_X86_KERNELS) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace SolverKernels
+{
+
+namespace {
+
+// K x is summed in the wider of the two scalar types: float in single
+// precision, double in the double and mixed modes
+template <typename Args>
+using SumType = decltype(typename Args::RealType() * typename Args::AccumType());
+
+template <typename Args>
+inline SumType<Args> rowDot(const Args& args, int row)
+{
+    SumType<Args> sum = 0;
+    for (int k = args.rowPointers[row]; k < args.rowPointers[row + 1]; ++k) {
+        sum += args.values[k] * args.positions[args.columnIndices[k]];
+    }
+    return sum;
+}
+
+template <typename Args>
+void computeForcesPortable(const Args& args)
+{
+    typedef typename Args::RealType Real;
+    const SumType<Args> damping = static_cast<SumType<Args>>(args.damping);
+    for (int i = args.begin; i < args.end; ++i) {
+        args.forces[i] = static_cast<Real>(-rowDot(args, i) - damping * args.velocities[i]);
+    }
+}
+
+template <typename Args>
+void symplecticEulerStepPortable(const Args& args)
+{
+    typedef typename Args::RealType Real;
+    typedef typename Args::AccumType Accum;
+    typedef SumType<Args> Sum;
+    const Accum dt = static_cast<Accum>(args.timeStep);
+    const Sum damping = static_cast<Sum>(args.damping);
+    double energy = 0.0;
+    for (int i = args.begin; i < args.end; ++i) {
+        const Sum kx = rowDot(args, i);
+        const Sum force = -kx - damping * args.velocities[i];
+        const Real acceleration = static_cast<Real>(force * args.inverseMasses[i]);
+        const Accum velocity = args.velocities[i] + acceleration * dt;
+        energy += 0.5 * static_cast<double>(args.velocities[i] * args.velocities[i] / args.inverseMasses[i]
+                                            + args.positions[i] * kx);
+        args.accelerations[i] = acceleration;
+        args.velocities[i] = velocity;
+        args.nextPositions[i] = args.positions[i] + velocity * dt;
+    }
+    if (args.energy) {
+        *args.energy = energy;
+    }
+}
+
+bool cpuSupports(Isa isa)
+{
+    if (isa == Isa::Scalar) {
+        return true;
+    }
+#if defined(SIMTOOL_X86_KERNELS) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave) {
+        return false;
+    }
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0;
+    const bool avx512f = (info[1] & (1 << 16)) != 0;
+    if (isa == Isa::AVX2) {
+        return avx2 && fma && (xcr0 & 0x6) == 0x6;
+    }
+    return avx512f && (xcr0 & 0xe6) == 0xe6;
+#elif defined(SIMTOOL_X86_KERNELS)
+    __builtin_cpu_init();
+    if (isa == Isa::AVX2) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+    return __builtin_cpu_supports("avx512f");
+#else
+    return false;
+#endif
+}
+
+const KernelTable scalarTable = {
+    Isa::Scalar, computeForcesScalar, symplecticEulerStepScalar,
+    ensembleSymplecticEulerStepScalar,
+    computeForcesScalar, symplecticEulerStepScalar,
+    computeForcesScalar, symplecticEulerStepScalar
+};
+
+#ifdef SIMTOOL_X86_KERNELS
+const KernelTable avx2Table = {
+    Isa::AVX2, computeForcesAVX2, symplecticEulerStepAVX2,
+    ensembleSymplecticEulerStepAVX2,
+    computeForcesAVX2, symplecticEulerStepAVX2,
+    computeForcesAVX2, symplecticEulerStepAVX2
+};
+const KernelTable avx512Table = {
+    Isa::AVX512, computeForcesAVX512, symplecticEulerStepAVX512,
+    ensembleSymplecticEulerStepAVX512,
+    computeForcesAVX512, symplecticEulerStepAVX512,
+    computeForcesAVX512, symplecticEulerStepAVX512
+};
+#endif
+
+const KernelTable& selectBest()
+{
+    // Optional override for comparisons: SIMTOOL_SIMD=scalar|avx2|avx512
+    Isa limit = Isa::AVX512;
+    const char* env = std::getenv("SIMTOOL_SIMD");
+    if (env) {
+        if (std::strcmp(env, "scalar") == 0) {
+            limit = Isa::Scalar;
+        } else if (std::strcmp(env, "avx2") == 0) {
+            limit = Isa::AVX2;
+        }
+    }
+
+#ifdef SIMTOOL_X86_KERNELS
+    if (limit == Isa::AVX512 && cpuSupports(Isa::AVX512)) {
+        return avx512Table;
+    }
+    if (limit != Isa::Scalar && cpuSupports(Isa::AVX2)) {
+        return avx2Table;
+    }
+#else
+    (void)limit;
+#endif
+    return scalarTable;
+}
+
+} // namespace
+
+void computeForcesScalar(const StepArgs& args)
+{
+    computeForcesPortable(args);
+}
+
+void symplecticEulerStepScalar(const StepArgs& args)
+{
+    symplecticEulerStepPortable(args);
+}
+
+void computeForcesScalar(const SingleStepArgs& args)
+{
+    computeForcesPortable(args);
+}
+
+void symplecticEulerStepScalar(const SingleStepArgs& args)
+{
+    symplecticEulerStepPortable(args);
+}
+
+void computeForcesScalar(const MixedStepArgs& args)
+{
+    computeForcesPortable(args);
+}
+
+void symplecticEulerStepScalar(const MixedStepArgs& args)
+{
+    symplecticEulerStepPortable(args);
+}
+
+void ensembleSymplecticEulerStepScalar(const EnsembleArgs& args)
+{
+    const int lanes = EnsembleLanes;
+    const double dt = args.timeStep;
+    double energy[EnsembleLanes] = {};
+
+    for (int i = args.begin; i < args.end; ++i) {
+        // Unit-stiffness K x of every member; one matrix entry feeds all lanes
+        double kx[EnsembleLanes] = {};
+        for (int k = args.rowPointers[i]; k < args.rowPointers[i + 1]; ++k) {
+            const double value = args.values[k];
+            const double* x = args.positions + args.columnIndices[k] * lanes;
+            for (int m = 0; m < lanes; ++m) {
+                kx[m] += value * x[m];
+            }
+        }
+
+        const double im = args.inverseMasses[i];
+        const int base = i * lanes;
+        for (int m = 0; m < lanes; ++m) {
+            const double x0 = args.positions[base + m];
+            const double v0 = args.velocities[base + m];
+            const double force = -args.stiffnesses[m] * kx[m] - args.dampings[m] * v0;
+            const double acceleration = force * im;
+            const double velocity = v0 + acceleration * dt;
+            energy[m] += v0 * v0 / im + x0 * args.stiffnesses[m] * kx[m];
+            args.accelerations[base + m] = acceleration;
+            args.velocities[base + m] = velocity;
+            args.nextPositions[base + m] = x0 + velocity * dt;
+        }
+    }
+    if (args.energies) {
+        for (int m = 0; m < lanes; ++m) {
+            args.energies[m] = 0.5 * energy[m];
+        }
+    }
+}
+
+namespace {
+
+const KernelTable& bestTable()
+{
+    static const KernelTable& best = selectBest();
+    return best;
+}
+
+// Table returned by kernels(): the best one until forceIsa() replaces it
+std::atomic<const KernelTable*>& activeTable()
+{
+    static std::atomic<const KernelTable*> table(&bestTable());
+    return table;
+}
+
+} // namespace
+
+const KernelTable& kernels()
+{
+    return *activeTable().load(std::memory_order_acquire);
+}
+
+const KernelTable& forceIsa(Isa isa)
+{
+    const KernelTable& table = kernels(isa);
+    activeTable().store(&table, std::memory_order_release);
+    return table;
+}
+
+const KernelTable& kernels(Isa isa)
+{
+#ifdef SIMTOOL_X86_KERNELS
+    if (isa == Isa::AVX512 && cpuSupports(Isa::AVX512)) {
+        return avx512Table;
+    }
+    if (isa == Isa::AVX2 && cpuSupports(Isa::AVX2)) {
+        return avx2Table;
+    }
+#endif
+    if (isa == Isa::Scalar) {
+        return scalarTable;
+    }
+    return bestTable();
+}
+
+bool isSupported(Isa isa)
+{
+    return cpuSupports(isa);
+}
+
+const char* isaName(Isa isa)
+{
+    switch (isa) {
+        case Isa::AVX2:   return "AVX2";
+        case Isa::AVX512: return "AVX-512";
+        default:          return "scalar";
+    }
+}
+
+} // namespace SolverKernels
@@ -0,0 +1,328 @@
+// Compiled with AVX2 + FMA enabled; only called after a runtime CPU check.
+#include "SolverKernels.h"
+#include <immintrin.h>
+
+namespace SolverKernels
+{
+
+namespace {
+
+// Lane masks for a partial tail of 0..3 elements
+alignas(32) const long long tailMask64[4][4] = {
+    {  0,  0,  0,  0 },
+    { -1,  0,  0,  0 },
+    { -1, -1,  0,  0 },
+    { -1, -1, -1,  0 },
+};
+alignas(16) const int tailMask32[4][4] = {
+    {  0,  0,  0,  0 },
+    { -1,  0,  0,  0 },
+    { -1, -1,  0,  0 },
+    { -1, -1, -1,  0 },
+};
+
+// Lane masks for a partial tail of 0..7 floats
+alignas(32) const int tailMaskFloat[8][8] = {
+    {  0,  0,  0,  0,  0,  0,  0,  0 },
+    { -1,  0,  0,  0,  0,  0,  0,  0 },
+    { -1, -1,  0,  0,  0,  0,  0,  0 },
+    { -1, -1, -1,  0,  0,  0,  0,  0 },
+    { -1, -1, -1, -1,  0,  0,  0,  0 },
+    { -1, -1, -1, -1, -1,  0,  0,  0 },
+    { -1, -1, -1, -1, -1, -1,  0,  0 },
+    { -1, -1, -1, -1, -1, -1, -1,  0 },
+};
+
+// Four lanes of double arithmetic, stored as double (double precision) or
+// float (force-side data in mixed precision)
+inline __m256d load4(const double* p) { return _mm256_loadu_pd(p); }
+inline __m256d load4(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+inline void store4(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+inline void store4(float* p, __m256d v) { _mm_storeu_ps(p, _mm256_cvtpd_ps(v)); }
+
+inline __m256d maskLoad4(const double* p, __m256i mask64, __m128i)
+{
+    return _mm256_maskload_pd(p, mask64);
+}
+inline __m256d maskLoad4(const float* p, __m256i, __m128i mask32)
+{
+    return _mm256_cvtps_pd(_mm_maskload_ps(p, mask32));
+}
+
+// Value as it reads back after being stored
+inline __m256d asStored(const double*, __m256d v) { return v; }
+inline __m256d asStored(const float*, __m256d v) { return _mm256_cvtps_pd(_mm256_cvtpd_ps(v)); }
+
+// Unreduced partial sums of one CSR row; the tail is masked, not branched
+template <typename Args>
+inline __m256d rowDot(const Args& args, int row)
+{
+    const int begin = args.rowPointers[row];
+    const int end = args.rowPointers[row + 1];
+    __m256d acc = _mm256_setzero_pd();
+
+    int k = begin;
+    for (; k + 4 <= end; k += 4) {
+        const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(args.columnIndices + k));
+        const __m256d x = _mm256_i32gather_pd(args.positions, idx, 8);
+        acc = _mm256_fmadd_pd(load4(args.values + k), x, acc);
+    }
+
+    const int rest = end - k;
+    const __m256i mask64 = _mm256_load_si256(reinterpret_cast<const __m256i*>(tailMask64[rest]));
+    const __m128i mask32 = _mm_load_si128(reinterpret_cast<const __m128i*>(tailMask32[rest]));
+    const __m128i idx = _mm_maskload_epi32(args.columnIndices + k, mask32);
+    const __m256d x = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), args.positions, idx,
+                                               _mm256_castsi256_pd(mask64), 8);
+    const __m256d a = maskLoad4(args.values + k, mask64, mask32);
+    return _mm256_fmadd_pd(a, x, acc);
+}
+
+// Reduce four row accumulators into one vector of row sums
+template <typename Args>
+inline __m256d rowDot4(const Args& args, int row)
+{
+    const __m256d t0 = _mm256_hadd_pd(rowDot(args, row), rowDot(args, row + 1));
+    const __m256d t1 = _mm256_hadd_pd(rowDot(args, row + 2), rowDot(args, row + 3));
+    const __m256d lo = _mm256_permute2f128_pd(t0, t1, 0x20);
+    const __m256d hi = _mm256_permute2f128_pd(t0, t1, 0x31);
+    return _mm256_add_pd(lo, hi);
+}
+
+inline double horizontalSum(__m256d v)
+{
+    const __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+// Double and mixed precision: positions and velocities in double lanes
+template <typename Args>
+void computeForcesDoubleLanes(const Args& args)
+{
+    const __m256d damping = _mm256_set1_pd(args.damping);
+
+    int i = args.begin;
+    for (; i + 4 <= args.end; i += 4) {
+        const __m256d kx = rowDot4(args, i);
+        const __m256d v = _mm256_loadu_pd(args.velocities + i);
+        const __m256d f = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_fmadd_pd(damping, v, kx));
+        store4(args.forces + i, f);
+    }
+    for (; i < args.end; ++i) {
+        args.forces[i] = -horizontalSum(rowDot(args, i)) - args.damping * args.velocities[i];
+    }
+}
+
+template <typename Args>
+void symplecticEulerStepDoubleLanes(const Args& args)
+{
+    typedef typename Args::RealType Real;
+    const __m256d damping = _mm256_set1_pd(args.damping);
+    const __m256d dt = _mm256_set1_pd(args.timeStep);
+    __m256d energy = _mm256_setzero_pd();
+
+    int i = args.begin;
+    for (; i + 4 <= args.end; i += 4) {
+        const __m256d kx = rowDot4(args, i);
+        __m256d v = _mm256_loadu_pd(args.velocities + i);
+        const __m256d im = load4(args.inverseMasses + i);
+        const __m256d x0 = _mm256_loadu_pd(args.positions + i);
+        // 2 E = m v^2 + x K x, at the start of the step
+        energy = _mm256_add_pd(energy, _mm256_fmadd_pd(x0, kx, _mm256_div_pd(_mm256_mul_pd(v, v), im)));
+        const __m256d f = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_fmadd_pd(damping, v, kx));
+        const __m256d a = asStored(args.accelerations, _mm256_mul_pd(f, im));
+        v = _mm256_fmadd_pd(a, dt, v);
+        const __m256d x = _mm256_fmadd_pd(v, dt, x0);
+        store4(args.accelerations + i, a);
+        _mm256_storeu_pd(args.velocities + i, v);
+        _mm256_storeu_pd(args.nextPositions + i, x);
+    }
+    double energyTail = 0.0;
+    for (; i < args.end; ++i) {
+        const double kx = horizontalSum(rowDot(args, i));
+        const double force = -kx - args.damping * args.velocities[i];
+        const Real acceleration = static_cast<Real>(force * args.inverseMasses[i]);
+        const double velocity = args.velocities[i] + acceleration * args.timeStep;
+        energyTail += args.velocities[i] * args.velocities[i] / args.inverseMasses[i]
+                      + args.positions[i] * kx;
+        args.accelerations[i] = acceleration;
+        args.velocities[i] = velocity;
+        args.nextPositions[i] = args.positions[i] + velocity * args.timeStep;
+    }
+    if (args.energy) {
+        *args.energy = 0.5 * (horizontalSum(energy) + energyTail);
+    }
+}
+
+// Single precision: eight float lanes
+inline __m256 rowDot(const SingleStepArgs& args, int row)
+{
+    const int begin = args.rowPointers[row];
+    const int end = args.rowPointers[row + 1];
+    __m256 acc = _mm256_setzero_ps();
+
+    int k = begin;
+    for (; k + 8 <= end; k += 8) {
+        const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(args.columnIndices + k));
+        const __m256 x = _mm256_i32gather_ps(args.positions, idx, 4);
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(args.values + k), x, acc);
+    }
+
+    const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(tailMaskFloat[end - k]));
+    const __m256i idx = _mm256_maskload_epi32(args.columnIndices + k, mask);
+    const __m256 x = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), args.positions, idx,
+                                              _mm256_castsi256_ps(mask), 4);
+    return _mm256_fmadd_ps(_mm256_maskload_ps(args.values + k, mask), x, acc);
+}
+
+// Reduce eight row accumulators into one vector of row sums
+inline __m256 rowDot8(const SingleStepArgs& args, int row)
+{
+    const __m256 t0 = _mm256_hadd_ps(rowDot(args, row), rowDot(args, row + 1));
+    const __m256 t1 = _mm256_hadd_ps(rowDot(args, row + 2), rowDot(args, row + 3));
+    const __m256 t2 = _mm256_hadd_ps(rowDot(args, row + 4), rowDot(args, row + 5));
+    const __m256 t3 = _mm256_hadd_ps(rowDot(args, row + 6), rowDot(args, row + 7));
+    const __m256 u0 = _mm256_hadd_ps(t0, t1);
+    const __m256 u1 = _mm256_hadd_ps(t2, t3);
+    return _mm256_add_ps(_mm256_permute2f128_ps(u0, u1, 0x20), _mm256_permute2f128_ps(u0, u1, 0x31));
+}
+
+inline float horizontalSum(__m256 v)
+{
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+}
+
+} // namespace
+
+void computeForcesAVX2(const StepArgs& args)
+{
+    computeForcesDoubleLanes(args);
+}
+
+void symplecticEulerStepAVX2(const StepArgs& args)
+{
+    symplecticEulerStepDoubleLanes(args);
+}
+
+void computeForcesAVX2(const MixedStepArgs& args)
+{
+    computeForcesDoubleLanes(args);
+}
+
+void symplecticEulerStepAVX2(const MixedStepArgs& args)
+{
+    symplecticEulerStepDoubleLanes(args);
+}
+
+void computeForcesAVX2(const SingleStepArgs& args)
+{
+    const __m256 damping = _mm256_set1_ps(static_cast<float>(args.damping));
+
+    int i = args.begin;
+    for (; i + 8 <= args.end; i += 8) {
+        const __m256 kx = rowDot8(args, i);
+        const __m256 v = _mm256_loadu_ps(args.velocities + i);
+        _mm256_storeu_ps(args.forces + i, _mm256_sub_ps(_mm256_setzero_ps(), _mm256_fmadd_ps(damping, v, kx)));
+    }
+    for (; i < args.end; ++i) {
+        args.forces[i] = -horizontalSum(rowDot(args, i)) - static_cast<float>(args.damping) * args.velocities[i];
+    }
+}
+
+void symplecticEulerStepAVX2(const SingleStepArgs& args)
+{
+    const float dampingValue = static_cast<float>(args.damping);
+    const float dtValue = static_cast<float>(args.timeStep);
+    const __m256 damping = _mm256_set1_ps(dampingValue);
+    const __m256 dt = _mm256_set1_ps(dtValue);
+    // Energy terms are formed in float, summed in double
+    __m256d energyLo = _mm256_setzero_pd();
+    __m256d energyHi = _mm256_setzero_pd();
+
+    int i = args.begin;
+    for (; i + 8 <= args.end; i += 8) {
+        const __m256 kx = rowDot8(args, i);
+        __m256 v = _mm256_loadu_ps(args.velocities + i);
+        const __m256 im = _mm256_loadu_ps(args.inverseMasses + i);
+        const __m256 x0 = _mm256_loadu_ps(args.positions + i);
+        // 2 E = m v^2 + x K x, at the start of the step
+        const __m256 e = _mm256_fmadd_ps(x0, kx, _mm256_div_ps(_mm256_mul_ps(v, v), im));
+        energyLo = _mm256_add_pd(energyLo, _mm256_cvtps_pd(_mm256_castps256_ps128(e)));
+        energyHi = _mm256_add_pd(energyHi, _mm256_cvtps_pd(_mm256_extractf128_ps(e, 1)));
+        const __m256 f = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_fmadd_ps(damping, v, kx));
+        const __m256 a = _mm256_mul_ps(f, im);
+        v = _mm256_fmadd_ps(a, dt, v);
+        _mm256_storeu_ps(args.accelerations + i, a);
+        _mm256_storeu_ps(args.velocities + i, v);
+        _mm256_storeu_ps(args.nextPositions + i, _mm256_fmadd_ps(v, dt, x0));
+    }
+    double energyTail = 0.0;
+    for (; i < args.end; ++i) {
+        const float kx = horizontalSum(rowDot(args, i));
+        const float force = -kx - dampingValue * args.velocities[i];
+        const float acceleration = force * args.inverseMasses[i];
+        const float velocity = args.velocities[i] + acceleration * dtValue;
+        energyTail += args.velocities[i] * args.velocities[i] / args.inverseMasses[i]
+                      + args.positions[i] * kx;
+        args.accelerations[i] = acceleration;
+        args.velocities[i] = velocity;
+        args.nextPositions[i] = args.positions[i] + velocity * dtValue;
+    }
+    if (args.energy) {
+        *args.energy = 0.5 * (horizontalSum(_mm256_add_pd(energyLo, energyHi)) + energyTail);
+    }
+}
+
+void ensembleSymplecticEulerStepAVX2(const EnsembleArgs& args)
+{
+    // Two vectors of four members each; matrix values are broadcast
+    const __m256d dt = _mm256_set1_pd(args.timeStep);
+    const __m256d stiffness0 = _mm256_loadu_pd(args.stiffnesses);
+    const __m256d stiffness1 = _mm256_loadu_pd(args.stiffnesses + 4);
+    const __m256d damping0 = _mm256_loadu_pd(args.dampings);
+    const __m256d damping1 = _mm256_loadu_pd(args.dampings + 4);
+    __m256d energy0 = _mm256_setzero_pd();
+    __m256d energy1 = _mm256_setzero_pd();
+
+    for (int i = args.begin; i < args.end; ++i) {
+        __m256d kx0 = _mm256_setzero_pd();
+        __m256d kx1 = _mm256_setzero_pd();
+        for (int k = args.rowPointers[i]; k < args.rowPointers[i + 1]; ++k) {
+            const __m256d value = _mm256_broadcast_sd(args.values + k);
+            const double* x = args.positions + args.columnIndices[k] * EnsembleLanes;
+            kx0 = _mm256_fmadd_pd(value, _mm256_loadu_pd(x), kx0);
+            kx1 = _mm256_fmadd_pd(value, _mm256_loadu_pd(x + 4), kx1);
+        }
+        kx0 = _mm256_mul_pd(stiffness0, kx0);
+        kx1 = _mm256_mul_pd(stiffness1, kx1);
+
+        const __m256d im = _mm256_broadcast_sd(args.inverseMasses + i);
+        const int base = i * EnsembleLanes;
+        const __m256d x00 = _mm256_loadu_pd(args.positions + base);
+        const __m256d x01 = _mm256_loadu_pd(args.positions + base + 4);
+        __m256d v0 = _mm256_loadu_pd(args.velocities + base);
+        __m256d v1 = _mm256_loadu_pd(args.velocities + base + 4);
+        // 2 E = m v^2 + x K x, at the start of the step
+        energy0 = _mm256_add_pd(energy0, _mm256_fmadd_pd(x00, kx0, _mm256_div_pd(_mm256_mul_pd(v0, v0), im)));
+        energy1 = _mm256_add_pd(energy1, _mm256_fmadd_pd(x01, kx1, _mm256_div_pd(_mm256_mul_pd(v1, v1), im)));
+        const __m256d a0 = _mm256_mul_pd(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_fmadd_pd(damping0, v0, kx0)), im);
+        const __m256d a1 = _mm256_mul_pd(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_fmadd_pd(damping1, v1, kx1)), im);
+        v0 = _mm256_fmadd_pd(a0, dt, v0);
+        v1 = _mm256_fmadd_pd(a1, dt, v1);
+        _mm256_storeu_pd(args.accelerations + base, a0);
+        _mm256_storeu_pd(args.accelerations + base + 4, a1);
+        _mm256_storeu_pd(args.velocities + base, v0);
+        _mm256_storeu_pd(args.velocities + base + 4, v1);
+        _mm256_storeu_pd(args.nextPositions + base, _mm256_fmadd_pd(v0, dt, x00));
+        _mm256_storeu_pd(args.nextPositions + base + 4, _mm256_fmadd_pd(v1, dt, x01));
+    }
+    if (args.energies) {
+        const __m256d half = _mm256_set1_pd(0.5);
+        _mm256_storeu_pd(args.energies, _mm256_mul_pd(half, energy0));
+        _mm256_storeu_pd(args.energies + 4, _mm256_mul_pd(half, energy1));
+    }
+}
+
+} // namespace SolverKernels
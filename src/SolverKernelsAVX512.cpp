@@ -0,0 +1,270 @@
+// Compiled with AVX-512F enabled; only called after a runtime CPU check.
+#include "SolverKernels.h"
+#include <immintrin.h>
+
+namespace SolverKernels
+{
+
+namespace {
+
+// Eight lanes of double arithmetic, stored as double (double precision) or
+// float (force-side data in mixed precision)
+inline __m512d load8(const double* p) { return _mm512_loadu_pd(p); }
+inline __m512d load8(const float* p) { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+inline void store8(double* p, __m512d v) { _mm512_storeu_pd(p, v); }
+inline void store8(float* p, __m512d v) { _mm256_storeu_ps(p, _mm512_cvtpd_ps(v)); }
+
+inline __m512d maskLoad8(const double* p, __mmask8 mask)
+{
+    return _mm512_maskz_loadu_pd(mask, p);
+}
+inline __m512d maskLoad8(const float* p, __mmask8 mask)
+{
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps(static_cast<__mmask16>(mask), p)));
+}
+
+// Value as it reads back after being stored
+inline __m512d asStored(const double*, __m512d v) { return v; }
+inline __m512d asStored(const float*, __m512d v) { return _mm512_cvtps_pd(_mm512_cvtpd_ps(v)); }
+
+// Row sum of one CSR row; the tail is masked, not branched
+template <typename Args>
+inline double rowDot(const Args& args, int row)
+{
+    const int begin = args.rowPointers[row];
+    const int end = args.rowPointers[row + 1];
+    __m512d acc = _mm512_setzero_pd();
+
+    int k = begin;
+    for (; k + 8 <= end; k += 8) {
+        const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(args.columnIndices + k));
+        const __m512d x = _mm512_i32gather_pd(idx, args.positions, 8);
+        acc = _mm512_fmadd_pd(load8(args.values + k), x, acc);
+    }
+
+    const __mmask8 mask = static_cast<__mmask8>((1u << (end - k)) - 1u);
+    const __m256i idx = _mm512_castsi512_si256(
+        _mm512_maskz_loadu_epi32(static_cast<__mmask16>(mask), args.columnIndices + k));
+    const __m512d x = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, idx, args.positions, 8);
+    acc = _mm512_fmadd_pd(maskLoad8(args.values + k, mask), x, acc);
+
+    return _mm512_reduce_add_pd(acc);
+}
+
+// Eight row sums as one vector
+template <typename Args>
+inline __m512d rowDot8(const Args& args, int row)
+{
+    alignas(64) double sums[8];
+    for (int j = 0; j < 8; ++j) {
+        sums[j] = rowDot(args, row + j);
+    }
+    return _mm512_load_pd(sums);
+}
+
+// Double and mixed precision: positions and velocities in double lanes
+template <typename Args>
+void computeForcesDoubleLanes(const Args& args)
+{
+    const __m512d damping = _mm512_set1_pd(args.damping);
+
+    int i = args.begin;
+    for (; i + 8 <= args.end; i += 8) {
+        const __m512d kx = rowDot8(args, i);
+        const __m512d v = _mm512_loadu_pd(args.velocities + i);
+        store8(args.forces + i, _mm512_sub_pd(_mm512_setzero_pd(), _mm512_fmadd_pd(damping, v, kx)));
+    }
+    for (; i < args.end; ++i) {
+        args.forces[i] = -rowDot(args, i) - args.damping * args.velocities[i];
+    }
+}
+
+template <typename Args>
+void symplecticEulerStepDoubleLanes(const Args& args)
+{
+    typedef typename Args::RealType Real;
+    const __m512d damping = _mm512_set1_pd(args.damping);
+    const __m512d dt = _mm512_set1_pd(args.timeStep);
+    __m512d energy = _mm512_setzero_pd();
+
+    int i = args.begin;
+    for (; i + 8 <= args.end; i += 8) {
+        const __m512d kx = rowDot8(args, i);
+        __m512d v = _mm512_loadu_pd(args.velocities + i);
+        const __m512d im = load8(args.inverseMasses + i);
+        const __m512d x0 = _mm512_loadu_pd(args.positions + i);
+        // 2 E = m v^2 + x K x, at the start of the step
+        energy = _mm512_add_pd(energy, _mm512_fmadd_pd(x0, kx, _mm512_div_pd(_mm512_mul_pd(v, v), im)));
+        const __m512d f = _mm512_sub_pd(_mm512_setzero_pd(), _mm512_fmadd_pd(damping, v, kx));
+        const __m512d a = asStored(args.accelerations, _mm512_mul_pd(f, im));
+        v = _mm512_fmadd_pd(a, dt, v);
+        const __m512d x = _mm512_fmadd_pd(v, dt, x0);
+        store8(args.accelerations + i, a);
+        _mm512_storeu_pd(args.velocities + i, v);
+        _mm512_storeu_pd(args.nextPositions + i, x);
+    }
+    double energyTail = 0.0;
+    for (; i < args.end; ++i) {
+        const double kx = rowDot(args, i);
+        const double force = -kx - args.damping * args.velocities[i];
+        const Real acceleration = static_cast<Real>(force * args.inverseMasses[i]);
+        const double velocity = args.velocities[i] + acceleration * args.timeStep;
+        energyTail += args.velocities[i] * args.velocities[i] / args.inverseMasses[i]
+                      + args.positions[i] * kx;
+        args.accelerations[i] = acceleration;
+        args.velocities[i] = velocity;
+        args.nextPositions[i] = args.positions[i] + velocity * args.timeStep;
+    }
+    if (args.energy) {
+        *args.energy = 0.5 * (_mm512_reduce_add_pd(energy) + energyTail);
+    }
+}
+
+// Single precision: sixteen float lanes
+inline float rowDot(const SingleStepArgs& args, int row)
+{
+    const int begin = args.rowPointers[row];
+    const int end = args.rowPointers[row + 1];
+    __m512 acc = _mm512_setzero_ps();
+
+    int k = begin;
+    for (; k + 16 <= end; k += 16) {
+        const __m512i idx = _mm512_loadu_si512(args.columnIndices + k);
+        const __m512 x = _mm512_i32gather_ps(idx, args.positions, 4);
+        acc = _mm512_fmadd_ps(_mm512_loadu_ps(args.values + k), x, acc);
+    }
+
+    const __mmask16 mask = static_cast<__mmask16>((1u << (end - k)) - 1u);
+    const __m512i idx = _mm512_maskz_loadu_epi32(mask, args.columnIndices + k);
+    const __m512 x = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, idx, args.positions, 4);
+    acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, args.values + k), x, acc);
+
+    return _mm512_reduce_add_ps(acc);
+}
+
+// Sixteen row sums as one vector
+inline __m512 rowDot16(const SingleStepArgs& args, int row)
+{
+    alignas(64) float sums[16];
+    for (int j = 0; j < 16; ++j) {
+        sums[j] = rowDot(args, row + j);
+    }
+    return _mm512_load_ps(sums);
+}
+
+} // namespace
+
+void computeForcesAVX512(const StepArgs& args)
+{
+    computeForcesDoubleLanes(args);
+}
+
+void symplecticEulerStepAVX512(const StepArgs& args)
+{
+    symplecticEulerStepDoubleLanes(args);
+}
+
+void computeForcesAVX512(const MixedStepArgs& args)
+{
+    computeForcesDoubleLanes(args);
+}
+
+void symplecticEulerStepAVX512(const MixedStepArgs& args)
+{
+    symplecticEulerStepDoubleLanes(args);
+}
+
+void computeForcesAVX512(const SingleStepArgs& args)
+{
+    const __m512 damping = _mm512_set1_ps(static_cast<float>(args.damping));
+
+    int i = args.begin;
+    for (; i + 16 <= args.end; i += 16) {
+        const __m512 kx = rowDot16(args, i);
+        const __m512 v = _mm512_loadu_ps(args.velocities + i);
+        _mm512_storeu_ps(args.forces + i, _mm512_sub_ps(_mm512_setzero_ps(), _mm512_fmadd_ps(damping, v, kx)));
+    }
+    for (; i < args.end; ++i) {
+        args.forces[i] = -rowDot(args, i) - static_cast<float>(args.damping) * args.velocities[i];
+    }
+}
+
+void symplecticEulerStepAVX512(const SingleStepArgs& args)
+{
+    const float dampingValue = static_cast<float>(args.damping);
+    const float dtValue = static_cast<float>(args.timeStep);
+    const __m512 damping = _mm512_set1_ps(dampingValue);
+    const __m512 dt = _mm512_set1_ps(dtValue);
+    // Energy terms are formed in float, summed in double
+    __m512d energyLo = _mm512_setzero_pd();
+    __m512d energyHi = _mm512_setzero_pd();
+
+    int i = args.begin;
+    for (; i + 16 <= args.end; i += 16) {
+        const __m512 kx = rowDot16(args, i);
+        __m512 v = _mm512_loadu_ps(args.velocities + i);
+        const __m512 im = _mm512_loadu_ps(args.inverseMasses + i);
+        const __m512 x0 = _mm512_loadu_ps(args.positions + i);
+        // 2 E = m v^2 + x K x, at the start of the step
+        const __m512 e = _mm512_fmadd_ps(x0, kx, _mm512_div_ps(_mm512_mul_ps(v, v), im));
+        energyLo = _mm512_add_pd(energyLo, _mm512_cvtps_pd(_mm512_castps512_ps256(e)));
+        energyHi = _mm512_add_pd(energyHi, _mm512_cvtps_pd(
+            _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(e), 1))));
+        const __m512 f = _mm512_sub_ps(_mm512_setzero_ps(), _mm512_fmadd_ps(damping, v, kx));
+        const __m512 a = _mm512_mul_ps(f, im);
+        v = _mm512_fmadd_ps(a, dt, v);
+        _mm512_storeu_ps(args.accelerations + i, a);
+        _mm512_storeu_ps(args.velocities + i, v);
+        _mm512_storeu_ps(args.nextPositions + i, _mm512_fmadd_ps(v, dt, x0));
+    }
+    double energyTail = 0.0;
+    for (; i < args.end; ++i) {
+        const float kx = rowDot(args, i);
+        const float force = -kx - dampingValue * args.velocities[i];
+        const float acceleration = force * args.inverseMasses[i];
+        const float velocity = args.velocities[i] + acceleration * dtValue;
+        energyTail += args.velocities[i] * args.velocities[i] / args.inverseMasses[i]
+                      + args.positions[i] * kx;
+        args.accelerations[i] = acceleration;
+        args.velocities[i] = velocity;
+        args.nextPositions[i] = args.positions[i] + velocity * dtValue;
+    }
+    if (args.energy) {
+        *args.energy = 0.5 * (_mm512_reduce_add_pd(_mm512_add_pd(energyLo, energyHi)) + energyTail);
+    }
+}
+
+void ensembleSymplecticEulerStepAVX512(const EnsembleArgs& args)
+{
+    // One vector holds all eight members; matrix values are broadcast
+    const __m512d dt = _mm512_set1_pd(args.timeStep);
+    const __m512d stiffness = _mm512_loadu_pd(args.stiffnesses);
+    const __m512d damping = _mm512_loadu_pd(args.dampings);
+    __m512d energy = _mm512_setzero_pd();
+
+    for (int i = args.begin; i < args.end; ++i) {
+        __m512d kx = _mm512_setzero_pd();
+        for (int k = args.rowPointers[i]; k < args.rowPointers[i + 1]; ++k) {
+            const __m512d x = _mm512_loadu_pd(args.positions + args.columnIndices[k] * EnsembleLanes);
+            kx = _mm512_fmadd_pd(_mm512_set1_pd(args.values[k]), x, kx);
+        }
+        kx = _mm512_mul_pd(stiffness, kx);
+
+        const __m512d im = _mm512_set1_pd(args.inverseMasses[i]);
+        const int base = i * EnsembleLanes;
+        const __m512d x0 = _mm512_loadu_pd(args.positions + base);
+        __m512d v = _mm512_loadu_pd(args.velocities + base);
+        // 2 E = m v^2 + x K x, at the start of the step
+        energy = _mm512_add_pd(energy, _mm512_fmadd_pd(x0, kx, _mm512_div_pd(_mm512_mul_pd(v, v), im)));
+        const __m512d a = _mm512_mul_pd(_mm512_sub_pd(_mm512_setzero_pd(), _mm512_fmadd_pd(damping, v, kx)), im);
+        v = _mm512_fmadd_pd(a, dt, v);
+        _mm512_storeu_pd(args.accelerations + base, a);
+        _mm512_storeu_pd(args.velocities + base, v);
+        _mm512_storeu_pd(args.nextPositions + base, _mm512_fmadd_pd(v, dt, x0));
+    }
+    if (args.energies) {
+        _mm512_storeu_pd(args.energies, _mm512_mul_pd(_mm512_set1_pd(0.5), energy));
+    }
+}
+
+} // namespace SolverKernels
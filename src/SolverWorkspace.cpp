@@ -0,0 +1,40 @@
+#include "SolverWorkspace.h"
+#include <algorithm>
+
+template <typename PrecisionPolicy>
+void BasicSolverWorkspace<PrecisionPolicy>::resize(int numDOF, int stageCount, int chunkCount)
+{
+    inverseMasses.assign(numDOF, Real(1));
+    nextPositions.assign(numDOF, Accum(0));
+    forces.assign(numDOF, Real(0));
+    chunkPartials.assign(std::max(chunkCount, 1), 0.0);
+    energyPartials.assign(std::max(chunkCount, 1), 0.0);
+
+    stages.resize(stageCount);
+    for (size_t i = 0; i < stages.size(); ++i) {
+        stages[i].assign(numDOF, Accum(0));
+    }
+}
+
+template <typename PrecisionPolicy>
+void BasicSolverWorkspace<PrecisionPolicy>::clear()
+{
+    BasicSolverWorkspace empty;
+    std::swap(*this, empty);
+}
+
+template <typename PrecisionPolicy>
+size_t BasicSolverWorkspace<PrecisionPolicy>::memoryUsage() const
+{
+    size_t bytes = (inverseMasses.capacity() + forces.capacity() + contactForces.capacity()) * sizeof(Real)
+                 + nextPositions.capacity() * sizeof(Accum)
+                 + (chunkPartials.capacity() + energyPartials.capacity()) * sizeof(double);
+    for (size_t i = 0; i < stages.size(); ++i) {
+        bytes += stages[i].capacity() * sizeof(Accum);
+    }
+    return bytes;
+}
+
+template struct BasicSolverWorkspace<ScalarPrecisions::Double>;
+template struct BasicSolverWorkspace<ScalarPrecisions::Single>;
+template struct BasicSolverWorkspace<ScalarPrecisions::Mixed>;
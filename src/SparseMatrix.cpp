@@ -0,0 +1,96 @@
+#include "SparseMatrix.h"
+#include <algorithm>
+
+SparseMatrix::SparseMatrix()
+    : m_size(0)
+    , m_rowPointers(1, 0)
+{
+}
+
+SparseMatrix SparseMatrix::fromTriplets(int size, std::vector<Triplet>& triplets)
+{
+    std::sort(triplets.begin(), triplets.end(),
+              [](const Triplet& a, const Triplet& b) {
+                  return a.row != b.row ? a.row < b.row : a.col < b.col;
+              });
+
+    SparseMatrix matrix;
+    matrix.m_size = size;
+    matrix.m_rowPointers.assign(static_cast<size_t>(size) + 1, 0);
+    matrix.m_columnIndices.reserve(triplets.size());
+    matrix.m_values.reserve(triplets.size());
+
+    for (size_t k = 0; k < triplets.size(); ++k) {
+        const Triplet& t = triplets[k];
+
+        // Sum duplicates into the previous entry of the same row
+        const bool duplicate = !matrix.m_values.empty()
+            && k > 0
+            && triplets[k - 1].row == t.row
+            && triplets[k - 1].col == t.col;
+
+        if (duplicate) {
+            matrix.m_values.back() += t.value;
+        } else {
+            matrix.m_columnIndices.push_back(t.col);
+            matrix.m_values.push_back(t.value);
+            matrix.m_rowPointers[t.row + 1]++;
+        }
+    }
+
+    // Convert per-row counts to offsets
+    for (int i = 0; i < size; ++i) {
+        matrix.m_rowPointers[i + 1] += matrix.m_rowPointers[i];
+    }
+
+    return matrix;
+}
+
+void SparseMatrix::multiply(const double* x, double* y) const
+{
+    multiplyRows(0, m_size, x, y);
+}
+
+void SparseMatrix::multiplyRows(int begin, int end, const double* x, double* y) const
+{
+    const int* rowPtr = m_rowPointers.data();
+    const int* cols = m_columnIndices.data();
+    const double* vals = m_values.data();
+
+    for (int i = begin; i < end; ++i) {
+        double sum = 0.0;
+        for (int k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+            sum += vals[k] * x[cols[k]];
+        }
+        y[i] = sum;
+    }
+}
+
+void SparseMatrix::diagonal(std::vector<double>& diagonal) const
+{
+    diagonal.assign(m_size, 0.0);
+
+    for (int i = 0; i < m_size; ++i) {
+        for (int k = m_rowPointers[i]; k < m_rowPointers[i + 1]; ++k) {
+            if (m_columnIndices[k] == i) {
+                diagonal[i] = m_values[k];
+                break;
+            }
+        }
+    }
+}
+
+SparseMatrix SparseMatrix::scaledPlusDiagonal(double scale, const double* shift) const
+{
+    std::vector<Triplet> triplets;
+    triplets.reserve(m_values.size() + m_size);
+
+    for (int i = 0; i < m_size; ++i) {
+        for (int k = m_rowPointers[i]; k < m_rowPointers[i + 1]; ++k) {
+            triplets.push_back(Triplet(i, m_columnIndices[k], scale * m_values[k]));
+        }
+        triplets.push_back(Triplet(i, i, shift[i]));
+    }
+
+    return fromTriplets(m_size, triplets);
+}
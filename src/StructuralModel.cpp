@@ -0,0 +1,151 @@
+#include "StructuralModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+void StructuralModel::assemble(double stiffnessCoefficient)
+{
+    const int n = numDOF();
+    const int d = dofsPerNode;
+    const double grounding = groundingStiffness(stiffnessCoefficient);
+    const double coupling = couplingStiffness(stiffnessCoefficient);
+
+    std::vector<SparseMatrix::Triplet> triplets;
+    triplets.reserve(static_cast<size_t>(n) + edges.size() * 2 * d * d);
+
+    // Grounding spring on every DOF
+    for (int i = 0; i < n; ++i) {
+        triplets.push_back(SparseMatrix::Triplet(i, i, grounding));
+    }
+
+    // Axial coupling spring along every edge
+    for (int e = 0; e < numEdges(); ++e) {
+        const int a = edges[2 * e];
+        const int b = edges[2 * e + 1];
+
+        double block[3][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+        if (d == 3) {
+            double dir[3];
+            double length = 0.0;
+            for (int c = 0; c < 3; ++c) {
+                dir[c] = nodeCoordinates[3 * b + c] - nodeCoordinates[3 * a + c];
+                length += dir[c] * dir[c];
+            }
+            length = std::sqrt(length);
+            if (length <= 0.0) {
+                continue;
+            }
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 3; ++c) {
+                    block[r][c] = dir[r] * dir[c] / (length * length);
+                }
+            }
+        }
+
+        for (int r = 0; r < d; ++r) {
+            for (int c = 0; c < d; ++c) {
+                const double k = coupling * block[r][c];
+                if (k == 0.0) {
+                    continue;
+                }
+                triplets.push_back(SparseMatrix::Triplet(a * d + r, a * d + c, k));
+                triplets.push_back(SparseMatrix::Triplet(b * d + r, b * d + c, k));
+                triplets.push_back(SparseMatrix::Triplet(a * d + r, b * d + c, -k));
+                triplets.push_back(SparseMatrix::Triplet(b * d + r, a * d + c, -k));
+            }
+        }
+    }
+
+    stiffness = SparseMatrix::fromTriplets(n, triplets);
+
+    // Unit lumped mass per DOF
+    masses.assign(n, 1.0);
+}
+
+void StructuralModel::renumberNodes(const std::vector<int>& order)
+{
+    const int n = numNodes();
+    std::vector<int> newIndex(n);
+    std::vector<double> coordinates(nodeCoordinates.size());
+    std::vector<int> bodies(nodeBodies.size());
+    for (int i = 0; i < n; ++i) {
+        const int old = order[i];
+        newIndex[old] = i;
+        for (int c = 0; c < 3; ++c) {
+            coordinates[3 * i + c] = nodeCoordinates[3 * old + c];
+        }
+        if (!nodeBodies.empty()) {
+            bodies[i] = nodeBodies[old];
+        }
+    }
+    nodeCoordinates.swap(coordinates);
+    nodeBodies.swap(bodies);
+
+    for (int& node : triangles) {
+        node = newIndex[node];
+    }
+    for (int& node : edges) {
+        node = newIndex[node];
+    }
+
+    stiffness = SparseMatrix();
+    masses.clear();
+}
+
+int StructuralModel::bandwidth() const
+{
+    int width = 0;
+    for (int e = 0; e < numEdges(); ++e) {
+        width = std::max(width, std::abs(edges[2 * e] - edges[2 * e + 1]));
+    }
+    return width;
+}
+
+void StructuralModel::nodeAdjacency(std::vector<int>& pointers, std::vector<int>& neighbours) const
+{
+    const int n = numNodes();
+    pointers.assign(static_cast<size_t>(n) + 1, 0);
+    for (int e = 0; e < numEdges(); ++e) {
+        const int a = edges[2 * e];
+        const int b = edges[2 * e + 1];
+        if (a != b) {
+            pointers[a + 1]++;
+            pointers[b + 1]++;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        pointers[i + 1] += pointers[i];
+    }
+    neighbours.resize(pointers[n]);
+    std::vector<int> fill(pointers.begin(), pointers.end() - 1);
+    for (int e = 0; e < numEdges(); ++e) {
+        const int a = edges[2 * e];
+        const int b = edges[2 * e + 1];
+        if (a != b) {
+            neighbours[fill[a]++] = b;
+            neighbours[fill[b]++] = a;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        std::sort(neighbours.begin() + pointers[i], neighbours.begin() + pointers[i + 1]);
+    }
+}
+
+StructuralModel StructuralModel::makeChain(int numNodes)
+{
+    StructuralModel model;
+    model.dofsPerNode = 1;
+    model.numBodies = 1;
+    model.nodeCoordinates.resize(static_cast<size_t>(numNodes) * 3, 0.0);
+    model.nodeBodies.assign(numNodes, 0);
+
+    for (int i = 0; i < numNodes; ++i) {
+        model.nodeCoordinates[3 * i] = static_cast<double>(i);
+    }
+    for (int i = 0; i + 1 < numNodes; ++i) {
+        model.edges.push_back(i);
+        model.edges.push_back(i + 1);
+    }
+
+    return model;
+}
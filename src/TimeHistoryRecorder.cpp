@@ -0,0 +1,467 @@
+#include "TimeHistoryRecorder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <type_traits>
+
+namespace {
+
+const char FileMagic[8] = { 'S', 'I', 'M', 'H', 'I', 'S', 'T', '1' };
+const char ChunkTag[4] = { 'C', 'H', 'N', 'K' };
+const std::uint32_t FileVersion = 1;
+const int FieldBits[] = { TimeHistoryRecorder::Positions, TimeHistoryRecorder::Velocities,
+                          TimeHistoryRecorder::Accelerations };
+const char FieldNames[] = { 'x', 'v', 'a' };
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::int32_t numDOF;
+    std::int32_t fields;
+    std::int32_t valueSize;     // 4 (float) or 8 (double)
+    std::int32_t blockSize;
+    std::int32_t chunkFrames;
+};
+
+struct ChunkHeader
+{
+    char tag[4];
+    std::int32_t frames;
+    std::int32_t firstStep;
+    std::int32_t reserved;
+    double firstTime;
+    double lastTime;
+};
+
+int countFields(int fields)
+{
+    int count = 0;
+    for (int bit : FieldBits) {
+        count += (fields & bit) ? 1 : 0;
+    }
+    return count;
+}
+
+// Bytes after the chunk header: time index columns, then the field blocks
+long long chunkBodySize(int frames, int numDOF, int fieldCount, int valueSize)
+{
+    const long long indexBytes = sizeof(double) + sizeof(std::int32_t) + 2 * sizeof(double);
+    return frames * indexBytes + static_cast<long long>(fieldCount) * numDOF * frames * valueSize;
+}
+
+} // namespace
+
+TimeHistoryRecorder::TimeHistoryRecorder(const Options& options)
+    : m_options(options)
+    , m_numDOF(0)
+    , m_fieldCount(0)
+    , m_head(0)
+    , m_tail(0)
+    , m_finishing(false)
+    , m_chunkFill(0)
+    , m_recorded(0)
+    , m_dropped(0)
+    , m_written(0)
+{
+    setOptions(options);
+}
+
+TimeHistoryRecorder::~TimeHistoryRecorder()
+{
+    finish();
+}
+
+void TimeHistoryRecorder::setOptions(const Options& options)
+{
+    if (isRecording()) {
+        return;
+    }
+
+    m_options = options;
+    m_options.recordInterval = std::max(m_options.recordInterval, 1);
+    m_options.chunkFrames = std::max(m_options.chunkFrames, 1);
+    m_options.blockSize = std::max(m_options.blockSize, 1);
+    m_options.queueFrames = std::max(m_options.queueFrames, 1);
+    m_fieldCount = countFields(m_options.fields);
+}
+
+void TimeHistoryRecorder::setOutputFile(const std::string& path)
+{
+    m_path = path;
+}
+
+std::string TimeHistoryRecorder::lastError() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastError;
+}
+
+bool TimeHistoryRecorder::start(int numDOF)
+{
+    finish();
+
+    m_lastError.clear();
+    m_file.open(m_path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        m_lastError = "Cannot write " + m_path;
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.numDOF = numDOF;
+    header.fields = m_options.fields;
+    header.valueSize = m_options.doublePrecision ? sizeof(double) : sizeof(float);
+    header.blockSize = m_options.blockSize;
+    header.chunkFrames = m_options.chunkFrames;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Everything the solver and writer touch is sized here, once per run
+    m_numDOF = numDOF;
+    m_queue.resize(m_options.queueFrames);
+    for (Frame& frame : m_queue) {
+        frame.values.assign(static_cast<size_t>(m_fieldCount) * numDOF, 0.0);
+    }
+    const int frames = m_options.chunkFrames;
+    m_times.assign(frames, 0.0);
+    m_steps.assign(frames, 0);
+    m_timeSteps.assign(frames, 0.0);
+    m_energies.assign(frames, 0.0);
+    m_columns.assign(static_cast<size_t>(m_fieldCount) * numDOF * frames, 0.0);
+    m_floatColumns.assign(m_options.doublePrecision ? 0 : static_cast<size_t>(numDOF) * frames, 0.0f);
+    m_chunkFill = 0;
+
+    m_head = 0;
+    m_tail = 0;
+    m_finishing = false;
+    m_recorded = 0;
+    m_dropped = 0;
+    m_written = 0;
+    m_thread = std::thread(&TimeHistoryRecorder::writerLoop, this);
+    return true;
+}
+
+bool TimeHistoryRecorder::record(const SimulationState& state)
+{
+    if (!m_thread.joinable() || state.currentStep % m_options.recordInterval != 0
+        || static_cast<int>(state.positions.size()) != m_numDOF) {
+        return false;
+    }
+
+    const long long head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= static_cast<long long>(m_queue.size())) {
+        m_dropped++;
+        return false;
+    }
+
+    // The slot is ours until m_head moves past it
+    Frame& frame = m_queue[head % m_queue.size()];
+    frame.time = state.currentTime;
+    frame.step = state.currentStep;
+    frame.timeStep = state.timeStep;
+    frame.energy = state.energy;
+    double* values = frame.values.data();
+    if (m_options.fields & Positions) {
+        values = std::copy(state.positions.begin(), state.positions.end(), values);
+    }
+    if (m_options.fields & Velocities) {
+        values = std::copy(state.velocities.begin(), state.velocities.end(), values);
+    }
+    if (m_options.fields & Accelerations) {
+        std::copy(state.accelerations.begin(), state.accelerations.end(), values);
+    }
+    m_head.store(head + 1, std::memory_order_release);
+    m_recorded++;
+
+    // Empty critical section: the writer is either before its check or waiting
+    { std::lock_guard<std::mutex> lock(m_mutex); }
+    m_condition.notify_one();
+    return true;
+}
+
+void TimeHistoryRecorder::finish()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finishing = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+    m_file.close();
+}
+
+void TimeHistoryRecorder::writerLoop()
+{
+    for (;;) {
+        const long long tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this, tail]() {
+                return m_head.load(std::memory_order_acquire) != tail || m_finishing;
+            });
+            if (m_head.load(std::memory_order_acquire) == tail) {
+                break;  // Finishing and drained
+            }
+            continue;
+        }
+
+        appendFrame(m_queue[tail % m_queue.size()]);
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        if (m_chunkFill == m_options.chunkFrames) {
+            writeChunk();
+        }
+    }
+
+    if (m_chunkFill > 0) {
+        writeChunk();
+    }
+    m_file.flush();
+}
+
+void TimeHistoryRecorder::appendFrame(const Frame& frame)
+{
+    const int f = m_chunkFill++;
+    m_times[f] = frame.time;
+    m_steps[f] = frame.step;
+    m_timeSteps[f] = frame.timeStep;
+    m_energies[f] = frame.energy;
+
+    // Block regions are strided by chunkFrames; a frame fills one row of each
+    const int frames = m_options.chunkFrames;
+    for (int field = 0; field < m_fieldCount; ++field) {
+        const double* values = frame.values.data() + static_cast<size_t>(field) * m_numDOF;
+        double* fieldColumns = m_columns.data() + static_cast<size_t>(field) * m_numDOF * frames;
+        for (int begin = 0; begin < m_numDOF; begin += m_options.blockSize) {
+            const int width = std::min(m_options.blockSize, m_numDOF - begin);
+            std::copy(values + begin, values + begin + width,
+                      fieldColumns + static_cast<size_t>(begin) * frames + static_cast<size_t>(f) * width);
+        }
+    }
+}
+
+void TimeHistoryRecorder::writeChunk()
+{
+    const int fill = m_chunkFill;
+    m_chunkFill = 0;
+    if (!m_file) {
+        return;
+    }
+
+    ChunkHeader header;
+    std::memcpy(header.tag, ChunkTag, sizeof(ChunkTag));
+    header.frames = fill;
+    header.firstStep = m_steps[0];
+    header.reserved = 0;
+    header.firstTime = m_times[0];
+    header.lastTime = m_times[fill - 1];
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.write(reinterpret_cast<const char*>(m_times.data()), fill * sizeof(double));
+    m_file.write(reinterpret_cast<const char*>(m_steps.data()), fill * sizeof(std::int32_t));
+    m_file.write(reinterpret_cast<const char*>(m_timeSteps.data()), fill * sizeof(double));
+    m_file.write(reinterpret_cast<const char*>(m_energies.data()), fill * sizeof(double));
+
+    // A partial chunk writes the filled rows of every block
+    const int frames = m_options.chunkFrames;
+    for (int field = 0; field < m_fieldCount; ++field) {
+        const double* fieldColumns = m_columns.data() + static_cast<size_t>(field) * m_numDOF * frames;
+        for (int begin = 0; begin < m_numDOF; begin += m_options.blockSize) {
+            const int width = std::min(m_options.blockSize, m_numDOF - begin);
+            const double* block = fieldColumns + static_cast<size_t>(begin) * frames;
+            const size_t count = static_cast<size_t>(fill) * width;
+            if (m_options.doublePrecision) {
+                m_file.write(reinterpret_cast<const char*>(block), count * sizeof(double));
+            } else {
+                std::copy(block, block + count, m_floatColumns.begin());
+                m_file.write(reinterpret_cast<const char*>(m_floatColumns.data()), count * sizeof(float));
+            }
+        }
+    }
+
+    if (!m_file) {
+        fail("Write to " + m_path + " failed");
+        return;
+    }
+    m_written += fill;
+}
+
+void TimeHistoryRecorder::fail(const std::string& error)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastError = error;
+}
+
+TimeHistoryReader::TimeHistoryReader()
+    : m_numDOF(0)
+    , m_fields(0)
+    , m_fieldCount(0)
+    , m_valueSize(0)
+    , m_blockSize(0)
+    , m_frameCount(0)
+{
+}
+
+bool TimeHistoryReader::open(const std::string& path)
+{
+    m_file.close();
+    m_file.clear();
+    m_chunks.clear();
+    m_frameCount = 0;
+
+    m_file.open(path.c_str(), std::ios::binary);
+    if (!m_file) {
+        m_lastError = "Cannot open " + path;
+        return false;
+    }
+
+    FileHeader header;
+    if (!m_file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion
+        || header.numDOF < 0 || (header.valueSize != sizeof(float) && header.valueSize != sizeof(double))
+        || header.blockSize < 1) {
+        m_lastError = path + " is not a time history of this version";
+        return false;
+    }
+    m_numDOF = header.numDOF;
+    m_fields = header.fields;
+    m_fieldCount = countFields(header.fields);
+    m_valueSize = header.valueSize;
+    m_blockSize = header.blockSize;
+
+    // Index the chunks; stop at the first incomplete one
+    m_file.seekg(0, std::ios::end);
+    const long long fileSize = m_file.tellg();
+    long long offset = sizeof(FileHeader);
+    while (offset + static_cast<long long>(sizeof(ChunkHeader)) <= fileSize) {
+        ChunkHeader chunk;
+        m_file.seekg(offset);
+        if (!m_file.read(reinterpret_cast<char*>(&chunk), sizeof(chunk))
+            || std::memcmp(chunk.tag, ChunkTag, sizeof(ChunkTag)) != 0 || chunk.frames < 1) {
+            break;
+        }
+        const long long end = offset + sizeof(ChunkHeader)
+                            + chunkBodySize(chunk.frames, m_numDOF, m_fieldCount, m_valueSize);
+        if (end > fileSize) {
+            break;
+        }
+
+        ChunkInfo info;
+        info.offset = offset;
+        info.frames = chunk.frames;
+        info.firstTime = chunk.firstTime;
+        info.lastTime = chunk.lastTime;
+        info.firstStep = chunk.firstStep;
+        m_chunks.push_back(info);
+        m_frameCount += chunk.frames;
+        offset = end;
+    }
+    m_file.clear();
+    return true;
+}
+
+bool TimeHistoryReader::readChunk(int index, Chunk& chunk)
+{
+    if (index < 0 || index >= static_cast<int>(m_chunks.size())) {
+        return false;
+    }
+
+    const ChunkInfo& info = m_chunks[index];
+    const int frames = info.frames;
+    m_buffer.resize(chunkBodySize(frames, m_numDOF, m_fieldCount, m_valueSize));
+    m_file.seekg(info.offset + sizeof(ChunkHeader));
+    if (!m_file.read(m_buffer.data(), m_buffer.size())) {
+        m_file.clear();
+        m_lastError = "Read failed";
+        return false;
+    }
+
+    const char* data = m_buffer.data();
+    auto column = [&data, frames](auto& values) {
+        typedef typename std::decay<decltype(values)>::type::value_type Value;
+        values.resize(frames);
+        std::memcpy(values.data(), data, frames * sizeof(Value));
+        data += frames * sizeof(Value);
+    };
+    chunk.frames = frames;
+    column(chunk.times);
+    column(chunk.steps);
+    column(chunk.timeSteps);
+    column(chunk.energies);
+
+    // Blocks hold rows of `width` DOFs; scatter them into full-width rows
+    chunk.columns.resize(static_cast<size_t>(m_fieldCount) * frames * m_numDOF);
+    for (int field = 0; field < m_fieldCount; ++field) {
+        double* fieldRows = chunk.columns.data() + static_cast<size_t>(field) * frames * m_numDOF;
+        for (int begin = 0; begin < m_numDOF; begin += m_blockSize) {
+            const int width = std::min(m_blockSize, m_numDOF - begin);
+            for (int f = 0; f < frames; ++f) {
+                double* row = fieldRows + static_cast<size_t>(f) * m_numDOF + begin;
+                if (m_valueSize == sizeof(double)) {
+                    std::memcpy(row, data, width * sizeof(double));
+                } else {
+                    float values[256];
+                    for (int i = 0; i < width; i += 256) {
+                        const int count = std::min(256, width - i);
+                        std::memcpy(values, data + i * sizeof(float), count * sizeof(float));
+                        std::copy(values, values + count, row + i);
+                    }
+                }
+                data += static_cast<size_t>(width) * m_valueSize;
+            }
+        }
+    }
+    return true;
+}
+
+bool TimeHistoryReader::exportCsv(const std::string& csvPath)
+{
+    std::ofstream out(csvPath.c_str());
+    if (!out) {
+        m_lastError = "Cannot write " + csvPath;
+        return false;
+    }
+
+    out << "time,step,timeStep,energy";
+    for (int field = 0; field < 3; ++field) {
+        if (m_fields & FieldBits[field]) {
+            for (int i = 0; i < m_numDOF; ++i) {
+                out << ',' << FieldNames[field] << i;
+            }
+        }
+    }
+    out << '\n';
+
+    // Digits that round-trip the stored precision
+    const int fieldDigits = (m_valueSize == sizeof(double)) ? 17 : 9;
+    Chunk chunk;
+    for (int c = 0; c < static_cast<int>(m_chunks.size()); ++c) {
+        if (!readChunk(c, chunk)) {
+            return false;
+        }
+        for (int f = 0; f < chunk.frames; ++f) {
+            out << std::setprecision(17) << chunk.times[f] << ',' << chunk.steps[f] << ','
+                << chunk.timeSteps[f] << ',' << chunk.energies[f] << std::setprecision(fieldDigits);
+            for (int field = 0; field < m_fieldCount; ++field) {
+                const double* row = chunk.columns.data()
+                                  + (static_cast<size_t>(field) * chunk.frames + f) * m_numDOF;
+                for (int i = 0; i < m_numDOF; ++i) {
+                    out << ',' << row[i];
+                }
+            }
+            out << '\n';
+        }
+    }
+
+    if (!out) {
+        m_lastError = "Write to " + csvPath + " failed";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,178 @@
+#include "WorkStealingPool.h"
+#include "AllocationCounter.h"
+#include <algorithm>
+
+namespace {
+
+// Busy-wait iterations before a worker goes to sleep between jobs; keeps
+// back-to-back time steps from paying a full wake-up each
+const int SpinIterations = 20000;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int numThreads)
+    : m_invoker(nullptr)
+    , m_context(nullptr)
+    , m_begin(0)
+    , m_end(0)
+    , m_grain(1)
+    , m_generation(0)
+    , m_workersDone(0)
+    , m_shutdown(false)
+{
+    const int count = resolveThreadCount(numThreads);
+
+    for (int i = 0; i < count; ++i) {
+        m_slots.push_back(std::unique_ptr<Slot>(new Slot()));
+    }
+    // Slot 0 belongs to the calling thread
+    for (int i = 1; i < count; ++i) {
+        m_threads.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_shutdown = true;
+        m_generation++;
+    }
+    m_jobCondition.notify_all();
+
+    for (size_t i = 0; i < m_threads.size(); ++i) {
+        m_threads[i].join();
+    }
+}
+
+int WorkStealingPool::resolveThreadCount(int requested)
+{
+    if (requested > 0) {
+        return requested;
+    }
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+void WorkStealingPool::run(int begin, int end, int grain, Invoker invoker, const void* context)
+{
+    grain = std::max(grain, 1);
+    const int chunks = chunkCount(begin, end, grain);
+    if (chunks == 0) {
+        return;
+    }
+
+    // Single participant or single chunk: run inline
+    if (m_threads.empty() || chunks == 1) {
+        for (int c = 0; c < chunks; ++c) {
+            const int chunkBegin = begin + c * grain;
+            invoker(context, c, chunkBegin, std::min(chunkBegin + grain, end));
+        }
+        return;
+    }
+
+    m_invoker = invoker;
+    m_context = context;
+    m_begin = begin;
+    m_end = end;
+    m_grain = grain;
+
+    // Deal contiguous runs of chunks to the participants
+    const int participants = threadCount();
+    for (int i = 0; i < participants; ++i) {
+        Slot& slot = *m_slots[i];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.next = static_cast<int>(static_cast<long long>(chunks) * i / participants);
+        slot.end = static_cast<int>(static_cast<long long>(chunks) * (i + 1) / participants);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_workersDone.store(0, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+    m_jobCondition.notify_all();
+
+    drain(0);
+
+    // Wait until every worker has finished with this job
+    const int workers = static_cast<int>(m_threads.size());
+    for (int spin = 0; spin < SpinIterations; ++spin) {
+        if (m_workersDone.load(std::memory_order_acquire) == workers) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(m_jobMutex);
+    m_doneCondition.wait(lock, [this, workers] {
+        return m_workersDone.load(std::memory_order_acquire) == workers;
+    });
+}
+
+void WorkStealingPool::workerLoop(int index)
+{
+    unsigned long long seen = 0;
+    AllocationCounter::trackThread();       // Chunks belong to the caller's step
+
+    for (;;) {
+        // Wait for the next job: spin briefly, then sleep
+        bool ready = false;
+        for (int spin = 0; spin < SpinIterations && !ready; ++spin) {
+            ready = m_generation.load(std::memory_order_acquire) != seen;
+            if (!ready) {
+                std::this_thread::yield();
+            }
+        }
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobCondition.wait(lock, [this, seen] {
+                return m_generation.load(std::memory_order_acquire) != seen;
+            });
+            if (m_shutdown) {
+                return;
+            }
+            seen = m_generation.load(std::memory_order_acquire);
+        }
+
+        drain(index);
+
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (m_workersDone.fetch_add(1, std::memory_order_acq_rel) + 1 == static_cast<int>(m_threads.size())) {
+            m_doneCondition.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::drain(int self)
+{
+    int chunk = 0;
+    while (takeChunk(self, chunk)) {
+        const int chunkBegin = m_begin + chunk * m_grain;
+        m_invoker(m_context, chunk, chunkBegin, std::min(chunkBegin + m_grain, m_end));
+    }
+}
+
+bool WorkStealingPool::takeChunk(int self, int& chunk)
+{
+    // Own run first, front to back
+    {
+        Slot& own = *m_slots[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.next < own.end) {
+            chunk = own.next++;
+            return true;
+        }
+    }
+
+    // Then steal from the back of the other runs
+    const int participants = threadCount();
+    for (int offset = 1; offset < participants; ++offset) {
+        Slot& victim = *m_slots[(self + offset) % participants];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.next < victim.end) {
+            chunk = --victim.end;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,777 @@
+// Benchmark suite: solver and engine throughput, STEP loading and shared
+// memory IPC. Results are written as JSON; --baseline compares them with a
+// stored run and fails on regressions or missing benchmarks. Headless like
+// SimulationToolCli.
+#include "NodeOrdering.h"
+#include "SharedMemorySender.h"
+#include "SimulationEngine.h"
+#include "SimulationSolver.h"
+#include "SolverKernels.h"
+#include "STEPReader.h"
+#include "WorkStealingPool.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSharedMemory>
+#include <QStringList>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <streambuf>
+
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <Standard_Version.hxx>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return (values.size() % 2) ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+}
+
+/**
+ * Silences std::cout while measuring, so the per-run logging of the engine
+ * and the STEP reader neither floods the report nor skews the timings.
+ */
+class MuteConsole
+{
+public:
+    MuteConsole() : m_previous(std::cout.rdbuf(&m_null)) {}
+    ~MuteConsole() { std::cout.rdbuf(m_previous); }
+
+private:
+    struct NullBuffer : std::streambuf
+    {
+        int overflow(int c) override { return c; }
+    };
+
+    NullBuffer m_null;
+    std::streambuf* m_previous;
+};
+
+/**
+ * One benchmark: its samples (one per repetition) and what it measured.
+ * The reported value is the median sample.
+ */
+struct Benchmark
+{
+    QString name;
+    QString unit;
+    bool higherIsBetter;
+    std::vector<double> samples;
+    QJsonObject parameters;
+
+    double value() const { return median(samples); }
+};
+
+struct Settings
+{
+    int repetitions;
+    double minTime;         // Seconds each throughput sample runs for at least
+    bool quick;
+    QRegularExpression filter;
+};
+
+class Suite
+{
+public:
+    explicit Suite(const Settings& settings) : m_settings(settings) {}
+
+    const Settings& settings() const { return m_settings; }
+    bool wants(const QString& name) const { return m_settings.filter.match(name).hasMatch(); }
+
+    void add(const Benchmark& benchmark)
+    {
+        std::cout << std::left << std::setw(48) << benchmark.name.toStdString() << std::right
+                  << std::setw(14) << std::setprecision(4) << benchmark.value() << ' '
+                  << benchmark.unit.toStdString() << std::endl;
+        m_benchmarks.push_back(benchmark);
+    }
+
+    void skip(const QString& name, const QString& reason)
+    {
+        std::cout << std::left << std::setw(48) << name.toStdString() << "skipped: "
+                  << reason.toStdString() << std::endl;
+    }
+
+    const std::vector<Benchmark>& benchmarks() const { return m_benchmarks; }
+
+private:
+    Settings m_settings;
+    std::vector<Benchmark> m_benchmarks;
+};
+
+const char* integratorName(IntegratorType type)
+{
+    switch (type) {
+        case IntegratorType::VelocityVerlet:     return "velocity-verlet";
+        case IntegratorType::RungeKutta4:        return "rk4";
+        case IntegratorType::Newmark:            return "newmark";
+        case IntegratorType::DormandPrince54:    return "dopri54";
+        case IntegratorType::BackwardEuler:      return "backward-euler";
+        case IntegratorType::ImplicitNewmark:    return "implicit-newmark";
+        case IntegratorType::ModalSuperposition: return "modal";
+        default:                                 return "symplectic-euler";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Microbenchmark: SimulationSolver steps per second vs DOF count
+// ---------------------------------------------------------------------------
+void benchSolver(Suite& suite)
+{
+    const bool quick = suite.settings().quick;
+    const std::vector<int> sizes = quick ? std::vector<int>{ 1000, 10000 }
+                                         : std::vector<int>{ 1000, 10000, 100000, 1000000 };
+    const IntegratorType integrators[] = { IntegratorType::SymplecticEuler, IntegratorType::VelocityVerlet,
+                                           IntegratorType::RungeKutta4, IntegratorType::BackwardEuler };
+
+    for (IntegratorType integrator : integrators) {
+        for (int numDOF : sizes) {
+            // Million-DOF runs only for the single-evaluation explicit schemes
+            if (numDOF > 100000 && integrator != IntegratorType::SymplecticEuler
+                && integrator != IntegratorType::VelocityVerlet) {
+                continue;
+            }
+            // Single-threaded everywhere; all cores once the model is large enough to split
+            std::vector<int> threadCounts{ 1 };
+            if (numDOF >= 100000) {
+                threadCounts.push_back(0);
+            }
+
+            // Explicit schemes also in single and mixed precision
+            std::vector<ScalarPrecision> precisions{ ScalarPrecision::Double };
+            if (integrator != IntegratorType::BackwardEuler) {
+                precisions.push_back(ScalarPrecision::Single);
+                precisions.push_back(ScalarPrecision::Mixed);
+            }
+
+            for (int threads : threadCounts) {
+                for (ScalarPrecision precision : precisions) {
+                    Benchmark benchmark;
+                    benchmark.name = QString("solver.%1.dof%2.%3").arg(integratorName(integrator)).arg(numDOF)
+                                     .arg(threads == 1 ? QString("t1") : QString("tall"));
+                    if (precision != ScalarPrecision::Double) {
+                        benchmark.name += QString(".") + precisionName(precision);
+                    }
+                    if (!suite.wants(benchmark.name)) {
+                        continue;
+                    }
+                    benchmark.unit = "steps/s";
+                    benchmark.higherIsBetter = true;
+                    benchmark.parameters["dof"] = numDOF;
+                    benchmark.parameters["threads"] = WorkStealingPool::resolveThreadCount(threads);
+                    benchmark.parameters["integrator"] = integratorName(integrator);
+                    benchmark.parameters["precision"] = precisionName(precision);
+
+                    SimulationParameters params;
+                    params.integrator = integrator;
+                    params.numThreads = threads;
+                    params.precision = precision;
+                    params.timeStep = 1e-3;
+                    params.totalTime = 1e9;     // Never reached; samples are time-boxed
+
+                    SimulationSolver solver;
+                    solver.initialize(params, StructuralModel::makeChain(numDOF));
+                    solver.dispatch([&](auto policy) {
+                        typedef decltype(policy) Integrator;
+                        for (int i = 0; i < 3; ++i) {
+                            solver.step<Integrator>();     // Warm up caches and the pool
+                        }
+                        for (int r = 0; r < suite.settings().repetitions; ++r) {
+                            const Clock::time_point start = Clock::now();
+                            int steps = 0;
+                            double elapsed = 0.0;
+                            do {
+                                solver.step<Integrator>();
+                                ++steps;
+                                elapsed = secondsSince(start);
+                            } while (elapsed < suite.settings().minTime);
+                            benchmark.samples.push_back(steps / elapsed);
+                        }
+                    });
+                    suite.add(benchmark);
+                }
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Microbenchmark: node orderings on a lattice numbered in random order
+// ---------------------------------------------------------------------------
+
+// Cubic lattice of side n with axis and face-diagonal edges; nodes are
+// numbered in a fixed random order, the worst case for a mesher's numbering
+StructuralModel makeShuffledLattice(int n)
+{
+    const int numNodes = n * n * n;
+    std::vector<int> index(numNodes);
+    std::iota(index.begin(), index.end(), 0);
+    std::mt19937 generator(2024);
+    std::shuffle(index.begin(), index.end(), generator);
+    auto node = [&index, n](int i, int j, int k) { return index[(k * n + j) * n + i]; };
+
+    StructuralModel model;
+    model.nodeCoordinates.resize(3 * static_cast<size_t>(numNodes));
+    model.nodeBodies.assign(numNodes, 0);
+    model.numBodies = 1;
+    for (int k = 0; k < n; ++k) {
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                const int id = node(i, j, k);
+                model.nodeCoordinates[3 * id] = i;
+                model.nodeCoordinates[3 * id + 1] = j;
+                model.nodeCoordinates[3 * id + 2] = k;
+                const int neighbours[4][3] = { { i + 1, j, k }, { i, j + 1, k }, { i, j, k + 1 }, { i + 1, j + 1, k } };
+                for (const int* other : neighbours) {
+                    if (other[0] < n && other[1] < n && other[2] < n) {
+                        model.edges.push_back(id);
+                        model.edges.push_back(node(other[0], other[1], other[2]));
+                    }
+                }
+            }
+        }
+    }
+    return model;
+}
+
+void benchOrdering(Suite& suite)
+{
+    const int side = suite.settings().quick ? 24 : 64;
+    const StructuralModel lattice = makeShuffledLattice(side);
+    const DofOrdering orderings[] = { DofOrdering::Natural, DofOrdering::ReverseCuthillMcKee,
+                                      DofOrdering::Morton, DofOrdering::Hilbert };
+
+    for (DofOrdering ordering : orderings) {
+        Benchmark benchmark;
+        benchmark.name = QString("ordering.lattice%1.%2").arg(lattice.numNodes() * 3).arg(NodeOrdering::name(ordering));
+        if (!suite.wants(benchmark.name)) {
+            continue;
+        }
+        benchmark.unit = "steps/s";
+        benchmark.higherIsBetter = true;
+        benchmark.parameters["dof"] = lattice.numNodes() * 3;
+        benchmark.parameters["ordering"] = NodeOrdering::name(ordering);
+
+        SimulationParameters params;
+        params.integrator = IntegratorType::VelocityVerlet;
+        params.numThreads = 1;
+        params.dofOrdering = ordering;
+        params.timeStep = 1e-3;
+        params.totalTime = 1e9;     // Never reached; samples are time-boxed
+
+        SimulationSolver solver;
+        {
+            MuteConsole mute;
+            solver.initialize(params, lattice);
+        }
+        benchmark.parameters["bandwidth"] = solver.model().bandwidth();
+        solver.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            for (int i = 0; i < 3; ++i) {
+                solver.step<Integrator>();
+            }
+            for (int r = 0; r < suite.settings().repetitions; ++r) {
+                const Clock::time_point start = Clock::now();
+                int steps = 0;
+                double elapsed = 0.0;
+                do {
+                    solver.step<Integrator>();
+                    ++steps;
+                    elapsed = secondsSince(start);
+                } while (elapsed < suite.settings().minTime);
+                benchmark.samples.push_back(steps / elapsed);
+            }
+        });
+        suite.add(benchmark);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Macrobenchmark: SimulationEngine headless runs, DOF set by geometry and mesh
+// ---------------------------------------------------------------------------
+
+// Wall time of one headless engine run of the given number of steps
+double timeEngineRun(const TopoDS_Shape& shape, double meshSize, int steps, int& numDOF)
+{
+    SimulationParameters params;
+    params.runMode = RunMode::Headless;
+    params.timeStep = 1e-3;
+    params.totalTime = steps * params.timeStep;
+    params.meshSize = meshSize;
+
+    SimulationEngine engine;
+    engine.setGeometry(shape);
+    engine.setParameters(params);
+
+    MuteConsole mute;
+    const Clock::time_point start = Clock::now();
+    engine.startSimulation();
+    engine.wait();
+    const double elapsed = secondsSince(start);
+    numDOF = static_cast<int>(engine.getCurrentState().positions.size());
+    return elapsed;
+}
+
+void benchEngineCase(Suite& suite, const QString& name, const TopoDS_Shape& shape, double meshSize)
+{
+    if (!suite.wants(name)) {
+        return;
+    }
+
+    Benchmark benchmark;
+    benchmark.name = name;
+    benchmark.unit = "steps/s";
+    benchmark.higherIsBetter = true;
+
+    // Setup (meshing, assembly, thread start) is the same for runs of N and
+    // 2N steps, so their difference times N steps alone
+    int numDOF = 0;
+    const int probeSteps = 20;
+    const double probe = timeEngineRun(shape, meshSize, 2 * probeSteps, numDOF)
+                       - timeEngineRun(shape, meshSize, probeSteps, numDOF);
+    const double probeRate = probeSteps / std::max(probe, 1e-6);
+    const int steps = static_cast<int>(std::min(std::max(probeRate * suite.settings().minTime, 1.0 * probeSteps),
+                                                1e7));
+
+    for (int r = 0; r < suite.settings().repetitions; ++r) {
+        const double single = timeEngineRun(shape, meshSize, steps, numDOF);
+        const double twice = timeEngineRun(shape, meshSize, 2 * steps, numDOF);
+        benchmark.samples.push_back(steps / std::max(twice - single, 1e-9));
+    }
+    benchmark.parameters["dof"] = numDOF;
+    benchmark.parameters["meshSize"] = meshSize;
+    benchmark.parameters["steps"] = steps;
+    suite.add(benchmark);
+}
+
+void benchEngine(Suite& suite, const std::vector<std::pair<QString, TopoDS_Shape>>& shapes)
+{
+    // Without geometry the engine falls back to its 10-DOF chain
+    benchEngineCase(suite, "engine.headless.chain", TopoDS_Shape(), 0.0);
+
+    const std::vector<int> divisions = suite.settings().quick ? std::vector<int>{ 8 }
+                                                              : std::vector<int>{ 8, 16, 32 };
+    for (const auto& entry : shapes) {
+        Bnd_Box box;
+        BRepBndLib::Add(entry.second, box);
+        if (box.IsVoid()) {
+            continue;
+        }
+        double xMin, yMin, zMin, xMax, yMax, zMax;
+        box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+        const double diagonal = std::sqrt((xMax - xMin) * (xMax - xMin) + (yMax - yMin) * (yMax - yMin)
+                                          + (zMax - zMin) * (zMax - zMin));
+
+        // Finer meshes of the same part give the DOF scaling of a real model
+        for (int division : divisions) {
+            benchEngineCase(suite, QString("engine.headless.%1.div%2").arg(entry.first).arg(division),
+                            entry.second, diagonal / division);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// STEP loading and topology analysis on the example files
+// ---------------------------------------------------------------------------
+std::vector<std::pair<QString, TopoDS_Shape>> benchSTEP(Suite& suite, const QString& examplesDir)
+{
+    std::vector<std::pair<QString, TopoDS_Shape>> shapes;
+    const QFileInfoList files = QDir(examplesDir).entryInfoList(QStringList() << "*.stp" << "*.step",
+                                                                QDir::Files, QDir::Name);
+    if (files.isEmpty()) {
+        suite.skip("step.*", QString("no STEP files in %1").arg(examplesDir));
+    }
+
+    for (const QFileInfo& file : files) {
+        const QString id = file.completeBaseName();
+
+        // Loading is also needed for the engine cases, so it runs even when filtered out
+        Benchmark load;
+        load.name = QString("step.load.%1").arg(id);
+        load.unit = "ms";
+        load.higherIsBetter = false;
+        load.parameters["bytes"] = static_cast<double>(file.size());
+
+        STEPReader reader;
+        bool loaded = true;
+        const int loads = suite.wants(load.name) ? suite.settings().repetitions : 1;
+        for (int r = 0; r < loads && loaded; ++r) {
+            reader.clear();
+            MuteConsole mute;
+            const Clock::time_point start = Clock::now();
+            loaded = reader.loadSTEPFile(file.absoluteFilePath());
+            load.samples.push_back(secondsSince(start) * 1e3);
+        }
+        if (!loaded) {
+            suite.skip(load.name, reader.getLastError());
+            continue;
+        }
+        if (suite.wants(load.name)) {
+            suite.add(load);
+        }
+        shapes.push_back(std::make_pair(id, reader.getShape()));
+
+        Benchmark analyze;
+        analyze.name = QString("step.analyze.%1").arg(id);
+        if (!suite.wants(analyze.name)) {
+            continue;
+        }
+        analyze.unit = "ms";
+        analyze.higherIsBetter = false;
+        const STEPReader::GeometryInfo info = reader.getGeometryInfo();
+        analyze.parameters["faces"] = info.numFaces;
+        analyze.parameters["edges"] = info.numEdges;
+
+        // A single pass can be far below the clock resolution; average over a time box
+        for (int r = 0; r < suite.settings().repetitions; ++r) {
+            MuteConsole mute;
+            const Clock::time_point start = Clock::now();
+            int passes = 0;
+            double elapsed = 0.0;
+            do {
+                reader.analyzeShape();
+                ++passes;
+                elapsed = secondsSince(start);
+            } while (elapsed < suite.settings().minTime);
+            analyze.samples.push_back(elapsed * 1e3 / passes);
+        }
+        suite.add(analyze);
+    }
+    return shapes;
+}
+
+// ---------------------------------------------------------------------------
+// SharedMemorySender bandwidth and packet latency
+// ---------------------------------------------------------------------------
+void benchIPC(Suite& suite)
+{
+    const QString key = QString("SimulationToolBench_%1").arg(QCoreApplication::applicationPid());
+    const int sizes[] = { 4 * 1024, 64 * 1024, 1024 * 1024 };
+
+    for (int size : sizes) {
+        Benchmark benchmark;
+        benchmark.name = QString("ipc.bandwidth.%1k").arg(size / 1024);
+        if (!suite.wants(benchmark.name)) {
+            continue;
+        }
+        benchmark.unit = "MB/s";
+        benchmark.higherIsBetter = true;
+        benchmark.parameters["bytes"] = size;
+
+        SharedMemorySender sender;
+        if (!sender.initialize(key, size)) {
+            suite.skip(benchmark.name, sender.getLastError());
+            continue;
+        }
+        const std::vector<char> payload(size, 'x');
+        for (int r = 0; r < suite.settings().repetitions; ++r) {
+            const Clock::time_point start = Clock::now();
+            long long bytes = 0;
+            double elapsed = 0.0;
+            do {
+                sender.sendData(payload.data(), size);
+                bytes += size;
+                elapsed = secondsSince(start);
+            } while (elapsed < suite.settings().minTime);
+            benchmark.samples.push_back(bytes / elapsed / 1e6);
+        }
+        suite.add(benchmark);
+    }
+
+    // Latency: publish a packet, then attach as a consumer would and read it back
+    Benchmark latency;
+    latency.name = "ipc.latency.packet";
+    latency.unit = "us";
+    latency.higherIsBetter = false;
+    Benchmark tail = latency;
+    tail.name = "ipc.latency.packet.p99";
+    if (!suite.wants(latency.name) && !suite.wants(tail.name)) {
+        return;
+    }
+
+    SharedMemorySender sender;
+    QSharedMemory consumer(key);
+    if (!sender.initialize(key, 1024 * 1024)) {
+        suite.skip(latency.name, sender.getLastError());
+        return;
+    }
+    if (!consumer.attach(QSharedMemory::ReadOnly)) {
+        suite.skip(latency.name, consumer.errorString());
+        return;
+    }
+    const int round = suite.settings().quick ? 2000 : 20000;
+    std::vector<double> trips(round);
+    for (int r = 0; r < suite.settings().repetitions; ++r) {
+        for (int i = 0; i < round; ++i) {
+            SharedMemorySender::DataPacket packet;
+            packet.frameNumber = i;
+            const Clock::time_point start = Clock::now();
+            sender.sendPacket(packet);
+            SharedMemorySender::DataPacket received;
+            consumer.lock();
+            std::memcpy(&received, consumer.constData(), sizeof(received));
+            consumer.unlock();
+            trips[i] = secondsSince(start) * 1e6;
+            if (received.frameNumber != i) {
+                suite.skip(latency.name, "consumer read a stale packet");
+                return;
+            }
+        }
+        std::sort(trips.begin(), trips.end());
+        latency.samples.push_back(trips[trips.size() / 2]);
+        tail.samples.push_back(trips[trips.size() * 99 / 100]);
+    }
+    if (suite.wants(latency.name)) {
+        suite.add(latency);
+    }
+    if (suite.wants(tail.name)) {
+        suite.add(tail);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Report and baseline comparison
+// ---------------------------------------------------------------------------
+QJsonObject toJson(const Benchmark& benchmark)
+{
+    QJsonArray samples;
+    for (double sample : benchmark.samples) {
+        samples.append(sample);
+    }
+    QJsonObject json;
+    json["name"] = benchmark.name;
+    json["unit"] = benchmark.unit;
+    json["higherIsBetter"] = benchmark.higherIsBetter;
+    json["value"] = benchmark.value();
+    json["min"] = *std::min_element(benchmark.samples.begin(), benchmark.samples.end());
+    json["max"] = *std::max_element(benchmark.samples.begin(), benchmark.samples.end());
+    json["samples"] = samples;
+    json["parameters"] = benchmark.parameters;
+    return json;
+}
+
+QJsonObject report(const Suite& suite)
+{
+    QJsonObject host;
+    host["isa"] = SolverKernels::isaName(SolverKernels::kernels().isa);
+    host["hardwareThreads"] = WorkStealingPool::resolveThreadCount(0);
+    host["qt"] = qVersion();
+    host["occt"] = OCC_VERSION_COMPLETE;
+
+    QJsonArray benchmarks;
+    for (const Benchmark& benchmark : suite.benchmarks()) {
+        benchmarks.append(toJson(benchmark));
+    }
+
+    QJsonObject json;
+    json["suite"] = "SimulationToolBench";
+    json["version"] = 1;
+    json["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    json["host"] = host;
+    json["repetitions"] = suite.settings().repetitions;
+    json["quick"] = suite.settings().quick;
+    json["benchmarks"] = benchmarks;
+    return json;
+}
+
+/**
+ * Compares the medians with a baseline report. A benchmark regresses when it
+ * is worse than the baseline by more than the threshold (a fraction).
+ * New benchmarks are listed only. Baseline benchmarks this run selected
+ * (--filter matches, same --quick setting) but did not produce are missing:
+ * renamed, removed or skipped, and they fail like a regression, since they
+ * would otherwise drop out of the comparison unnoticed. The others are listed.
+ * @return Regressed plus missing benchmarks
+ */
+int compareWithBaseline(QJsonObject& json, const QJsonObject& baseline, double threshold, const Suite& suite)
+{
+    std::map<QString, double> baseValues;
+    for (const QJsonValue& entry : baseline.value("benchmarks").toArray()) {
+        const QJsonObject benchmark = entry.toObject();
+        baseValues[benchmark.value("name").toString()] = benchmark.value("value").toDouble();
+    }
+
+    std::cout << "\nComparison with baseline (threshold " << threshold * 100.0 << "%)" << std::endl;
+    int regressions = 0;
+    QJsonArray benchmarks = json.value("benchmarks").toArray();
+    for (int i = 0; i < benchmarks.size(); ++i) {
+        QJsonObject benchmark = benchmarks[i].toObject();
+        const QString name = benchmark.value("name").toString();
+        const double value = benchmark.value("value").toDouble();
+        const std::map<QString, double>::const_iterator base = baseValues.find(name);
+
+        std::cout << std::left << std::setw(48) << name.toStdString() << std::right;
+        if (base == baseValues.end() || base->second <= 0.0) {
+            std::cout << "  new" << std::endl;
+            continue;
+        }
+
+        // Positive change = better, whichever direction the unit improves in
+        const double ratio = value / base->second;
+        const double change = benchmark.value("higherIsBetter").toBool() ? ratio - 1.0 : 1.0 / ratio - 1.0;
+        const bool regressed = change < -threshold;
+        regressions += regressed ? 1 : 0;
+
+        benchmark["baseline"] = base->second;
+        benchmark["change"] = change;
+        benchmark["regressed"] = regressed;
+        benchmarks[i] = benchmark;
+
+        std::cout << std::setw(14) << std::setprecision(4) << base->second << " -> " << std::setw(12) << value
+                  << "  " << std::showpos << std::fixed << std::setprecision(1) << change * 100.0 << '%'
+                  << std::noshowpos << std::defaultfloat << (regressed ? "  REGRESSED" : "") << std::endl;
+    }
+    json["benchmarks"] = benchmarks;
+    json["regressions"] = regressions;
+
+    // Baseline benchmarks absent from this run
+    std::set<QString> current;
+    for (const Benchmark& benchmark : suite.benchmarks()) {
+        current.insert(benchmark.name);
+    }
+    const bool sameSizes = baseline.value("quick").toBool() == suite.settings().quick;
+    QJsonArray missing;
+    for (const std::pair<const QString, double>& base : baseValues) {
+        if (current.count(base.first) != 0) {
+            continue;
+        }
+        const bool selected = sameSizes && suite.wants(base.first);
+        std::cout << std::left << std::setw(48) << base.first.toStdString() << std::right
+                  << (selected ? "  MISSING" : "  not run") << std::endl;
+        if (selected) {
+            missing.append(base.first);
+        }
+    }
+    json["missing"] = missing;
+    return regressions + missing.size();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("SimulationToolBench");
+    app.setApplicationVersion("1.0.0");
+    app.setOrganizationName("MyAICAD");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark suite: solver, engine, STEP loading and shared memory IPC.\n"
+                                     "Exit codes: 0 ok, 1 failure, 2 usage error, 3 regression or missing benchmark against --baseline.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "Write the JSON report to this file.",
+                                          "file");
+    const QCommandLineOption baselineOption("baseline", "Compare with this JSON report.", "file");
+    const QCommandLineOption thresholdOption("threshold", "Allowed slowdown vs the baseline (default 0.10).",
+                                             "fraction", "0.10");
+    const QCommandLineOption filterOption("filter", "Run only benchmarks whose name matches this regex.",
+                                          "regex", ".");
+    const QCommandLineOption repetitionsOption("repetitions", "Samples per benchmark (default 5).", "n", "5");
+    const QCommandLineOption minTimeOption("min-time", "Seconds per throughput sample (default 0.2).", "s", "0.2");
+    const QCommandLineOption examplesOption("examples", "Directory with the STEP files (default examples).",
+                                            "dir", "examples");
+    const QCommandLineOption quickOption("quick", "Smaller models and fewer cases, for CI smoke runs.");
+    parser.addOptions({ outputOption, baselineOption, thresholdOption, filterOption, repetitionsOption,
+                        minTimeOption, examplesOption, quickOption });
+    parser.process(app);
+
+    bool repetitionsOk = false;
+    bool minTimeOk = false;
+    bool thresholdOk = false;
+    Settings settings;
+    settings.repetitions = parser.value(repetitionsOption).toInt(&repetitionsOk);
+    settings.minTime = parser.value(minTimeOption).toDouble(&minTimeOk);
+    settings.quick = parser.isSet(quickOption);
+    settings.filter = QRegularExpression(parser.value(filterOption));
+    const double threshold = parser.value(thresholdOption).toDouble(&thresholdOk);
+    if (!repetitionsOk || !minTimeOk || !thresholdOk || settings.repetitions < 1 || settings.minTime <= 0.0
+        || threshold < 0.0 || !settings.filter.isValid()) {
+        std::cerr << "Invalid option value; see --help" << std::endl;
+        return 2;
+    }
+
+    // Read the baseline first, so a bad path fails before the suite runs
+    QJsonObject baseline;
+    if (parser.isSet(baselineOption)) {
+        QFile file(parser.value(baselineOption));
+        const QJsonDocument document = file.open(QIODevice::ReadOnly) ? QJsonDocument::fromJson(file.readAll())
+                                                                      : QJsonDocument();
+        if (!document.isObject()) {
+            std::cerr << "Cannot read baseline " << parser.value(baselineOption).toStdString() << std::endl;
+            return 1;
+        }
+        baseline = document.object();
+    }
+
+    std::cout << "[SimulationToolBench] " << SolverKernels::isaName(SolverKernels::kernels().isa) << ", "
+              << WorkStealingPool::resolveThreadCount(0) << " hardware threads, " << settings.repetitions
+              << " samples per benchmark" << std::endl;
+
+    Suite suite(settings);
+    try {
+        benchSolver(suite);
+        benchOrdering(suite);
+        const std::vector<std::pair<QString, TopoDS_Shape>> shapes = benchSTEP(suite, parser.value(examplesOption));
+        benchEngine(suite, shapes);
+        benchIPC(suite);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    QJsonObject json = report(suite);
+    int failures = 0;
+    if (parser.isSet(baselineOption)) {
+        json["baseline"] = parser.value(baselineOption);
+        failures = compareWithBaseline(json, baseline, threshold, suite);
+    }
+
+    const QByteArray text = QJsonDocument(json).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(text) != text.size()) {
+            std::cerr << "Cannot write " << parser.value(outputOption).toStdString() << std::endl;
+            return 1;
+        }
+    } else {
+        std::cout << text.constData();
+    }
+
+    if (failures > 0) {
+        std::cout << json.value("regressions").toInt() << " benchmark(s) regressed, "
+                  << json.value("missing").toArray().size() << " missing" << std::endl;
+        return 3;
+    }
+    return 0;
+}
@@ -0,0 +1,726 @@
+// Headless entry point: no QApplication, no OpenGL surface, no OCC viewer.
+// Links only the simulation core, STEP loading and shared memory output.
+#include "DomainExchange.h"
+#include "ModalAnalysis.h"
+#include "MonteCarloEnsemble.h"
+#include "NodeOrdering.h"
+#include "ParameterSweep.h"
+#include "SharedMemorySender.h"
+#include "SimulationEngine.h"
+#include "SimulationSolver.h"
+#include "STEPReader.h"
+#include "Profiler.h"
+#include "TimeHistoryRecorder.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+struct NamedIntegrator
+{
+    const char* name;
+    IntegratorType type;
+};
+
+const NamedIntegrator integratorNames[] = {
+    { "symplectic-euler", IntegratorType::SymplecticEuler },
+    { "velocity-verlet",  IntegratorType::VelocityVerlet },
+    { "rk4",              IntegratorType::RungeKutta4 },
+    { "newmark",          IntegratorType::Newmark },
+    { "dopri54",          IntegratorType::DormandPrince54 },
+    { "backward-euler",   IntegratorType::BackwardEuler },
+    { "implicit-newmark", IntegratorType::ImplicitNewmark },
+    { "modal",            IntegratorType::ModalSuperposition },
+};
+
+bool parseIntegrator(const QString& name, IntegratorType& type)
+{
+    for (const NamedIntegrator& entry : integratorNames) {
+        if (name == QLatin1String(entry.name)) {
+            type = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parsePreconditioner(const QString& name, ConjugateGradient::Preconditioner& preconditioner)
+{
+    if (name == "jacobi") {
+        preconditioner = ConjugateGradient::Preconditioner::Jacobi;
+    } else if (name == "ic0") {
+        preconditioner = ConjugateGradient::Preconditioner::IncompleteCholesky;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseNonlinear(const QString& name, NonlinearMethod& method)
+{
+    if (name == "linear") {
+        method = NonlinearMethod::Linear;
+    } else if (name == "newton") {
+        method = NonlinearMethod::Newton;
+    } else if (name == "modified-newton") {
+        method = NonlinearMethod::ModifiedNewton;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseOrdering(const QString& name, DofOrdering& ordering)
+{
+    const DofOrdering orderings[] = { DofOrdering::Natural, DofOrdering::ReverseCuthillMcKee,
+                                      DofOrdering::Morton, DofOrdering::Hilbert };
+    for (DofOrdering candidate : orderings) {
+        if (name == QLatin1String(NodeOrdering::name(candidate))) {
+            ordering = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parsePrecision(const QString& name, ScalarPrecision& precision)
+{
+    const ScalarPrecision modes[] = { ScalarPrecision::Double, ScalarPrecision::Single, ScalarPrecision::Mixed };
+    for (ScalarPrecision mode : modes) {
+        if (name == QLatin1String(precisionName(mode))) {
+            precision = mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseList(const QString& text, std::vector<double>& values)
+{
+    values.clear();
+    for (const QString& item : text.split(',', QString::SkipEmptyParts)) {
+        bool ok = false;
+        values.push_back(item.trimmed().toDouble(&ok));
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// fixed:value, uniform:low:high or normal:mean:stddev
+bool parseDistribution(const QString& text, MonteCarloEnsemble::Distribution& distribution)
+{
+    const QStringList parts = text.split(':');
+    std::vector<double> values;
+    for (int i = 1; i < parts.size(); ++i) {
+        bool ok = false;
+        values.push_back(parts[i].trimmed().toDouble(&ok));
+        if (!ok) {
+            return false;
+        }
+    }
+    if (parts[0] == "fixed" && values.size() == 1) {
+        distribution = MonteCarloEnsemble::Distribution::fixed(values[0]);
+    } else if (parts[0] == "uniform" && values.size() == 2) {
+        distribution = MonteCarloEnsemble::Distribution::uniform(values[0], values[1]);
+    } else if (parts[0] == "normal" && values.size() == 2) {
+        distribution = MonteCarloEnsemble::Distribution::normal(values[0], values[1]);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * JSON keys are the SimulationParameters field names; integrator,
+ * preconditioner, precision, nonlinear (nonlinearMethod) and ordering
+ * (dofOrdering) take the command line names.
+ */
+bool applyJson(const QJsonObject& json, SimulationParameters& params, QString& error)
+{
+    auto number = [&json](const char* key, double& value) {
+        if (json.contains(key)) {
+            value = json.value(key).toDouble(value);
+        }
+    };
+    auto integer = [&json](const char* key, int& value) {
+        if (json.contains(key)) {
+            value = json.value(key).toInt(value);
+        }
+    };
+
+    number("timeStep", params.timeStep);
+    number("totalTime", params.totalTime);
+    number("damping", params.damping);
+    number("stiffness", params.stiffness);
+    integer("maxIterations", params.maxIterations);
+    number("tolerance", params.tolerance);
+    number("meshSize", params.meshSize);
+    number("contactStiffness", params.contactStiffness);
+    number("contactThickness", params.contactThickness);
+    integer("modeCount", params.modeCount);
+    integer("publishInterval", params.publishInterval);
+    integer("numThreads", params.numThreads);
+    integer("subdomains", params.subdomains);
+    integer("timeSlices", params.timeSlices);
+    integer("coarseStepRatio", params.coarseStepRatio);
+    number("pararealTolerance", params.pararealTolerance);
+    integer("pararealMaxIterations", params.pararealMaxIterations);
+    integer("stepBatchSize", params.stepBatchSize);
+    number("steadyStateThreshold", params.steadyStateThreshold);
+    integer("steadyStateWindow", params.steadyStateWindow);
+    integer("checkpointInterval", params.checkpointInterval);
+    integer("precisionCheckSteps", params.precisionCheckSteps);
+    number("precisionTolerance", params.precisionTolerance);
+
+    if (json.contains("integrator") && !parseIntegrator(json.value("integrator").toString(), params.integrator)) {
+        error = QString("Unknown integrator: %1").arg(json.value("integrator").toString());
+        return false;
+    }
+    if (json.contains("preconditioner")
+        && !parsePreconditioner(json.value("preconditioner").toString(), params.preconditioner)) {
+        error = QString("Unknown preconditioner: %1").arg(json.value("preconditioner").toString());
+        return false;
+    }
+    if (json.contains("precision") && !parsePrecision(json.value("precision").toString(), params.precision)) {
+        error = QString("Unknown precision: %1").arg(json.value("precision").toString());
+        return false;
+    }
+    if (json.contains("nonlinear") && !parseNonlinear(json.value("nonlinear").toString(), params.nonlinearMethod)) {
+        error = QString("Unknown nonlinear method: %1").arg(json.value("nonlinear").toString());
+        return false;
+    }
+    if (json.contains("ordering") && !parseOrdering(json.value("ordering").toString(), params.dofOrdering)) {
+        error = QString("Unknown DOF ordering: %1").arg(json.value("ordering").toString());
+        return false;
+    }
+    return true;
+}
+
+bool loadJson(const QString& path, SimulationParameters& params, QString& error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot open %1").arg(path);
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject()) {
+        error = QString("%1: %2").arg(path, parseError.errorString());
+        return false;
+    }
+    return applyJson(document.object(), params, error);
+}
+
+/**
+ * Records the published states of one engine run as a time history.
+ */
+class RunRecorder : public QObject
+{
+public:
+    RunRecorder(SimulationEngine* engine, QTextStream* history, SharedMemorySender* sender)
+        : m_history(history)
+        , m_sender(sender)
+        , m_frame(0)
+        , m_failed(false)
+    {
+        connect(engine, &SimulationEngine::stateUpdated, this, &RunRecorder::record);
+        connect(engine, &SimulationEngine::simulationFinished, this, [this]() { finish(); });
+        connect(engine, &SimulationEngine::simulationError, this, [this](const QString& error) {
+            std::cerr << error.toStdString() << std::endl;
+            m_failed = true;
+            finish();
+        });
+    }
+
+    bool failed() const { return m_failed; }
+
+private:
+    void record(const SimulationEngine::StateSnapshot& state)
+    {
+        double peak = 0.0;
+        for (double x : state->positions) {
+            peak = std::max(peak, std::abs(x));
+        }
+
+        if (m_history) {
+            *m_history << state->currentTime << ',' << state->currentStep << ',' << state->timeStep << ','
+                       << state->energy << ',' << peak << '\n';
+        }
+        if (m_sender && m_sender->isInitialized()) {
+            SharedMemorySender::DataPacket packet;
+            packet.timestamp = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+            packet.frameNumber = m_frame;
+            packet.currentTime = state->currentTime;
+            packet.currentStep = state->currentStep;
+            packet.numPoints = static_cast<int>(state->positions.size());
+            m_sender->sendPacket(packet);
+        }
+        m_frame++;
+    }
+
+    void finish()
+    {
+        QCoreApplication::quit();
+    }
+
+    QTextStream* m_history;
+    SharedMemorySender* m_sender;
+    int m_frame;
+    bool m_failed;
+};
+
+bool writeFinalState(const QString& path, const SimulationEngine::SimulationState& state)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    out.setRealNumberPrecision(17);
+    out << "dof,position,velocity,acceleration\n";
+    for (size_t i = 0; i < state.positions.size(); ++i) {
+        out << i << ',' << state.positions[i] << ',' << state.velocities[i] << ','
+            << state.accelerations[i] << '\n';
+    }
+    return true;
+}
+
+int runSweep(const StructuralModel& model, const std::vector<SimulationParameters>& cases,
+             const QString& output, bool resume, int maxConcurrent)
+{
+    ParameterSweep::Options options;
+    options.maxConcurrent = maxConcurrent;
+    ParameterSweep sweep(options);
+    sweep.setCases(cases);
+    if (resume && !output.isEmpty()) {
+        std::cout << "[SimulationToolCli] Resumed " << sweep.loadResults(output.toStdString())
+                  << " completed cases from " << output.toStdString() << std::endl;
+    }
+
+    sweep.run(model, [&](int index, const ParameterSweep::CaseResult& result) {
+        std::cout << "[SimulationToolCli] Case " << index << ": " << ParameterSweep::statusName(result.status)
+                  << (result.error.empty() ? "" : " (" + result.error + ")") << std::endl;
+    });
+
+    if (!output.isEmpty() && !sweep.saveResults(output.toStdString())) {
+        std::cerr << "Cannot write " << output.toStdString() << std::endl;
+        return 1;
+    }
+    return sweep.completedCount() == static_cast<int>(cases.size()) ? 0 : 1;
+}
+
+struct NamedMetric
+{
+    const char* name;
+    double MonteCarloEnsemble::Member::* metric;
+};
+
+const NamedMetric ensembleMetrics[] = {
+    { "peakDisplacement", &MonteCarloEnsemble::Member::peakDisplacement },
+    { "settlingTime",     &MonteCarloEnsemble::Member::settlingTime },
+    { "finalEnergy",      &MonteCarloEnsemble::Member::finalEnergy },
+};
+
+int runEnsemble(const StructuralModel& model, const MonteCarloEnsemble::Options& options, const QString& output)
+{
+    MonteCarloEnsemble ensemble(options);
+    ensemble.run(model);
+
+    std::cout << "metric,mean,stddev,min,max" << std::endl;
+    std::cout.precision(10);
+    for (const NamedMetric& entry : ensembleMetrics) {
+        const MonteCarloEnsemble::Statistics stats = ensemble.statistics(entry.metric);
+        std::cout << entry.name << ',' << stats.mean << ',' << stats.stddev << ',' << stats.min << ','
+                  << stats.max << std::endl;
+    }
+
+    if (!output.isEmpty() && !ensemble.saveResults(output.toStdString())) {
+        std::cerr << "Cannot write " << output.toStdString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int runModalAnalysis(const StructuralModel& model, const SimulationParameters& params)
+{
+    ModalAnalysis modes;
+    ModalAnalysis::Options options;
+    options.modeCount = params.modeCount;
+    options.preconditioner = params.preconditioner;
+    if (!modes.compute(model, options, nullptr, 4096)) {
+        std::cerr << "Modal analysis failed: " << modes.lastError() << std::endl;
+        return 1;
+    }
+
+    std::cout << "mode,eigenvalue,angularFrequency,frequency,period" << std::endl;
+    std::cout.precision(10);
+    for (int k = 0; k < modes.modeCount(); ++k) {
+        const double frequency = modes.frequency(k);
+        std::cout << k + 1 << ',' << modes.eigenvalues()[k] << ',' << modes.angularFrequency(k) << ','
+                  << frequency << ',' << (frequency > 0.0 ? 1.0 / frequency : 0.0) << std::endl;
+    }
+
+    const double highest = ModalAnalysis::estimateHighestEigenvalue(model);
+    const double suggested = ModalAnalysis::suggestTimeStep(model, params);
+    std::cout << "[SimulationToolCli] " << modes.modeCount() << " modes from " << model.numDOF() << " DOFs in "
+              << modes.lanczosSteps() << " Lanczos steps; highest eigenvalue " << highest << " (omega "
+              << std::sqrt(std::max(highest, 0.0)) << " rad/s)" << std::endl;
+    if (!modes.isVerified()) {
+        std::cout << "[SimulationToolCli] Inertia check skipped (model too large); repeated eigenvalues may be missing"
+                  << std::endl;
+    }
+    if (suggested > 0.0) {
+        std::cout << "[SimulationToolCli] Suggested time step: " << suggested << std::endl;
+    } else {
+        std::cout << "[SimulationToolCli] Integrator is unconditionally stable; any time step is stable" << std::endl;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("SimulationToolCli");
+    app.setApplicationVersion("1.0.0");
+    app.setOrganizationName("MyAICAD");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless simulation runner (no display required).");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("step-file", "STEP model to simulate (omit for the 10-DOF chain).");
+
+    const QCommandLineOption configOption(QStringList() << "c" << "config",
+        "JSON file with SimulationParameters fields.", "file");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output",
+        "Time history CSV (sweeps: case table).", "file");
+    const QCommandLineOption finalStateOption("final-state", "Final x, v, a per DOF as CSV.", "file");
+    const QCommandLineOption recordOption("record-interval", "Record every N steps (default 10).", "n", "10");
+    const QCommandLineOption timeStepOption("time-step", "Time step in seconds.", "value");
+    const QCommandLineOption totalTimeOption("total-time", "Total simulated time in seconds.", "value");
+    const QCommandLineOption dampingOption("damping", "Damping coefficient.", "value");
+    const QCommandLineOption stiffnessOption("stiffness", "Stiffness coefficient.", "value");
+    const QCommandLineOption integratorOption("integrator",
+        "symplectic-euler, velocity-verlet, rk4, newmark, dopri54, backward-euler, implicit-newmark or modal.", "name");
+    const QCommandLineOption toleranceOption("tolerance", "Adaptive error / CG and Newton residual tolerance.", "value");
+    const QCommandLineOption iterationsOption("max-iterations", "Adaptive attempts / CG and Newton iterations.", "n");
+    const QCommandLineOption nonlinearOption("nonlinear",
+        "Implicit integrators: linear, newton or modified-newton (geometrically exact springs).", "name");
+    const QCommandLineOption preconditionerOption("preconditioner", "CG preconditioner: jacobi or ic0.", "name");
+    const QCommandLineOption precisionOption("precision",
+        "double, single or mixed (float forces, double state); explicit fixed-step integrators only.", "name");
+    const QCommandLineOption precisionCheckOption("precision-check",
+        "Single/mixed: steps compared against a double run first (0 = off, default 200).", "n");
+    const QCommandLineOption meshSizeOption("mesh-size", "Target element size (0 = automatic).", "value");
+    const QCommandLineOption orderingOption("ordering",
+        "Node renumbering for cache locality: natural, rcm, morton or hilbert.", "name");
+    const QCommandLineOption contactStiffnessOption("contact-stiffness",
+        "Penalty stiffness of contact between bodies (0 = off).", "value");
+    const QCommandLineOption contactThicknessOption("contact-thickness",
+        "Contact distance (0 = a quarter of the mean edge length).", "value");
+    const QCommandLineOption modesOption("modes", "Modal superposition: lowest modes retained (default 50).", "n");
+    const QCommandLineOption modalAnalysisOption("modal-analysis",
+        "Print the lowest --modes natural frequencies and the suggested time step, then exit.");
+    const QCommandLineOption threadsOption("threads", "Threads per run (0 = all cores).", "n");
+    const QCommandLineOption subdomainsOption("subdomains",
+        "Split the model over N worker processes (explicit fixed-step integrators, double precision).", "n");
+    const QCommandLineOption timeSlicesOption("time-slices",
+        "Parareal: integrate N time slices in parallel (fixed-step integrators, no contact).", "n");
+    const QCommandLineOption coarseRatioOption("coarse-ratio",
+        "Parareal: fine steps per step of the coarse sweep (default 4).", "n");
+    const QCommandLineOption pararealToleranceOption("parareal-tolerance",
+        "Parareal: boundary change relative to the largest boundary state that ends the iteration (default 1e-6).",
+        "value");
+    const QCommandLineOption pararealIterationsOption("parareal-iterations",
+        "Parareal: iteration cap; the run fails if it is reached unconverged (0 = slice count, default).", "n");
+    QCommandLineOption domainWorkerOption("domain-worker", "Run as a subdomain worker of this segment.", "key");
+    QCommandLineOption domainRankOption("domain-rank", "Part index of the subdomain worker.", "n");
+    domainWorkerOption.setHidden(true);
+    domainRankOption.setHidden(true);
+    const QCommandLineOption batchOption("batch-size", "Steps between checks for stop requests (default 64).", "n");
+    const QCommandLineOption steadyOption("steady-threshold", "Stop once E / E0 stays below this.", "value");
+    const QCommandLineOption steadyWindowOption("steady-window", "Steps E / E0 must stay below the threshold.", "n");
+    const QCommandLineOption shmOption("shm", "Publish progress packets to this shared memory key.", "key");
+    const QCommandLineOption sweepDampingOption("sweep-damping", "Sweep: comma-separated damping values.", "list");
+    const QCommandLineOption sweepStiffnessOption("sweep-stiffness", "Sweep: comma-separated stiffness values.", "list");
+    const QCommandLineOption sweepTimeStepOption("sweep-time-step", "Sweep: comma-separated time steps.", "list");
+    const QCommandLineOption resumeOption("resume", "Sweep: skip cases already completed in --output.");
+    const QCommandLineOption ensembleOption("ensemble",
+        "Monte Carlo ensemble of N members (symplectic Euler); --output writes the member table.", "n");
+    const QCommandLineOption ensembleDampingOption("ensemble-damping",
+        "Ensemble damping: fixed:value, uniform:low:high or normal:mean:stddev (default fixed --damping).", "spec");
+    const QCommandLineOption ensembleStiffnessOption("ensemble-stiffness",
+        "Ensemble stiffness, like --ensemble-damping (default fixed --stiffness).", "spec");
+    const QCommandLineOption ensembleAmplitudeOption("ensemble-amplitude",
+        "Ensemble scale of the initial displacement, like --ensemble-damping (default fixed:1).", "spec");
+    const QCommandLineOption ensembleNoiseOption("ensemble-noise",
+        "Ensemble: standard deviation of independent noise on each initial DOF (default 0).", "value");
+    const QCommandLineOption seedOption("seed", "Ensemble: random seed (default 1).", "n");
+    const QCommandLineOption historyOption("history",
+                                           "Stream x and v of every recorded step to this columnar file.", "file");
+    const QCommandLineOption checkpointOption("checkpoint", "Write checkpoints to this file.", "file");
+    const QCommandLineOption checkpointIntervalOption("checkpoint-interval",
+                                                      "Steps between checkpoints (default 1000 with --checkpoint).", "n");
+    const QCommandLineOption restartOption("restart", "Continue from the newest checkpoint in this file.", "file");
+    const QCommandLineOption traceOption("trace",
+                                         "Chrome trace of the step loop (needs a SIMTOOL_PROFILING build).", "file");
+    parser.addOptions({ configOption, outputOption, finalStateOption, recordOption, timeStepOption,
+                        totalTimeOption, dampingOption, stiffnessOption, integratorOption, toleranceOption,
+                        iterationsOption, nonlinearOption, preconditionerOption, precisionOption, precisionCheckOption, meshSizeOption, orderingOption, contactStiffnessOption,
+                        contactThicknessOption, modesOption, modalAnalysisOption, threadsOption, subdomainsOption, timeSlicesOption,
+                        coarseRatioOption, pararealToleranceOption, pararealIterationsOption, batchOption, steadyOption,
+                        steadyWindowOption, shmOption, sweepDampingOption, sweepStiffnessOption,
+                        sweepTimeStepOption, resumeOption, ensembleOption, ensembleDampingOption,
+                        ensembleStiffnessOption, ensembleAmplitudeOption, ensembleNoiseOption, seedOption, checkpointOption, checkpointIntervalOption,
+                        restartOption, historyOption, traceOption, domainWorkerOption, domainRankOption });
+    parser.process(app);
+
+    // Started by a decomposed run (see DomainCoordinator): step one subdomain until told to stop
+    if (parser.isSet(domainWorkerOption)) {
+        return DomainWorker::run(parser.value(domainWorkerOption), parser.value(domainRankOption).toInt());
+    }
+
+    // Parameters: defaults, then the JSON file, then the command line
+    SimulationParameters params;
+    QString error;
+    if (parser.isSet(configOption) && !loadJson(parser.value(configOption), params, error)) {
+        std::cerr << error.toStdString() << std::endl;
+        return 2;
+    }
+
+    bool ok = true;
+    auto number = [&](const QCommandLineOption& option, double& value) {
+        if (parser.isSet(option)) {
+            bool parsed = false;
+            value = parser.value(option).toDouble(&parsed);
+            ok = ok && parsed;
+        }
+    };
+    auto integer = [&](const QCommandLineOption& option, int& value) {
+        if (parser.isSet(option)) {
+            bool parsed = false;
+            value = parser.value(option).toInt(&parsed);
+            ok = ok && parsed;
+        }
+    };
+    number(timeStepOption, params.timeStep);
+    number(totalTimeOption, params.totalTime);
+    number(dampingOption, params.damping);
+    number(stiffnessOption, params.stiffness);
+    number(toleranceOption, params.tolerance);
+    integer(iterationsOption, params.maxIterations);
+    number(meshSizeOption, params.meshSize);
+    number(contactStiffnessOption, params.contactStiffness);
+    number(contactThicknessOption, params.contactThickness);
+    integer(modesOption, params.modeCount);
+    integer(threadsOption, params.numThreads);
+    integer(subdomainsOption, params.subdomains);
+    integer(timeSlicesOption, params.timeSlices);
+    integer(coarseRatioOption, params.coarseStepRatio);
+    number(pararealToleranceOption, params.pararealTolerance);
+    integer(pararealIterationsOption, params.pararealMaxIterations);
+    integer(batchOption, params.stepBatchSize);
+    number(steadyOption, params.steadyStateThreshold);
+    integer(steadyWindowOption, params.steadyStateWindow);
+    integer(precisionCheckOption, params.precisionCheckSteps);
+    if (parser.isSet(checkpointOption) && params.checkpointInterval <= 0) {
+        params.checkpointInterval = 1000;
+    }
+    integer(checkpointIntervalOption, params.checkpointInterval);
+    if (parser.isSet(integratorOption) && !parseIntegrator(parser.value(integratorOption), params.integrator)) {
+        ok = false;
+    }
+    if (parser.isSet(preconditionerOption)
+        && !parsePreconditioner(parser.value(preconditionerOption), params.preconditioner)) {
+        ok = false;
+    }
+    if (parser.isSet(precisionOption) && !parsePrecision(parser.value(precisionOption), params.precision)) {
+        ok = false;
+    }
+    if (parser.isSet(nonlinearOption) && !parseNonlinear(parser.value(nonlinearOption), params.nonlinearMethod)) {
+        ok = false;
+    }
+    if (parser.isSet(orderingOption) && !parseOrdering(parser.value(orderingOption), params.dofOrdering)) {
+        ok = false;
+    }
+    bool recordOk = false;
+    const int recordInterval = parser.value(recordOption).toInt(&recordOk);
+    if (!ok || !recordOk || recordInterval < 1 || params.checkpointInterval < 0 || params.modeCount < 1
+        || params.subdomains < 1 || params.timeSlices < 1 || params.coarseStepRatio < 1
+        || params.pararealTolerance < 0.0 || params.pararealMaxIterations < 0
+        || params.timeStep <= 0.0 || params.totalTime <= 0.0) {
+        std::cerr << "Invalid parameter value; see --help" << std::endl;
+        return 2;
+    }
+    params.runMode = RunMode::Headless;
+    params.publishInterval = recordInterval;
+
+    // Geometry
+    STEPReader reader;
+    const QStringList positional = parser.positionalArguments();
+    if (!positional.isEmpty()) {
+        if (!reader.loadSTEPFile(positional.first())) {
+            std::cerr << "Failed to load " << positional.first().toStdString() << ": "
+                      << reader.getLastError().toStdString() << std::endl;
+            return 1;
+        }
+        const STEPReader::GeometryInfo info = reader.getGeometryInfo();
+        std::cout << "[SimulationToolCli] " << info.numSolids << " solids, " << info.numFaces << " faces, volume "
+                  << info.volume << ", surface area " << info.surfaceArea << std::endl;
+    }
+
+    // Modal analysis only: frequencies instead of a run
+    if (parser.isSet(modalAnalysisOption)) {
+        try {
+            StructuralModel model = SimulationSolver::buildModel(reader.getShape(), params.meshSize);
+            model.assemble(params.stiffness);
+            return runModalAnalysis(model, params);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Ensemble mode: the member table replaces the time history
+    if (parser.isSet(ensembleOption)) {
+        MonteCarloEnsemble::Options options;
+        options.base = params;
+        options.damping = MonteCarloEnsemble::Distribution::fixed(params.damping);
+        options.stiffness = MonteCarloEnsemble::Distribution::fixed(params.stiffness);
+        options.maxConcurrent = params.numThreads;
+        bool parsed = true;
+        options.members = parser.value(ensembleOption).toInt(&parsed);
+        bool valid = parsed && options.members >= 1;
+        if (parser.isSet(ensembleDampingOption)) {
+            valid = valid && parseDistribution(parser.value(ensembleDampingOption), options.damping);
+        }
+        if (parser.isSet(ensembleStiffnessOption)) {
+            valid = valid && parseDistribution(parser.value(ensembleStiffnessOption), options.stiffness);
+        }
+        if (parser.isSet(ensembleAmplitudeOption)) {
+            valid = valid && parseDistribution(parser.value(ensembleAmplitudeOption), options.amplitude);
+        }
+        if (parser.isSet(ensembleNoiseOption)) {
+            options.positionNoise = parser.value(ensembleNoiseOption).toDouble(&parsed);
+            valid = valid && parsed;
+        }
+        if (parser.isSet(seedOption)) {
+            options.seed = parser.value(seedOption).toULongLong(&parsed);
+            valid = valid && parsed;
+        }
+        if (!valid) {
+            std::cerr << "Invalid ensemble option; see --help" << std::endl;
+            return 2;
+        }
+        try {
+            const StructuralModel model = SimulationSolver::buildModel(reader.getShape(), params.meshSize);
+            return runEnsemble(model, options, parser.value(outputOption));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Sweep mode: the case table replaces the time history
+    if (parser.isSet(sweepDampingOption) || parser.isSet(sweepStiffnessOption) || parser.isSet(sweepTimeStepOption)) {
+        std::vector<double> dampings;
+        std::vector<double> stiffnesses;
+        std::vector<double> timeSteps;
+        if (!parseList(parser.value(sweepDampingOption), dampings)
+            || !parseList(parser.value(sweepStiffnessOption), stiffnesses)
+            || !parseList(parser.value(sweepTimeStepOption), timeSteps)) {
+            std::cerr << "Invalid sweep list; see --help" << std::endl;
+            return 2;
+        }
+        try {
+            const StructuralModel model = SimulationSolver::buildModel(reader.getShape(), params.meshSize);
+            return runSweep(model, ParameterSweep::grid(params, dampings, stiffnesses, timeSteps),
+                            parser.value(outputOption), parser.isSet(resumeOption), params.numThreads);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Single run on the engine thread; states arrive here as queued signals
+    QFile historyFile;
+    QTextStream history;
+    if (parser.isSet(outputOption)) {
+        historyFile.setFileName(parser.value(outputOption));
+        if (!historyFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            std::cerr << "Cannot write " << parser.value(outputOption).toStdString() << std::endl;
+            return 1;
+        }
+        history.setDevice(&historyFile);
+        history.setRealNumberPrecision(17);
+        history << "time,step,timeStep,energy,maxDisplacement\n";
+    }
+
+    SharedMemorySender sender;
+    if (parser.isSet(shmOption) && !sender.initialize(parser.value(shmOption), 1024 * 1024)) {
+        std::cerr << "Shared memory: " << sender.getLastError().toStdString() << std::endl;
+    }
+
+    // Declared before the engine, which writes to it until its thread ends
+    TimeHistoryRecorder::Options historyOptions;
+    historyOptions.recordInterval = recordInterval;
+    TimeHistoryRecorder historyRecorder(historyOptions);
+    historyRecorder.setOutputFile(parser.value(historyOption).toStdString());
+
+    SimulationEngine engine;
+    engine.setParameters(params);
+    engine.setGeometry(reader.getShape());
+    engine.setWorkerProgram(QCoreApplication::applicationFilePath());
+    engine.setCheckpointFile(parser.value(checkpointOption));
+    if (parser.isSet(historyOption)) {
+        engine.setRecorder(&historyRecorder);
+    }
+    if (parser.isSet(restartOption)) {
+        engine.setResumeCheckpoint(parser.value(restartOption));
+    }
+    if (parser.isSet(traceOption) && !Profiler::isEnabled()) {
+        std::cerr << "--trace ignored: built without SIMTOOL_PROFILING" << std::endl;
+    }
+    engine.setTracing(parser.isSet(traceOption) && Profiler::isEnabled());
+    RunRecorder recorder(&engine, historyFile.isOpen() ? &history : nullptr, &sender);
+
+    engine.startSimulation();
+    app.exec();
+    engine.wait();
+    history.flush();
+
+    if (recorder.failed()) {
+        return 1;
+    }
+
+    std::string traceError;
+    if (parser.isSet(traceOption) && Profiler::isEnabled()
+        && !Profiler::writeChromeTrace(parser.value(traceOption).toStdString(), traceError)) {
+        std::cerr << traceError << std::endl;
+        return 1;
+    }
+
+    const SimulationEngine::SimulationState state = engine.getCurrentState();
+    std::cout << "[SimulationToolCli] Finished at t = " << state.currentTime << " after "
+              << state.currentStep << " steps, energy " << state.energy << std::endl;
+    if (parser.isSet(finalStateOption) && !writeFinalState(parser.value(finalStateOption), state)) {
+        std::cerr << "Cannot write " << parser.value(finalStateOption).toStdString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
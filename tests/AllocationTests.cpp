@@ -0,0 +1,88 @@
+// The step loop must not allocate: every integrator (and precision) is
+// stepped single- and multi-threaded while the allocations of this thread
+// and the pool workers are counted.
+#include "AllocationCounter.h"
+#include "SimulationSolver.h"
+#include "TestSuite.h"
+#include <iostream>
+
+namespace {
+
+const int StepsChecked = 20;
+
+// More DOF than two ParallelGrain chunks, so numThreads > 1 really splits the loops
+const int ChainDOF = 3 * 4096;
+
+unsigned long long countStepAllocations(const SimulationParameters& params, const StructuralModel& model)
+{
+    SimulationSolver solver;
+    solver.initialize(params, model);
+
+    AllocationCounter::trackThread();
+    unsigned long long allocations = 0;
+    solver.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        const unsigned long long before = AllocationCounter::trackedAllocations();
+        for (int i = 0; i < StepsChecked && !solver.isEndReached<Integrator>(); ++i) {
+            solver.step<Integrator>();
+        }
+        allocations = AllocationCounter::trackedAllocations() - before;
+    });
+    return allocations;
+}
+
+} // namespace
+
+SIMTOOL_TEST(step_allocations)
+{
+    SIMTOOL_CHECK(AllocationCounter::isEnabled());
+
+    struct Case
+    {
+        IntegratorType integrator;
+        ScalarPrecision precision;
+        NonlinearMethod nonlinearMethod;
+    };
+    const Case cases[] = {
+        { IntegratorType::SymplecticEuler, ScalarPrecision::Double, NonlinearMethod::Linear },
+        { IntegratorType::SymplecticEuler, ScalarPrecision::Single, NonlinearMethod::Linear },
+        { IntegratorType::SymplecticEuler, ScalarPrecision::Mixed, NonlinearMethod::Linear },
+        { IntegratorType::VelocityVerlet, ScalarPrecision::Double, NonlinearMethod::Linear },
+        { IntegratorType::VelocityVerlet, ScalarPrecision::Single, NonlinearMethod::Linear },
+        { IntegratorType::VelocityVerlet, ScalarPrecision::Mixed, NonlinearMethod::Linear },
+        { IntegratorType::RungeKutta4, ScalarPrecision::Double, NonlinearMethod::Linear },
+        { IntegratorType::RungeKutta4, ScalarPrecision::Single, NonlinearMethod::Linear },
+        { IntegratorType::RungeKutta4, ScalarPrecision::Mixed, NonlinearMethod::Linear },
+        { IntegratorType::Newmark, ScalarPrecision::Double, NonlinearMethod::Linear },
+        { IntegratorType::Newmark, ScalarPrecision::Single, NonlinearMethod::Linear },
+        { IntegratorType::Newmark, ScalarPrecision::Mixed, NonlinearMethod::Linear },
+        { IntegratorType::DormandPrince54, ScalarPrecision::Double, NonlinearMethod::Linear },
+        { IntegratorType::BackwardEuler, ScalarPrecision::Double, NonlinearMethod::Linear },
+        { IntegratorType::BackwardEuler, ScalarPrecision::Double, NonlinearMethod::Newton },
+        { IntegratorType::ImplicitNewmark, ScalarPrecision::Double, NonlinearMethod::Linear },
+        { IntegratorType::ImplicitNewmark, ScalarPrecision::Double, NonlinearMethod::ModifiedNewton },
+        { IntegratorType::ModalSuperposition, ScalarPrecision::Double, NonlinearMethod::Linear },
+    };
+
+    const StructuralModel chain = StructuralModel::makeChain(ChainDOF);
+    for (const Case& test : cases) {
+        for (int threads : { 1, 3 }) {
+            SimulationParameters params;
+            params.integrator = test.integrator;
+            params.precision = test.precision;
+            params.precisionCheckSteps = 0;
+            params.nonlinearMethod = test.nonlinearMethod;
+            params.modeCount = 8;
+            params.numThreads = threads;
+            params.timeStep = 1e-3;
+            params.totalTime = 1.0;
+
+            const unsigned long long allocations = countStepAllocations(params, chain);
+            SIMTOOL_CHECK_MESSAGE(allocations == 0, allocations << " allocations in " << StepsChecked
+                                  << " steps, integrator " << static_cast<int>(test.integrator)
+                                  << ", precision " << static_cast<int>(test.precision)
+                                  << ", nonlinear " << static_cast<int>(test.nonlinearMethod)
+                                  << ", " << threads << " threads");
+        }
+    }
+}
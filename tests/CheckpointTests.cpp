@@ -0,0 +1,122 @@
+// A checkpoint must read back exactly what was written, a run resumed from
+// it must continue bit-identical to an uninterrupted one, and a torn newest
+// slot must fall back to the previous checkpoint.
+#include "Checkpoint.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+const char* const CheckpointPath = "checkpoint_round_trip.ckpt";
+
+// Overwrite the first copy of value in the file, as a write cut off halfway would
+bool tearValue(const char* path, double value)
+{
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const char* pattern = reinterpret_cast<const char*>(&value);
+    for (size_t i = 0; i + sizeof(double) <= bytes.size(); ++i) {
+        if (std::equal(pattern, pattern + sizeof(double), bytes.begin() + i)) {
+            bytes[i] ^= 0x5a;
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            return static_cast<bool>(out);
+        }
+    }
+    return false;
+}
+
+// A position that only the given state holds, to find its slot in the file
+double markerValue(const SimulationState& state)
+{
+    double marker = 0.0;
+    for (double x : state.positions) {
+        if (std::fabs(x) > std::fabs(marker)) {
+            marker = x;
+        }
+    }
+    return marker;
+}
+
+} // namespace
+
+SIMTOOL_TEST(checkpoint_round_trip)
+{
+    const StructuralModel plates = TestModels::makeTwoPlates(12, 0.02);
+    SimulationParameters params;
+    params.integrator = IntegratorType::DormandPrince54;   // Step size and FSAL stage are part of the state
+    params.timeStep = 1e-3;
+    params.numThreads = 1;
+    params.contactStiffness = 1e4;
+    params.damping = 0.37;
+    const SimulationState uninterrupted = TestModels::run(params, plates, 100);
+
+    // Two checkpoints, after 30 and 60 steps
+    std::remove(CheckpointPath);
+    SimulationSolver solver;
+    solver.initialize(params, plates);
+    CheckpointWriter writer;
+    SIMTOOL_CHECK_MESSAGE(writer.open(CheckpointPath, plates.numDOF()), writer.lastError().toStdString());
+    SimulationState first;
+    solver.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        for (int i = 0; i < 60; ++i) {
+            solver.step<Integrator>();
+            if (solver.currentStep() == 30 || solver.currentStep() == 60) {
+                writer.flush();     // So neither submission is skipped as busy
+                SIMTOOL_CHECK(writer.submit(params, solver.state(), solver.initialEnergy(), solver.quietSteps()));
+            }
+            if (solver.currentStep() == 30) {
+                first = solver.state();
+            }
+        }
+    });
+    writer.close();
+    const SimulationState second = solver.state();
+    SIMTOOL_CHECK(writer.writtenCount() == 2);
+
+    // Newest checkpoint reads back exactly
+    Checkpoint checkpoint;
+    QString error;
+    SIMTOOL_CHECK_MESSAGE(Checkpoint::read(CheckpointPath, checkpoint, error), error.toStdString());
+    SIMTOOL_CHECK(TestModels::identical(checkpoint.state, second));
+    SIMTOOL_CHECK(checkpoint.state.timeStep == second.timeStep);
+    SIMTOOL_CHECK(checkpoint.parameters.integrator == params.integrator);
+    SIMTOOL_CHECK(checkpoint.parameters.damping == params.damping);
+    SIMTOOL_CHECK(checkpoint.parameters.contactStiffness == params.contactStiffness);
+    SIMTOOL_CHECK(checkpoint.initialEnergy == solver.initialEnergy());
+    SIMTOOL_CHECK(checkpoint.quietSteps == solver.quietSteps());
+
+    // Resuming from it continues bit-identical to the uninterrupted run
+    SimulationSolver resumed;
+    resumed.initialize(checkpoint.parameters, plates);
+    resumed.restore(checkpoint.state, checkpoint.initialEnergy, checkpoint.quietSteps);
+    resumed.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        while (resumed.currentStep() < 100) {
+            resumed.step<Integrator>();
+        }
+    });
+    SIMTOOL_CHECK(TestModels::identical(resumed.state(), uninterrupted));
+
+    // A torn newest slot fails its checksum; the previous checkpoint is used
+    SIMTOOL_CHECK(tearValue(CheckpointPath, markerValue(second)));
+    SIMTOOL_CHECK_MESSAGE(Checkpoint::read(CheckpointPath, checkpoint, error), error.toStdString());
+    SIMTOOL_CHECK(TestModels::identical(checkpoint.state, first));
+
+    // With both slots torn there is nothing to resume from
+    SIMTOOL_CHECK(tearValue(CheckpointPath, markerValue(first)));
+    SIMTOOL_CHECK(!Checkpoint::read(CheckpointPath, checkpoint, error));
+    SIMTOOL_CHECK(!error.isEmpty());
+
+    std::remove(CheckpointPath);
+}
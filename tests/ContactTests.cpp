@@ -0,0 +1,72 @@
+// Overlapping plates must push every node apart with forces that cancel
+// (node forces against their barycentric reactions), and separating them
+// must clear the contact set and every force written before.
+#include "ContactDetector.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const double PenaltyStiffness = 1e4;
+const double Thickness = 0.05;
+const double Gap = 0.02;                // Closer than the contact thickness
+
+// Largest |component| of the summed force over all nodes
+double netForce(const std::vector<double>& forces)
+{
+    double sum[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < forces.size(); ++i) {
+        sum[i % 3] += forces[i];
+    }
+    return std::max(std::fabs(sum[0]), std::max(std::fabs(sum[1]), std::fabs(sum[2])));
+}
+
+} // namespace
+
+SIMTOOL_TEST(contact_forces)
+{
+    const int n = 8;
+    const StructuralModel plates = TestModels::makeTwoPlates(n, Gap);
+    const int numNodes = plates.numNodes();
+    ContactDetector contact;
+    SIMTOOL_CHECK(contact.setup(plates, PenaltyStiffness, Thickness, nullptr, 16));
+    SIMTOOL_CHECK(contact.bodyCount() == 2);
+
+    // Small in-plane offsets, so the closest points fall inside triangles with uneven weights
+    std::vector<double> displacements(plates.numDOF(), 0.0);
+    for (int node = 0; node < numNodes; ++node) {
+        displacements[3 * node] = 0.01 * std::sin(1.3 * node);
+        displacements[3 * node + 1] = 0.01 * std::cos(0.7 * node);
+    }
+    std::vector<double> forces(plates.numDOF(), 0.0);
+    contact.computeForces(displacements.data(), forces.data());
+
+    // Every node overlaps the other plate: it is pushed away from it along z
+    SIMTOOL_CHECK(contact.statistics().contacts == numNodes);
+    SIMTOOL_CHECK(static_cast<int>(contact.activeNodes().size()) == numNodes);
+    SIMTOOL_CHECK(std::fabs(contact.statistics().maxPenetration - (Thickness - Gap)) <= 1e-12);
+    for (int node = 0; node < numNodes; ++node) {
+        const double outward = (plates.nodeBodies[node] == 0 ? -1.0 : 1.0) * forces[3 * node + 2];
+        SIMTOOL_CHECK_MESSAGE(outward > 0.0, "node " << node << ", force " << forces[3 * node + 2]);
+    }
+
+    // Action and reaction: the forces of the whole model sum to zero
+    const double scale = PenaltyStiffness * (Thickness - Gap) * numNodes;
+    SIMTOOL_CHECK_MESSAGE(netForce(forces) <= 1e-12 * scale, "net force " << netForce(forces));
+
+    // Lift the upper plate clear: no contact, and the earlier forces are zeroed
+    for (int node = 0; node < numNodes; ++node) {
+        if (plates.nodeBodies[node] == 1) {
+            displacements[3 * node + 2] = Thickness;
+        }
+    }
+    contact.computeForces(displacements.data(), forces.data());
+    SIMTOOL_CHECK(contact.activeNodes().empty() && contact.statistics().contacts == 0);
+    for (double force : forces) {
+        SIMTOOL_CHECK(force == 0.0);
+    }
+    SIMTOOL_CHECK(contact.statistics().peakContacts == numNodes && contact.statistics().evaluations == 2);
+}
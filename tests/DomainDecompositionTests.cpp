@@ -0,0 +1,95 @@
+// A run split into subdomains on worker processes must follow the
+// undivided run: the owned rows are the full operator's rows, summed in
+// the local node order, so the two agree to rounding.
+#include "DomainExchange.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <QCoreApplication>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const int Steps = 150;
+const int BatchSteps = 37;                  // Batches end mid-run and out of step with anything else
+
+// Same bound as for node renumbering (see OrderingTests.cpp)
+const double DecompositionTolerance = 1e-9;
+
+std::string describe(const SimulationParameters& params)
+{
+    return "integrator " + std::to_string(static_cast<int>(params.integrator))
+         + ", " + std::to_string(params.subdomains) + " parts"
+         + ", ordering " + std::to_string(static_cast<int>(params.dofOrdering));
+}
+
+} // namespace
+
+SIMTOOL_TEST(decomposition_matches_undivided)
+{
+    const StructuralModel plates = TestModels::shuffled(TestModels::makeTwoPlates(20, 0.02), 2024);
+    // The workers are this executable again (see main_tests.cpp)
+    const QString program = QCoreApplication::applicationFilePath();
+
+    const IntegratorType integrators[] = { IntegratorType::SymplecticEuler, IntegratorType::VelocityVerlet,
+                                           IntegratorType::RungeKutta4, IntegratorType::Newmark };
+    for (IntegratorType integrator : integrators) {
+        for (int parts : { 3, 5 }) {   // More parts than bodies, so edges are cut
+            for (DofOrdering ordering : { DofOrdering::Natural, DofOrdering::Hilbert }) {
+                SimulationParameters params;
+                params.integrator = integrator;
+                params.timeStep = 1e-3;
+                params.numThreads = 1;
+                params.subdomains = parts;
+                params.dofOrdering = ordering;
+
+                // Undivided reference from a displaced start, so every DOF moves
+                SimulationSolver undivided;
+                undivided.initialize(params, plates);
+                SimulationState initial = undivided.state();
+                for (size_t i = 0; i < initial.positions.size(); ++i) {
+                    initial.positions[i] += 0.01 * std::sin(0.37 * i);
+                }
+                undivided.restore(initial, undivided.initialEnergy(), 0);
+                const SimulationState start = undivided.state();
+                undivided.dispatch([&](auto policy) {
+                    typedef decltype(policy) Integrator;
+                    for (int i = 0; i < Steps; ++i) {
+                        undivided.step<Integrator>();
+                    }
+                });
+
+                DomainCoordinator coordinator;
+                coordinator.start(params, plates, start, program);
+                SIMTOOL_CHECK(coordinator.parts() == parts);
+                SIMTOOL_CHECK(coordinator.haloValuesPerStep() > 0);
+                for (int done = 0; done < Steps; done += BatchSteps) {
+                    coordinator.runBatch(std::min(BatchSteps, Steps - done));
+                }
+                SimulationState decomposed = start;
+                coordinator.readState(decomposed);
+                coordinator.stop();
+
+                const double difference = TestModels::relativeDifference(decomposed, undivided.state());
+                SIMTOOL_CHECK_MESSAGE(difference <= DecompositionTolerance,
+                                      describe(params) << ", difference " << difference);
+            }
+        }
+    }
+
+    // Schemes the subdomains cannot run are refused before any worker starts
+    SimulationParameters adaptive;
+    adaptive.integrator = IntegratorType::DormandPrince54;
+    adaptive.subdomains = 2;
+    DomainCoordinator coordinator;
+    bool refused = false;
+    try {
+        coordinator.start(adaptive, plates, SimulationState(), program);
+    }
+    catch (const std::runtime_error&) {
+        refused = true;
+    }
+    SIMTOOL_CHECK(refused && !coordinator.isRunning());
+}
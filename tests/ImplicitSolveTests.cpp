@@ -0,0 +1,179 @@
+// The linear implicit steps must follow the same schemes solved directly,
+// with either preconditioner, and a linear solve that cannot converge must
+// stop the run instead of taking an inaccurate step.
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const int Steps = 25;
+const double SolveTolerance = 1e-13;
+
+// Dense copy of the system (M + dampingScale c + stiffnessScale K), row-major
+std::vector<double> systemMatrix(const StructuralModel& model, double damping, double dampingScale,
+                                 double stiffnessScale)
+{
+    const int n = model.numDOF();
+    std::vector<double> a(static_cast<size_t>(n) * n);
+    std::vector<double> unit(n, 0.0);
+    std::vector<double> column(n);
+    for (int j = 0; j < n; ++j) {
+        unit[j] = 1.0;
+        model.stiffness.multiply(unit.data(), column.data());
+        unit[j] = 0.0;
+        for (int i = 0; i < n; ++i) {
+            a[static_cast<size_t>(i) * n + j] = stiffnessScale * column[i];
+        }
+        a[static_cast<size_t>(j) * n + j] += model.masses[j] + dampingScale * damping;
+    }
+    return a;
+}
+
+// Gaussian elimination with partial pivoting; a is overwritten
+std::vector<double> directSolve(std::vector<double> a, std::vector<double> b)
+{
+    const int n = static_cast<int>(b.size());
+    for (int k = 0; k < n; ++k) {
+        int pivot = k;
+        for (int i = k + 1; i < n; ++i) {
+            if (std::fabs(a[static_cast<size_t>(i) * n + k]) > std::fabs(a[static_cast<size_t>(pivot) * n + k])) {
+                pivot = i;
+            }
+        }
+        for (int j = 0; j < n; ++j) {
+            std::swap(a[static_cast<size_t>(k) * n + j], a[static_cast<size_t>(pivot) * n + j]);
+        }
+        std::swap(b[k], b[pivot]);
+        for (int i = k + 1; i < n; ++i) {
+            const double factor = a[static_cast<size_t>(i) * n + k] / a[static_cast<size_t>(k) * n + k];
+            for (int j = k; j < n; ++j) {
+                a[static_cast<size_t>(i) * n + j] -= factor * a[static_cast<size_t>(k) * n + j];
+            }
+            b[i] -= factor * b[k];
+        }
+    }
+    std::vector<double> x(n);
+    for (int i = n - 1; i >= 0; --i) {
+        double sum = b[i];
+        for (int j = i + 1; j < n; ++j) {
+            sum -= a[static_cast<size_t>(i) * n + j] * x[j];
+        }
+        x[i] = sum / a[static_cast<size_t>(i) * n + i];
+    }
+    return x;
+}
+
+// One step of the scheme from state, with every system solved directly
+void directStep(IntegratorType integrator, const StructuralModel& model, const SimulationParameters& params,
+                SimulationState& state)
+{
+    const int n = model.numDOF();
+    const double h = params.timeStep;
+    const double c = params.damping;
+    AlignedVector& x = state.positions;
+    AlignedVector& v = state.velocities;
+    AlignedVector& a = state.accelerations;
+    std::vector<double> kx(n);
+    std::vector<double> b(n);
+
+    if (integrator == IntegratorType::BackwardEuler) {
+        // (M + h c + h^2 K) v_next = M v - h K x, then x += h v_next
+        model.stiffness.multiply(x.data(), kx.data());
+        for (int i = 0; i < n; ++i) {
+            b[i] = model.masses[i] * v[i] - h * kx[i];
+        }
+        const std::vector<double> next = directSolve(systemMatrix(model, c, h, h * h), b);
+        for (int i = 0; i < n; ++i) {
+            a[i] = (next[i] - v[i]) / h;
+            v[i] = next[i];
+            x[i] += h * v[i];
+        }
+        return;
+    }
+
+    // Newmark (beta 1/4, gamma 1/2): (M + gamma h c + beta h^2 K) a_next = -K x_pred - c v_pred
+    const double beta = 0.25;
+    const double gamma = 0.5;
+    std::vector<double> xPredicted(n);
+    std::vector<double> vPredicted(n);
+    for (int i = 0; i < n; ++i) {
+        xPredicted[i] = x[i] + h * v[i] + (0.5 - beta) * h * h * a[i];
+        vPredicted[i] = v[i] + (1.0 - gamma) * h * a[i];
+    }
+    model.stiffness.multiply(xPredicted.data(), kx.data());
+    for (int i = 0; i < n; ++i) {
+        b[i] = -kx[i] - c * vPredicted[i];
+    }
+    const std::vector<double> next = directSolve(systemMatrix(model, c, gamma * h, beta * h * h), b);
+    for (int i = 0; i < n; ++i) {
+        a[i] = next[i];
+        x[i] = xPredicted[i] + beta * h * h * a[i];
+        v[i] = vPredicted[i] + gamma * h * a[i];
+    }
+}
+
+std::string describe(const SimulationParameters& params)
+{
+    return "integrator " + std::to_string(static_cast<int>(params.integrator))
+         + (params.preconditioner == ConjugateGradient::Preconditioner::Jacobi ? ", Jacobi" : ", IC(0)");
+}
+
+} // namespace
+
+SIMTOOL_TEST(implicit_matches_direct_solve)
+{
+    const StructuralModel chain = StructuralModel::makeChain(16);
+
+    for (IntegratorType integrator : { IntegratorType::BackwardEuler, IntegratorType::ImplicitNewmark }) {
+        for (ConjugateGradient::Preconditioner preconditioner : { ConjugateGradient::Preconditioner::Jacobi,
+                                                                  ConjugateGradient::Preconditioner::IncompleteCholesky }) {
+            SimulationParameters params;
+            params.integrator = integrator;
+            params.preconditioner = preconditioner;
+            params.timeStep = 0.05;         // Large enough that h^2 K dominates M
+            params.damping = 0.3;
+            params.numThreads = 1;
+            params.tolerance = SolveTolerance;
+
+            SimulationSolver solver;
+            solver.initialize(params, chain);
+            SimulationState reference = solver.state();
+            solver.dispatch([&](auto policy) {
+                typedef decltype(policy) Integrator;
+                for (int i = 0; i < Steps; ++i) {
+                    solver.step<Integrator>();
+                    directStep(integrator, solver.model(), params, reference);
+                }
+            });
+            const double difference = TestModels::relativeDifference(solver.state(), reference);
+            SIMTOOL_CHECK_MESSAGE(difference <= 1e-9, describe(params) << ", difference " << difference);
+
+            // Two Jacobi-preconditioned CG iterations cannot reach the tolerance: step() must throw
+            // (IC(0) of the tridiagonal chain system is its exact Cholesky factor, so it cannot be starved)
+            if (preconditioner == ConjugateGradient::Preconditioner::Jacobi) {
+                SimulationParameters starved = params;
+                starved.maxIterations = 2;
+                SimulationSolver starvedSolver;
+                starvedSolver.initialize(starved, chain);
+                std::string error;
+                try {
+                    starvedSolver.dispatch([&](auto policy) {
+                        typedef decltype(policy) Integrator;
+                        starvedSolver.step<Integrator>();
+                    });
+                }
+                catch (const std::runtime_error& e) {
+                    error = e.what();
+                }
+                SIMTOOL_CHECK_MESSAGE(error.find("Linear solver") != std::string::npos,
+                                      describe(params) << ", error '" << error << "'");
+                SIMTOOL_CHECK(starvedSolver.currentStep() == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+// Every instruction set the CPU supports must follow the scalar kernels.
+// The vector kernels sum the rows in a different order (four partial sums,
+// then a horizontal sum), so the runs agree to rounding, not bitwise.
+#include "MonteCarloEnsemble.h"
+#include "SolverKernels.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int Steps = 200;
+
+// Per precision: rounding differences grow with the steps, but stay far below the state
+const double DoubleTolerance = 1e-12;
+const double SingleTolerance = 1e-4;
+
+struct Case
+{
+    std::string label;
+    SimulationParameters params;
+    const StructuralModel* model;
+    double tolerance;
+};
+
+double relative(double a, double b)
+{
+    return std::fabs(a - b) / std::max(std::fabs(b), 1e-300);
+}
+
+} // namespace
+
+SIMTOOL_TEST(kernels_match_scalar)
+{
+    const SolverKernels::Isa original = SolverKernels::kernels().isa;
+    const StructuralModel chain = StructuralModel::makeChain(1001);     // Not a multiple of any vector width
+    const StructuralModel plates = TestModels::makeTwoPlates(12, 0.5);  // 3x3 blocks, rows of uneven length
+
+    // Fused symplectic Euler step, computeForces (Runge-Kutta), and the reduced precision variants
+    std::vector<Case> cases;
+    for (const StructuralModel* model : { &chain, &plates }) {
+        const std::string name = (model == &chain) ? "chain" : "plates";
+        for (IntegratorType integrator : { IntegratorType::SymplecticEuler, IntegratorType::RungeKutta4 }) {
+            Case c = { name + ", integrator " + std::to_string(static_cast<int>(integrator)),
+                       SimulationParameters(), model, DoubleTolerance };
+            c.params.integrator = integrator;
+            c.params.timeStep = 1e-3;
+            c.params.numThreads = 1;
+            cases.push_back(c);
+        }
+        for (ScalarPrecision precision : { ScalarPrecision::Single, ScalarPrecision::Mixed }) {
+            Case c = { name + ", " + precisionName(precision), SimulationParameters(), model, SingleTolerance };
+            c.params.integrator = IntegratorType::SymplecticEuler;
+            c.params.precision = precision;
+            c.params.precisionCheckSteps = 0;
+            c.params.timeStep = 1e-3;
+            c.params.numThreads = 1;
+            cases.push_back(c);
+        }
+    }
+
+    // Ensemble kernel: all lanes of a batch at once
+    MonteCarloEnsemble::Options ensembleOptions;
+    ensembleOptions.base.timeStep = 1e-3;
+    ensembleOptions.base.totalTime = Steps * 1e-3;
+    ensembleOptions.members = SolverKernels::EnsembleLanes;
+    ensembleOptions.maxConcurrent = 1;
+    ensembleOptions.stiffness = MonteCarloEnsemble::Distribution::uniform(500.0, 1500.0);
+
+    SolverKernels::forceIsa(SolverKernels::Isa::Scalar);
+    SIMTOOL_CHECK(SolverKernels::kernels().isa == SolverKernels::Isa::Scalar);
+    std::vector<SimulationState> references;
+    for (const Case& c : cases) {
+        references.push_back(TestModels::run(c.params, *c.model, Steps));
+    }
+    MonteCarloEnsemble scalarEnsemble(ensembleOptions);
+    SIMTOOL_CHECK(scalarEnsemble.run(chain));
+
+    for (SolverKernels::Isa isa : { SolverKernels::Isa::AVX2, SolverKernels::Isa::AVX512 }) {
+        if (!SolverKernels::isSupported(isa)) {
+            continue;
+        }
+        SolverKernels::forceIsa(isa);
+        SIMTOOL_CHECK(SolverKernels::kernels().isa == isa);
+        const std::string name = SolverKernels::isaName(isa);
+
+        for (size_t k = 0; k < cases.size(); ++k) {
+            const Case& c = cases[k];
+            const SimulationState state = TestModels::run(c.params, *c.model, Steps);
+            const double difference = TestModels::relativeDifference(state, references[k]);
+            const double energy = relative(state.energy, references[k].energy);
+            SIMTOOL_CHECK_MESSAGE(difference <= c.tolerance && energy <= c.tolerance,
+                                  name << ", " << c.label << ": difference " << difference << ", energy " << energy);
+        }
+
+        MonteCarloEnsemble ensemble(ensembleOptions);
+        SIMTOOL_CHECK(ensemble.run(chain));
+        for (size_t m = 0; m < ensemble.members().size(); ++m) {
+            const MonteCarloEnsemble::Member& a = ensemble.members()[m];
+            const MonteCarloEnsemble::Member& b = scalarEnsemble.members()[m];
+            SIMTOOL_CHECK_MESSAGE(relative(a.peakDisplacement, b.peakDisplacement) <= DoubleTolerance
+                                  && relative(a.finalEnergy, b.finalEnergy) <= DoubleTolerance,
+                                  name << ", ensemble member " << m);
+        }
+    }
+
+    SolverKernels::forceIsa(original);
+}
@@ -0,0 +1,135 @@
+// The extracted modes must match the chain's closed-form spectrum, keep
+// every copy of a repeated eigenvalue, and the suggested explicit step must
+// sit just inside the stability limit of the highest mode.
+#include "ModalAnalysis.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const double Stiffness = 1000.0;
+
+// Largest |K phi - lambda M phi| / lambda and |Phi^T M Phi - I| over the modes
+void checkModes(const ModalAnalysis& modes, const StructuralModel& model, const char* label)
+{
+    const int n = model.numDOF();
+    std::vector<double> product(n);
+    double residual = 0.0;
+    double orthogonality = 0.0;
+    for (int k = 0; k < modes.modeCount(); ++k) {
+        const double* phi = modes.modeShape(k);
+        const double lambda = modes.eigenvalues()[k];
+        model.stiffness.multiply(phi, product.data());
+        double norm = 0.0;
+        for (int i = 0; i < n; ++i) {
+            const double r = product[i] - lambda * model.masses[i] * phi[i];
+            norm += r * r;
+        }
+        residual = std::max(residual, std::sqrt(norm) / lambda);
+        for (int l = 0; l <= k; ++l) {
+            const double* other = modes.modeShape(l);
+            double dot = 0.0;
+            for (int i = 0; i < n; ++i) {
+                dot += phi[i] * model.masses[i] * other[i];
+            }
+            orthogonality = std::max(orthogonality, std::fabs(dot - (k == l ? 1.0 : 0.0)));
+        }
+    }
+    SIMTOOL_CHECK_MESSAGE(residual <= 1e-7 && orthogonality <= 1e-10,
+                          label << ": residual " << residual << ", orthogonality " << orthogonality);
+}
+
+// Largest peak |x| of an undamped symplectic Euler run with a fixed step
+double peakDisplacement(const StructuralModel& chain, double timeStep, int steps)
+{
+    SimulationParameters params;
+    params.integrator = IntegratorType::SymplecticEuler;
+    params.stiffness = Stiffness;
+    params.damping = 0.0;
+    params.timeStep = timeStep;
+    params.numThreads = 1;
+    SimulationSolver solver;
+    solver.initialize(params, chain);
+    double peak = 0.0;
+    solver.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        for (int i = 0; i < steps; ++i) {
+            solver.step<Integrator>();
+        }
+    });
+    for (double x : solver.state().positions) {
+        peak = std::max(peak, std::fabs(x));
+    }
+    return peak;
+}
+
+} // namespace
+
+SIMTOOL_TEST(modal_spectrum)
+{
+    // Chain: K = k I + 0.1 k (path Laplacian), unit masses, so
+    // lambda_j = k + 0.2 k (1 - cos(pi j / n)), j = 0 .. n - 1
+    const int nodes = 200;
+    StructuralModel chain = StructuralModel::makeChain(nodes);
+    chain.assemble(Stiffness);
+    const double pi = std::acos(-1.0);
+    auto analytic = [&](int j) { return Stiffness + 0.2 * Stiffness * (1.0 - std::cos(pi * j / nodes)); };
+
+    ModalAnalysis::Options options;
+    options.modeCount = 12;
+    ModalAnalysis modes;
+    SIMTOOL_CHECK_MESSAGE(modes.compute(chain, options, nullptr, 64), modes.lastError());
+    SIMTOOL_CHECK(modes.modeCount() == options.modeCount && modes.isVerified());
+    double spectrumError = 0.0;
+    for (int j = 0; j < modes.modeCount(); ++j) {
+        spectrumError = std::max(spectrumError, std::fabs(modes.eigenvalues()[j] - analytic(j)) / analytic(j));
+    }
+    SIMTOOL_CHECK_MESSAGE(spectrumError <= 1e-15, "chain spectrum error " << spectrumError);
+    checkModes(modes, chain, "chain");
+
+    // Two identical plates without contact: every eigenvalue comes twice. Out of plane and
+    // along the in-plane rigid motions (2 translations, 1 rotation) no edge spring is
+    // stretched, so k alone is repeated 2 (n^2 + 3) times before the pairs above it
+    const int n = 4;
+    StructuralModel plates = TestModels::makeTwoPlates(n, 1.0);
+    plates.assemble(Stiffness);
+    const int groundOnly = 2 * (n * n + 3);
+    options.modeCount = groundOnly + 8;
+    ModalAnalysis repeated;
+    SIMTOOL_CHECK_MESSAGE(repeated.compute(plates, options, nullptr, 64), repeated.lastError());
+    SIMTOOL_CHECK_MESSAGE(repeated.modeCount() == options.modeCount && repeated.isVerified(),
+                          repeated.modeCount() << " modes: " << repeated.lastError());
+    const std::vector<double>& lambda = repeated.eigenvalues();
+    for (int j = 0; j < repeated.modeCount(); ++j) {
+        const bool ground = std::fabs(lambda[j] - Stiffness) <= 1e-10 * Stiffness;
+        SIMTOOL_CHECK_MESSAGE(ground == (j < groundOnly), "mode " << j << ": " << lambda[j]);
+    }
+    for (int j = groundOnly; j + 1 < repeated.modeCount(); j += 2) {
+        SIMTOOL_CHECK_MESSAGE(std::fabs(lambda[j + 1] - lambda[j]) <= 1e-10 * lambda[j],
+                              "modes " << j << ", " << j + 1 << ": " << lambda[j] << ", " << lambda[j + 1]);
+    }
+    checkModes(repeated, plates, "plates");
+
+    // Suggested step: at most the critical step of the exact highest eigenvalue, and close to it
+    SimulationParameters params;
+    params.integrator = IntegratorType::SymplecticEuler;
+    params.damping = 0.0;
+    const double critical = ModalAnalysis::criticalTimeStep(params.integrator, analytic(nodes - 1), 0.0);
+    SIMTOOL_CHECK(std::fabs(critical - 2.0 / std::sqrt(analytic(nodes - 1))) <= 1e-15 * critical);
+    const double suggested = ModalAnalysis::suggestTimeStep(chain, params, 1.0);
+    SIMTOOL_CHECK_MESSAGE(suggested <= critical && suggested >= 0.99 * critical,
+                          "suggested " << suggested << ", critical " << critical);
+    SIMTOOL_CHECK(ModalAnalysis::suggestTimeStep(chain, params) == 0.9 * suggested);
+
+    // The step is the stability limit: bounded just below it, exploding just above
+    const double start = peakDisplacement(chain, critical, 0);
+    SIMTOOL_CHECK(peakDisplacement(chain, 0.98 * critical, 2000) <= 10.0 * start);
+    SIMTOOL_CHECK(peakDisplacement(chain, 1.02 * critical, 200) >= 1e6 * start);
+
+    // Implicit schemes need no limit
+    params.integrator = IntegratorType::BackwardEuler;
+    SIMTOOL_CHECK(ModalAnalysis::suggestTimeStep(chain, params) == 0.0);
+}
@@ -0,0 +1,124 @@
+// A member with the base damping and stiffness must follow a SimulationSolver
+// run of them, whatever batch lane it lands in, and the options the ensemble
+// cannot run must be refused.
+#include "MonteCarloEnsemble.h"
+#include "SettlingTracker.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+bool refused(const MonteCarloEnsemble::Options& options, const StructuralModel& model)
+{
+    MonteCarloEnsemble ensemble(options);
+    try {
+        ensemble.run(model);
+    }
+    catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// Members scale a unit stiffness operator per lane, the solver assembles it
+// with the coefficient, so the two runs agree to rounding
+const double MemberTolerance = 1e-12;
+
+bool close(double a, double b)
+{
+    return std::fabs(a - b) <= MemberTolerance * std::fabs(b);
+}
+
+bool sameBits(double a, double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+} // namespace
+
+SIMTOOL_TEST(ensemble_matches_solver)
+{
+    const StructuralModel chain = StructuralModel::makeChain(10);
+    SimulationParameters params;
+    params.totalTime = 20.0;
+    params.damping = 2.0;               // Settles well before the end
+    params.numThreads = 1;
+
+    // Reference: the solver's run, tracked on the ensemble's time base (step * timeStep)
+    SimulationSolver solver;
+    solver.initialize(params, chain);
+    SettlingTracker tracker;
+    tracker.add(0.0, SettlingTracker::maxAbs(solver.state().positions.data(), chain.numDOF()));
+    solver.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        while (!solver.isEndReached<Integrator>()) {
+            solver.step<Integrator>();
+            tracker.add(solver.currentStep() * params.timeStep,
+                        SettlingTracker::maxAbs(solver.state().positions.data(), chain.numDOF()));
+        }
+    });
+    const SimulationState& final = solver.state();
+    const StructuralModel& assembled = solver.model();
+    std::vector<double> kx(chain.numDOF());
+    assembled.stiffness.multiply(final.positions.data(), kx.data());
+    double energy = 0.0;
+    for (int i = 0; i < chain.numDOF(); ++i) {
+        energy += assembled.masses[i] * final.velocities[i] * final.velocities[i] + final.positions[i] * kx[i];
+    }
+    energy *= 0.5;
+    SIMTOOL_CHECK(tracker.settlingTime() > 0.0 && tracker.settlingTime() < params.totalTime);
+
+    // Default options: no position noise; more members than one batch holds
+    MonteCarloEnsemble::Options options;
+    options.base = params;
+    options.members = SolverKernels::EnsembleLanes + 3;
+    options.damping = MonteCarloEnsemble::Distribution::fixed(params.damping);
+    options.stiffness = MonteCarloEnsemble::Distribution::fixed(params.stiffness);
+    MonteCarloEnsemble ensemble(options);
+    SIMTOOL_CHECK(ensemble.run(chain));
+    SIMTOOL_CHECK(static_cast<int>(ensemble.members().size()) == options.members);
+    for (size_t m = 0; m < ensemble.members().size(); ++m) {
+        const MonteCarloEnsemble::Member& member = ensemble.members()[m];
+        SIMTOOL_CHECK_MESSAGE(close(member.peakDisplacement, tracker.peak())
+                              && close(member.settlingTime, tracker.settlingTime())
+                              && close(member.finalEnergy, energy),
+                              "member " << m << ": peak " << member.peakDisplacement << " vs " << tracker.peak()
+                              << ", settling time " << member.settlingTime << " vs " << tracker.settlingTime()
+                              << ", energy " << member.finalEnergy << " vs " << energy);
+    }
+
+    // Sampled members and noise do not depend on the thread count
+    options.damping = MonteCarloEnsemble::Distribution::uniform(0.05, 0.5);
+    options.stiffness = MonteCarloEnsemble::Distribution::normal(params.stiffness, 100.0);
+    options.positionNoise = 1e-3;
+    options.maxConcurrent = 1;
+    MonteCarloEnsemble sequential(options);
+    SIMTOOL_CHECK(sequential.run(chain));
+    options.maxConcurrent = 3;
+    MonteCarloEnsemble concurrent(options);
+    SIMTOOL_CHECK(concurrent.run(chain));
+    for (size_t m = 0; m < sequential.members().size(); ++m) {
+        const MonteCarloEnsemble::Member& a = sequential.members()[m];
+        const MonteCarloEnsemble::Member& b = concurrent.members()[m];
+        SIMTOOL_CHECK_MESSAGE(sameBits(a.stiffness, b.stiffness) && sameBits(a.peakDisplacement, b.peakDisplacement)
+                              && sameBits(a.finalEnergy, b.finalEnergy), "member " << m);
+    }
+    SIMTOOL_CHECK(sequential.statistics(&MonteCarloEnsemble::Member::stiffness).stddev > 0.0);
+
+    // Options the members cannot run
+    MonteCarloEnsemble::Options implicit;
+    implicit.base.integrator = IntegratorType::BackwardEuler;
+    SIMTOOL_CHECK(refused(implicit, chain));
+    MonteCarloEnsemble::Options degenerate;
+    degenerate.damping = MonteCarloEnsemble::Distribution::normal(0.1, 0.0);
+    SIMTOOL_CHECK(refused(degenerate, chain));
+    MonteCarloEnsemble::Options reversed;
+    reversed.amplitude = MonteCarloEnsemble::Distribution::uniform(1.0, 0.5);
+    SIMTOOL_CHECK(refused(reversed, chain));
+    MonteCarloEnsemble::Options negative;
+    negative.positionNoise = -1.0;
+    SIMTOOL_CHECK(refused(negative, chain));
+}
@@ -0,0 +1,163 @@
+// Geometrically exact springs must see no force under a rigid motion, the
+// Newton iterations must converge as the statistics report and fail loudly
+// when they cannot, and modified Newton must reuse its Jacobian.
+#include "NewtonSolver.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const double Stiffness = 1000.0;
+
+// One unit spring along x between two free nodes
+StructuralModel makeSpring()
+{
+    StructuralModel model;
+    model.numBodies = 1;
+    model.nodeCoordinates = { 0.0, 0.0, 0.0, 1.0, 0.0, 0.0 };
+    model.nodeBodies = { 0, 0 };
+    model.edges = { 0, 1 };
+    model.assemble(Stiffness);
+    return model;
+}
+
+// Plates bent far beyond the small-displacement range (amplitude half the edge length)
+SimulationSolver& bend(SimulationSolver& solver, const SimulationParameters& params, const StructuralModel& model)
+{
+    solver.initialize(params, model);
+    SimulationState state = solver.state();
+    for (size_t i = 0; i < state.positions.size(); ++i) {
+        state.positions[i] = 0.05 * std::sin(0.37 * i);
+    }
+    solver.restore(state, solver.initialEnergy(), 0);
+    return solver;
+}
+
+} // namespace
+
+SIMTOOL_TEST(newton_iterations)
+{
+    // Rigid rotation by 60 degrees about z plus a translation: the spring keeps its length
+    const StructuralModel spring = makeSpring();
+    const double angle = std::acos(-1.0) / 3.0;
+    const double translation[3] = { 0.2, -0.1, 0.3 };
+    std::vector<double> rigid(6);
+    for (int c = 0; c < 3; ++c) {
+        rigid[c] = translation[c];
+    }
+    rigid[3] = std::cos(angle) - 1.0 + translation[0];
+    rigid[4] = std::sin(angle) + translation[1];
+    rigid[5] = translation[2];
+
+    NewtonSolver newton;
+    NewtonSolver::Options options;
+    newton.setup(spring, Stiffness, 0.0, 0.0, 1.0, options, rigid.data(), nullptr, nullptr, nullptr, 64);
+
+    // Only the linear grounding springs push back; the assembled linear K would see a strain
+    std::vector<double> forces(6);
+    std::vector<double> linear(6);
+    newton.computeForces(rigid.data(), nullptr, forces.data());
+    spring.stiffness.multiply(rigid.data(), linear.data());
+    double linearError = 0.0;
+    for (int i = 0; i < 6; ++i) {
+        const double grounding = -StructuralModel::groundingStiffness(Stiffness) * rigid[i];
+        SIMTOOL_CHECK_MESSAGE(std::fabs(forces[i] - grounding) <= 1e-12 * Stiffness, "DOF " << i);
+        linearError = std::max(linearError, std::fabs(-linear[i] - grounding));
+    }
+    SIMTOOL_CHECK(linearError > 0.1 * StructuralModel::couplingStiffness(Stiffness));
+
+    // Step equation M y - b - f(0 + y) = 0 solved by the rigid motion: zero residual there...
+    std::vector<double> b(6);
+    for (int i = 0; i < 6; ++i) {
+        b[i] = spring.masses[i] * rigid[i] - forces[i];
+    }
+    const std::vector<double> origin(6, 0.0);
+    NewtonSolver::StepEquation equation = { b.data(), origin.data(), nullptr, 1.0, 1.0, 0.0 };
+    std::vector<double> y = rigid;
+    NewtonSolver::Result result = newton.solve(equation, y.data());
+    SIMTOOL_CHECK_MESSAGE(result.converged && result.iterations == 0, "residual " << result.residual);
+
+    // ...and the exact tangent takes a nearby start there in one iteration
+    for (int i = 0; i < 6; ++i) {
+        y[i] = rigid[i] + 1e-6 * std::cos(1.0 + i);
+    }
+    result = newton.solve(equation, y.data());
+    SIMTOOL_CHECK_MESSAGE(result.converged && result.iterations == 1,
+                          result.iterations << " iterations, residual " << result.residual);
+    for (int i = 0; i < 6; ++i) {
+        SIMTOOL_CHECK(std::fabs(y[i] - rigid[i]) <= 1e-9);
+    }
+
+    const StructuralModel plates = TestModels::makeTwoPlates(6, 1.0);
+    SimulationParameters params;
+    params.numThreads = 1;
+
+    // One correction cannot reach a tight tolerance on a bent mesh: step() must throw
+    SimulationParameters starved = params;
+    starved.integrator = IntegratorType::BackwardEuler;
+    starved.nonlinearMethod = NonlinearMethod::Newton;
+    starved.maxIterations = 1;
+    starved.tolerance = 1e-14;
+    SimulationSolver starvedSolver;
+    bend(starvedSolver, starved, plates);
+    std::string error;
+    try {
+        starvedSolver.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            starvedSolver.step<Integrator>();
+        });
+    }
+    catch (const std::runtime_error& e) {
+        error = e.what();
+    }
+    SIMTOOL_CHECK_MESSAGE(error.find("Newton") != std::string::npos, "error '" << error << "'");
+    SIMTOOL_CHECK(starvedSolver.newton().statistics().failedSteps == 1);
+
+    // Large deformation: every step converges in the iterations the statistics show
+    for (IntegratorType integrator : { IntegratorType::BackwardEuler, IntegratorType::ImplicitNewmark }) {
+        SimulationParameters full = params;
+        full.integrator = integrator;
+        full.nonlinearMethod = NonlinearMethod::Newton;
+        full.maxIterations = 30;
+        SimulationSolver solver;
+        bend(solver, full, plates);
+        int most = 0;
+        solver.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            for (int i = 0; i < 20; ++i) {
+                solver.step<Integrator>();
+                const NewtonSolver::Result& last = solver.newton().lastResult();
+                SIMTOOL_CHECK(last.converged && last.iterations == solver.state().iterations);
+                SIMTOOL_CHECK(last.iterations >= 1 && last.iterations <= full.maxIterations);
+                most = std::max(most, last.iterations);
+            }
+        });
+        const NewtonSolver::Statistics& stats = solver.newton().statistics();
+        SIMTOOL_CHECK(stats.steps == 20 && stats.failedSteps == 0);
+        SIMTOOL_CHECK(stats.maxStepIterations == most && most > 1);     // Nonlinear, unlike a linear step
+        SIMTOOL_CHECK(stats.iterations == solver.state().totalIterations);
+        SIMTOOL_CHECK(stats.tangentUpdates >= stats.iterations);        // Full Newton re-forms every iteration
+
+        // Modified Newton reuses its Jacobian across iterations and steps
+        SimulationParameters modified = full;
+        modified.nonlinearMethod = NonlinearMethod::ModifiedNewton;
+        SimulationSolver reusing;
+        bend(reusing, modified, plates);
+        reusing.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            for (int i = 0; i < 20; ++i) {
+                reusing.step<Integrator>();
+            }
+        });
+        const NewtonSolver::Statistics& reused = reusing.newton().statistics();
+        SIMTOOL_CHECK(reused.steps == 20 && reused.failedSteps == 0);
+        SIMTOOL_CHECK_MESSAGE(reused.tangentUpdates < reused.iterations,
+                              reused.tangentUpdates << " tangents for " << reused.iterations << " iterations");
+        SIMTOOL_CHECK(TestModels::relativeDifference(reusing.state(), solver.state()) <= 1e-4);
+    }
+}
@@ -0,0 +1,128 @@
+// Node renumbering only changes the memory layout: every ordering must
+// give the same run in the original numbering, and a state read with
+// state() must continue exactly after restore(), in any ordering.
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <string>
+
+namespace {
+
+const int Steps = 40;
+const DofOrdering Orderings[] = { DofOrdering::Natural, DofOrdering::ReverseCuthillMcKee,
+                                  DofOrdering::Morton, DofOrdering::Hilbert };
+
+// Renumbered rows sum their neighbours in another order, so results agree to rounding only
+const double OrderingTolerance = 1e-9;
+
+std::string describe(const SimulationParameters& params)
+{
+    return "integrator " + std::to_string(static_cast<int>(params.integrator))
+         + ", precision " + std::to_string(static_cast<int>(params.precision))
+         + ", ordering " + std::to_string(static_cast<int>(params.dofOrdering));
+}
+
+// Steps first, then a fresh solver with the same parameters restored from
+// state() runs second steps more
+SimulationState runRestored(const SimulationParameters& params, const StructuralModel& model,
+                            int first, int second, DofOrdering restoreOrdering)
+{
+    SimulationSolver solver;
+    solver.initialize(params, model);
+    solver.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        for (int i = 0; i < first; ++i) {
+            solver.step<Integrator>();
+        }
+    });
+
+    SimulationParameters resumed = params;
+    resumed.dofOrdering = restoreOrdering;
+    SimulationSolver next;
+    next.initialize(resumed, model);
+    next.restore(solver.state(), solver.initialEnergy(), solver.quietSteps());
+    next.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        for (int i = 0; i < second; ++i) {
+            next.step<Integrator>();
+        }
+    });
+    return next.state();
+}
+
+} // namespace
+
+SIMTOOL_TEST(ordering_invariance)
+{
+    const StructuralModel plates = TestModels::shuffled(TestModels::makeTwoPlates(24, 0.02), 2024);
+    // The flat plates' out-of-plane eigenvalue is repeated once per node, so a
+    // truncated modal basis of them is not unique; the chain's eigenvalues are distinct
+    const StructuralModel chain = TestModels::shuffled(StructuralModel::makeChain(2000), 2024);
+
+    struct Case
+    {
+        IntegratorType integrator;
+        ScalarPrecision precision;
+    };
+    const Case cases[] = {
+        { IntegratorType::SymplecticEuler, ScalarPrecision::Double },
+        { IntegratorType::VelocityVerlet, ScalarPrecision::Double },
+        { IntegratorType::VelocityVerlet, ScalarPrecision::Single },
+        { IntegratorType::RungeKutta4, ScalarPrecision::Mixed },
+        { IntegratorType::Newmark, ScalarPrecision::Double },
+        { IntegratorType::DormandPrince54, ScalarPrecision::Double },
+        { IntegratorType::BackwardEuler, ScalarPrecision::Double },
+        { IntegratorType::ImplicitNewmark, ScalarPrecision::Double },
+        { IntegratorType::ModalSuperposition, ScalarPrecision::Double },
+    };
+
+    for (const Case& test : cases) {
+        SimulationParameters params;
+        params.integrator = test.integrator;
+        params.precision = test.precision;
+        params.precisionCheckSteps = 0;
+        params.timeStep = 1e-3;
+        params.numThreads = 1;
+        params.modeCount = 12;
+        // Contact is explicit everywhere but in modal runs, which do not support it
+        const bool modal = test.integrator == IntegratorType::ModalSuperposition;
+        params.contactStiffness = modal ? 0.0 : 1e4;
+        const StructuralModel& model = modal ? chain : plates;
+
+        const SimulationState natural = TestModels::run(params, model, Steps);
+        // The adaptive step size control amplifies rounding up to its local error tolerance;
+        // reduced precision rounds each step to float
+        double tolerance = OrderingTolerance;
+        if (test.integrator == IntegratorType::DormandPrince54) {
+            tolerance = params.tolerance;
+        } else if (test.precision != ScalarPrecision::Double) {
+            tolerance = 1e-4;
+        }
+        for (DofOrdering ordering : Orderings) {
+            params.dofOrdering = ordering;
+            const SimulationState reference = TestModels::run(params, model, Steps);
+            const double difference = TestModels::relativeDifference(reference, natural);
+            SIMTOOL_CHECK_MESSAGE(reference.currentStep == natural.currentStep && difference <= tolerance,
+                                  describe(params) << ", difference " << difference);
+
+            // Round trip through state() / restore() in the same ordering is exact, except
+            // that modal runs project the restored state onto the modes again
+            const SimulationState restored = runRestored(params, model, Steps / 2, Steps - Steps / 2, ordering);
+            if (modal) {
+                const double restoredDifference = TestModels::relativeDifference(restored, reference);
+                SIMTOOL_CHECK_MESSAGE(restored.currentStep == reference.currentStep
+                                      && restoredDifference <= OrderingTolerance,
+                                      describe(params) << ", restored, difference " << restoredDifference);
+            } else {
+                SIMTOOL_CHECK_MESSAGE(TestModels::identical(restored, reference), describe(params) << ", restored");
+            }
+
+            // ...and a state saved in one ordering continues in another
+            const SimulationState crossed = runRestored(params, model, Steps / 2, Steps - Steps / 2,
+                                                        DofOrdering::Natural);
+            const double crossedDifference = TestModels::relativeDifference(crossed, natural);
+            SIMTOOL_CHECK_MESSAGE(crossed.currentStep == natural.currentStep && crossedDifference <= tolerance,
+                                  describe(params) << ", restored in natural order, difference "
+                                  << crossedDifference);
+        }
+    }
+}
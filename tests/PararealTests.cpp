@@ -0,0 +1,92 @@
+// After k Parareal iterations the first k slice boundaries are fine
+// propagations of exact states, so they must be bit-identical to the
+// sequential run, and after as many iterations as slices the whole run is.
+#include "Parareal.h"
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace {
+
+const int Slices = 6;
+
+// Sequential run from start to the end of the run, keeping the state after every step
+std::map<int, SimulationState> sequentialRun(const SimulationParameters& params, const StructuralModel& model,
+                                             const SimulationState& start)
+{
+    SimulationSolver solver;
+    solver.initialize(params, model);
+    solver.restore(start, solver.initialEnergy(), 0);
+    std::map<int, SimulationState> states;
+    states[start.currentStep] = solver.state();
+    solver.dispatch([&](auto policy) {
+        typedef decltype(policy) Integrator;
+        while (!solver.isEndReached<Integrator>()) {
+            solver.step<Integrator>();
+            states[solver.currentStep()] = solver.state();
+        }
+    });
+    return states;
+}
+
+void checkExactSlices(const Parareal& parareal, const std::map<int, SimulationState>& sequential, int exactSlices,
+                      const std::string& label)
+{
+    for (int n = 0; n <= exactSlices; ++n) {
+        const SimulationState& boundary = parareal.boundaries()[n];
+        const auto reference = sequential.find(boundary.currentStep);
+        SIMTOOL_CHECK_MESSAGE(reference != sequential.end() && TestModels::identical(boundary, reference->second),
+                              label << ", boundary " << n << " of " << exactSlices << " exact slices");
+    }
+}
+
+} // namespace
+
+SIMTOOL_TEST(parareal_matches_sequential)
+{
+    const StructuralModel plates = TestModels::shuffled(TestModels::makeTwoPlates(10, 0.02), 2024);
+    const IntegratorType integrators[] = {
+        IntegratorType::SymplecticEuler, IntegratorType::VelocityVerlet, IntegratorType::RungeKutta4,
+        IntegratorType::Newmark, IntegratorType::BackwardEuler, IntegratorType::ImplicitNewmark
+    };
+    for (IntegratorType integrator : integrators) {
+        SimulationParameters params;
+        params.integrator = integrator;
+        params.timeStep = 1e-3;
+        params.totalTime = 0.25;
+        params.numThreads = 3;
+        params.timeSlices = Slices;
+        params.coarseStepRatio = 8;
+        params.pararealTolerance = 0.0;     // Iterate up to the slice count
+        const std::string label = "integrator " + std::to_string(static_cast<int>(integrator));
+
+        // Displaced start, so every DOF moves
+        SimulationSolver initializer;
+        initializer.initialize(params, plates);
+        SimulationState initial = initializer.state();
+        for (size_t i = 0; i < initial.positions.size(); ++i) {
+            initial.positions[i] += 0.01 * std::sin(0.37 * i);
+        }
+        initializer.restore(initial, initializer.initialEnergy(), 0);
+        const std::map<int, SimulationState> sequential = sequentialRun(params, plates, initializer.state());
+
+        // From the start and from a restart partway through the run
+        for (int firstStep : { 0, 40 }) {
+            const std::string context = label + ", from step " + std::to_string(firstStep);
+            Parareal parareal;
+            parareal.setup(params, plates, sequential.at(firstStep));
+            SIMTOOL_CHECK(parareal.sliceCount() == Slices);
+            int lastIteration = 0;
+            SIMTOOL_CHECK(parareal.run([&](const Parareal::Iteration& iteration) {
+                checkExactSlices(parareal, sequential, iteration.exactSlices, context);
+                lastIteration = iteration.iteration;
+            }));
+            SIMTOOL_CHECK_MESSAGE(parareal.isConverged() && parareal.iterations() == Slices && lastIteration == Slices,
+                                  context << ", " << parareal.iterations() << " iterations");
+            checkExactSlices(parareal, sequential, Slices, context);
+            SIMTOOL_CHECK(parareal.boundaries().back().currentStep == sequential.rbegin()->first);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef TESTMODELS_H
+#define TESTMODELS_H
+
+#include "SimulationSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Models and state comparisons shared by the test cases
+ */
+namespace TestModels
+{
+    /**
+     * @brief Two parallel n x n triangulated plates, gap apart along z
+     *
+     * Two bodies, so penalty contact is active when the gap is below the
+     * contact thickness (a quarter of the 0.1 edge length by default).
+     */
+    inline StructuralModel makeTwoPlates(int n, double gap)
+    {
+        StructuralModel model;
+        model.numBodies = 2;
+        auto node = [n](int body, int i, int j) { return (body * n + j) * n + i; };
+        for (int body = 0; body < 2; ++body) {
+            for (int j = 0; j < n; ++j) {
+                for (int i = 0; i < n; ++i) {
+                    model.nodeCoordinates.push_back(0.1 * i);
+                    model.nodeCoordinates.push_back(0.1 * j);
+                    model.nodeCoordinates.push_back(body * gap);
+                    model.nodeBodies.push_back(body);
+                }
+            }
+        }
+        std::vector<std::pair<int, int>> edges;
+        for (int body = 0; body < 2; ++body) {
+            for (int j = 0; j + 1 < n; ++j) {
+                for (int i = 0; i + 1 < n; ++i) {
+                    const int a = node(body, i, j);
+                    const int b = node(body, i + 1, j);
+                    const int c = node(body, i + 1, j + 1);
+                    const int d = node(body, i, j + 1);
+                    const int corners[6] = { a, b, c, a, c, d };
+                    model.triangles.insert(model.triangles.end(), corners, corners + 6);
+                    const std::pair<int, int> quad[5] = { { a, b }, { b, c }, { a, c }, { a, d }, { d, c } };
+                    edges.insert(edges.end(), quad, quad + 5);
+                }
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        for (const std::pair<int, int>& edge : edges) {
+            model.edges.push_back(edge.first);
+            model.edges.push_back(edge.second);
+        }
+        return model;
+    }
+
+    /**
+     * @brief Number the nodes in a fixed random order, the worst case for a mesher's numbering
+     */
+    inline StructuralModel shuffled(StructuralModel model, unsigned seed)
+    {
+        std::vector<int> order(model.numNodes());
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937 generator(seed);
+        std::shuffle(order.begin(), order.end(), generator);
+        model.renumberNodes(order);
+        return model;
+    }
+
+    /**
+     * @brief Run steps (or to the end of the run, if sooner) and return the state
+     */
+    inline SimulationState run(const SimulationParameters& params, const StructuralModel& model, int steps)
+    {
+        SimulationSolver solver;
+        solver.initialize(params, model);
+        solver.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            for (int i = 0; i < steps && !solver.isEndReached<Integrator>(); ++i) {
+                solver.step<Integrator>();
+            }
+        });
+        return solver.state();
+    }
+
+    inline bool sameBits(const AlignedVector& a, const AlignedVector& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+    }
+
+    /**
+     * @brief Largest difference of positions and velocities, relative to their largest magnitude
+     */
+    inline double relativeDifference(const SimulationState& a, const SimulationState& b)
+    {
+        double difference = 0.0;
+        double magnitude = 0.0;
+        for (size_t i = 0; i < a.positions.size() && i < b.positions.size(); ++i) {
+            difference = std::max(difference, std::fabs(a.positions[i] - b.positions[i]));
+            difference = std::max(difference, std::fabs(a.velocities[i] - b.velocities[i]));
+            magnitude = std::max(magnitude, std::max(std::fabs(b.positions[i]), std::fabs(b.velocities[i])));
+        }
+        return a.positions.size() == b.positions.size() ? difference / magnitude : HUGE_VAL;
+    }
+
+    /**
+     * @brief Whether two states are bit-identical (vectors, time, step and energy)
+     */
+    inline bool identical(const SimulationState& a, const SimulationState& b)
+    {
+        return a.currentStep == b.currentStep
+            && std::memcmp(&a.currentTime, &b.currentTime, sizeof(double)) == 0
+            && std::memcmp(&a.energy, &b.energy, sizeof(double)) == 0
+            && sameBits(a.positions, b.positions)
+            && sameBits(a.velocities, b.velocities)
+            && sameBits(a.accelerations, b.accelerations);
+    }
+}
+
+#endif // TESTMODELS_H
@@ -0,0 +1,74 @@
+#ifndef TESTSUITE_H
+#define TESTSUITE_H
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Minimal test registry for SimulationToolTests
+ *
+ * Each test file defines its cases with SIMTOOL_TEST(name); main_tests.cpp
+ * runs the cases named on the command line (all of them without
+ * arguments), one ctest entry per case. A failed SIMTOOL_CHECK throws, so
+ * a case stops at its first failure.
+ */
+namespace TestSuite
+{
+    typedef void (*TestFunction)();
+
+    struct TestCase
+    {
+        const char* name;
+        TestFunction function;
+    };
+
+    /**
+     * @brief Registered cases, in registration order
+     */
+    inline std::vector<TestCase>& cases()
+    {
+        static std::vector<TestCase> registered;
+        return registered;
+    }
+
+    struct Registration
+    {
+        Registration(const char* name, TestFunction function)
+        {
+            cases().push_back(TestCase{ name, function });
+        }
+    };
+
+    inline void fail(const std::string& message, const char* file, int line)
+    {
+        std::ostringstream out;
+        out << file << ':' << line << ": " << message;
+        throw std::runtime_error(out.str());
+    }
+}
+
+#define SIMTOOL_TEST(name)                                                      \
+    static void name();                                                         \
+    static const TestSuite::Registration name##Registration(#name, &name);      \
+    static void name()
+
+#define SIMTOOL_CHECK(condition)                                                \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            TestSuite::fail("check failed: " #condition, __FILE__, __LINE__);   \
+        }                                                                       \
+    } while (false)
+
+// Like SIMTOOL_CHECK, with a message built from stream insertions
+#define SIMTOOL_CHECK_MESSAGE(condition, message)                               \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::ostringstream simtoolMessage;                                  \
+            simtoolMessage << "check failed: " #condition " (" << message << ')'; \
+            TestSuite::fail(simtoolMessage.str(), __FILE__, __LINE__);          \
+        }                                                                       \
+    } while (false)
+
+#endif // TESTSUITE_H
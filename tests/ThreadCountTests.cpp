@@ -0,0 +1,65 @@
+// Chunked parallel loops combine their partial results in chunk order, so
+// a run must end bit-identical for any number of threads.
+#include "TestModels.h"
+#include "TestSuite.h"
+#include <string>
+
+namespace {
+
+const int Steps = 50;
+
+// Enough DOF for three ParallelGrain chunks, so every thread count splits differently
+const int ChainDOF = 3 * 4096;
+
+void checkThreadCounts(SimulationParameters params, const StructuralModel& model, const std::string& label)
+{
+    params.numThreads = 1;
+    const SimulationState reference = TestModels::run(params, model, Steps);
+    SIMTOOL_CHECK_MESSAGE(reference.currentStep > 0, label);
+    for (int threads : { 2, 3, 4 }) {
+        params.numThreads = threads;
+        SIMTOOL_CHECK_MESSAGE(TestModels::identical(TestModels::run(params, model, Steps), reference),
+                              label << ", " << threads << " threads");
+    }
+}
+
+} // namespace
+
+SIMTOOL_TEST(thread_count_determinism)
+{
+    const IntegratorType integrators[] = {
+        IntegratorType::SymplecticEuler, IntegratorType::VelocityVerlet, IntegratorType::RungeKutta4,
+        IntegratorType::Newmark, IntegratorType::DormandPrince54, IntegratorType::BackwardEuler,
+        IntegratorType::ImplicitNewmark, IntegratorType::ModalSuperposition
+    };
+    const StructuralModel chain = StructuralModel::makeChain(ChainDOF);
+    for (IntegratorType integrator : integrators) {
+        SimulationParameters params;
+        params.integrator = integrator;
+        params.timeStep = 1e-3;
+        params.modeCount = 8;
+        checkThreadCounts(params, chain, "chain, integrator " + std::to_string(static_cast<int>(integrator)));
+    }
+
+    // Reduced precision keeps its own reductions
+    SimulationParameters single;
+    single.integrator = IntegratorType::VelocityVerlet;
+    single.precision = ScalarPrecision::Single;
+    single.precisionCheckSteps = 0;
+    single.timeStep = 1e-3;
+    checkThreadCounts(single, chain, "chain, single precision");
+
+    // Contact forces are gathered per node, Newton iterations reduce residual norms
+    const StructuralModel plates = TestModels::makeTwoPlates(50, 0.02);
+    SimulationParameters contact;
+    contact.integrator = IntegratorType::SymplecticEuler;
+    contact.timeStep = 1e-3;
+    contact.contactStiffness = 1e4;
+    checkThreadCounts(contact, plates, "plates, contact");
+
+    SimulationParameters newton;
+    newton.integrator = IntegratorType::BackwardEuler;
+    newton.nonlinearMethod = NonlinearMethod::Newton;
+    newton.timeStep = 1e-3;
+    checkThreadCounts(newton, plates, "plates, Newton");
+}
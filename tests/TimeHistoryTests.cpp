@@ -0,0 +1,143 @@
+// Every recorded frame must read back from the .simh file through
+// TimeHistoryReader, a file cut short must stay readable up to its last
+// whole chunk, and the CSV export must hold one row per frame.
+#include "TestModels.h"
+#include "TestSuite.h"
+#include "TimeHistoryRecorder.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const HistoryPath = "time_history_round_trip.simh";
+const char* const CsvPath = "time_history_round_trip.csv";
+
+double stored(double value, bool doublePrecision)
+{
+    return doublePrecision ? value : static_cast<double>(static_cast<float>(value));
+}
+
+// Compare the frames of one chunk, starting at frame first of the recorded ones
+void checkChunk(const TimeHistoryReader::Chunk& chunk, const std::vector<SimulationState>& frames,
+                size_t first, bool doublePrecision)
+{
+    const size_t numDOF = frames[0].positions.size();
+    for (int f = 0; f < chunk.frames; ++f) {
+        const SimulationState& state = frames[first + f];
+        SIMTOOL_CHECK(chunk.times[f] == state.currentTime);
+        SIMTOOL_CHECK(chunk.steps[f] == state.currentStep);
+        SIMTOOL_CHECK(chunk.timeSteps[f] == state.timeStep);
+        SIMTOOL_CHECK(chunk.energies[f] == state.energy);
+        const AlignedVector* fields[3] = { &state.positions, &state.velocities, &state.accelerations };
+        for (int field = 0; field < 3; ++field) {
+            const double* column = chunk.columns.data() + (static_cast<size_t>(field) * chunk.frames + f) * numDOF;
+            for (size_t i = 0; i < numDOF; ++i) {
+                SIMTOOL_CHECK_MESSAGE(column[i] == stored((*fields[field])[i], doublePrecision),
+                                      "frame " << first + f << ", field " << field << ", DOF " << i);
+            }
+        }
+    }
+}
+
+} // namespace
+
+SIMTOOL_TEST(time_history_round_trip)
+{
+    const StructuralModel plates = TestModels::makeTwoPlates(12, 0.02);
+    SimulationParameters params;
+    params.integrator = IntegratorType::DormandPrince54;   // Varying step sizes in the time index
+    params.timeStep = 1e-3;
+    params.numThreads = 1;
+
+    for (bool doublePrecision : { false, true }) {
+        TimeHistoryRecorder::Options options;
+        options.fields = TimeHistoryRecorder::Positions | TimeHistoryRecorder::Velocities
+                       | TimeHistoryRecorder::Accelerations;
+        options.recordInterval = 3;
+        options.chunkFrames = 16;
+        options.blockSize = 100;            // Uneven last block
+        options.queueFrames = 128;          // Holds the whole run, so no frame is dropped
+        options.doublePrecision = doublePrecision;
+
+        std::remove(HistoryPath);
+        TimeHistoryRecorder recorder(options);
+        recorder.setOutputFile(HistoryPath);
+        SIMTOOL_CHECK_MESSAGE(recorder.start(plates.numDOF()), recorder.lastError());
+
+        SimulationSolver solver;
+        solver.initialize(params, plates);
+        std::vector<SimulationState> frames;
+        solver.dispatch([&](auto policy) {
+            typedef decltype(policy) Integrator;
+            for (int i = 0; i < 200; ++i) {
+                solver.step<Integrator>();
+                if (recorder.isDue(solver.currentStep())) {
+                    SIMTOOL_CHECK(recorder.record(solver.state()));
+                    frames.push_back(solver.state());
+                } else {
+                    SIMTOOL_CHECK(!recorder.record(solver.state()));
+                }
+            }
+        });
+        recorder.finish();
+        SIMTOOL_CHECK(recorder.droppedCount() == 0);
+        SIMTOOL_CHECK(recorder.writtenCount() == static_cast<long long>(frames.size()));
+        SIMTOOL_CHECK(frames.size() == 200 / 3);
+
+        // Every frame reads back: float-rounded fields, exact time index
+        // (the reader is scoped, so the file is closed before it is cut below)
+        TimeHistoryReader::Chunk chunk;
+        size_t chunkCount = 0;
+        int lastFrames = 0;
+        {
+            TimeHistoryReader reader;
+            SIMTOOL_CHECK_MESSAGE(reader.open(HistoryPath), reader.lastError());
+            SIMTOOL_CHECK(reader.numDOF() == plates.numDOF());
+            SIMTOOL_CHECK(reader.fieldCount() == 3);
+            SIMTOOL_CHECK(reader.frameCount() == static_cast<long long>(frames.size()));
+            size_t first = 0;
+            for (int c = 0; c < static_cast<int>(reader.chunks().size()); ++c) {
+                SIMTOOL_CHECK_MESSAGE(reader.readChunk(c, chunk), reader.lastError());
+                checkChunk(chunk, frames, first, doublePrecision);
+                first += chunk.frames;
+            }
+            SIMTOOL_CHECK(first == frames.size());
+
+            // One CSV row per frame after the header
+            SIMTOOL_CHECK_MESSAGE(reader.exportCsv(CsvPath), reader.lastError());
+            std::ifstream csv(CsvPath);
+            std::string line;
+            long long rows = 0;
+            while (std::getline(csv, line)) {
+                ++rows;
+            }
+            csv.close();
+            SIMTOOL_CHECK(rows == reader.frameCount() + 1);
+            chunkCount = reader.chunks().size();
+            lastFrames = reader.chunks().back().frames;
+        }
+
+        // A crash mid-chunk: the file ends a few bytes short, the whole chunks still read
+        std::vector<char> bytes;
+        {
+            std::ifstream in(HistoryPath, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream out(HistoryPath, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 5));
+        }
+        TimeHistoryReader truncated;
+        SIMTOOL_CHECK_MESSAGE(truncated.open(HistoryPath), truncated.lastError());
+        SIMTOOL_CHECK(truncated.frameCount() == static_cast<long long>(frames.size()) - lastFrames);
+        SIMTOOL_CHECK(truncated.chunks().size() == chunkCount - 1);
+        SIMTOOL_CHECK(truncated.readChunk(0, chunk));
+        checkChunk(chunk, frames, 0, doublePrecision);
+    }
+
+    std::remove(HistoryPath);
+    std::remove(CsvPath);
+}
@@ -0,0 +1,58 @@
+// Test runner: runs the cases named on the command line, or every case.
+// Built as SimulationToolTests with SIMTOOL_COUNT_ALLOCATIONS; ctest runs
+// one case per entry (see CMakeLists.txt).
+#include "DomainExchange.h"
+#include "TestSuite.h"
+#include <QCoreApplication>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("SimulationToolTests");
+
+    // The domain decomposition case starts this executable as its workers
+    if (argc == 5 && std::strcmp(argv[1], "--domain-worker") == 0 && std::strcmp(argv[3], "--domain-rank") == 0) {
+        return DomainWorker::run(QString::fromLocal8Bit(argv[2]), std::atoi(argv[4]));
+    }
+
+    std::vector<TestSuite::TestCase> selected;
+    if (argc < 2) {
+        selected = TestSuite::cases();
+    }
+    for (int i = 1; i < argc; ++i) {
+        bool found = false;
+        for (const TestSuite::TestCase& test : TestSuite::cases()) {
+            if (std::strcmp(test.name, argv[i]) == 0) {
+                selected.push_back(test);
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "Unknown test " << argv[i] << "; available:";
+            for (const TestSuite::TestCase& test : TestSuite::cases()) {
+                std::cerr << ' ' << test.name;
+            }
+            std::cerr << std::endl;
+            return 2;
+        }
+    }
+
+    int failed = 0;
+    for (const TestSuite::TestCase& test : selected) {
+        try {
+            test.function();
+            std::cout << "[PASS] " << test.name << std::endl;
+        }
+        catch (const std::exception& e) {
+            std::cout << "[FAIL] " << test.name << ": " << e.what() << std::endl;
+            ++failed;
+        }
+    }
+    std::cout << "[SimulationToolTests] " << static_cast<int>(selected.size()) - failed << " of " << selected.size()
+              << " passed" << std::endl;
+    return failed ? 1 : 0;
+}